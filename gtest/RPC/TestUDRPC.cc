@@ -0,0 +1,80 @@
+#include "TestUDRPC.h"
+
+void TestUDRPC::SetUp() {
+  Config::RDMA_MEMSIZE = 4 * 1024 * 1024;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+  m_rdmaServer = std::make_unique<RDMAServer<SegmentedUnreliableRDMA>>();
+  ASSERT_TRUE(m_rdmaServer->startServer());
+  m_handler = std::make_unique<IncrementHandler>(m_rdmaServer.get(), 16);
+  ASSERT_TRUE(m_handler->startHandler());
+
+  m_connection = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  m_rdmaClient = std::make_unique<RDMAClient<SegmentedUnreliableRDMA>>();
+  ASSERT_TRUE(m_rdmaClient->connect(m_connection, m_nodeId));
+}
+
+void TestUDRPC::TearDown() {
+  m_handler->stopHandler();
+}
+
+
+TEST_F(TestUDRPC, testCall) {
+  UDRPCClient<testMsg> client(m_rdmaClient.get(), m_nodeId);
+  const size_t calls = 100;
+  for (size_t i = 0; i < calls; ++i) {
+    testMsg request{i};
+    testMsg response{0};
+    ASSERT_TRUE(client.call(&request, &response));
+    ASSERT_EQ(response.value, i + 1);
+  }
+  // retransmitted requests are not handled again
+  ASSERT_EQ(m_handler->m_handled, calls);
+}
+
+
+TEST_F(TestUDRPC, testDuplicateSuppression) {
+  const size_t msgSize = sizeof(ud_rpc_hdr_t) + sizeof(testMsg);
+  char* request = (char*) m_rdmaClient->localAlloc(msgSize);
+  auto hdr = (ud_rpc_hdr_t*) request;
+  hdr->reqID = 1;
+  hdr->epoch = 7;
+  hdr->nodeID = m_rdmaClient->getOwnNodeID();
+  ((testMsg*) (request + sizeof(ud_rpc_hdr_t)))->value = 41;
+
+  std::vector<char> responses(2 * msgSize);
+  m_rdmaClient->receiveMessage(responses.data(), msgSize);
+  m_rdmaClient->receiveMessage(responses.data() + msgSize, msgSize);
+
+  // a retransmitted request is answered again but handled once
+  m_rdmaClient->sendMessage(m_nodeId, request, msgSize);
+  m_rdmaClient->sendMessage(m_nodeId, request, msgSize);
+  for (size_t i = 0; i < 2; ++i) {
+    SegmentedUnreliableRDMA::ud_message_t msg;
+    ASSERT_TRUE(m_rdmaClient->pollReceiveMessage(msg, true));
+    ASSERT_EQ(msg.size, msgSize);
+    ASSERT_EQ(((ud_rpc_hdr_t*) msg.memAddr)->reqID, 1u);
+    ASSERT_EQ(((testMsg*) ((char*) msg.memAddr + sizeof(ud_rpc_hdr_t)))->value, 42u);
+  }
+  ASSERT_EQ(m_handler->m_handled, 1u);
+  m_rdmaClient->localFree(request);
+}
+
+
+TEST_F(TestUDRPC, testClientsOfSameNode) {
+  // request IDs of a recreated client start at 1 again on the same node
+  const size_t calls = 10;
+  for (size_t c = 0; c < 2; ++c) {
+    UDRPCClient<testMsg> client(m_rdmaClient.get(), m_nodeId);
+    // responses are not demultiplexed between clients of a RDMAClient
+    ASSERT_THROW(UDRPCClient<testMsg>(m_rdmaClient.get(), m_nodeId), runtime_error);
+    for (size_t i = 0; i < calls; ++i) {
+      testMsg request{100 * c + i};
+      testMsg response{0};
+      ASSERT_TRUE(client.call(&request, &response));
+      ASSERT_EQ(response.value, 100 * c + i + 1);
+    }
+  }
+  ASSERT_EQ(m_handler->m_handled, 2 * calls);
+}
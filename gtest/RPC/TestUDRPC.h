@@ -0,0 +1,50 @@
+/**
+ * @file TestUDRPC.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestUDRPC_H_
+#define SRC_TEST_NET_TestUDRPC_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/RPC/UDRPCHandlerThread.h"
+#include "../../src/RPC/UDRPCClient.h"
+#include <gtest/gtest.h>
+
+
+using namespace rdma;
+
+class TestUDRPC : public testing::Test {
+protected:
+
+  struct testMsg {
+    uint64_t value;
+  };
+
+  // answers with the value incremented by one
+  class IncrementHandler : public UDRPCHandlerThread<testMsg> {
+  public:
+    using UDRPCHandlerThread<testMsg>::UDRPCHandlerThread;
+
+    void handleRDMARPC(testMsg* message, NodeID &) override {
+      m_handled++;
+      m_intermediateRspBuffer->value = message->value + 1;
+    }
+
+    std::atomic<size_t> m_handled {0};
+  };
+
+  void SetUp() override;
+  void TearDown() override;
+
+  std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+  std::unique_ptr<RDMAServer<SegmentedUnreliableRDMA>> m_rdmaServer;
+  std::unique_ptr<RDMAClient<SegmentedUnreliableRDMA>> m_rdmaClient;
+  std::unique_ptr<IncrementHandler> m_handler;
+  string m_connection;
+
+  NodeID m_nodeId = 0;
+};
+
+#endif /* SRC_TEST_NET_TestUDRPC_H_ */
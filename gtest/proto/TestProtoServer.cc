@@ -19,3 +19,31 @@ TEST_F(TestProtoServer,testMsgExchange) {
   ASSERT_EQ(m_testServer->msgReceived(), msg);
   ASSERT_EQ(m_testClient->msgReceived(), msg);
 }
+
+TEST_F(TestProtoServer,testStopServer) {
+  m_testClient->hello("BeforeStop");
+  ASSERT_TRUE(m_testServer->isRunning());
+  m_testServer->stopServer();
+  ASSERT_FALSE(m_testServer->isRunning());
+}
+
+TEST_F(TestProtoServer,testInprocSharedContext) {
+  // inproc endpoints only work between sockets of the same context
+  ProtoSocket receiver("inproc://TestProtoServer", ZMQ_PAIR);
+  ASSERT_TRUE(receiver.bind());
+  ProtoSocket sender("inproc://TestProtoServer", ZMQ_PAIR);
+  ASSERT_TRUE(sender.connect());
+
+  HelloMessage sendMsg;
+  sendMsg.set_name("Inproc");
+  Any sendAny;
+  sendAny.PackFrom(sendMsg);
+  ASSERT_TRUE(sender.send(&sendAny));
+
+  Any rcvAny;
+  ASSERT_TRUE(receiver.receive(&rcvAny));
+  ASSERT_TRUE(rcvAny.Is<HelloMessage>());
+  HelloMessage rcvMsg;
+  rcvAny.UnpackTo(&rcvMsg);
+  ASSERT_EQ(rcvMsg.name(), sendMsg.name());
+}
@@ -0,0 +1,80 @@
+#include "TestBroadcastTree.h"
+
+#include <thread>
+
+void TestBroadcastTree::SetUp() {
+  Config::RDMA_MEMSIZE = 1024 * 1024 * 16;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+
+  m_rdmaServer1 = std::make_unique<RDMAServer<ReliableRDMA>>("Server1", Config::RDMA_PORT);
+  m_rdmaServer2 = std::make_unique<RDMAServer<ReliableRDMA>>("Server2", Config::RDMA_PORT + 1);
+  ASSERT_TRUE(m_rdmaServer1->startServer());
+  ASSERT_TRUE(m_rdmaServer2->startServer());
+  m_rdmaClient = std::make_unique<RDMAClient<ReliableRDMA>>();
+
+  string connection1 = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  string connection2 = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT + 1);
+  NodeID server1ID;
+  NodeID server2ID;
+  ASSERT_TRUE(m_rdmaServer2->connect(connection1, server1ID));
+  ASSERT_TRUE(m_rdmaClient->connect(connection1, server1ID));
+  ASSERT_TRUE(m_rdmaClient->connect(connection2, server2ID));
+
+  m_members = {server1ID, server2ID, m_rdmaClient->getOwnNodeID()};
+}
+
+void TestBroadcastTree::testBroadcast(BroadcastTree::Topology topology) {
+  size_t oldChunkSize = Config::RDMA_BULK_CHUNK_SIZE;
+  Config::RDMA_BULK_CHUNK_SIZE = 64 * 1024;
+  const size_t size = 1024 * 1024 * 4 + 100;  // last chunk is not full
+
+  BroadcastTree root(m_rdmaServer1.get(), m_members[0], m_members, topology);
+  BroadcastTree inner(m_rdmaServer2.get(), m_members[1], m_members, topology);
+  BroadcastTree leaf(m_rdmaClient.get(), m_members[2], m_members, topology);
+
+  char *data = (char *)m_rdmaServer1->localAlloc(size);
+  char *data2 = (char *)m_rdmaServer2->localAlloc(size);
+  char *data3 = (char *)m_rdmaClient->localAlloc(size);
+
+  // several rounds, the buffers are reused
+  for (int round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < size; ++i) {
+      data[i] = (char)(i * 7 + round);
+    }
+    memset(data2, 0, size);
+    memset(data3, 0, size);
+
+    std::thread innerThread([&]() { inner.broadcast(data2, size); });
+    std::thread leafThread([&]() { leaf.broadcast(data3, size); });
+    ASSERT_NO_THROW(root.broadcast(data, size));
+    innerThread.join();
+    leafThread.join();
+
+    ASSERT_EQ(0, memcmp(data, data2, size));
+    ASSERT_EQ(0, memcmp(data, data3, size));
+  }
+  Config::RDMA_BULK_CHUNK_SIZE = oldChunkSize;
+}
+
+
+TEST_F(TestBroadcastTree, testTopology) {
+  BroadcastTree root(m_rdmaServer1.get(), m_members[0], m_members, BroadcastTree::BINOMIAL);
+  ASSERT_TRUE(root.isRoot());
+  ASSERT_EQ(2, root.getChildren().size());
+  BroadcastTree leaf(m_rdmaClient.get(), m_members[2], m_members, BroadcastTree::BINOMIAL);
+  ASSERT_EQ(m_members[0], leaf.getParent());
+
+  BroadcastTree chainLeaf(m_rdmaClient.get(), m_members[2], m_members, BroadcastTree::CHAIN);
+  ASSERT_EQ(m_members[1], chainLeaf.getParent());
+  ASSERT_EQ(0, chainLeaf.getChildren().size());
+}
+
+TEST_F(TestBroadcastTree, testBinomial) {
+  testBroadcast(BroadcastTree::BINOMIAL);
+}
+
+TEST_F(TestBroadcastTree, testChain) {
+  testBroadcast(BroadcastTree::CHAIN);
+}
@@ -0,0 +1,35 @@
+/**
+ * @file TestBroadcastTree.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestBroadcastTree_H_
+#define SRC_TEST_NET_TestBroadcastTree_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/rdma/RDMAServer.h"
+#include "../../src/rdma/RDMAClient.h"
+#include "../../src/rdma/BroadcastTree.h"
+#include <gtest/gtest.h>
+
+
+using namespace rdma;
+
+class TestBroadcastTree : public testing::Test
+{
+ protected:
+    void SetUp();
+    void testBroadcast(BroadcastTree::Topology topology);
+
+    std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+
+    // root, inner node and leaf of the chain, root and two children of the binomial tree
+    std::unique_ptr<RDMAServer<ReliableRDMA>> m_rdmaServer1;
+    std::unique_ptr<RDMAServer<ReliableRDMA>> m_rdmaServer2;
+    std::unique_ptr<RDMAClient<ReliableRDMA>> m_rdmaClient;
+
+    std::vector<NodeID> m_members;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "TestCollectives.h"
+
+#include <atomic>
+#include <thread>
+
+void TestCollectives::SetUp() {
+  Config::RDMA_MEMSIZE = 1024 * 1024;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+
+  m_rdmaServer1 = std::make_unique<RDMAServer<ReliableRDMA>>("Server1", Config::RDMA_PORT);
+  m_rdmaServer2 = std::make_unique<RDMAServer<ReliableRDMA>>("Server2", Config::RDMA_PORT + 1);
+  ASSERT_TRUE(m_rdmaServer1->startServer());
+  ASSERT_TRUE(m_rdmaServer2->startServer());
+  m_rdmaClient = std::make_unique<RDMAClient<ReliableRDMA>>();
+
+  string connection1 = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  string connection2 = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT + 1);
+  NodeID server1ID;
+  NodeID server2ID;
+  ASSERT_TRUE(m_rdmaServer2->connect(connection1, server1ID));
+  ASSERT_TRUE(m_rdmaClient->connect(connection1, server1ID));
+  ASSERT_TRUE(m_rdmaClient->connect(connection2, server2ID));
+
+  std::vector<NodeID> members = {server1ID, server2ID, m_rdmaClient->getOwnNodeID()};
+  m_collectives.push_back(std::make_unique<Collectives>(m_rdmaServer1.get(), server1ID, members, 4));
+  m_collectives.push_back(std::make_unique<Collectives>(m_rdmaServer2.get(), server2ID, members, 4));
+  m_collectives.push_back(std::make_unique<Collectives>(m_rdmaClient.get(), members[2], members, 4));
+}
+
+void TestCollectives::runAll(std::function<void(Collectives &collectives)> func) {
+  std::vector<std::thread> threads;
+  for (auto &collectives : m_collectives) {
+    Collectives *member = collectives.get();
+    threads.emplace_back([member, &func]() { func(*member); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+
+TEST_F(TestCollectives, testBarrier) {
+  std::atomic<size_t> entered(0);
+  std::atomic<bool> early(false);
+  runAll([&](Collectives &collectives) {
+    for (size_t i = 1; i <= 100; ++i) {
+      entered++;
+      collectives.barrier();
+      // nobody leaves before all entered
+      if (entered < i * m_collectives.size()) {
+        early = true;
+      }
+      collectives.barrier();
+    }
+  });
+  ASSERT_FALSE(early);
+}
+
+TEST_F(TestCollectives, testAllreduce) {
+  runAll([&](Collectives &collectives) {
+    for (uint64_t i = 0; i < 100; ++i) {
+      uint64_t rank = collectives.getRank();
+      uint64_t values[3] = {rank + i, rank * 10, 7};
+      collectives.allreduce(values, 3, Collectives::SUM);
+      ASSERT_EQ(3 + 3 * i, values[0]);
+      ASSERT_EQ(30, values[1]);
+      ASSERT_EQ(21, values[2]);
+
+      int64_t signedValues[2] = {(int64_t)rank - 1, (int64_t)(rank * i)};
+      collectives.allreduce(signedValues, 2, Collectives::MIN);
+      ASSERT_EQ(-1, signedValues[0]);
+      ASSERT_EQ(0, signedValues[1]);
+
+      // another count in the same slots
+      int64_t max = -(int64_t)rank;
+      collectives.allreduce(&max, 1, Collectives::MAX);
+      ASSERT_EQ(0, max);
+    }
+  });
+}
+
+TEST_F(TestCollectives, testAllgather) {
+  runAll([&](Collectives &collectives) {
+    for (uint64_t i = 0; i < 100; ++i) {
+      uint64_t rank = collectives.getRank();
+      uint64_t values[2] = {rank, i};
+      uint64_t result[6];
+      collectives.allgather(values, 2, result);
+      for (uint64_t r = 0; r < 3; ++r) {
+        ASSERT_EQ(r, result[r * 2]);
+        ASSERT_EQ(i, result[r * 2 + 1]);
+      }
+    }
+  });
+}
+
+TEST_F(TestCollectives, testTooManyValues) {
+  uint64_t values[5];
+  ASSERT_THROW(m_collectives[0]->allreduce(values, 5, Collectives::SUM), runtime_error);
+}
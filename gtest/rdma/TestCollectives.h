@@ -0,0 +1,38 @@
+/**
+ * @file TestCollectives.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestCollectives_H_
+#define SRC_TEST_NET_TestCollectives_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/rdma/RDMAServer.h"
+#include "../../src/rdma/RDMAClient.h"
+#include "../../src/rdma/Collectives.h"
+#include <gtest/gtest.h>
+
+#include <functional>
+
+
+using namespace rdma;
+
+class TestCollectives : public testing::Test
+{
+ protected:
+    void SetUp();
+    // runs func concurrently on all members
+    void runAll(std::function<void(Collectives &collectives)> func);
+
+    std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+
+    // three members (not a power of two), fully connected
+    std::unique_ptr<RDMAServer<ReliableRDMA>> m_rdmaServer1;
+    std::unique_ptr<RDMAServer<ReliableRDMA>> m_rdmaServer2;
+    std::unique_ptr<RDMAClient<ReliableRDMA>> m_rdmaClient;
+
+    std::vector<std::unique_ptr<Collectives>> m_collectives;
+};
+
+#endif
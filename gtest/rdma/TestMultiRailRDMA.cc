@@ -0,0 +1,64 @@
+#include "TestMultiRailRDMA.h"
+
+void TestMultiRailRDMA::SetUp() {
+  // e.g. Config::RDMA_RAILS = "rxe0:1,rxe1:1" with two Soft-RoCE devices
+  Config::RDMA_MEMSIZE = 4 * 1024 * 1024;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+  m_rdmaServer = std::make_unique<RDMAServer<MultiRailRDMA>>();
+  m_rdmaServer->startServer();
+  m_connection = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  m_rdmaClient = std::make_unique<RDMAClient<MultiRailRDMA>>();
+
+  ASSERT_TRUE(m_rdmaClient->connect(m_connection, m_nodeId));
+  ASSERT_EQ(m_rdmaClient->getRailCount(m_nodeId), std::min(m_rdmaClient->getRailCount(), m_rdmaServer->getRailCount()));
+}
+
+
+TEST_F(TestMultiRailRDMA, testStripedWriteRead) {
+  size_t memSize = 2 * Config::RDMA_STRIPE_THRESHOLD + 100;
+  size_t remoteOffset = 0;
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, memSize, remoteOffset));
+  char* localValues = (char*) m_rdmaClient->localAlloc(memSize);
+  for (size_t i = 0; i < memSize; ++i) {
+    localValues[i] = (char) i;
+  }
+
+  m_rdmaClient->write(m_nodeId, remoteOffset, localValues, memSize, true);
+  char* remoteValues = (char*) m_rdmaServer->getBuffer(remoteOffset);
+  for (size_t i = 0; i < memSize; ++i) {
+    ASSERT_EQ(remoteValues[i], (char) i);
+  }
+
+  memset(localValues, 0, memSize);
+  m_rdmaClient->read(m_nodeId, remoteOffset, localValues, memSize, true);
+  for (size_t i = 0; i < memSize; ++i) {
+    ASSERT_EQ(localValues[i], (char) i);
+  }
+
+  m_rdmaClient->localFree(localValues);
+  ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, memSize, remoteOffset));
+}
+
+TEST_F(TestMultiRailRDMA, testSmallWrites) {
+  // small writes of different pages are spread over the rails,
+  // the last signaled write completes all of them
+  const size_t pages = 16;
+  size_t memSize = pages * 4096;
+  size_t remoteOffset = 0;
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, memSize, remoteOffset));
+  uint64_t* localValue = (uint64_t*) m_rdmaClient->localAlloc(sizeof(uint64_t));
+  *localValue = 42;
+
+  for (size_t p = 0; p < pages; ++p) {
+    m_rdmaClient->write(m_nodeId, remoteOffset + p * 4096, localValue, sizeof(uint64_t), p == pages - 1);
+  }
+  char* remoteValues = (char*) m_rdmaServer->getBuffer(remoteOffset);
+  for (size_t p = 0; p < pages; ++p) {
+    ASSERT_EQ(*(uint64_t*)(remoteValues + p * 4096), 42u);
+  }
+
+  m_rdmaClient->localFree(localValue);
+  ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, memSize, remoteOffset));
+}
@@ -0,0 +1,32 @@
+/**
+ * @file TestMultiRailRDMA.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestMultiRailRDMA_H_
+#define SRC_TEST_NET_TestMultiRailRDMA_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/rdma/RDMAServer.h"
+#include "../../src/rdma/RDMAClient.h"
+#include "../../src/rdma/MultiRailRDMA.h"
+#include <gtest/gtest.h>
+
+
+using namespace rdma;
+
+class TestMultiRailRDMA : public testing::Test {
+protected:
+
+  void SetUp() override;
+
+  std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+  std::unique_ptr<RDMAServer<MultiRailRDMA>> m_rdmaServer;
+  std::unique_ptr<RDMAClient<MultiRailRDMA>> m_rdmaClient;
+  string m_connection;
+
+  NodeID m_nodeId = 0;
+};
+
+#endif /* SRC_TEST_NET_TestMultiRailRDMA_H_ */
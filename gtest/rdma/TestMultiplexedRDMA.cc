@@ -0,0 +1,129 @@
+#include "TestMultiplexedRDMA.h"
+
+#include <set>
+#include <thread>
+
+void TestMultiplexedRDMA::SetUp() {
+  Config::RDMA_MEMSIZE = 1024 * 1024;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+  m_rdmaServer = std::make_unique<RDMAServer<ReliableRDMA>>();
+  m_rdmaServer->startServer();
+  m_connection = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  m_rdmaClient = std::make_unique<RDMAClient<MultiplexedRDMA>>();
+
+  ASSERT_TRUE(m_rdmaClient->connect(m_connection, m_nodeId));
+}
+
+
+TEST_F(TestMultiplexedRDMA, testConcurrentWrites) {
+  const size_t threads = 4;
+  const size_t iterations = 1000;
+  size_t remoteOffset = 0;
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, threads * sizeof(uint64_t), remoteOffset));
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      auto conn = m_rdmaClient->openLogicalConnection(m_nodeId);
+      uint64_t* localValues = (uint64_t*) m_rdmaClient->localAlloc(iterations * sizeof(uint64_t));
+      for (size_t i = 1; i <= iterations; ++i) {
+        // unsignaled writes are batched, only every 16th and the last write is signaled
+        localValues[i - 1] = i;
+        conn->write(remoteOffset + t * sizeof(uint64_t), &localValues[i - 1], sizeof(uint64_t),
+                    i % 16 == 0 || i == iterations);
+      }
+      ASSERT_TRUE(conn->pollSend(false));
+      m_rdmaClient->closeLogicalConnection(conn);
+      m_rdmaClient->localFree(localValues);
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  uint64_t* remoteValues = (uint64_t*) m_rdmaServer->getBuffer(remoteOffset);
+  for (size_t t = 0; t < threads; ++t) {
+    ASSERT_EQ(remoteValues[t], iterations);
+  }
+  ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, threads * sizeof(uint64_t), remoteOffset));
+}
+
+TEST_F(TestMultiplexedRDMA, testQPPool) {
+  const size_t poolSize = 4;
+  ASSERT_TRUE(m_rdmaClient->connectQPPool(m_nodeId, poolSize));
+  ASSERT_EQ(m_rdmaClient->getPoolSize(m_nodeId), poolSize);
+
+  // logical connections are spread evenly over the QPs of the pool
+  std::vector<MultiplexedRDMA::LogicalConnection*> conns;
+  std::set<size_t> connIDs;
+  for (size_t i = 0; i < 2 * poolSize; ++i) {
+    conns.push_back(m_rdmaClient->openLogicalConnection(m_nodeId));
+    connIDs.insert(conns.back()->getConnID());
+  }
+  ASSERT_EQ(connIDs.size(), poolSize);
+
+  size_t remoteOffset = 0;
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, conns.size() * sizeof(uint64_t), remoteOffset));
+  uint64_t* localValues = (uint64_t*) m_rdmaClient->localAlloc(conns.size() * sizeof(uint64_t));
+  for (size_t i = 0; i < conns.size(); ++i) {
+    localValues[i] = i + 1;
+    conns[i]->write(remoteOffset + i * sizeof(uint64_t), &localValues[i], sizeof(uint64_t), true);
+  }
+  uint64_t* remoteValues = (uint64_t*) m_rdmaServer->getBuffer(remoteOffset);
+  for (size_t i = 0; i < conns.size(); ++i) {
+    ASSERT_EQ(remoteValues[i], i + 1);
+    m_rdmaClient->closeLogicalConnection(conns[i]);
+  }
+  m_rdmaClient->localFree(localValues);
+  ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, conns.size() * sizeof(uint64_t), remoteOffset));
+}
+
+TEST_F(TestMultiplexedRDMA, testConcurrentFetchAndAdd) {
+  const size_t threads = 4;
+  const size_t iterations = 1000;
+  size_t remoteOffset = 0;
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, sizeof(uint64_t), remoteOffset));
+  uint64_t* remoteValue = (uint64_t*) m_rdmaServer->getBuffer(remoteOffset);
+  *remoteValue = 0;
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&]() {
+      auto conn = m_rdmaClient->openLogicalConnection(m_nodeId);
+      uint64_t* localValue = (uint64_t*) m_rdmaClient->localAlloc(sizeof(uint64_t));
+      for (size_t i = 0; i < iterations; ++i) {
+        conn->fetchAndAdd(remoteOffset, localValue, 1, true);
+      }
+      m_rdmaClient->closeLogicalConnection(conn);
+      m_rdmaClient->localFree(localValue);
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  ASSERT_EQ(*remoteValue, threads * iterations);
+  ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, sizeof(uint64_t), remoteOffset));
+}
+
+TEST_F(TestMultiplexedRDMA, testReceiveRouting) {
+  auto conn = m_rdmaClient->openLogicalConnection(m_nodeId);
+  int* localValue = (int*) m_rdmaClient->localAlloc(sizeof(int));
+  int* remoteValue = (int*) m_rdmaServer->localAlloc(sizeof(int));
+
+  conn->receive(localValue, sizeof(int));
+  ASSERT_EQ(conn->pollReceive(false), 0);
+
+  vector<size_t> clientIDs = m_rdmaServer->getConnectedConnIDs();
+  ASSERT_EQ(clientIDs.size(), 1u);
+  *remoteValue = 42;
+  m_rdmaServer->sendImm(clientIDs[0], remoteValue, sizeof(int), 7, true);
+
+  uint32_t imm = 0;
+  ASSERT_EQ(conn->pollReceive(true, &imm), 1);
+  ASSERT_EQ(*localValue, 42);
+  ASSERT_EQ(imm, 7u);
+  m_rdmaClient->closeLogicalConnection(conn);
+}
@@ -0,0 +1,92 @@
+#include "TestNodeMembership.h"
+
+void TestNodeMembership::SetUp() {
+  m_sequencerIpPort = "127.0.0.1:" + to_string(Config::SEQUENCER_PORT);
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+  ASSERT_TRUE(m_protoClient.connectProto(m_sequencerIpPort));
+
+  m_membership = std::make_unique<NodeMembership>(m_sequencerIpPort);
+  ASSERT_TRUE(m_membership->subscribe());
+  sync();
+}
+
+NodeID TestNodeMembership::registerNode(string ipPort, NodeType::Enum nodeType) {
+  Any sendAny = ProtoMessageFactory::createNodeIDRequest(ipPort, "TestNode", nodeType);
+  Any rcvAny;
+  m_protoClient.exchangeProtoMsg(m_sequencerIpPort, &sendAny, &rcvAny);
+  NodeIDResponse response;
+  rcvAny.UnpackTo(&response);
+  return response.nodeid();
+}
+
+void TestNodeMembership::sync() {
+  Any sendAny = ProtoMessageFactory::createGetAllNodeIDsRequest(0);
+  Any rcvAny;
+  m_protoClient.exchangeProtoMsg(m_sequencerIpPort, &sendAny, &rcvAny);
+  GetAllNodeIDsResponse snapshot;
+  rcvAny.UnpackTo(&snapshot);
+  m_membership->applySnapshot(snapshot);
+}
+
+
+TEST_F(TestNodeMembership, testJoinAndLeave) {
+  string serverIpPort = "127.0.0.1:5300";
+  NodeID nodeID;
+  ASSERT_FALSE(m_membership->lookupServer(serverIpPort, nodeID));
+
+  // join is pushed to the membership table
+  uint64_t version = m_membership->getVersion();
+  NodeID serverNodeID = registerNode(serverIpPort, NodeType::Enum::SERVER);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!m_membership->lookupServer(serverIpPort, nodeID)) {
+    ASSERT_TRUE(m_membership->waitForChange(version, deadline));
+    if (m_membership->needsSync()) sync();
+    version = m_membership->getVersion();
+  }
+  ASSERT_EQ(serverNodeID, nodeID);
+
+  // leave is pushed to the membership table
+  Any releaseAny = ProtoMessageFactory::createNodeIDReleaseRequest(serverNodeID);
+  Any rcvAny;
+  m_protoClient.exchangeProtoMsg(m_sequencerIpPort, &releaseAny, &rcvAny);
+  while (m_membership->lookupServer(serverIpPort, nodeID)) {
+    ASSERT_TRUE(m_membership->waitForChange(version, deadline));
+    if (m_membership->needsSync()) sync();
+    version = m_membership->getVersion();
+  }
+}
+
+TEST_F(TestNodeMembership, testSnapshot) {
+  NodeID clientNodeID = registerNode("127.0.0.1:5301", NodeType::Enum::CLIENT);
+  sync();
+  NodeMembership::MemberEntry_t entry;
+  ASSERT_TRUE(m_membership->lookup(clientNodeID, entry));
+  ASSERT_EQ(entry.nodeType, NodeType::Enum::CLIENT);
+
+  // clients are no servers
+  NodeID nodeID;
+  ASSERT_FALSE(m_membership->lookupServer("127.0.0.1:5301", nodeID));
+}
+
+TEST_F(TestNodeMembership, testReservedConnIDs) {
+  uint64_t version = m_membership->getVersion();
+  Any sendAny = ProtoMessageFactory::createConnIDReserveRequest(3);
+  Any rcvAny;
+  m_protoClient.exchangeProtoMsg(m_sequencerIpPort, &sendAny, &rcvAny);
+  ASSERT_TRUE(rcvAny.Is<NodeIDResponse>());
+  NodeIDResponse response;
+  rcvAny.UnpackTo(&response);
+  NodeID firstID = response.nodeid();
+
+  // the next node gets the id after the reserved ones
+  NodeID clientNodeID = registerNode("127.0.0.1:5302", NodeType::Enum::CLIENT);
+  ASSERT_EQ(clientNodeID, firstID + 3);
+
+  // reserved ids are no members and only the join changed the version
+  sync();
+  ASSERT_EQ(m_membership->getVersion(), version + 1);
+  NodeMembership::MemberEntry_t entry;
+  for (NodeID id = firstID; id < firstID + 3; ++id) {
+    ASSERT_FALSE(m_membership->lookup(id, entry));
+  }
+}
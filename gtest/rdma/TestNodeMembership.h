@@ -0,0 +1,33 @@
+/**
+ * @file TestNodeMembership.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestNodeMembership_H_
+#define SRC_TEST_NET_TestNodeMembership_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/proto/ProtoClient.h"
+#include "../../src/rdma/NodeIDSequencer.h"
+#include "../../src/rdma/NodeMembership.h"
+#include <gtest/gtest.h>
+
+
+using namespace rdma;
+
+class TestNodeMembership : public testing::Test {
+protected:
+
+  void SetUp() override;
+
+  NodeID registerNode(string ipPort, NodeType::Enum nodeType);
+  void sync();
+
+  std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+  std::unique_ptr<NodeMembership> m_membership;
+  ProtoClient m_protoClient;
+  string m_sequencerIpPort;
+};
+
+#endif /* SRC_TEST_NET_TestNodeMembership_H_ */
@@ -0,0 +1,52 @@
+#include "TestRDMACM.h"
+
+void TestRDMACM::SetUp() {
+  Config::RDMA_MEMSIZE = 1024 * 1024;
+  m_connection = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT + 1);
+
+  m_cmServer = std::make_unique<RDMACMServer>(Config::RDMA_PORT + 1);
+  ASSERT_TRUE(m_cmServer->startServer());
+  m_cmClient = std::make_unique<RDMACMClient>();
+
+  ASSERT_TRUE(m_cmClient->connect(m_connection, m_connID));
+}
+
+
+TEST_F(TestRDMACM, testWrite) {
+  size_t remoteOffset = 0;
+  size_t memSize = sizeof(int) * 2;
+
+  //allocate local array
+  int* localValues = (int*) m_cmClient->localAlloc(memSize);
+  ASSERT_TRUE(localValues!=nullptr);
+
+  //write to remote machine
+  localValues[0] = 1;
+  localValues[1] = 2;
+  m_cmClient->write(m_connID, remoteOffset, localValues, memSize, true);
+
+  //read from remote machine
+  int* remoteVals = (int*) m_cmServer->getBuffer();
+  ASSERT_EQ(remoteVals[0], localValues[0]);
+  ASSERT_EQ(remoteVals[1], localValues[1]);
+}
+
+TEST_F(TestRDMACM, testParallelConnect) {
+  // every connect has its own event channel
+  const size_t connects = 4;
+  std::vector<NodeID> connIDs(connects);
+  std::vector<std::thread> threads;
+  std::atomic<size_t> connected {0};
+  for (size_t i = 0; i < connects; ++i) {
+    threads.emplace_back([&, i] {
+      if (m_cmClient->connect(m_connection, connIDs[i])) connected++;
+    });
+  }
+  for (auto &t : threads) t.join();
+  ASSERT_EQ(connected, connects);
+
+  int* localValue = (int*) m_cmClient->localAlloc(sizeof(int));
+  *localValue = 42;
+  m_cmClient->write(connIDs[connects - 1], sizeof(int), localValue, sizeof(int), true);
+  ASSERT_EQ(((int*) m_cmServer->getBuffer())[1], 42);
+}
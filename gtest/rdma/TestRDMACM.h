@@ -0,0 +1,30 @@
+/**
+ * @file TestRDMACM.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestRDMACM_H_
+#define SRC_TEST_NET_TestRDMACM_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/rdma/RDMACMServer.h"
+#include "../../src/rdma/RDMACMClient.h"
+#include <gtest/gtest.h>
+
+
+using namespace rdma;
+
+class TestRDMACM : public testing::Test {
+protected:
+
+  void SetUp() override;
+
+  std::unique_ptr<RDMACMServer> m_cmServer;
+  std::unique_ptr<RDMACMClient> m_cmClient;
+  string m_connection;
+
+  NodeID m_connID = 0;
+};
+
+#endif /* SRC_TEST_NET_TestRDMACM_H_ */
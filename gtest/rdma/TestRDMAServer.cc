@@ -65,6 +65,44 @@ TEST_F(TestRDMAServer, testWrite) {
   ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, memSize, remoteOffset));
 }
 
+TEST_F(TestRDMAServer, testBulkWriteRead) {
+  // several chunks and windows with a small interleaved write
+  // restores the chunk size also if an assertion fails
+  struct ChunkSizeGuard {
+    size_t oldChunkSize = Config::RDMA_BULK_CHUNK_SIZE;
+    ~ChunkSizeGuard() { Config::RDMA_BULK_CHUNK_SIZE = oldChunkSize; }
+  } chunkSizeGuard;
+  Config::RDMA_BULK_CHUNK_SIZE = 4096;
+  size_t memSize = 64 * 4096 + 100;
+  size_t remoteOffset = 0;
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, memSize + sizeof(int), remoteOffset));
+  char* localValues = (char*) m_rdmaClient->localAlloc(memSize);
+  int* localValue = (int*) m_rdmaClient->localAlloc(sizeof(int));
+  for (size_t i = 0; i < memSize; ++i) {
+    localValues[i] = (char) i;
+  }
+
+  bulk_transfer_t transfer;
+  m_rdmaClient->startBulkWrite(transfer, m_nodeId, remoteOffset, localValues, memSize);
+  *localValue = 42;
+  m_rdmaClient->write(m_nodeId, remoteOffset + memSize, localValue, sizeof(int), true);
+  while (!m_rdmaClient->progressBulk(transfer)) {}
+
+  char* remoteValues = (char*) m_rdmaServer->getBuffer(remoteOffset);
+  for (size_t i = 0; i < memSize; ++i) {
+    ASSERT_EQ(remoteValues[i], (char) i);
+  }
+  ASSERT_EQ(*(int*)(remoteValues + memSize), 42);
+
+  memset(localValues, 0, memSize);
+  m_rdmaClient->readBulk(m_nodeId, remoteOffset, localValues, memSize);
+  for (size_t i = 0; i < memSize; ++i) {
+    ASSERT_EQ(localValues[i], (char) i);
+  }
+
+  ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, memSize + sizeof(int), remoteOffset));
+}
+
 TEST_F(TestRDMAServer, testWriteImm) {
     size_t remoteOffset = 0;
     size_t memSize = sizeof(int) * 2;
@@ -0,0 +1,76 @@
+#include "TestReliableMulticast.h"
+
+#include <atomic>
+#include <thread>
+
+void TestReliableMulticast::SetUp() {
+  Config::RDMA_MEMSIZE = 1024 * 1024 * 4;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+  m_mCastAddr = Config::getIP(Config::RDMA_INTERFACE); //Multicast address must be a valid IP of one of the RNICs
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+
+  m_rdmaServer = std::make_unique<RDMAServer<UnreliableRDMA>>();
+  ASSERT_TRUE(m_rdmaServer->startServer());
+  ASSERT_NO_THROW(m_rdmaServer->joinMCastGroup(m_mCastAddr, m_serverMCastID));
+
+  // receivers send ACKs and NACKs to the sender, repairs go the other way
+  m_rdmaClient = std::make_unique<RDMAClient<UnreliableRDMA>>();
+  string connection = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  ASSERT_TRUE(m_rdmaClient->connect(connection, m_serverID));
+  ASSERT_NO_THROW(m_rdmaClient->joinMCastGroup(m_mCastAddr, m_clientMCastID));
+}
+
+
+TEST_F(TestReliableMulticast, testOrderedDelivery) {
+  // several windows, the sender has to wait for acknowledgements
+  const size_t messages = Config::RDMA_MCAST_WINDOW * 8;
+  const size_t maxMsgSize = 64;
+
+  ReliableMulticastReceiver receiver(m_rdmaClient.get(), m_clientMCastID, m_rdmaClient->getOwnNodeID(), m_serverID,
+                                     maxMsgSize);
+  ReliableMulticastSender sender(m_rdmaServer.get(), m_serverMCastID, m_rdmaServer->getOwnNodeID(),
+                                 {m_rdmaClient->getOwnNodeID()}, maxMsgSize);
+
+  std::vector<uint64_t> received;
+  std::atomic<bool> flushed(false);
+  std::thread receiverThread([&]() {
+    char buffer[maxMsgSize];
+    size_t size;
+    while (received.size() < messages) {
+      receiver.receive(buffer, size);
+      uint64_t value;
+      memcpy(&value, buffer, sizeof(value));
+      received.push_back(value);
+    }
+    // the last ACK might be answered to a heartbeat of the flushing sender
+    while (!flushed) {
+      receiver.receive(buffer, size, false);
+    }
+  });
+
+  uint64_t *message = (uint64_t *)m_rdmaServer->localAlloc(sizeof(uint64_t));
+  for (uint64_t i = 0; i < messages; ++i) {
+    *message = i;
+    ASSERT_NO_THROW(sender.send(message, sizeof(uint64_t)));
+  }
+  ASSERT_NO_THROW(sender.flush());
+  flushed = true;
+  receiverThread.join();
+
+  ASSERT_EQ(messages, received.size());
+  for (uint64_t i = 0; i < messages; ++i) {
+    ASSERT_EQ(i, received[i]);
+  }
+}
+
+
+TEST_F(TestReliableMulticast, testMessageTooLarge) {
+  ReliableMulticastSender sender(m_rdmaServer.get(), m_serverMCastID, m_rdmaServer->getOwnNodeID(),
+                                 {m_rdmaClient->getOwnNodeID()}, 64);
+  char message[128];
+  ASSERT_THROW(sender.send(message, sizeof(message)), runtime_error);
+  ASSERT_THROW(ReliableMulticastSender(m_rdmaServer.get(), m_serverMCastID, m_rdmaServer->getOwnNodeID(),
+                                       {m_rdmaClient->getOwnNodeID()}, Config::RDMA_UD_MTU),
+               runtime_error);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file TestReliableMulticast.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestReliableMulticast_H_
+#define SRC_TEST_NET_TestReliableMulticast_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/rdma/RDMAServer.h"
+#include "../../src/rdma/RDMAClient.h"
+#include "../../src/rdma/ReliableMulticast.h"
+#include <gtest/gtest.h>
+
+using namespace rdma;
+
+class TestReliableMulticast : public testing::Test {
+
+ protected:
+  void SetUp() override;
+  std::unique_ptr<RDMAServer<UnreliableRDMA>> m_rdmaServer;
+  std::unique_ptr<RDMAClient<UnreliableRDMA>> m_rdmaClient;
+  std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+  string m_mCastAddr;
+  NodeID m_clientMCastID;
+  NodeID m_serverMCastID;
+  NodeID m_serverID;
+
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "TestSegmentedUD.h"
+
+#include <thread>
+
+void TestSegmentedUD::SetUp() {
+  Config::RDMA_MEMSIZE = 4 * 1024 * 1024;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+  m_rdmaServer = std::make_unique<RDMAServer<SegmentedUnreliableRDMA>>();
+  ASSERT_TRUE(m_rdmaServer->startServer());
+  m_connection = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  m_rdmaClient1 = std::make_unique<RDMAClient<SegmentedUnreliableRDMA>>();
+  m_rdmaClient2 = std::make_unique<RDMAClient<SegmentedUnreliableRDMA>>();
+
+  ASSERT_TRUE(m_rdmaClient1->connect(m_connection, m_nodeId));
+  ASSERT_TRUE(m_rdmaClient2->connect(m_connection, m_nodeId));
+}
+
+
+TEST_F(TestSegmentedUD, testLargeMessage) {
+  const size_t size = 64 * 1024;
+  ASSERT_GT(size, m_rdmaClient1->getSegmentPayload());
+
+  char* message = (char*) m_rdmaClient1->localAlloc(size);
+  for (size_t i = 0; i < size; ++i) {
+    message[i] = (char) (i % 251);
+  }
+  std::vector<char> received(size, 0);
+  m_rdmaServer->receiveMessage(received.data(), received.size());
+
+  ASSERT_NO_THROW(m_rdmaClient1->sendMessage(m_nodeId, message, size));
+
+  SegmentedUnreliableRDMA::ud_message_t msg;
+  ASSERT_TRUE(m_rdmaServer->pollReceiveMessage(msg, true));
+  ASSERT_EQ(msg.memAddr, (void*) received.data());
+  ASSERT_EQ(msg.size, size);
+  for (size_t i = 0; i < size; ++i) {
+    ASSERT_EQ(received[i], (char) (i % 251));
+  }
+  m_rdmaClient1->localFree(message);
+}
+
+
+TEST_F(TestSegmentedUD, testFanIn) {
+  const size_t size = 8 * 1024 + 100;
+  const size_t messages = 8;
+  SegmentedUnreliableRDMA* clients[] = {m_rdmaClient1.get(), m_rdmaClient2.get()};
+
+  std::vector<std::vector<uint32_t>> received(2 * messages, std::vector<uint32_t>(size / sizeof(uint32_t)));
+  for (auto &buffer : received) {
+    m_rdmaServer->receiveMessage(buffer.data(), size);
+  }
+
+  // segments of both clients arrive interleaved
+  std::vector<std::thread> senders;
+  for (uint32_t c = 0; c < 2; ++c) {
+    senders.emplace_back([&, c]() {
+      uint32_t* message = (uint32_t*) clients[c]->localAlloc(size);
+      for (uint32_t m = 0; m < messages; ++m) {
+        for (size_t i = 0; i < size / sizeof(uint32_t); ++i) {
+          message[i] = (c << 24) | (m << 16) | (uint32_t) i;
+        }
+        clients[c]->sendMessage(m_nodeId, message, size);
+      }
+      clients[c]->localFree(message);
+    });
+  }
+
+  std::vector<uint32_t> nextMessage(2, 0);
+  for (size_t n = 0; n < 2 * messages; ++n) {
+    SegmentedUnreliableRDMA::ud_message_t msg;
+    ASSERT_TRUE(m_rdmaServer->pollReceiveMessage(msg, true));
+    ASSERT_EQ(msg.size, size);
+    uint32_t* data = (uint32_t*) msg.memAddr;
+    uint32_t c = data[0] >> 24;
+    ASSERT_LT(c, 2u);
+    // messages of one sender complete in order
+    ASSERT_EQ((data[0] >> 16) & 0xFF, nextMessage[c]++);
+    for (size_t i = 0; i < size / sizeof(uint32_t); ++i) {
+      ASSERT_EQ(data[i], (data[0] & 0xFFFF0000) | (uint32_t) i);
+    }
+  }
+  for (auto &sender : senders) {
+    sender.join();
+  }
+}
+
+
+TEST_F(TestSegmentedUD, testMessageExceedsBuffer) {
+  const size_t size = 16 * 1024;
+  char* message = (char*) m_rdmaClient1->localAlloc(size);
+  memset(message, 'a', size);
+
+  std::vector<char> received(1024, 0);
+  m_rdmaServer->receiveMessage(received.data(), received.size());
+
+  // dropped, the buffer is kept for the next message
+  ASSERT_NO_THROW(m_rdmaClient1->sendMessage(m_nodeId, message, size));
+  memset(message, 'b', received.size());
+  ASSERT_NO_THROW(m_rdmaClient1->sendMessage(m_nodeId, message, received.size()));
+
+  SegmentedUnreliableRDMA::ud_message_t msg;
+  ASSERT_TRUE(m_rdmaServer->pollReceiveMessage(msg, true));
+  ASSERT_EQ(msg.size, received.size());
+  ASSERT_EQ(received[0], 'b');
+  ASSERT_EQ(received[received.size() - 1], 'b');
+
+  SegmentedUnreliableRDMA::ud_message_t none;
+  ASSERT_FALSE(m_rdmaServer->pollReceiveMessage(none, false));
+  m_rdmaClient1->localFree(message);
+}
+
+
+TEST_F(TestSegmentedUD, testMismatchedSegment) {
+  typedef SegmentAccess::ud_segment_hdr_t segment_hdr_t;
+  const size_t payload = m_rdmaClient1->getSegmentPayload();
+  const size_t size = 2 * payload;
+
+  // the guard behind the buffer must not be written
+  std::vector<char> received(size + payload, 0);
+  m_rdmaServer->receiveMessage(received.data(), size);
+
+  char* segment = (char*) m_rdmaClient1->localAlloc(sizeof(segment_hdr_t) + payload);
+  auto sendSegment = [&](uint32_t messageSize, uint32_t offset, uint16_t index, char fill) {
+    segment_hdr_t hdr;
+    hdr.sender = 42;
+    hdr.msgID = 7;
+    hdr.size = messageSize;
+    hdr.offset = offset;
+    hdr.segment = index;
+    hdr.segments = 2;
+    memcpy(segment, &hdr, sizeof(hdr));
+    memset(segment + sizeof(hdr), fill, payload);
+    m_rdmaClient1->send(m_nodeId, segment, sizeof(hdr) + payload, true);
+  };
+
+  sendSegment(size, 0, 0, 'a');
+  // claims a larger message than the first segment, its payload would land behind the buffer
+  sendSegment(size + payload, size, 1, 'x');
+  sendSegment(size, payload, 1, 'b');
+
+  SegmentedUnreliableRDMA::ud_message_t msg;
+  ASSERT_TRUE(m_rdmaServer->pollReceiveMessage(msg, true));
+  ASSERT_EQ(msg.memAddr, (void*) received.data());
+  ASSERT_EQ(msg.size, size);
+  for (size_t i = 0; i < payload; ++i) {
+    ASSERT_EQ(received[i], 'a');
+    ASSERT_EQ(received[payload + i], 'b');
+    ASSERT_EQ(received[size + i], 0);
+  }
+  m_rdmaClient1->localFree(segment);
+}
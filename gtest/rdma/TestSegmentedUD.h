@@ -0,0 +1,39 @@
+/**
+ * @file TestSegmentedUD.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestSegmentedUD_H_
+#define SRC_TEST_NET_TestSegmentedUD_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/rdma/RDMAServer.h"
+#include "../../src/rdma/RDMAClient.h"
+#include "../../src/rdma/SegmentedUnreliableRDMA.h"
+#include <gtest/gtest.h>
+
+
+using namespace rdma;
+
+class TestSegmentedUD : public testing::Test {
+protected:
+
+  void SetUp() override;
+
+  // exposes the segment header to send hand-crafted segments
+  class SegmentAccess : public SegmentedUnreliableRDMA {
+   public:
+    using SegmentedUnreliableRDMA::ud_segment_hdr_t;
+  };
+
+  std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+  std::unique_ptr<RDMAServer<SegmentedUnreliableRDMA>> m_rdmaServer;
+  std::unique_ptr<RDMAClient<SegmentedUnreliableRDMA>> m_rdmaClient1;
+  std::unique_ptr<RDMAClient<SegmentedUnreliableRDMA>> m_rdmaClient2;
+  string m_connection;
+
+  NodeID m_nodeId = 0;
+};
+
+#endif /* SRC_TEST_NET_TestSegmentedUD_H_ */
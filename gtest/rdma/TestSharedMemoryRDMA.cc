@@ -0,0 +1,81 @@
+#include "TestSharedMemoryRDMA.h"
+
+void TestSharedMemoryRDMA::SetUp() {
+  // server and client run on the same host, so no NIC is needed
+  Config::RDMA_MEMSIZE = 1024 * 1024;
+  Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
+
+  m_nodeIDSequencer = std::make_unique<NodeIDSequencer>();
+  m_rdmaServer = std::make_unique<RDMAServer<SharedMemoryRDMA>>();
+  m_rdmaServer->startServer();
+  m_connection = Config::getIP(Config::RDMA_INTERFACE) + ":" + to_string(Config::RDMA_PORT);
+  m_rdmaClient = std::make_unique<RDMAClient<SharedMemoryRDMA>>();
+
+  ASSERT_TRUE(m_rdmaClient->connect(m_connection, m_nodeId));
+  ASSERT_TRUE(m_rdmaClient->isLocal(m_nodeId));
+}
+
+
+TEST_F(TestSharedMemoryRDMA, testWriteRead) {
+  size_t remoteOffset = 0;
+  size_t memSize = sizeof(int) * 2;
+
+  int* localValues = (int*) m_rdmaClient->localAlloc(memSize);
+  ASSERT_TRUE(localValues!=nullptr);
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, memSize, remoteOffset));
+
+  localValues[0] = 1;
+  localValues[1] = 2;
+  m_rdmaClient->write(m_nodeId, remoteOffset, localValues, memSize, true);
+
+  int* remoteVals = (int*) m_rdmaServer->getBuffer(remoteOffset);
+  ASSERT_EQ(remoteVals[0], localValues[0]);
+  ASSERT_EQ(remoteVals[1], localValues[1]);
+
+  remoteVals[1] = 3;
+  m_rdmaClient->read(m_nodeId, remoteOffset, localValues, memSize, true);
+  ASSERT_EQ(localValues[1], 3);
+
+  ASSERT_TRUE(m_rdmaClient->remoteFree(m_connection, memSize, remoteOffset));
+}
+
+TEST_F(TestSharedMemoryRDMA, testSendReceive) {
+  size_t memSize = sizeof(int);
+  int* localValue = (int*) m_rdmaClient->localAlloc(memSize);
+  int* remoteValue = (int*) m_rdmaServer->localAlloc(memSize);
+
+  // no receive posted yet
+  ASSERT_THROW(m_rdmaClient->send(m_nodeId, localValue, memSize, true), runtime_error);
+
+  vector<size_t> clientIDs = m_rdmaServer->getConnectedConnIDs();
+  ASSERT_EQ(clientIDs.size(), 1u);
+  m_rdmaServer->receive(clientIDs[0], remoteValue, memSize);
+  ASSERT_EQ(m_rdmaServer->pollReceive(clientIDs[0], false), 0);
+
+  *localValue = 42;
+  m_rdmaClient->sendImm(m_nodeId, localValue, memSize, 7, true);
+  uint32_t imm = 0;
+  ASSERT_EQ(m_rdmaServer->pollReceive(clientIDs[0], true, &imm), 1);
+  ASSERT_EQ(*remoteValue, 42);
+  ASSERT_EQ(imm, 7u);
+}
+
+TEST_F(TestSharedMemoryRDMA, testAtomics) {
+  size_t remoteOffset = 0;
+  ASSERT_TRUE(m_rdmaClient->remoteAlloc(m_connection, sizeof(uint64_t), remoteOffset));
+  uint64_t* remoteValue = (uint64_t*) m_rdmaServer->getBuffer(remoteOffset);
+  uint64_t* localValue = (uint64_t*) m_rdmaClient->localAlloc(sizeof(uint64_t));
+  *remoteValue = 5;
+
+  m_rdmaClient->fetchAndAdd(m_nodeId, remoteOffset, localValue, true);
+  ASSERT_EQ(*localValue, 5u);
+  ASSERT_EQ(*remoteValue, 6u);
+
+  m_rdmaClient->compareAndSwap(m_nodeId, remoteOffset, localValue, 6, 10, true);
+  ASSERT_EQ(*localValue, 6u);
+  ASSERT_EQ(*remoteValue, 10u);
+
+  m_rdmaClient->compareAndSwap(m_nodeId, remoteOffset, localValue, 6, 11, true);
+  ASSERT_EQ(*localValue, 10u);
+  ASSERT_EQ(*remoteValue, 10u);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file TestSharedMemoryRDMA.h
+ */
+
+
+
+#ifndef SRC_TEST_NET_TestSharedMemoryRDMA_H_
+#define SRC_TEST_NET_TestSharedMemoryRDMA_H_
+
+#include "../../src/utils/Config.h"
+#include "../../src/rdma/RDMAServer.h"
+#include "../../src/rdma/RDMAClient.h"
+#include "../../src/rdma/SharedMemoryRDMA.h"
+#include <gtest/gtest.h>
+
+
+using namespace rdma;
+
+class TestSharedMemoryRDMA : public testing::Test {
+protected:
+
+  void SetUp() override;
+
+  std::unique_ptr<NodeIDSequencer> m_nodeIDSequencer;
+  std::unique_ptr<RDMAServer<SharedMemoryRDMA>> m_rdmaServer;
+  std::unique_ptr<RDMAClient<SharedMemoryRDMA>> m_rdmaClient;
+  string m_connection;
+
+  NodeID m_nodeId = 0;
+};
+
+#endif /* SRC_TEST_NET_TestSharedMemoryRDMA_H_ */
@@ -1,6 +1,8 @@
 
 #include "TestSimpleUD.h"
 
+#include <thread>
+
 void TestSimpleUD::SetUp() {
   Config::RDMA_MEMSIZE = 1024 * 1024;
   Config::SEQUENCER_IP = rdma::Config::getIP(rdma::Config::RDMA_INTERFACE);
@@ -90,3 +92,69 @@ TEST_F(TestSimpleUD, testSendRecieve) {
   //CPPUNIT_ASSERT_EQUAL(*message22,1);
 }
 
+
+
+TEST_F(TestSimpleUD, testSendBatch) {
+  int* message1 = (int*) m_rdmaClient1->localAlloc(sizeof(int));
+  int* message2 = (int*) m_rdmaClient2->localAlloc(sizeof(int));
+  *message1 = 0;
+  *message2 = 0;
+  ASSERT_NO_THROW(m_rdmaClient1->receive(m_s1_nodeId, (void*) message1, sizeof(int)));
+  ASSERT_NO_THROW(m_rdmaClient2->receive(m_s1_nodeId, (void*) message2, sizeof(int)));
+
+  int* remoteMsg1 = (int*) m_rdmaServer1->localAlloc(sizeof(int));
+  int* remoteMsg2 = (int*) m_rdmaServer1->localAlloc(sizeof(int));
+  *remoteMsg1 = 1;
+  *remoteMsg2 = 2;
+
+  // one doorbell for both clients
+  UnreliableRDMA::ud_send_t sends[] = {
+      {m_rdmaClient1->getOwnNodeID(), remoteMsg1, sizeof(int)},
+      {m_rdmaClient2->getOwnNodeID(), remoteMsg2, sizeof(int)}};
+  ASSERT_NO_THROW(m_rdmaServer1->sendBatch(sends, 2, true));
+
+  ASSERT_EQ(m_rdmaClient1->pollReceive(m_s1_nodeId, true), 1);
+  ASSERT_EQ(m_rdmaClient2->pollReceive(m_s1_nodeId, true), 1);
+  ASSERT_EQ(*message1, 1);
+  ASSERT_EQ(*message2, 2);
+}
+
+
+TEST_F(TestSimpleUD, testConcurrentSend) {
+  const int threads = 4;
+  const int messages = 64;
+
+  int* received = (int*) m_rdmaServer1->localAlloc(threads * messages * sizeof(int));
+  for (int i = 0; i < threads * messages; ++i) {
+    ASSERT_NO_THROW(m_rdmaServer1->receive(0, (void*) (received + i), sizeof(int)));
+  }
+
+  // every thread sends on a UD QP of its own, released when the thread exits
+  size_t threadQPs = m_rdmaClient1->getThreadQPCount();
+  std::vector<std::thread> senders;
+  for (int t = 0; t < threads; ++t) {
+    senders.emplace_back([&, t]() {
+      int* message = (int*) m_rdmaClient1->localAlloc(sizeof(int));
+      for (int i = 0; i < messages; ++i) {
+        *message = t;
+        m_rdmaClient1->send(m_s1_nodeId, (void*) message, sizeof(int), true);
+      }
+      m_rdmaClient1->localFree(message);
+    });
+  }
+  for (auto &sender : senders) {
+    sender.join();
+  }
+  ASSERT_EQ(m_rdmaClient1->getThreadQPCount(), threadQPs);
+
+  for (int i = 0; i < threads * messages; ++i) {
+    ASSERT_EQ(m_rdmaServer1->pollReceive(0, true), 1);
+  }
+
+  // polling without a send does not create a QP
+  std::thread poller([&]() {
+    ASSERT_THROW(m_rdmaClient1->pollSend(m_s1_nodeId, false), runtime_error);
+    ASSERT_EQ(m_rdmaClient1->getThreadQPCount(), threadQPs);
+  });
+  poller.join();
+}
@@ -0,0 +1,197 @@
+#include "../src/memory/MainMemory.h"
+#include "../src/memory/LocalBaseMemoryStub.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+
+using namespace rdma;
+
+namespace {
+
+// memory is not registered with IBV and on NUMA node 0 so that no RDMA device is required
+const size_t MEMORY_SIZE = 64 * 1024 * 1024; // more than the allocations of any benchmark
+const int NUMA_NODE = 0;
+const uint64_t SEED = 42; // every run allocates the same sizes in the same order
+const size_t MIN_RANDOM_SIZE = 8, MAX_RANDOM_SIZE = 4096;
+const size_t RANDOM_RING_SIZE = 1 << 16; // precomputed random choices for the steady state benchmarks
+
+MainMemory* createMemory(){
+	return new MainMemory(false, MEMORY_SIZE, false, NUMA_NODE);
+}
+
+std::vector<size_t> randomSizes(size_t count, std::mt19937_64 &generator){
+	std::uniform_int_distribution<size_t> distribution(MIN_RANDOM_SIZE, MAX_RANDOM_SIZE);
+	std::vector<size_t> sizes(count);
+	for(size_t &size : sizes) size = distribution(generator);
+	return sizes;
+}
+
+}
+
+
+/* Function: BM_AllocFreeLIFO
+ * ----------------
+ * Allocates range(0) parts of range(1) bytes and releases
+ * them in reverse order like a stack of request buffers.
+ */
+static void BM_AllocFreeLIFO(benchmark::State &state){
+	MainMemory *memory = createMemory();
+	const size_t count = state.range(0), size = state.range(1);
+	std::vector<rdma_mem_t> allocs(count);
+	for(auto _ : state){
+		for(size_t i = 0; i < count; i++){
+			allocs[i] = memory->internalAlloc(size);
+			if(allocs[i].isnull){ state.SkipWithError("BaseMemory out of local memory"); delete memory; return; }
+		}
+		for(size_t i = count; i > 0; i--) memory->free(allocs[i-1].offset);
+	}
+	state.SetItemsProcessed(state.iterations() * count * 2); // alloc + free
+	delete memory;
+}
+BENCHMARK(BM_AllocFreeLIFO)->ArgsProduct({{1, 64, 1024}, {64, 4096}});
+
+
+/* Function: BM_AllocFreeFIFO
+ * ----------------
+ * Same as LIFO but releases the parts in allocation order
+ * so that the free list grows until the last part is freed.
+ */
+static void BM_AllocFreeFIFO(benchmark::State &state){
+	MainMemory *memory = createMemory();
+	const size_t count = state.range(0), size = state.range(1);
+	std::vector<rdma_mem_t> allocs(count);
+	for(auto _ : state){
+		for(size_t i = 0; i < count; i++){
+			allocs[i] = memory->internalAlloc(size);
+			if(allocs[i].isnull){ state.SkipWithError("BaseMemory out of local memory"); delete memory; return; }
+		}
+		for(size_t i = 0; i < count; i++) memory->free(allocs[i].offset);
+	}
+	state.SetItemsProcessed(state.iterations() * count * 2); // alloc + free
+	delete memory;
+}
+BENCHMARK(BM_AllocFreeFIFO)->ArgsProduct({{64, 1024}, {64, 4096}});
+
+
+/* Function: BM_AllocFreeRandom
+ * ----------------
+ * Allocates range(0) parts of random sizes and releases
+ * them in random order.
+ */
+static void BM_AllocFreeRandom(benchmark::State &state){
+	MainMemory *memory = createMemory();
+	const size_t count = state.range(0);
+	std::mt19937_64 generator(SEED);
+	std::vector<size_t> sizes = randomSizes(count, generator);
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), generator);
+
+	std::vector<rdma_mem_t> allocs(count);
+	for(auto _ : state){
+		for(size_t i = 0; i < count; i++){
+			allocs[i] = memory->internalAlloc(sizes[i]);
+			if(allocs[i].isnull){ state.SkipWithError("BaseMemory out of local memory"); delete memory; return; }
+		}
+		for(size_t i : order) memory->free(allocs[i].offset);
+	}
+	state.SetItemsProcessed(state.iterations() * count * 2); // alloc + free
+	delete memory;
+}
+BENCHMARK(BM_AllocFreeRandom)->Arg(64)->Arg(1024)->Arg(4096);
+
+
+/* Function: BM_AllocFreeFragmented
+ * ----------------
+ * Leaves range(0) free holes of 64 bytes between used parts
+ * and then allocates and releases a part of range(1) bytes.
+ * Parts bigger than the holes have to walk past all of them.
+ */
+static void BM_AllocFreeFragmented(benchmark::State &state){
+	MainMemory *memory = createMemory();
+	const size_t holes = state.range(0), size = state.range(1);
+	std::vector<rdma_mem_t> allocs(holes * 2);
+	for(rdma_mem_t &alloc : allocs) alloc = memory->internalAlloc(64);
+	for(size_t i = 0; i < allocs.size(); i += 2) memory->free(allocs[i].offset);
+
+	for(auto _ : state){
+		rdma_mem_t alloc = memory->internalAlloc(size);
+		if(alloc.isnull){ state.SkipWithError("BaseMemory out of local memory"); break; }
+		memory->free(alloc.offset);
+	}
+	state.SetItemsProcessed(state.iterations() * 2); // alloc + free
+	delete memory;
+}
+BENCHMARK(BM_AllocFreeFragmented)->ArgsProduct({{16, 256, 4096}, {64, 128}});
+
+
+/* Function: BM_AllocFreeMixed
+ * ----------------
+ * Keeps range(0) parts of random sizes allocated and replaces
+ * a random one with a part of another random size in every
+ * iteration, which fragments the memory over time like
+ * long running servers do.
+ */
+static void BM_AllocFreeMixed(benchmark::State &state){
+	MainMemory *memory = createMemory();
+	const size_t live = state.range(0);
+	std::mt19937_64 generator(SEED);
+	std::vector<rdma_mem_t> allocs;
+	for(size_t size : randomSizes(live, generator)) allocs.push_back(memory->internalAlloc(size));
+	std::vector<size_t> sizes = randomSizes(RANDOM_RING_SIZE, generator);
+	std::vector<size_t> victims(RANDOM_RING_SIZE);
+	std::uniform_int_distribution<size_t> distribution(0, live - 1);
+	for(size_t &victim : victims) victim = distribution(generator);
+
+	size_t next = 0;
+	for(auto _ : state){
+		rdma_mem_t &alloc = allocs[victims[next]];
+		memory->free(alloc.offset);
+		alloc = memory->internalAlloc(sizes[next]);
+		if(alloc.isnull){ state.SkipWithError("BaseMemory out of local memory"); break; }
+		next = (next + 1) % RANDOM_RING_SIZE;
+	}
+	state.SetItemsProcessed(state.iterations() * 2); // alloc + free
+	delete memory;
+}
+BENCHMARK(BM_AllocFreeMixed)->Arg(64)->Arg(1024)->Arg(4096);
+
+
+/* Function: BM_MallocStub
+ * ----------------
+ * Allocates a part of range(0) bytes as LocalMainMemoryStub
+ * and deletes the stub which releases the part again.
+ */
+static void BM_MallocStub(benchmark::State &state){
+	MainMemory *memory = createMemory();
+	const size_t size = state.range(0);
+	for(auto _ : state){
+		LocalBaseMemoryStub *stub = memory->malloc(size);
+		benchmark::DoNotOptimize(stub->pointer());
+		delete stub;
+	}
+	state.SetItemsProcessed(state.iterations());
+	delete memory;
+}
+BENCHMARK(BM_MallocStub)->Arg(64)->Arg(4096);
+
+
+/* Function: BM_CreateStub
+ * ----------------
+ * Creates and deletes a LocalMainMemoryStub of an already
+ * allocated part without allocating memory.
+ */
+static void BM_CreateStub(benchmark::State &state){
+	MainMemory *memory = createMemory();
+	for(auto _ : state){
+		LocalBaseMemoryStub *stub = memory->createStub(memory->pointer(), 4096, 4096);
+		benchmark::DoNotOptimize(stub->pointer());
+		delete stub;
+	}
+	state.SetItemsProcessed(state.iterations());
+	delete memory;
+}
+BENCHMARK(BM_CreateStub);
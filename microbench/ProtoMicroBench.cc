@@ -0,0 +1,105 @@
+#include "../src/message/ProtoMessageFactory.h"
+#include "../src/proto/ProtoSocket.h"
+#include "../src/rdma/NodeIDSequencer.h"
+
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace rdma;
+
+
+/* Function: BM_CreateMemoryResourceRequest
+ * ----------------
+ * Packs the request of a remote allocation into an Any.
+ */
+static void BM_CreateMemoryResourceRequest(benchmark::State &state){
+	for(auto _ : state){
+		Any anyMessage = ProtoMessageFactory::createMemoryResourceRequest(4096);
+		benchmark::DoNotOptimize(anyMessage);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CreateMemoryResourceRequest);
+
+
+/* Function: BM_CreateNodeIDRequest
+ * ----------------
+ * Packs the request a node registers at the sequencer with.
+ */
+static void BM_CreateNodeIDRequest(benchmark::State &state){
+	const std::string ipPort = "192.168.100.100:5400", name = "MicroBenchClient";
+	for(auto _ : state){
+		Any anyMessage = ProtoMessageFactory::createNodeIDRequest(ipPort, name, NodeType::Enum::CLIENT);
+		benchmark::DoNotOptimize(anyMessage);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CreateNodeIDRequest);
+
+
+/* Function: BM_CreateMembershipUpdate
+ * ----------------
+ * Packs the update the sequencer sends to all subscribers.
+ */
+static void BM_CreateMembershipUpdate(benchmark::State &state){
+	const std::string ipPort = "192.168.100.100:5400", name = "MicroBenchClient";
+	uint64_t version = 0;
+	for(auto _ : state){
+		Any anyMessage = ProtoMessageFactory::createMembershipUpdate(MembershipUpdateKind::NODE_JOINED, ++version, ipPort, name, 42, NodeType::Enum::CLIENT);
+		benchmark::DoNotOptimize(anyMessage);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CreateMembershipUpdate);
+
+
+/* Function: BM_UnpackMemoryResourceRequest
+ * ----------------
+ * Checks the type of a received Any and unpacks it like
+ * the handle() functions of the servers do.
+ */
+static void BM_UnpackMemoryResourceRequest(benchmark::State &state){
+	Any anyMessage = ProtoMessageFactory::createMemoryResourceRequest(4096);
+	for(auto _ : state){
+		MemoryResourceRequest request;
+		if(anyMessage.Is<MemoryResourceRequest>()) anyMessage.UnpackTo(&request);
+		benchmark::DoNotOptimize(request.size());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UnpackMemoryResourceRequest);
+
+
+/* Function: BM_ProtoSocketRoundTrip
+ * ----------------
+ * Sends a message with a payload of range(0) bytes from a
+ * REQ to a REP ProtoSocket and back, which serializes and
+ * parses it twice. Both sockets live in this process and
+ * share its ZMQ context, so they are connected inproc and
+ * neither a port nor another node is required.
+ */
+static void BM_ProtoSocketRoundTrip(benchmark::State &state){
+	static int run = 0; // every run binds its own endpoint
+	const std::string endpoint = "inproc://ProtoSocketRoundTrip" + std::to_string(run++);
+	ProtoSocket server(endpoint, ZMQ_REP);
+	ProtoSocket client(endpoint, ZMQ_REQ);
+	if(!server.bind() || !client.connect()){
+		state.SkipWithError("Could not open ProtoSockets");
+		return;
+	}
+
+	HelloMessage helloMsg;
+	helloMsg.set_name(std::string(state.range(0), 'x'));
+	Any request, received, response;
+	request.PackFrom(helloMsg);
+
+	for(auto _ : state){
+		if(!client.send(&request) || !server.receive(&received) || !server.send(&received) || !client.receive(&response)){
+			state.SkipWithError("ProtoSocket exchange failed");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * request.ByteSizeLong() * 2); // request + response
+}
+BENCHMARK(BM_ProtoSocketRoundTrip)->Arg(16)->Arg(1024)->Arg(65536);
@@ -228,18 +228,24 @@ void rdma::AtomicsBandwidthPerfTest::runTest(){
 
 		// Measure bandwidth for fetching & adding
 		if(hasTestOperation(FETCH_ADD_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(FETCH_ADD_OPERATION); // fetch & add
+			startPerfEvents();
 			auto startFetchAdd = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedFetchAddMs = rdma::PerfTest::stopTimer(startFetchAdd); 
+			stopPerfEvents(FETCH_ADD_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure bandwidth for comparing & swaping
 		if(hasTestOperation(COMPARE_SWAP_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(COMPARE_SWAP_OPERATION); // compare & swap
+			startPerfEvents();
 			auto startCompareSwap = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedCompareSwapMs = rdma::PerfTest::stopTimer(startCompareSwap);
+			stopPerfEvents(COMPARE_SWAP_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 	}
 }
@@ -305,6 +311,7 @@ std::string rdma::AtomicsBandwidthPerfTest::getTestResults(std::string csvFileNa
 					ofs << ", Comp&Swap [MB/s], Avg Comp&Swap [MB/s], Median Comp&Swap [MB/s], Min Comp&Swap [MB/s], Max Comp&Swap [MB/s], ";
 					ofs << "Comp&Swap [Sec], Avg Comp&Swap [Sec], Median Comp&Swap [Sec], Min Comp&Swap [Sec], Max Comp&Swap [Sec]";
 				}
+				writePerfEventsCSVHeader(ofs);
 				ofs << std::endl; 
 			}
 			ofs << iters;
@@ -332,6 +339,7 @@ std::string rdma::AtomicsBandwidthPerfTest::getTestResults(std::string csvFileNa
 				ofs << (round(minCompareSwapMs/tu * 100000)/100000.0) << ", "; // min comp&swap Sec
 				ofs << (round(maxCompareSwapMs/tu * 100000)/100000.0); // max comp&swap Sec
 			}
+			writePerfEventsCSV(ofs);
 			ofs << std::endl; ofs.close();
 		}
 
@@ -21,8 +21,6 @@ rdma::AtomicsLatencyPerfClientThread::AtomicsLatencyPerfClientThread(BaseMemory
 	this->m_buffer_slots = buffer_slots;
 	this->m_iterations_per_thread = iterations_per_thread;
 	this->m_remOffsets = new size_t[m_rdma_addresses.size()];
-	this->m_arrFetchAddMs = new int64_t[iterations_per_thread];
-	this->m_arrCompareSwapMs = new int64_t[iterations_per_thread];
 
 	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
 	    NodeID  nodeId = 0;
@@ -51,9 +49,6 @@ rdma::AtomicsLatencyPerfClientThread::~AtomicsLatencyPerfClientThread() {
     delete m_remOffsets;
 	delete m_local_memory; // implicitly deletes local allocs in RDMAClient
 	delete m_client;
-
-	delete m_arrFetchAddMs;
-	delete m_arrCompareSwapMs;
 }
 
 void rdma::AtomicsLatencyPerfClientThread::run() {
@@ -74,10 +69,7 @@ void rdma::AtomicsLatencyPerfClientThread::run() {
 					auto start = rdma::PerfTest::startTimer();
 					m_client->fetchAndAdd(m_addr[connIdx], m_remOffsets[connIdx] + offset, m_local_memory->pointer(offset), 2, rdma::ATOMICS_SIZE, true); // true=signaled
 					int64_t time = rdma::PerfTest::stopTimer(start);
-					m_sumFetchAddMs += time;
-					if(m_minFetchAddMs > time) m_minFetchAddMs = time;
-					if(m_maxFetchAddMs < time) m_maxFetchAddMs = time;
-					m_arrFetchAddMs[i] = time;
+					m_fetchAddHistogram.record(time);
 				}
 			}
 			break;
@@ -88,10 +80,7 @@ void rdma::AtomicsLatencyPerfClientThread::run() {
 					auto start = rdma::PerfTest::startTimer();
 					m_client->compareAndSwap(m_addr[connIdx], m_remOffsets[connIdx] + offset, m_local_memory->pointer(offset), i, i+1, rdma::ATOMICS_SIZE, true); // true=signaled
 					int64_t time = rdma::PerfTest::stopTimer(start);
-					m_sumCompareSwapMs += time;
-					if(m_minCompareSwapMs > time) m_minCompareSwapMs = time;
-					if(m_maxCompareSwapMs < time) m_maxCompareSwapMs = time;
-					m_arrCompareSwapMs[i] = time;
+					m_compareSwapHistogram.record(time);
 				}
 			}
 			break;
@@ -227,14 +216,20 @@ void rdma::AtomicsLatencyPerfTest::runTest(){
 
 		// Measure Latency for fetching & adding
 		if(hasTestOperation(FETCH_ADD_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(FETCH_ADD_OPERATION); // fetch & add
+			startPerfEvents();
 			runThreads();
+			stopPerfEvents(FETCH_ADD_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure Latency for comparing & swaping
 		if(hasTestOperation(COMPARE_SWAP_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(COMPARE_SWAP_OPERATION); // compare & swap
+			startPerfEvents();
 			runThreads();
+			stopPerfEvents(COMPARE_SWAP_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 	}
 }
@@ -245,38 +240,14 @@ std::string rdma::AtomicsLatencyPerfTest::getTestResults(std::string csvFileName
 		return "only client";
 	} else {
 
-		/*	There are  n  threads
-			Each thread computes  iterations_per_thread = total_iterations / n
-			Each thread takes  n  times more time compared to a single thread
-			  Latency 	= elapsedTime / iterations
-						= (elpasedTime_per_thread) / (n * iterations_per_thread)
-		*/
-
-		int64_t minFetchAddMs=std::numeric_limits<int64_t>::max(), maxFetchAddMs=-1, medianFetchAddMs=-1;
-		int64_t minCompareSwapMs=std::numeric_limits<int64_t>::max(), maxCompareSwapMs=-1, medianCompareSwapMs=-1;
-		long double avgFetchAddMs=0, avgCompareSwapMs=0;
-		int64_t mediansFetchAddNs[thread_count], mediansCompareSwapNs[thread_count];
-        const long double divAvg = m_client_threads.size() * m_iterations_per_thread * m_rdma_addresses.size(); // for calculating average
+		// threads recorded into their own histograms
+		LatencyHistogram fetchAddHistogram, compareSwapHistogram;
 		for(size_t i=0; i<m_client_threads.size(); i++){
 			AtomicsLatencyPerfClientThread *thr = m_client_threads[i];
-			if(minFetchAddMs > thr->m_minFetchAddMs) minFetchAddMs = thr->m_minFetchAddMs;
-			if(maxFetchAddMs < thr->m_maxFetchAddMs) maxFetchAddMs = thr->m_maxFetchAddMs;
-			avgFetchAddMs += thr->m_sumFetchAddMs / divAvg;
-			if(minCompareSwapMs > thr->m_minCompareSwapMs) minCompareSwapMs = thr->m_minCompareSwapMs;
-			if(maxCompareSwapMs < thr->m_maxCompareSwapMs) maxCompareSwapMs = thr->m_maxCompareSwapMs;
-			avgCompareSwapMs += thr->m_sumCompareSwapMs / divAvg;
-			
-			std::sort(thr->m_arrFetchAddMs, thr->m_arrFetchAddMs + m_iterations_per_thread);
-			std::sort(thr->m_arrCompareSwapMs, thr->m_arrCompareSwapMs + m_iterations_per_thread);
-			mediansFetchAddNs[i] = thr->m_arrFetchAddMs[(int)(m_iterations_per_thread/2)];
-			mediansCompareSwapNs[i] = thr->m_arrCompareSwapMs[(int)(m_iterations_per_thread/2)];
+			fetchAddHistogram.merge(thr->m_fetchAddHistogram);
+			compareSwapHistogram.merge(thr->m_compareSwapHistogram);
 		}
 
-		std::sort(mediansFetchAddNs, mediansFetchAddNs + thread_count);
-		std::sort(mediansCompareSwapNs, mediansCompareSwapNs + thread_count);
-		medianFetchAddMs = mediansFetchAddNs[(int)(thread_count/2)];
-		medianCompareSwapMs = mediansCompareSwapNs[(int)(thread_count/2)];
-
 		// write results into CSV file
 		if(!csvFileName.empty()){
 			const long double ustu = 1000; // nanosec to microsec
@@ -288,39 +259,58 @@ std::string rdma::AtomicsLatencyPerfTest::getTestResults(std::string csvFileName
 				ofs << "Iterations";
 				if(hasTestOperation(FETCH_ADD_OPERATION)){
 					ofs << ", Avg Fetch&Add [usec], Median Fetch&Add [usec], Min Fetch&Add [usec], Max Fetch&Add [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, "Fetch&Add");
 				}
 				if(hasTestOperation(COMPARE_SWAP_OPERATION)){
 					ofs << ", Avg Comp&Swap [usec], Median Comp&Swap [usec], Min Comp&Swap [usec], Max Comp&Swap [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, "Comp&Swap");
 				}
+				writePerfEventsCSVHeader(ofs);
 				ofs << std::endl;
 			}
 			ofs << (m_iterations_per_thread * thread_count);
 			if(hasTestOperation(FETCH_ADD_OPERATION)){
-				ofs << ", " << (round(avgFetchAddMs/ustu * 10)/10.0) << ", "; // avg fetch&add us
-				ofs << (round(medianFetchAddMs/ustu * 10)/10.0) << ", "; // median fetch&add us
-				ofs << (round(minFetchAddMs/ustu * 10)/10.0) << ", "; // min fetch&add us
-				ofs << (round(maxFetchAddMs/ustu * 10)/10.0); // max fetch&add us
+				ofs << ", " << (round(fetchAddHistogram.getAverage()/ustu * 10)/10.0) << ", "; // avg fetch&add us
+				ofs << (round(fetchAddHistogram.getMedian()/ustu * 10)/10.0) << ", "; // median fetch&add us
+				ofs << (round(fetchAddHistogram.getMin()/ustu * 10)/10.0) << ", "; // min fetch&add us
+				ofs << (round(fetchAddHistogram.getMax()/ustu * 10)/10.0); // max fetch&add us
+				rdma::PerfTest::writePercentilesCSV(ofs, fetchAddHistogram);
 			}
 			if(hasTestOperation(COMPARE_SWAP_OPERATION)){
-				ofs << ", " << (round(avgCompareSwapMs/ustu * 10)/10.0) << ", "; // avg comp&swap us
-				ofs << (round(medianCompareSwapMs/ustu * 10)/10.0) << ", "; // median comp&swap us
-				ofs << (round(minCompareSwapMs/ustu * 10)/10.0) << ", "; // min comp&swap us
-				ofs << (round(maxCompareSwapMs/ustu * 10)/10.0); // max comp&swap us
+				ofs << ", " << (round(compareSwapHistogram.getAverage()/ustu * 10)/10.0) << ", "; // avg comp&swap us
+				ofs << (round(compareSwapHistogram.getMedian()/ustu * 10)/10.0) << ", "; // median comp&swap us
+				ofs << (round(compareSwapHistogram.getMin()/ustu * 10)/10.0) << ", "; // min comp&swap us
+				ofs << (round(compareSwapHistogram.getMax()/ustu * 10)/10.0); // max comp&swap us
+				rdma::PerfTest::writePercentilesCSV(ofs, compareSwapHistogram);
 			}
+			writePerfEventsCSV(ofs);
 			ofs << std::endl; ofs.close();
 		}
 
+		// write full histograms
+		if(!histogramFileName.empty()){
+			std::ofstream ofs;
+			ofs.open(histogramFileName, std::ofstream::out | std::ofstream::app);
+			ofs << std::endl << "ATOMICS LATENCY HISTOGRAM, " << getTestParameters(true) << std::endl;
+			LatencyHistogram::writeBucketsHeader(ofs);
+			if(hasTestOperation(FETCH_ADD_OPERATION)) fetchAddHistogram.writeBuckets(ofs, "Fetch&Add");
+			if(hasTestOperation(COMPARE_SWAP_OPERATION)) compareSwapHistogram.writeBuckets(ofs, "Comp&Swap");
+			ofs.close();
+		}
+
 		// generate result string
 		std::ostringstream oss;
 		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
 		oss << "Measured as 'round-trip time' latencies per operation:" << std::endl;
 		if(hasTestOperation(FETCH_ADD_OPERATION)){
-			oss << " - Fetch&Add:       average = " << rdma::PerfTest::convertTime(avgFetchAddMs) << "    median = " << rdma::PerfTest::convertTime(medianFetchAddMs);
-			oss << "    range = " <<  rdma::PerfTest::convertTime(minFetchAddMs) << " - " << rdma::PerfTest::convertTime(maxFetchAddMs) << std::endl;
+			oss << " - Fetch&Add:       average = " << rdma::PerfTest::convertTime(fetchAddHistogram.getAverage()) << "    median = " << rdma::PerfTest::convertTime(fetchAddHistogram.getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(fetchAddHistogram.getMin()) << " - " << rdma::PerfTest::convertTime(fetchAddHistogram.getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(fetchAddHistogram) << std::endl;
 		}
 		if(hasTestOperation(COMPARE_SWAP_OPERATION)){
-			oss << " - Compare&Swap:    average = " << rdma::PerfTest::convertTime(avgCompareSwapMs) << "   median = " << rdma::PerfTest::convertTime(medianCompareSwapMs);
-			oss << "    range = " <<  rdma::PerfTest::convertTime(minCompareSwapMs) << " - " << rdma::PerfTest::convertTime(maxCompareSwapMs) << std::endl;
+			oss << " - Compare&Swap:    average = " << rdma::PerfTest::convertTime(compareSwapHistogram.getAverage()) << "   median = " << rdma::PerfTest::convertTime(compareSwapHistogram.getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(compareSwapHistogram.getMin()) << " - " << rdma::PerfTest::convertTime(compareSwapHistogram.getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(compareSwapHistogram) << std::endl;
 		}
 		return oss.str();
 	}
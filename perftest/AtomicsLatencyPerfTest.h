@@ -2,6 +2,7 @@
 #define AtomicsLatencyPerfTest_H
 
 #include "PerfTest.h"
+#include "LatencyHistogram.h"
 #include "../src/memory/LocalBaseMemoryStub.h"
 #include "../src/rdma/RDMAClient.h"
 #include "../src/rdma/RDMAServer.h"
@@ -25,9 +26,7 @@ public:
 		return m_ready;
 	}
 
-	int64_t m_sumFetchAddMs = 0, m_minFetchAddMs=std::numeric_limits<int64_t>::max(), m_maxFetchAddMs=-1;
-	int64_t m_sumCompareSwapMs = 0, m_minCompareSwapMs=std::numeric_limits<int64_t>::max(), m_maxCompareSwapMs=-1;
-	int64_t *m_arrFetchAddMs, *m_arrCompareSwapMs;
+	LatencyHistogram m_fetchAddHistogram, m_compareSwapHistogram;
 
 private:
 	bool m_ready = false;
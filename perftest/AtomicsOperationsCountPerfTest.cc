@@ -227,18 +227,24 @@ void rdma::AtomicsOperationsCountPerfTest::runTest(){
 
 		// Measure operations/s for fetching & adding
 		if(hasTestOperation(FETCH_ADD_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(FETCH_ADD_OPERATION); // fetch & add
+			startPerfEvents();
 			auto startFetchAdd = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedFetchAdd = rdma::PerfTest::stopTimer(startFetchAdd); 
+			stopPerfEvents(FETCH_ADD_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure operations/s for comparing & swaping
 		if(hasTestOperation(COMPARE_SWAP_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(COMPARE_SWAP_OPERATION); // compare & swap
+			startPerfEvents();
 			auto startCompareSwap = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedCompareSwap = rdma::PerfTest::stopTimer(startCompareSwap);
+			stopPerfEvents(COMPARE_SWAP_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 	}
 }
@@ -302,6 +308,7 @@ std::string rdma::AtomicsOperationsCountPerfTest::getTestResults(std::string csv
 					ofs << ", Comp&Swap [megaOp/s], Avg Comp&Swap [megaOp/s], Median Comp&Swap [megaOp/s], Min Comp&Swap [megaOp/s], Max Comp&Swap [megaOp/s], ";
 					ofs << "Comp&Swap [Sec], Avg Comp&Swap [Sec], Median Comp&Swap [Sec], Min Comp&Swap [Sec], Max Comp&Swap [Sec]";
 				}
+				writePerfEventsCSVHeader(ofs);
 				ofs << std::endl;
 			}
 			ofs << iters;
@@ -329,6 +336,7 @@ std::string rdma::AtomicsOperationsCountPerfTest::getTestResults(std::string csv
 				ofs << (round(minCompareSwap/tu * 100000)/100000.0) << ", "; // min comp&swap Sec
 				ofs << (round(maxCompareSwap/tu * 100000)/100000.0); // max comp&swap Sec
 			}
+			writePerfEventsCSV(ofs);
 			ofs << std::endl; ofs.close();
 		}
 
@@ -490,28 +490,37 @@ void rdma::BandwidthPerfTest::runTest(){
 
         // Measure bandwidth for writing
 		if(hasTestOperation(WRITE_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(WRITE_OPERATION); // write
 			usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first post its receives
+			startPerfEvents();
 			auto startWrite = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedWriteMs = rdma::PerfTest::stopTimer(startWrite);
+			stopPerfEvents(WRITE_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure bandwidth for reading
 		if(hasTestOperation(READ_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(READ_OPERATION); // read
+			startPerfEvents();
 			auto startRead = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedReadMs = rdma::PerfTest::stopTimer(startRead);
+			stopPerfEvents(READ_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		if(hasTestOperation(SEND_RECEIVE_OPERATION)){
 			// Measure bandwidth for sending
+			preparePerfEvents();
 			makeThreadsReady(SEND_RECEIVE_OPERATION); // send
 			usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first post its receives
+			startPerfEvents();
 			auto startSend = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedSendMs = rdma::PerfTest::stopTimer(startSend);
+			stopPerfEvents(SEND_RECEIVE_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 	}
@@ -586,6 +595,7 @@ std::string rdma::BandwidthPerfTest::getTestResults(std::string csvFileName, boo
 					ofs << ", Send/Recv [MB/s], Min Send/Recv [MB/s], Max Send/Recv [MB/s], Avg Send/Recv [MB/s], Median Send/Recv [MB/s], ";
 					ofs << "Send/Recv [Sec], Min Send/Recv [Sec], Max Send/Recv [Sec], Avg Send/Recv [Sec], Median Send/Recv [Sec]";
 				}
+				writePerfEventsCSVHeader(ofs);
 				ofs << std::endl;
 			}
 			ofs << m_packet_size << ", " << transferedBytes; // packet size Bytes
@@ -626,6 +636,8 @@ std::string rdma::BandwidthPerfTest::getTestResults(std::string csvFileName, boo
 				ofs << (round(medianSendMs/tu * 100000)/100000.0); // median send Sec
 			}
 
+			writePerfEventsCSV(ofs);
+
 			ofs << std::endl; ofs.close();
 		}
 
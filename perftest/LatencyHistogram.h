@@ -0,0 +1,134 @@
+#ifndef LatencyHistogram_H
+#define LatencyHistogram_H
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+
+namespace rdma {
+
+/* Class: LatencyHistogram
+ * ----------------
+ * Log-linear (HDR style) histogram of latencies in nanoseconds.
+ * Values below 2^SUB_BUCKET_BITS are counted exactly, above every
+ * power of two is split into 2^(SUB_BUCKET_BITS-1) linear buckets,
+ * so every value is known with a relative error below 1%.
+ *
+ * Each thread records into its own histogram without locking,
+ * the histograms are merged after the threads finished.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 8;
+    static const uint64_t SUB_BUCKETS = (uint64_t)1 << SUB_BUCKET_BITS;
+    static const uint64_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+    static const uint64_t BUCKETS = (64 - SUB_BUCKET_BITS + 2) * HALF_SUB_BUCKETS;
+
+    // percentiles reported in console and CSV output
+    static constexpr double PERCENTILES[] = { 90, 99, 99.9, 99.99 };
+    static constexpr const char* PERCENTILE_NAMES[] = { "P90", "P99", "P99.9", "P99.99" };
+
+    LatencyHistogram() : m_counts(BUCKETS, 0) {}
+
+    inline void record(int64_t nanoseconds){
+        uint64_t value = (nanoseconds < 0 ? 0 : (uint64_t)nanoseconds);
+        m_counts[indexOf(value)]++;
+        m_count++;
+        m_sum += value;
+        if(value < m_min) m_min = value;
+        if(value > m_max) m_max = value;
+    }
+
+    void merge(const LatencyHistogram &other){
+        for(uint64_t i = 0; i < BUCKETS; i++){
+            m_counts[i] += other.m_counts[i];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        if(other.m_min < m_min) m_min = other.m_min;
+        if(other.m_max > m_max) m_max = other.m_max;
+    }
+
+    uint64_t getCount() const { return m_count; }
+    int64_t getMin() const { return m_count > 0 ? (int64_t)m_min : 0; }
+    int64_t getMax() const { return (int64_t)m_max; }
+    long double getAverage() const { return m_count > 0 ? (long double)m_sum / m_count : 0; }
+
+    /* Function: getPercentile
+     * ----------------
+     * Highest value of the bucket containing the percentile,
+     * at most the maximum recorded value
+     *
+     * percentile:  0 - 100
+     */
+    int64_t getPercentile(double percentile) const {
+        if(m_count == 0) return 0;
+        uint64_t rank = (uint64_t)std::ceil(percentile / 100.0 * m_count);
+        if(rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for(uint64_t i = 0; i < BUCKETS; i++){
+            seen += m_counts[i];
+            if(seen >= rank){
+                uint64_t highest = highestValueOf(i);
+                return (int64_t)(highest < m_max ? highest : m_max);
+            }
+        }
+        return (int64_t)m_max;
+    }
+
+    int64_t getMedian() const { return getPercentile(50); }
+
+    /* Function: writeBuckets
+     * ----------------
+     * Appends all non-empty buckets as CSV lines
+     * 'name, lowest [ns], highest [ns], count, cumulative [%]'
+     */
+    void writeBuckets(std::ofstream &ofs, const std::string &name) const {
+        uint64_t seen = 0;
+        for(uint64_t i = 0; i < BUCKETS; i++){
+            if(m_counts[i] == 0) continue;
+            seen += m_counts[i];
+            ofs << name << ", " << lowestValueOf(i) << ", " << highestValueOf(i) << ", " << m_counts[i];
+            ofs << ", " << (100.0L * seen / m_count) << std::endl;
+        }
+    }
+
+    static void writeBucketsHeader(std::ofstream &ofs){
+        ofs << "Operation, Lowest [nsec], Highest [nsec], Count, Cumulative [%]" << std::endl;
+    }
+
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count = 0;
+    uint64_t m_sum = 0;
+    uint64_t m_min = std::numeric_limits<uint64_t>::max();
+    uint64_t m_max = 0;
+
+    static inline uint64_t indexOf(uint64_t value){
+        if(value < SUB_BUCKETS) return value;
+        // value >> shift is in [HALF_SUB_BUCKETS, SUB_BUCKETS)
+        uint64_t shift = (63 - __builtin_clzll(value)) - (SUB_BUCKET_BITS - 1);
+        return shift * HALF_SUB_BUCKETS + (value >> shift);
+    }
+
+    static inline uint64_t shiftOf(uint64_t index){
+        return index < SUB_BUCKETS ? 0 : index / HALF_SUB_BUCKETS - 1;
+    }
+
+    static inline uint64_t lowestValueOf(uint64_t index){
+        uint64_t shift = shiftOf(index);
+        return (index - shift * HALF_SUB_BUCKETS) << shift;
+    }
+
+    static inline uint64_t highestValueOf(uint64_t index){
+        uint64_t shift = shiftOf(index);
+        return lowestValueOf(index) + ((uint64_t)1 << shift) - 1;
+    }
+};
+
+}
+#endif
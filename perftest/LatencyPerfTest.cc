@@ -30,10 +30,6 @@ rdma::LatencyPerfClientThread::LatencyPerfClientThread(BaseMemory *memory, std::
 	this->m_write_mode = write_mode;
 	this->m_remOffsets = new size_t[m_rdma_addresses.size()];
 
-	this->m_arrWriteMs = new int64_t[iterations_per_thread];
-	this->m_arrReadMs = new int64_t[iterations_per_thread];
-	this->m_arrSendMs = new int64_t[iterations_per_thread];
-
 	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
 	    NodeID  nodeId = 0;
 		//ib_addr_t ibAddr;
@@ -67,11 +63,7 @@ rdma::LatencyPerfClientThread::~LatencyPerfClientThread() {
 	}
 	delete m_remOffsets;
 	delete m_local_memory;
-    
 
-	delete m_arrWriteMs;
-	delete m_arrReadMs;
-	delete m_arrSendMs;
 	delete m_client;
 }
 
@@ -116,12 +108,8 @@ void rdma::LatencyPerfClientThread::run() {
 								if((++counter) % 100000000 == 0){ std::cout << "KILL ME, I'M FROZEN " << std::endl; }
 							}
 							int64_t time = rdma::PerfTest::stopTimer(start) / 2; // half trip time for write
-							m_sumWriteMs += time;
-							if(m_minWriteMs > time) m_minWriteMs = time;
-							if(m_maxWriteMs < time) m_maxWriteMs = time;
-							m_arrWriteMs[i] += time;
+							m_writeHistogram.record(time);
 						}
-						m_arrWriteMs[i] /= m_rdma_addresses.size();
 					}
 					break;
 				case WRITE_MODE_IMMEDIATE:
@@ -139,12 +127,8 @@ void rdma::LatencyPerfClientThread::run() {
 							m_client->writeImm(m_addr[connIdx], remoteOffset, (void*)arrSend, m_packet_size, receiveRootOffsetIdx, true);
 							m_client->pollReceive(m_addr[connIdx], true);
 							int64_t time = rdma::PerfTest::stopTimer(start) / 2; // half trip time for write
-							m_sumWriteMs += time;
-							if(m_minWriteMs > time) m_minWriteMs = time;
-							if(m_maxWriteMs < time) m_maxWriteMs = time;
-							m_arrWriteMs[i] += time;
+							m_writeHistogram.record(time);
 						}
-						m_arrWriteMs[i] /= m_rdma_addresses.size();
 					}
 					break;
 				default: throw invalid_argument("LatencyPerfClientThread unknown write mode"); 
@@ -161,12 +145,8 @@ void rdma::LatencyPerfClientThread::run() {
 					auto start = rdma::PerfTest::startTimer();
 					m_client->read(m_addr[connIdx], remoteOffset, (void*)arrRecv, m_packet_size, true); // true=signaled
 					int64_t time = rdma::PerfTest::stopTimer(start);
-					m_sumReadMs += time;
-					if(m_minReadMs > time) m_minReadMs = time;
-					if(m_maxReadMs < time) m_maxReadMs = time;
-					m_arrReadMs[i] += time;
+					m_readHistogram.record(time);
 				}
-				m_arrReadMs[i] /= m_rdma_addresses.size();
 			}
 			break;
 
@@ -188,12 +168,8 @@ void rdma::LatencyPerfClientThread::run() {
 					m_client->pollReceive(m_addr[connIdx], true); // true=poll
 					m_client->receive(m_addr[connIdx], (void*)arrRecv, m_packet_size);
 					int64_t time = rdma::PerfTest::stopTimer(start) / 2; // half trip time for send
-					m_sumSendMs += time;
-					if(m_minSendMs > time) m_minSendMs = time;
-					if(m_maxSendMs < time) m_maxSendMs = time;
-					m_arrSendMs[i] += time;
+					m_sendHistogram.record(time);
 				}
-				m_arrSendMs[i] /= m_rdma_addresses.size();
 			}
 			break;
 		default: throw invalid_argument("LatencyPerfClientThread unknown test mode");
@@ -452,23 +428,32 @@ void rdma::LatencyPerfTest::runTest(){
 
         // Measure Latency for writing
 		if(hasTestOperation(WRITE_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(WRITE_OPERATION); // write
 			usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first post the receives
+			startPerfEvents();
 			runThreads();
+			stopPerfEvents(WRITE_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure Latency for reading
 		if(hasTestOperation(READ_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(READ_OPERATION); // read
 			usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first make ready (shouldn't be necessary)
+			startPerfEvents();
 			runThreads();
+			stopPerfEvents(READ_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure Latency for sending
 		if(hasTestOperation(SEND_RECEIVE_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(SEND_RECEIVE_OPERATION); // send
 			usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first post the receives
+			startPerfEvents();
 			runThreads();
+			stopPerfEvents(SEND_RECEIVE_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 	}
 }
@@ -478,47 +463,16 @@ std::string rdma::LatencyPerfTest::getTestResults(std::string csvFileName, bool
 	if(m_is_server){
 		return "only client";
 	} else {
-		
-		/*	There are  n  threads
-			Each thread computes  iterations_per_thread = total_iterations / n
-			Each thread takes  n  times more time compared to a single thread
-			  Latency 	= elapsedTime / iterations
-						= (elpasedTime_per_thread) / (n * iterations_per_thread)
-		*/
-
-		int64_t minWriteMs=std::numeric_limits<int64_t>::max(), maxWriteMs=-1, medianWriteMs=-1;
-		int64_t minReadMs=std::numeric_limits<int64_t>::max(), maxReadMs=-1, medianReadMs=-1;
-		int64_t minSendMs=std::numeric_limits<int64_t>::max(), maxSendMs=-1, medianSendMs=-1;
-		long double avgWriteMs=0, avgReadMs=0, avgSendMs=0;
-		int64_t mediansWriteNs[thread_count], mediansReadNs[thread_count], mediansSendNs[thread_count];
-		const long double divAvg = m_client_threads.size() * m_iterations_per_thread * m_rdma_addresses.size(); // for calculating average
+
+		// threads recorded into their own histograms
+		LatencyHistogram writeHistogram, readHistogram, sendHistogram;
 		for(size_t i=0; i<m_client_threads.size(); i++){
 			LatencyPerfClientThread *thr = m_client_threads[i];
-			if(minWriteMs > thr->m_minWriteMs) minWriteMs = thr->m_minWriteMs;
-			if(maxWriteMs < thr->m_maxWriteMs) maxWriteMs = thr->m_maxWriteMs;
-			avgWriteMs += thr->m_sumWriteMs / divAvg;
-			if(minReadMs > thr->m_minReadMs) minReadMs = thr->m_minReadMs;
-			if(maxReadMs < thr->m_maxReadMs) maxReadMs = thr->m_maxReadMs;
-			avgReadMs += thr->m_sumReadMs / divAvg;
-			if(minSendMs > thr->m_minSendMs) minSendMs = thr->m_minSendMs;
-			if(maxSendMs < thr->m_maxSendMs) maxSendMs = thr->m_maxSendMs;
-			avgSendMs += thr->m_sumSendMs / divAvg;
-
-			std::sort(thr->m_arrWriteMs, thr->m_arrWriteMs + m_iterations_per_thread);
-			std::sort(thr->m_arrReadMs, thr->m_arrReadMs + m_iterations_per_thread);
-			std::sort(thr->m_arrSendMs, thr->m_arrSendMs + m_iterations_per_thread);
-			mediansWriteNs[i] = thr->m_arrWriteMs[(int)(m_iterations_per_thread/2)];
-			mediansReadNs[i] = thr->m_arrReadMs[(int)(m_iterations_per_thread/2)];
-			mediansSendNs[i] = thr->m_arrSendMs[(int)(m_iterations_per_thread/2)];
+			writeHistogram.merge(thr->m_writeHistogram);
+			readHistogram.merge(thr->m_readHistogram);
+			sendHistogram.merge(thr->m_sendHistogram);
 		}
 
-		std::sort(mediansWriteNs, mediansWriteNs + thread_count);
-		std::sort(mediansReadNs, mediansReadNs + thread_count);
-		std::sort(mediansSendNs, mediansSendNs + thread_count);
-		medianWriteMs = mediansWriteNs[(int)(thread_count/2)];
-		medianReadMs = mediansReadNs[(int)(thread_count/2)];
-		medianSendMs = mediansSendNs[(int)(thread_count/2)];
-
 		// write results into CSV file
 		if(!csvFileName.empty()){
 			const long double ustu = 1000; // nanosec to microsec
@@ -530,52 +484,75 @@ std::string rdma::LatencyPerfTest::getTestResults(std::string csvFileName, bool
 				ofs << "PacketSize [Bytes]";
 				if(hasTestOperation(WRITE_OPERATION)){
 					ofs << ", Avg Write [usec], Median Write [usec], Min Write [usec], Max Write [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, "Write");
 				}
 				if(hasTestOperation(READ_OPERATION)){
 					ofs << ", Avg Read [usec], Median Read [usec], Min Read [usec], Max Read [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, "Read");
 				}
 				if(hasTestOperation(SEND_RECEIVE_OPERATION)){
 					ofs << ", Avg Send/Recv [usec], Median Send/Recv [usec], Min Send/Recv [usec], Max Send/Recv [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, "Send/Recv");
 				}
+				writePerfEventsCSVHeader(ofs);
 				ofs << std::endl;
 			}
 			ofs << m_packet_size; // packet size Bytes
 			if(hasTestOperation(WRITE_OPERATION)){
-				ofs << ", " << (round(avgWriteMs/ustu * 10)/10.0) << ", "; // avg write us
-				ofs << (round(medianWriteMs/ustu * 10)/10.0) << ", "; // median write us
-				ofs << (round(minWriteMs/ustu * 10)/10.0) << ", "; // min write us
-				ofs << (round(maxWriteMs/ustu * 10)/10.0); // max write us
+				ofs << ", " << (round(writeHistogram.getAverage()/ustu * 10)/10.0) << ", "; // avg write us
+				ofs << (round(writeHistogram.getMedian()/ustu * 10)/10.0) << ", "; // median write us
+				ofs << (round(writeHistogram.getMin()/ustu * 10)/10.0) << ", "; // min write us
+				ofs << (round(writeHistogram.getMax()/ustu * 10)/10.0); // max write us
+				rdma::PerfTest::writePercentilesCSV(ofs, writeHistogram);
 			}
 			if(hasTestOperation(READ_OPERATION)){
-				ofs << ", " << (round(avgReadMs/ustu * 10)/10.0) << ", "; // avg read us
-				ofs << (round(medianReadMs/ustu * 10)/10.0) << ", "; // median read us
-				ofs << (round(minReadMs/ustu * 10)/10.0) << ", "; // min read us
-				ofs << (round(maxReadMs/ustu * 10)/10.0); // max read us
+				ofs << ", " << (round(readHistogram.getAverage()/ustu * 10)/10.0) << ", "; // avg read us
+				ofs << (round(readHistogram.getMedian()/ustu * 10)/10.0) << ", "; // median read us
+				ofs << (round(readHistogram.getMin()/ustu * 10)/10.0) << ", "; // min read us
+				ofs << (round(readHistogram.getMax()/ustu * 10)/10.0); // max read us
+				rdma::PerfTest::writePercentilesCSV(ofs, readHistogram);
 			}
 			if(hasTestOperation(SEND_RECEIVE_OPERATION)){
-				ofs << ", " << (round(avgSendMs/ustu * 10)/10.0) << ", "; // avg send us
-				ofs << (round(medianSendMs/ustu * 10)/10.0) << ", "; // median send us
-				ofs << (round(minSendMs/ustu * 10)/10.0) << ", "; // min send us
-				ofs << (round(maxSendMs/ustu * 10)/10.0); // max send us
+				ofs << ", " << (round(sendHistogram.getAverage()/ustu * 10)/10.0) << ", "; // avg send us
+				ofs << (round(sendHistogram.getMedian()/ustu * 10)/10.0) << ", "; // median send us
+				ofs << (round(sendHistogram.getMin()/ustu * 10)/10.0) << ", "; // min send us
+				ofs << (round(sendHistogram.getMax()/ustu * 10)/10.0); // max send us
+				rdma::PerfTest::writePercentilesCSV(ofs, sendHistogram);
 			}
+			writePerfEventsCSV(ofs);
 			ofs << std::endl; ofs.close();
 		}
 
+		// write full histograms
+		if(!histogramFileName.empty()){
+			std::ofstream ofs;
+			ofs.open(histogramFileName, std::ofstream::out | std::ofstream::app);
+			ofs << std::endl << "LATENCY HISTOGRAM, " << getTestParameters(true) << ", packetsize=" << m_packet_size << std::endl;
+			LatencyHistogram::writeBucketsHeader(ofs);
+			if(hasTestOperation(WRITE_OPERATION)) writeHistogram.writeBuckets(ofs, "Write");
+			if(hasTestOperation(READ_OPERATION)) readHistogram.writeBuckets(ofs, "Read");
+			if(hasTestOperation(SEND_RECEIVE_OPERATION)) sendHistogram.writeBuckets(ofs, "Send/Recv");
+			ofs.close();
+		}
+
 		// generate result string
 		std::ostringstream oss;
 		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
 		oss << "Measured as 'round-trip time' latency for read and 'half-trip time' latency for write and send:" << std::endl;
 		if(hasTestOperation(WRITE_OPERATION)){
-			oss << " - Write:           average = " << rdma::PerfTest::convertTime(avgWriteMs) << "    median = " << rdma::PerfTest::convertTime(medianWriteMs);
-			oss << "    range = " <<  rdma::PerfTest::convertTime(minWriteMs) << " - " << rdma::PerfTest::convertTime(maxWriteMs) << std::endl;
+			oss << " - Write:           average = " << rdma::PerfTest::convertTime(writeHistogram.getAverage()) << "    median = " << rdma::PerfTest::convertTime(writeHistogram.getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(writeHistogram.getMin()) << " - " << rdma::PerfTest::convertTime(writeHistogram.getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(writeHistogram) << std::endl;
 		}
 		if(hasTestOperation(READ_OPERATION)){
-			oss << " - Read:            average = " << rdma::PerfTest::convertTime(avgReadMs) << "    median = " << rdma::PerfTest::convertTime(medianReadMs);
-			oss << "    range = " <<  rdma::PerfTest::convertTime(minReadMs) << " - " << rdma::PerfTest::convertTime(maxReadMs) << std::endl;
+			oss << " - Read:            average = " << rdma::PerfTest::convertTime(readHistogram.getAverage()) << "    median = " << rdma::PerfTest::convertTime(readHistogram.getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(readHistogram.getMin()) << " - " << rdma::PerfTest::convertTime(readHistogram.getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(readHistogram) << std::endl;
 		}
 		if(hasTestOperation(SEND_RECEIVE_OPERATION)){
-			oss << " - Send:            average = " << rdma::PerfTest::convertTime(avgSendMs) << "    median = " << rdma::PerfTest::convertTime(medianSendMs);
-			oss << "    range = " <<  rdma::PerfTest::convertTime(minSendMs) << " - " << rdma::PerfTest::convertTime(maxSendMs) << std::endl;
+			oss << " - Send:            average = " << rdma::PerfTest::convertTime(sendHistogram.getAverage()) << "    median = " << rdma::PerfTest::convertTime(sendHistogram.getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(sendHistogram.getMin()) << " - " << rdma::PerfTest::convertTime(sendHistogram.getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(sendHistogram) << std::endl;
 		}
 		return oss.str();
 	}
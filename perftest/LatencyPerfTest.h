@@ -2,6 +2,7 @@
 #define LatencyPerfTest_H
 
 #include "PerfTest.h"
+#include "LatencyHistogram.h"
 #include "../src/memory/LocalBaseMemoryStub.h"
 #include "../src/rdma/RDMAClient.h"
 #include "../src/rdma/RDMAServer.h"
@@ -25,10 +26,7 @@ public:
 		return m_ready;
 	}
 
-	int64_t m_sumWriteMs = 0, m_minWriteMs=std::numeric_limits<int64_t>::max(), m_maxWriteMs=-1;
-	int64_t m_sumReadMs = 0, m_minReadMs=std::numeric_limits<int64_t>::max(), m_maxReadMs=-1;
-	int64_t m_sumSendMs = 0, m_minSendMs=std::numeric_limits<int64_t>::max(), m_maxSendMs=-1;
-	int64_t *m_arrWriteMs, *m_arrReadMs, *m_arrSendMs;
+	LatencyHistogram m_writeHistogram, m_readHistogram, m_sendHistogram; // recorded without locking, merged after run
 
 private:
 	bool m_ready = false;
@@ -1,10 +1,18 @@
 #include "PerfTest.h"
+#include "PerfReport.h"
+#include "PerfOrchestrator.h"
 #include "BandwidthPerfTest.h"
 #include "AtomicsBandwidthPerfTest.h"
 #include "LatencyPerfTest.h"
 #include "AtomicsLatencyPerfTest.h"
 #include "OperationsCountPerfTest.h"
 #include "AtomicsOperationsCountPerfTest.h"
+#include "OpenLoopPerfTest.h"
+#include "ScanPerfTest.h"
+#include "RPCPerfTest.h"
+#include "UnreliablePerfTest.h"
+#include "WorkloadPerfTest.h"
+#include "QPScalabilityPerfTest.h"
 
 #include "../src/utils/Config.h"
 #include "../src/utils/StringHelper.h"
@@ -19,13 +27,19 @@
 #include <ctime>
 #include <chrono>
 #include <bits/stdc++.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
 
 #include <gflags/gflags.h>
 
 DEFINE_bool(fulltest, false, "Sets default values for flags 'test, gpu, remote_gpu, packetsize, threads, iterations, bufferslots, csv' to execute a broad variety of predefined tests. Flags can still be overwritten. If GPUs are supported then gpu=-1,-1,0,0 on client side and gpu=-1,0,-1,0 on server side to test all memory combinations: Main->Main, Main->GPU, GPU->Main, GPU->GPU");
 DEFINE_bool(halftest, false, "Sets default values for flags 'test, gpu, remote_gpu, packetsize, threads, iterations, bufferslots, csv' to execute a smaller variety of predefined tests. If GPUs are supported then gpu=-1,-1,0,0 on client side and gpu=-1,0,-1,0 on server side to test all memory combinations: Main->Main, Main->GPU, GPU->Main, GPU->GPU");
 DEFINE_bool(quicktest, false, "Sets default values for flags 'test, gpu, remote_gpu, packetsize, threads, iterations, csv' to execute a very smaller variety of predefined tests. If GPUs are supported then gpu=-1,-1,0,0 on client side and gpu=-1,0,-1,0 on server side to test all memory combinations: Main->Main, Main->GPU, GPU->Main, GPU->GPU");
-DEFINE_string(test, "", "Tests: [bandwidth, latency, operationscount, atomicsbandwidth, atomicslatency, atomicsoperationscount] OR MORE GRANULAR [write_bw, write_lat, write_ops, read_bw, read_lat, read_ops, send_bw, send_lat, send_ops, fetch_bw, fetch_lat, fetch_ops, swap_bw, swap_lat, swap_ops] (multiples separated by comma without space, not full word required) [Default bandwidth]");
+DEFINE_string(test, "", "Tests: [bandwidth, latency, operationscount, atomicsbandwidth, atomicslatency, atomicsoperationscount, openloop, scan, rpc, udbandwidth, udlatency, workload, qpscale] OR MORE GRANULAR [write_bw, write_lat, write_ops, write_ol, read_bw, read_lat, read_ops, read_ol, send_bw, send_lat, send_ops, send_ol, fetch_bw, fetch_lat, fetch_ops, fetch_ol, swap_bw, swap_lat, swap_ops, swap_ol, ud_bw, ud_lat, mcast_bw, mcast_lat] (multiples separated by comma without space, not full word required) [Default bandwidth]");
 DEFINE_bool(server, false, "Act as server for a client to test performance");
 DEFINE_int32(clients, 1, "Required by all servers as well as all clients to know how many actual client processes are running. It is irelevant how many threads actually used just how often an instance of the performance tool got started in client mode.");
 DEFINE_string(memtype, "", "Memory type or index of GPU for memory allocation ('-3' or 'MAIN' for Main memory, '-2' or 'GPU.NUMA' for NUMA aware GPU, '-1' or 'GPU.D' for default GPU, '0..n' or 'GPU.i' i index for fixed GPU | multiples separated by comma without space) [Default -3]");
@@ -39,17 +53,52 @@ DEFINE_string(transfersize, "", "How much data should be transfered in bandwidth
 DEFINE_int32(maxiterations, 500000, "Amount of iterations for bandwidth and operations/sec are calculated via transfersize/packetsize and this flag sets a maximum limit to speed up tests for very small packetsizes. Set to zero or negative value to ignore this flag. Doesn't affect the  --iterations  or  --maxtransfersize  flag");
 DEFINE_bool(csv, false, "Results will be written into an automatically generated CSV file");
 DEFINE_string(csvfile, "", "Results will be written into a given CSV file");
+DEFINE_string(histogramfile, "", "Full latency histograms (bucket ranges, counts and cumulative percentages) of the latency tests will be appended to a given CSV file");
+DEFINE_bool(perfevents, false, "Measures the client threads of every test phase with hardware counters (cycles, instructions, L1/LLC misses, branch misses via perf_event_open) and their CPU time (getrusage) and reports them per operation in the console and CSV file");
+DEFINE_string(json, "", "Results of all tests together with their parameters and metadata of the host (CPU, RDMA device, port rate, NUMA node, git revision) will be written into a given JSON file");
+DEFINE_string(compare, "", "JSON file of an earlier run (see  --json  flag) used as baseline. Metrics that got worse by more than  --threshold  and whose confidence intervals don't overlap are reported as regressions and the exit code is 1");
+DEFINE_string(threshold, "5", "Change in percent a metric may get worse compared to the  --compare  baseline. Either a single value or additionally per unit like '5,usec=10,%=1'");
+DEFINE_int32(repetitions, 1, "How often all tests are repeated. Servers and clients need exactly the same value. The JSON report contains mean, standard deviation and confidence interval of the repetitions");
+DEFINE_int32(confidence, 95, "Confidence level in percent of the confidence intervals in the JSON report and for  --compare  (90, 95 or 99)");
 DEFINE_string(seqaddr, "", "Address of NodeIDSequencer to connect/bind to. If empty then config value will be used");
 DEFINE_int32(seqport, -1, "Port of NodeIDSequencer to connect/bind to. If empty then config value will be used");
 DEFINE_string(ownaddr, "", "Address of own RDMA interface that the RDMAServer will use to bind to and the RDMAClient the retriev its node id. If empty then config value 'RDMA_INTERFACE' will be used");
 DEFINE_string(addr, "", "RDMA address for the RDMACLient to connect to. If empty then config value 'RDMA_SERVER_ADDRESSES' will be used. It is also possible to directly append the port value after the address in form of ip:port. (multiples separated by comma without space will open a connection to each address in parallel)");
 DEFINE_int32(port, -1, "RDMA port that is used for addresses which have no port explicitly defined. If negative then config value will be used");
 DEFINE_string(writemode, "auto", "Which RDMA write mode should be used. Possible values are 'immediate' where remote receives and completion entry after a write, 'normal' where remote possibly has to pull the memory constantly to detect changes, 'auto' which uses preferred (ignored by atomics tests | multiples separated by comma without space)");
+DEFINE_string(rate, "", "Target operations per second of each client thread for the open-loop tests. Operations are issued at the intended send times independent of completions (offered load sweep | multiples separated by comma without space) [Default 100000]");
+DEFINE_string(arrival, "poisson", "Interarrival times of the open-loop tests: 'poisson' for exponentially distributed or 'constant'");
+DEFINE_string(prefetch, "", "How many page reads the scan test keeps outstanding while processing the current page (multiples separated by comma without space) [Default 16]");
+DEFINE_string(scansize, "64MB", "Size of the remote table partition each client thread scans in the scan test. The page size is given by  --packetsize");
+DEFINE_string(responsesize, "", "Response size in bytes of the RPC test whereas the request size is given by  --packetsize. Zero answers with the request size (multiples separated by comma without space) [Default 0]");
+DEFINE_string(outstanding, "", "How many requests each client thread of the RPC test keeps in flight per connection (multiples separated by comma without space) [Default 1]");
+DEFINE_string(mcastaddr, "", "Address of the multicast group the servers of the UD tests join and the clients send to. Servers and clients need exactly the same value. If empty then the IP of the first  --addr  value will be used (required with multiple servers)");
+DEFINE_string(mix, "read=95,write=5", "Weights of the operations of the workload test like 'read=50,write=45,fetch=5' (read, write, fetch for fetch&add, swap for compare&swap) or the YCSB workloads 'a' (50% reads, 50% writes), 'b' (95%, 5%), 'c' (only reads)");
+DEFINE_string(keys, "", "Amount of objects in the key-value table of the workload test which are distributed over all servers. The object size is given by  --packetsize  (multiples separated by comma without space) [Default 1000000]");
+DEFINE_string(distribution, "zipfian", "Key distributions of the workload test: 'uniform', 'zipfian' (see  --zipftheta) or 'hotspot' (see  --hotset  and  --hotops) (multiples separated by comma without space)");
+DEFINE_double(zipftheta, 0.99, "Skew of the zipfian key distribution of the workload test (between 0 and 1 exclusive, YCSB uses 0.99)");
+DEFINE_double(hotset, 0.2, "Share of the keys that are hot for the hotspot key distribution of the workload test");
+DEFINE_double(hotops, 0.8, "Share of the operations that access the hot keys for the hotspot key distribution of the workload test");
+DEFINE_string(qps, "", "Amount of QPs each client opens to every server in the QP scalability test. They are distributed evenly over the client threads which issue each operation on one of their QPs picked at random (multiples separated by comma without space) [Default 1,10,100,1000,10000]");
+DEFINE_bool(loopback, false, "Runs the NodeIDSequencer, the server and the client with a single invocation on the local RDMA device (Soft-RoCE works). The server side gets forked before any RDMA resources exist and binds to  --ownaddr  and  --port  which the client connects to. Flags  --server, --addr, --seqaddr  and  --clients  are ignored");
+DEFINE_string(loopbacklog, "", "File the output of the server side of  --loopback  is written into. If empty then the output is discarded (errors are still printed)");
+DEFINE_string(servercores, "", "CPU cores the threads of a server (also the server side of  --loopback) are pinned to. If empty then all cores of the NUMA region given by  --numa  or the config are used (multiples separated by comma without space)");
+DEFINE_string(clientcores, "", "CPU cores the threads of a client (also the client side of  --loopback) are pinned to. If empty then all cores of the NUMA region given by  --numa  or the config are used (multiples separated by comma without space)");
+DEFINE_bool(sequencer, true, "Servers start the NodeIDSequencer if  --seqaddr  is a local address. Disable if it already runs on this host (runs of a  --controller  always disable it)");
+DEFINE_bool(agent, false, "Runs as agent of a  --controller: registers at the NodeIDSequencer given by  --seqaddr  and executes the runs of the controller as separate perf_test processes until the controller stops it. Test flags are given by the controller whereas  --config, --ownaddr, --numa, --seqaddr  and  --seqport  are taken from the agent");
+DEFINE_int32(readyfd, -1, "File descriptor a server writes a byte into once clients can connect. Set by agents to report the readiness of a server run to the controller");
+DEFINE_int32(agentport, 5300, "Port an agent receives the runs of the controller on");
+DEFINE_bool(controller, false, "Orchestrates the tests on  --agents  agents registered at the NodeIDSequencer (started by the controller if  --seqaddr  is local). Every combination of the  --matrix  flags is a run that is executed synchronously on all agents with the first  --servers  agents as servers. Results of all nodes are collected into the console output,  --csvfile  and  --json  report and the agents are stopped afterwards");
+DEFINE_int32(agents, 2, "Amount of agents the controller waits for and runs the tests on");
+DEFINE_int32(servers, 1, "How many of the agents of the controller act as servers, the others are clients");
+DEFINE_string(matrix, "test,threads", "Test flags the controller executes a separate synchronous run for every value of (every combination if multiple flags). Values of the other test flags are passed to every run unchanged (multiples separated by comma without space)");
+DEFINE_int32(agenttimeout, 300, "Seconds the controller waits for the agents to register");
+DEFINE_int32(runtimeout, 0, "Seconds after which the agents kill a run of the controller that has not finished, e.g. servers whose client failed. Zero waits forever");
 DEFINE_bool(ignoreerrors, false, "If an error occurs test will be skiped and execution continues");
 DEFINE_string(config, "./bin/conf/RDMA.conf", "Path to the config file");
 DEFINE_int32(numa, -1, "NUMA region on which the IB device sits. -1 will use the value from the config file.");
 
-enum TEST { BANDWIDTH_TEST=1, LATENCY_TEST=2, OPERATIONS_COUNT_TEST=3, ATOMICS_BANDWIDTH_TEST=4, ATOMICS_LATENCY_TEST=5, ATOMICS_OPERATIONS_COUNT_TEST=6 };
+enum TEST { BANDWIDTH_TEST=1, LATENCY_TEST=2, OPERATIONS_COUNT_TEST=3, ATOMICS_BANDWIDTH_TEST=4, ATOMICS_LATENCY_TEST=5, ATOMICS_OPERATIONS_COUNT_TEST=6, OPEN_LOOP_TEST=7, SCAN_TEST=8, RPC_TEST=9, UD_BANDWIDTH_TEST=10, UD_LATENCY_TEST=11, WORKLOAD_TEST=12, QP_SCALABILITY_TEST=13 };
 extern const uint64_t MINIMUM_PACKET_SIZE = 4; // >=4 for latency to transfer remote offset
 
 
@@ -132,6 +181,51 @@ static std::vector<int> parseMemoryTypeList(std::string str){
 }
 
 
+static rdma::PerfReport *report = nullptr; // if results should be stored as JSON or compared
+
+// appends CSV rows a test wrote for the report into the actual CSV file
+static void appendCSV(std::string fromFileName, std::string toFileName, bool csvAddHeader){
+    std::ifstream ifs(fromFileName);
+    std::ofstream ofs(toFileName, std::ofstream::out | std::ofstream::app);
+    std::string line;
+    size_t lineNumber = 0;
+    while(std::getline(ifs, line)){
+        if(csvAddHeader || lineNumber++ >= 3) ofs << line << std::endl; // empty line, title, column names
+    }
+}
+
+// appends CSV rows an agent returned and extends their titles by the agent
+static void appendAgentCSV(std::string csv, std::string toFileName, std::string agent){
+    std::istringstream iss(csv);
+    std::ofstream ofs(toFileName, std::ofstream::out | std::ofstream::app);
+    std::string line;
+    bool title = true; // first line after an empty line
+    while(std::getline(iss, line)){
+        std::string trimmed = line;
+        bool empty = rdma::StringHelper::trim(trimmed).empty();
+        ofs << line << (title && !empty ? ", node=" + agent : "") << std::endl;
+        title = empty;
+    }
+}
+
+// writes the JSON report and compares it with the baseline
+static int finishReport(const std::vector<rdma::PerfReport::Result> &baseline){
+    int exitCode = 0;
+    if(report != nullptr){
+        if(!FLAGS_json.empty()){
+            report->writeJSON(FLAGS_json);
+            std::cout << "Report written into '" << FLAGS_json << "'" << std::endl;
+        }
+        if(!FLAGS_compare.empty()){
+            std::cout << std::endl << "COMPARISON WITH BASELINE '" << FLAGS_compare << "'" << std::endl;
+            if(report->compare(baseline, FLAGS_threshold, std::cout) > 0) exitCode = 1;
+        }
+        delete report;
+        report = nullptr;
+    }
+    return exitCode;
+}
+
 static void runTest(size_t testNumber, size_t testIterations, std::string testName, rdma::PerfTest *test, std::string csvFileName, bool csvAddHeader){
     bool error = false;
     std::string errorname = "", errorstr = "";
@@ -141,13 +235,27 @@ static void runTest(size_t testNumber, size_t testIterations, std::string testNa
         std::time_t systime = std::time(NULL);
         std::strftime(timestr, 255, "%F %T", std::localtime(&systime));
         std::cout << "SETTING UP ENVIRONMENT FOR TEST '" << testName << "' (" << timestr << ") ..." << std::endl;
+        test->perfEvents = FLAGS_perfevents;
         test->setupTest();
 
         std::cout << "RUN TEST WITH PARAMETERS:  " << test->getTestParameters() << std::endl;
         auto start = rdma::PerfTest::startTimer();
         test->runTest();
         int64_t duration = rdma::PerfTest::stopTimer(start);
-        std::cout << "RESULTS: " << test->getTestResults(csvFileName, csvAddHeader) << std::endl;
+        test->histogramFileName = FLAGS_histogramfile;
+        if(report != nullptr){
+            // test always writes the CSV header for the report
+            std::string reportFileName = "/tmp/perf_test_report_" + std::to_string(getpid()) + ".csv";
+            std::remove(reportFileName.c_str());
+            std::cout << "RESULTS: " << test->getTestResults(reportFileName, true) << std::endl;
+            report->addResult(testName, test->getTestParameters(), reportFileName);
+            if(!csvFileName.empty()) appendCSV(reportFileName, csvFileName, csvAddHeader);
+            std::remove(reportFileName.c_str());
+        } else {
+            std::cout << "RESULTS: " << test->getTestResults(csvFileName, csvAddHeader) << std::endl;
+        }
+        std::string perfEventsResults = test->getPerfEventsResults();
+        if(!perfEventsResults.empty()) std::cout << "PERF EVENTS (per operation of all client threads):" << std::endl << perfEventsResults << std::endl;
         std::cout << "DONE TESTING '" << testName << "' (" << rdma::PerfTest::convertTime(duration) << ")" << std::endl << std::endl;
     } catch (const std::exception &ex){
         error = true;
@@ -177,12 +285,18 @@ static void runTest(size_t testNumber, size_t testIterations, std::string testNa
 }
 
 
-static void initialSyncAsServer(std::string ownIpPort, std::string sequencerIpPort, size_t expected_clients){
+// readyFd (if not -1) gets a byte and is closed once clients can connect
+static void initialSyncAsServer(std::string ownIpPort, std::string sequencerIpPort, size_t expected_clients, int readyFd = -1){
     int port = rdma::Network::getPortOfConnection(ownIpPort);
     std::string addr = rdma::Network::getAddressOfConnection(ownIpPort);
     uint64_t mem_size = 1; //if(mem_size < rdma::Config::GPUDIRECT_MINIMUM_MSG_SIZE) mem_size =  rdma::Config::GPUDIRECT_MINIMUM_MSG_SIZE;
     rdma::RDMAServer<rdma::ReliableRDMA> *server = new rdma::RDMAServer<rdma::ReliableRDMA>(std::string("IntialSyncServer"), port, addr, mem_size, sequencerIpPort);
     server->startServer();
+    if(readyFd >= 0){
+        const char ready = 1;
+        if(write(readyFd, &ready, 1) != 1) throw runtime_error("Could not signal readiness of server side");
+        close(readyFd);
+    }
     rdma::PerfTest::global_barrier_server(server, expected_clients);
     while(!server->getConnectedConnIDs().empty()){
         usleep(rdma::Config::RDMA_SLEEP_INTERVAL); // wait for all clients to disconnect
@@ -206,6 +320,40 @@ static void initialSyncAsClient(const std::vector<std::string> &serverIpAndPorts
 }
 
 
+// exit status of the server side of the loopback mode once it ended (-1 while running)
+static volatile sig_atomic_t loopbackServerStatus = -1;
+
+// client side must not wait forever for a server side that failed
+static void onLoopbackServerExit(int){
+    int status = 0;
+    if(waitpid(-1, &status, WNOHANG) <= 0) return;
+    loopbackServerStatus = (WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+    if(loopbackServerStatus != 0){
+        const char msg[] = "Server side of loopback failed\n";
+        if(write(STDERR_FILENO, msg, sizeof(msg) - 1) < 0){}
+        _exit(1);
+    }
+}
+
+// threads of this process are pinned to the given cores instead of the cores of the NUMA region (see Thread::execute)
+static void pinThreads(const std::vector<int> &cores){
+    if(cores.empty()) return;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for(const int &core : cores){
+        if(core < 0 || core >= CPU_SETSIZE) throw runtime_error("Invalid CPU core " + to_string(core));
+        CPU_SET(core, &cpuset);
+    }
+    if(rdma::Config::NUMA_THREAD_CPUS.size() <= (size_t)rdma::Config::RDMA_NUMAREGION) rdma::Config::NUMA_THREAD_CPUS.resize(rdma::Config::RDMA_NUMAREGION + 1);
+    rdma::Config::NUMA_THREAD_CPUS[rdma::Config::RDMA_NUMAREGION] = cores;
+    if(sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) throw runtime_error("Could not pin threads to the given CPU cores");
+}
+
+
+static bool isLocalAddress(std::string addr){
+    return (addr=="*" || addr=="localhost" || addr=="127.0.0.1" || addr == rdma::Network::getOwnAddress());
+}
+
 static bool checkInvalidTestParams(size_t packet_size, int local_gpu_index, int remote_gpu_index){
     // skip if GPU and packet size < Config::GPUDIRECT_MINIMUM_MSG_SIZE  (same if condition lower)
     if((FLAGS_server ? remote_gpu_index : local_gpu_index) > (int)rdma::MEMORY_TYPE::MAIN && packet_size < rdma::Config::GPUDIRECT_MINIMUM_MSG_SIZE){
@@ -217,6 +365,8 @@ static bool checkInvalidTestParams(size_t packet_size, int local_gpu_index, int
 
 
 int main(int argc, char *argv[]){
+    std::ostringstream commandLine;
+    for(int i = 0; i < argc; i++) commandLine << (i > 0 ? " " : "") << argv[i];
     std::cout << std::endl << "INFO:  All bandwidth measurements are correctly measured in MiB/s to be compareable to other tools and network stats but labeled as MB/s as this is commonly practiced!" << std::endl << std::endl;
     std::cout << "Parsing arguments ..." << std::endl;
     gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -231,10 +381,32 @@ int main(int argc, char *argv[]){
             rdma::Config::RDMA_INTERFACE = FLAGS_ownaddr;
             FLAGS_ownaddr=rdma::Config::getIP(FLAGS_ownaddr);
         }
+    if(FLAGS_loopback){
+        if(FLAGS_server) throw runtime_error("Loopback starts the server side itself therefore the  --server  flag is not allowed");
+        FLAGS_addr = FLAGS_ownaddr; // server side binds to own address
+        FLAGS_seqaddr = FLAGS_ownaddr; // server side starts the sequencer
+        FLAGS_clients = 1;
+    }
     if(FLAGS_addr.empty()) FLAGS_addr=rdma::Config::RDMA_SERVER_ADDRESSES;
     if(FLAGS_port<=0) FLAGS_port=rdma::Config::RDMA_PORT;
     std::cout << "Config loaded" << std::endl;
 
+
+    // AGENT: executes the runs of a controller as separate processes
+    if(FLAGS_agent){
+        if(FLAGS_server || FLAGS_controller || FLAGS_loopback) throw runtime_error("An agent gets its role from the controller therefore  --server, --controller  and  --loopback  are not allowed");
+        std::vector<std::string> localArgs = { "--config=" + FLAGS_config, "--ownaddr=" + FLAGS_ownaddr, "--seqaddr=" + FLAGS_seqaddr, "--seqport=" + to_string(FLAGS_seqport), "--sequencer=false" };
+        if(FLAGS_numa >= 0) localArgs.push_back("--numa=" + to_string(FLAGS_numa));
+        std::string agentIpPort = FLAGS_ownaddr + ":" + to_string(FLAGS_agentport);
+        std::cout << "Starting agent " << agentIpPort << " and registering at NodeIDSequencer " << FLAGS_seqaddr << ":" << FLAGS_seqport << " ..." << std::endl;
+        rdma::PerfAgent *agent = new rdma::PerfAgent(agentIpPort, FLAGS_seqaddr + ":" + to_string(FLAGS_seqport), localArgs);
+        std::cout << "Waiting for runs of the controller ..." << std::endl;
+        while(!agent->isStopped()) usleep(rdma::Config::RDMA_SLEEP_INTERVAL);
+        delete agent;
+        delete config;
+        return 0;
+    }
+
     if(FLAGS_fulltest || FLAGS_halftest || FLAGS_quicktest){
         FLAGS_csv = true;
         if(FLAGS_test.empty()) FLAGS_test = "write_bw,write_lat,write_ops,read_bw,read_lat,read_ops,send_bw,send_lat,send_ops,fetch_bw,fetch_lat,fetch_ops,swap_bw,swap_lat,swap_ops";
@@ -272,6 +444,12 @@ int main(int argc, char *argv[]){
     if(FLAGS_threads.empty()) FLAGS_threads = "1";
     if(FLAGS_iterations.empty()) FLAGS_iterations = "500000";
     if(FLAGS_transfersize.empty()) FLAGS_transfersize = "24GB";
+    if(FLAGS_rate.empty()) FLAGS_rate = "100000";
+    if(FLAGS_prefetch.empty()) FLAGS_prefetch = "16";
+    if(FLAGS_responsesize.empty()) FLAGS_responsesize = "0";
+    if(FLAGS_outstanding.empty()) FLAGS_outstanding = "1";
+    if(FLAGS_keys.empty()) FLAGS_keys = "1000000";
+    if(FLAGS_qps.empty()) FLAGS_qps = "1,10,100,1000,10000";
 
     // Checking if default packet sizes are requested
     std::string packetSizeStr = FLAGS_packetsize;
@@ -300,6 +478,14 @@ int main(int argc, char *argv[]){
     int64_t maxtransfersize = rdma::StringHelper::parseByteSize(FLAGS_maxtransfersize);
     std::vector<uint64_t> transfersizes = parseByteSizesList(FLAGS_transfersize);
     std::vector<std::string> writeModeNames = rdma::StringHelper::split(FLAGS_writemode);
+    std::vector<uint64_t> rates = parseUInt64List(FLAGS_rate);
+    std::vector<uint64_t> prefetches = parseUInt64List(FLAGS_prefetch);
+    uint64_t scansize = rdma::StringHelper::parseByteSize(FLAGS_scansize);
+    std::vector<uint64_t> responsesizes = parseByteSizesList(FLAGS_responsesize);
+    std::vector<uint64_t> outstandings = parseUInt64List(FLAGS_outstanding);
+    std::vector<uint64_t> key_counts = parseUInt64List(FLAGS_keys);
+    std::vector<uint64_t> qp_counts = parseUInt64List(FLAGS_qps);
+    std::vector<std::string> distributionNames = rdma::StringHelper::split(FLAGS_distribution);
     std::vector<std::string> addresses = rdma::StringHelper::split(FLAGS_addr);
 	for (auto &addr : addresses){
         bool hasPort = (addr.find(":") != std::string::npos);
@@ -312,6 +498,8 @@ int main(int argc, char *argv[]){
     if(FLAGS_server && addresses.size()!= 1){
         throw runtime_error("As server the -addr flag is only allowed to contain just a single value");
     }
+    std::string mcastAddress = FLAGS_mcastaddr;
+    if(mcastAddress.empty() && addresses.size() > 0) mcastAddress = rdma::Network::getAddressOfConnection(addresses[0]);
 
     // check thread counts and if server then multiply by amount of clients
     for(int &tc : thread_counts){
@@ -330,6 +518,62 @@ int main(int argc, char *argv[]){
         }
     }
 
+    // check prefetch depths
+    for(uint64_t &prefetch : prefetches){
+        if(prefetch < 1 || prefetch > rdma::Config::RDMA_MAX_WR) throw runtime_error("Prefetch must be between 1 and Config::RDMA_MAX_WR");
+    }
+
+    // check outstanding RPC requests
+    for(uint64_t &outstanding : outstandings){
+        if(outstanding < 1 || outstanding > rdma::Config::RDMA_MAX_WR) throw runtime_error("Outstanding requests must be between 1 and Config::RDMA_MAX_WR");
+    }
+
+    // check open-loop rates
+    for(uint64_t &rate : rates){
+        if(rate < 1) throw runtime_error("Rate cannot be smaller than 1");
+    }
+
+    // Parse arrival mode
+    std::string arrivalName = FLAGS_arrival;
+    std::transform(arrivalName.begin(), arrivalName.end(), arrivalName.begin(), ::tolower);
+    rdma::ArrivalMode arrival = rdma::ARRIVAL_POISSON;
+    if(std::string("constant").rfind(arrivalName, 0) == 0 || std::string("fixed").rfind(arrivalName, 0) == 0){
+        arrival = rdma::ARRIVAL_CONSTANT;
+    } else if(std::string("poisson").rfind(arrivalName, 0) != 0 && std::string("exponential").rfind(arrivalName, 0) != 0){
+        throw runtime_error("No arrival mode with name '" + FLAGS_arrival + "' found");
+    }
+
+    // Parse workload mix and key distributions
+    std::vector<uint32_t> mix = rdma::WorkloadPerfTest::parseMix(FLAGS_mix);
+    std::vector<rdma::WorkloadKeys> distributions;
+    for(std::string distributionName : distributionNames){
+        std::transform(distributionName.begin(), distributionName.end(), distributionName.begin(), ::tolower);
+        rdma::WorkloadKeys keys;
+        keys.theta = FLAGS_zipftheta;
+        keys.hotSet = FLAGS_hotset;
+        keys.hotOps = FLAGS_hotops;
+        if(std::string("uniform").rfind(distributionName, 0) == 0){
+            keys.distribution = rdma::DISTRIBUTION_UNIFORM;
+        } else if(std::string("zipfian").rfind(distributionName, 0) == 0){
+            keys.distribution = rdma::DISTRIBUTION_ZIPFIAN;
+        } else if(std::string("hotspot").rfind(distributionName, 0) == 0){
+            keys.distribution = rdma::DISTRIBUTION_HOTSPOT;
+        } else {
+            throw runtime_error("No key distribution with name '" + distributionName + "' found");
+        }
+        distributions.push_back(keys);
+    }
+    for(uint64_t &keys : key_counts){
+        if(keys < 1) throw runtime_error("Keys cannot be smaller than 1");
+    }
+
+    // check QP counts (every thread needs at least one QP)
+    for(uint64_t &qps : qp_counts){
+        for(int &tc : thread_counts){
+            if(qps < (uint64_t)tc) throw runtime_error("QPs cannot be smaller than the thread count");
+        }
+    }
+
     // check CSV file
     std::string csvFileName = FLAGS_csvfile;
     if(FLAGS_csv && csvFileName.empty()){
@@ -346,6 +590,13 @@ int main(int argc, char *argv[]){
         csvFileName = oss.str();
     }
 
+    // check JSON report and baseline
+    if(FLAGS_repetitions < 1) throw runtime_error("Repetitions cannot be smaller than 1");
+    if(FLAGS_confidence != 90 && FLAGS_confidence != 95 && FLAGS_confidence != 99) throw runtime_error("Confidence level must be 90, 95 or 99");
+    std::vector<rdma::PerfReport::Result> baseline;
+    if(!FLAGS_compare.empty()) baseline = rdma::PerfReport::readJSON(FLAGS_compare); // fail before running any test
+    if(!FLAGS_json.empty() || !FLAGS_compare.empty()) report = new rdma::PerfReport(commandLine.str(), FLAGS_confidence / 100.0);
+
     // check CUDA support
     #ifndef CUDA_ENABLED /* defined in CMakeLists.txt to globally enable/disable CUDA support */
 		local_memtypes.clear(); local_memtypes.push_back(-3);
@@ -422,10 +673,61 @@ int main(int argc, char *argv[]){
             test_ops = (testOperations.find(test) != testOperations.end() ? testOperations[test] : 0);
             if(test_ops == 0){ count *= iteration_counts.size(); }
             parse_op = false;
+        } else if(std::string("scan").find(testName) == 0){
+            test = SCAN_TEST;
+            count = local_memtypes.size() * thread_counts.size() * packetsizes.size() * prefetches.size(); // no buffer slots
+            if(testOperations.find(test) != testOperations.end()){ count = 0; }
+            test_ops = (int)rdma::READ_OPERATION;
+            parse_op = false;
+        } else if(std::string("rpc").find(testName) == 0){
+            test = RPC_TEST;
+            count = thread_counts.size() * iteration_counts.size() * packetsizes.size() * responsesizes.size() * outstandings.size(); // main memory only, no buffer slots
+            if(testOperations.find(test) != testOperations.end()){ count = 0; }
+            test_ops = (int)rdma::SEND_RECEIVE_OPERATION;
+            parse_op = false;
+        } else if(testName.rfind("ud", 0) == 0 || testName.rfind("mcast", 0) == 0 || testName.rfind("multicast", 0) == 0){
+            // udbandwidth, udlatency for both operations OR granular ud_bw, ud_lat, mcast_bw, mcast_lat
+            if(testName.find("lat") != std::string::npos){
+                test = UD_LATENCY_TEST;
+            } else if(testName.find("b") != std::string::npos){
+                test = UD_BANDWIDTH_TEST;
+            } else {
+                std::cerr << "Unknown test '" << testName << "'" << std::endl;
+                continue;
+            }
+            test_ops = (testOperations.find(test) != testOperations.end() ? testOperations[test] : 0);
+            count = (test_ops != 0 ? 0 : thread_counts.size() * (test==UD_LATENCY_TEST ? iteration_counts.size() : transfersizes.size()) * packetsizes.size()); // main memory only, no buffer slots
+            if(testName.rfind("ud", 0) != 0){
+                test_ops = (test_ops | (int)rdma::MULTICAST_OPERATION);
+            } else if(testName.find("_") != std::string::npos){
+                test_ops = (test_ops | (int)rdma::SEND_RECEIVE_OPERATION);
+            } else {
+                test_ops = (test_ops | (int)rdma::SEND_RECEIVE_OPERATION | (int)rdma::MULTICAST_OPERATION);
+            }
+            parse_op = false;
+        } else if(std::string("workload").find(testName) == 0 || std::string("ycsb").find(testName) == 0){
+            test = WORKLOAD_TEST;
+            count = local_memtypes.size() * thread_counts.size() * distributions.size() * key_counts.size() * iteration_counts.size() * packetsizes.size(); // no buffer slots
+            if(testOperations.find(test) != testOperations.end()){ count = 0; }
+            test_ops = 0; // operations are given by the mix
+            parse_op = false;
+        } else if(std::string("qpscale").find(testName) == 0 || std::string("qps").find(testName) == 0 || std::string("connections").find(testName) == 0){
+            test = QP_SCALABILITY_TEST;
+            count = local_memtypes.size() * thread_counts.size() * qp_counts.size() * iteration_counts.size() * packetsizes.size(); // no buffer slots
+            if(testOperations.find(test) != testOperations.end()){ count = 0; }
+            test_ops = (int)rdma::WRITE_OPERATION | (int)rdma::READ_OPERATION;
+            parse_op = false;
+        } else if(std::string("openloop").find(testName) == 0){
+            test = OPEN_LOOP_TEST;
+            test_ops = (testOperations.find(test) != testOperations.end() ? testOperations[test] : 0);
+            if(test_ops == 0){ count *= iteration_counts.size() * packetsizes.size() * rates.size(); }
+            parse_op = false;
 
         } else { 
 
-            if(testName.rfind("bw") != std::string::npos){
+            if(testName.rfind("_ol") != std::string::npos){
+                test = OPEN_LOOP_TEST;
+            } else if(testName.rfind("bw") != std::string::npos){
                 test = BANDWIDTH_TEST;
             } else if(testName.rfind("lat") != std::string::npos){
                 test = LATENCY_TEST;
@@ -441,29 +743,37 @@ int main(int argc, char *argv[]){
         // Parse test operations
         if(parse_op){
             if(testName.find("wri") != std::string::npos){
-                if(test_ops == 0){ count *= (test!=LATENCY_TEST ? transfersizes.size() : iteration_counts.size()) * packetsizes.size() * write_modes.size(); }
+                if(test_ops == 0){ count *= (test==OPEN_LOOP_TEST ? iteration_counts.size() * rates.size() : (test!=LATENCY_TEST ? transfersizes.size() : iteration_counts.size()) * write_modes.size()) * packetsizes.size(); }
                 test_ops = (test_ops | (int)rdma::WRITE_OPERATION);
             } else if(testName.find("rea") != std::string::npos){
-                if(test_ops == 0){ count *= (test!=LATENCY_TEST ? transfersizes.size() : iteration_counts.size()) * packetsizes.size() * write_modes.size(); }
+                if(test_ops == 0){ count *= (test==OPEN_LOOP_TEST ? iteration_counts.size() * rates.size() : (test!=LATENCY_TEST ? transfersizes.size() : iteration_counts.size()) * write_modes.size()) * packetsizes.size(); }
                 test_ops = (test_ops | (int)rdma::READ_OPERATION);
             } else if(testName.find("sen") != std::string::npos || testName.find("rec") != std::string::npos){
-                if(test_ops == 0){ count *= (test!=LATENCY_TEST ? transfersizes.size() : iteration_counts.size()) * packetsizes.size() * write_modes.size(); }
+                if(test_ops == 0){ count *= (test==OPEN_LOOP_TEST ? iteration_counts.size() * rates.size() : (test!=LATENCY_TEST ? transfersizes.size() : iteration_counts.size()) * write_modes.size()) * packetsizes.size(); }
                 test_ops = (test_ops | (int)rdma::SEND_RECEIVE_OPERATION);
             } else if(testName.find("fet") != std::string::npos || testName.find("add") != std::string::npos){
-                test = (test==BANDWIDTH_TEST?ATOMICS_BANDWIDTH_TEST:(test==LATENCY_TEST?ATOMICS_LATENCY_TEST:ATOMICS_OPERATIONS_COUNT_TEST));
-                test_ops = (testOperations.find(test) != testOperations.end() ? testOperations[test] : 0);
-                if(test_ops == 0){ count *= iteration_counts.size(); }
+                if(test == OPEN_LOOP_TEST){
+                    if(test_ops == 0){ count *= iteration_counts.size() * rates.size() * packetsizes.size(); }
+                } else {
+                    test = (test==BANDWIDTH_TEST?ATOMICS_BANDWIDTH_TEST:(test==LATENCY_TEST?ATOMICS_LATENCY_TEST:ATOMICS_OPERATIONS_COUNT_TEST));
+                    test_ops = (testOperations.find(test) != testOperations.end() ? testOperations[test] : 0);
+                    if(test_ops == 0){ count *= iteration_counts.size(); }
+                }
                 test_ops = (test_ops | (int)rdma::FETCH_ADD_OPERATION);
             } else if(testName.find("com") != std::string::npos || testName.find("swa") != std::string::npos){
-                test = (test==BANDWIDTH_TEST?ATOMICS_BANDWIDTH_TEST:(test==LATENCY_TEST?ATOMICS_LATENCY_TEST:ATOMICS_OPERATIONS_COUNT_TEST));
-                test_ops = (testOperations.find(test) != testOperations.end() ? testOperations[test] : 0);
-                if(test_ops == 0){ count *= iteration_counts.size(); }
+                if(test == OPEN_LOOP_TEST){
+                    if(test_ops == 0){ count *= iteration_counts.size() * rates.size() * packetsizes.size(); }
+                } else {
+                    test = (test==BANDWIDTH_TEST?ATOMICS_BANDWIDTH_TEST:(test==LATENCY_TEST?ATOMICS_LATENCY_TEST:ATOMICS_OPERATIONS_COUNT_TEST));
+                    test_ops = (testOperations.find(test) != testOperations.end() ? testOperations[test] : 0);
+                    if(test_ops == 0){ count *= iteration_counts.size(); }
+                }
                 test_ops = (test_ops | (int)rdma::COMPARE_SWAP_OPERATION);
             } else {
                 std::cerr << "Could not detect RDMA operation from '" << testName << "'" << std::endl;
                 continue;
             }
-        } else {
+        } else if(test != SCAN_TEST && test != RPC_TEST && test != UD_BANDWIDTH_TEST && test != UD_LATENCY_TEST && test != WORKLOAD_TEST && test != QP_SCALABILITY_TEST){
             test_ops = (int)rdma::WRITE_OPERATION | (int)rdma::READ_OPERATION | (int)rdma::SEND_RECEIVE_OPERATION |
                         (int)rdma::FETCH_ADD_OPERATION | (int)rdma::COMPARE_SWAP_OPERATION;  // all operations
         }
@@ -475,11 +785,161 @@ int main(int argc, char *argv[]){
 
         testIterations += count;
     }
+    testIterations *= FLAGS_repetitions;
+
+
+    // CONTROLLER: executes the tests on the agents instead of itself
+    if(FLAGS_controller){
+        if(FLAGS_server || FLAGS_loopback) throw runtime_error("Controller assigns the roles to the agents therefore  --server  and  --loopback  are not allowed");
+        if(FLAGS_servers < 1 || FLAGS_servers >= FLAGS_agents) throw runtime_error("Controller needs at least one server and one client agent");
+        if(FLAGS_sequencer && isLocalAddress(FLAGS_seqaddr)){
+            std::cout << "Starting NodeIDSequencer on port " << FLAGS_seqport << std::endl;
+            new rdma::NodeIDSequencer(FLAGS_seqport, "*");
+        }
+
+        // test flags as they are after applying the defaults
+        std::vector<std::pair<std::string, std::string>> testFlags;
+        for(const std::string &name : rdma::PerfController::TEST_FLAGS){
+            std::string value;
+            if(!gflags::GetCommandLineOption(name.c_str(), &value)) throw runtime_error("Unknown test flag '" + name + "'");
+            testFlags.emplace_back(name, value);
+        }
+        std::vector<std::string> matrix;
+        for(std::string name : rdma::StringHelper::split(FLAGS_matrix)){
+            name = rdma::StringHelper::trim(name);
+            if(!name.empty()) matrix.push_back(name);
+        }
+        auto combinations = rdma::PerfController::expandMatrix(testFlags, matrix);
+
+        // memory types are given from the client's perspective
+        std::string serverMemtypes = FLAGS_remote_memtype;
+        if(serverMemtypes.empty()){
+            for(size_t i = 0; i < rdma::StringHelper::split(FLAGS_memtype).size(); i++) serverMemtypes += (i == 0 ? "-3" : ",-3");
+        }
+
+        rdma::PerfController controller(FLAGS_seqaddr + ":" + to_string(FLAGS_seqport));
+        std::cout << "Waiting for " << FLAGS_agents << " agents to register ..." << std::endl;
+        std::vector<std::string> agents = controller.waitForAgents(FLAGS_agents, FLAGS_agenttimeout);
+        std::string serverAddresses = "";
+        for(int i = 0; i < FLAGS_agents; i++){
+            std::cout << "  " << (i < FLAGS_servers ? "Server" : "Client") << " agent " << agents[i] << std::endl;
+            if(i < FLAGS_servers) serverAddresses += (i == 0 ? "" : ",") + rdma::Network::getAddressOfConnection(agents[i]) + ":" + to_string(FLAGS_port);
+        }
+
+        int exitCode = 0;
+        auto totalStart = rdma::PerfTest::startTimer();
+        for(size_t c = 0; c < combinations.size(); c++){
+            std::vector<std::string> args;
+            for(auto &flag : combinations[c]) args.push_back("--" + flag.first + "=" + flag.second);
+            args.push_back("--clients=" + to_string(FLAGS_agents - FLAGS_servers));
+
+            std::ostringstream title;
+            for(auto &flag : combinations[c]){
+                if(std::find(matrix.begin(), matrix.end(), flag.first) != matrix.end()) title << (title.tellp() > 0 ? ", " : "") << flag.first << "=" << flag.second;
+            }
+            std::cout << std::endl << "RUN " << (c+1) << " / " << combinations.size() << " (" << title.str() << ")" << std::endl;
+
+            std::vector<rdma::PerfController::AgentRun> runs(agents.size());
+            for(size_t i = 0; i < agents.size(); i++){
+                rdma::PerfController::AgentRun &run = runs[i];
+                run.agent = agents[i];
+                run.server = ((int)i < FLAGS_servers);
+                run.args = args;
+                if(run.server){
+                    run.args.push_back("--server");
+                    run.args.push_back("--addr=" + rdma::Network::getAddressOfConnection(agents[i]) + ":" + to_string(FLAGS_port));
+                    run.args.push_back("--memtype=" + serverMemtypes);
+                    run.args.push_back("--remote_memtype=" + FLAGS_memtype);
+                } else {
+                    run.args.push_back("--addr=" + serverAddresses);
+                    run.args.push_back("--memtype=" + FLAGS_memtype);
+                    run.args.push_back("--remote_memtype=" + FLAGS_remote_memtype);
+                }
+            }
+            controller.run(runs, FLAGS_runtimeout);
+
+            bool failed = false;
+            for(rdma::PerfController::AgentRun &run : runs){
+                if(run.exitCode != 0) failed = true;
+                if(!run.server || run.exitCode != 0){
+                    std::cout << "OUTPUT OF " << (run.server ? "SERVER" : "CLIENT") << " AGENT " << run.agent << " (exit code " << run.exitCode << "):" << std::endl << run.output << std::endl;
+                }
+                if(!csvFileName.empty() && !run.csv.empty()) appendAgentCSV(run.csv, csvFileName, run.agent);
+                if(report != nullptr && !run.report.empty()){
+                    try {
+                        std::map<std::string, std::string> environment;
+                        report->addResults(rdma::PerfReport::parseJSON(run.report, &environment), run.agent);
+                        report->addNode(run.agent, environment);
+                    } catch (const std::runtime_error &ex){
+                        std::cerr << "Could not read report of agent " << run.agent << ": " << ex.what() << std::endl;
+                        failed = true;
+                    }
+                }
+            }
+            if(failed){
+                exitCode = 1;
+                std::cerr << "ERROR OCCURRED WHILE EXECUTING RUN " << (c+1) << " (" << title.str() << ")" << (FLAGS_ignoreerrors ? " --> JUMP TO NEXT RUN" : "") << std::endl;
+                if(!FLAGS_ignoreerrors) break;
+            }
+        }
+        controller.stopAgents(agents);
+
+        int64_t totalDuration = rdma::PerfTest::stopTimer(totalStart);
+        std::cout << std::endl << "TOTAL EXECUTION TIME " << rdma::PerfTest::convertTime(totalDuration) << std::endl;
+        if(finishReport(baseline) != 0) exitCode = 1;
+        delete config;
+        return exitCode;
+    }
+
+
+    // LOOPBACK: server side runs in a child process that executes the same tests
+    pid_t loopbackServerPid = 0;
+    int readyFd = FLAGS_readyfd; // write end of the pipe the server side signals its readiness through (loopback or agent)
+    if(FLAGS_loopback){
+        std::cout << "Starting server side for loopback ..." << std::endl;
+        int readyPipe[2];
+        if(pipe(readyPipe) != 0) throw runtime_error("Could not create pipe for server side of loopback");
+        loopbackServerPid = fork();
+        if(loopbackServerPid < 0) throw runtime_error("Could not fork server side for loopback");
+        if(loopbackServerPid == 0){
+            prctl(PR_SET_PDEATHSIG, SIGTERM); // don't outlive the client side
+            close(readyPipe[0]);
+            readyFd = readyPipe[1];
+            FLAGS_server = true;
+            if(report != nullptr){ delete report; report = nullptr; } // results are only reported by the client side
+            FLAGS_json = ""; FLAGS_compare = ""; csvFileName = "";
+
+            // memory types are given from the client's perspective
+            std::vector<int> server_memtypes, client_memtypes;
+            for(size_t gpui = 0; gpui < local_memtypes.size(); gpui++){
+                int remote_gpu_index = remote_memtypes[gpui % remote_memtypes.size()];
+                server_memtypes.push_back(remote_gpu_index == -404 ? (int)rdma::MEMORY_TYPE::MAIN : remote_gpu_index);
+                client_memtypes.push_back(local_memtypes[gpui]);
+            }
+            local_memtypes = server_memtypes;
+            remote_memtypes = client_memtypes;
+
+            int fd = open(FLAGS_loopbacklog.empty() ? "/dev/null" : FLAGS_loopbacklog.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0) throw runtime_error("Could not open loopback log file '" + FLAGS_loopbacklog + "'");
+            dup2(fd, STDOUT_FILENO);
+            close(fd);
+        } else {
+            signal(SIGCHLD, onLoopbackServerExit);
+            close(readyPipe[1]);
+            // wait until server side started the sequencer and server, EOF if it ended before
+            char ready = 0;
+            ssize_t received;
+            while((received = read(readyPipe[0], &ready, 1)) < 0 && errno == EINTR){}
+            close(readyPipe[0]);
+            if(received != 1) throw runtime_error("Server side of loopback ended before it was ready");
+        }
+    }
+    pinThreads(parseIntList(FLAGS_server ? FLAGS_servercores : FLAGS_clientcores));
 
 
     // start NodeIDSequencer
-    if(FLAGS_server){
-        if(FLAGS_seqaddr=="*" || FLAGS_seqaddr=="localhost" || FLAGS_seqaddr=="127.0.0.1" || FLAGS_seqaddr == rdma::Network::getOwnAddress()){
+    if(FLAGS_server && FLAGS_sequencer){
+        if(FLAGS_loopback || isLocalAddress(FLAGS_seqaddr)){
             std::cout << "Starting NodeIDSequencer on port " << FLAGS_seqport << std::endl;
             new rdma::NodeIDSequencer(FLAGS_seqport, "*");
         }
@@ -491,7 +951,7 @@ int main(int argc, char *argv[]){
     // INTIAL SYNC
     if(FLAGS_server){
         std::cout << "Waiting for " << FLAGS_clients << " clients to connect..." << std::endl;
-        initialSyncAsServer(ownIpPort, sequencerIpAddr, FLAGS_clients);
+        initialSyncAsServer(ownIpPort, sequencerIpAddr, FLAGS_clients, readyFd);
         std::cout << "All clients are connected!" << std::endl;
     } else {
         std::cout << "Waiting for all clients to connect" << std::endl;
@@ -502,125 +962,273 @@ int main(int argc, char *argv[]){
 
     // EXECUTE TESTS
     auto totalStart = rdma::PerfTest::startTimer();
-    for(TEST &t : tests){
-        int test_ops = testOperations[t];
-        for(size_t gpui = 0; gpui < local_memtypes.size(); gpui++){
-            const int local_gpu_index = local_memtypes[gpui];
-            const int remote_gpu_index = remote_memtypes[gpui % remote_memtypes.size()];
-
-            for(int &thread_count : thread_counts){
-                for(int &buffer_slots : bufferslots){
-                    bool csvAddHeader = true;
-                    
-                    for(uint64_t &transfersize : transfersizes){
-                        rdma::PerfTest *test = nullptr;
-                        std::string testName;
+    for(int repetition = 1; repetition <= FLAGS_repetitions; repetition++){
+        if(FLAGS_repetitions > 1) std::cout << std::endl << "REPETITION " << repetition << " / " << FLAGS_repetitions << std::endl;
+        for(TEST &t : tests){
+            int test_ops = testOperations[t];
+            for(size_t gpui = 0; gpui < local_memtypes.size(); gpui++){
+                const int local_gpu_index = local_memtypes[gpui];
+                const int remote_gpu_index = remote_memtypes[gpui % remote_memtypes.size()];
+
+                for(int &thread_count : thread_counts){
+                    if(t == RPC_TEST){
+                        if(gpui > 0) continue; // requests and responses are always in main memory
+                        for(uint64_t &outstanding : outstandings){
+                            for(uint64_t &iterations : iteration_counts){
+                                uint64_t iterations_per_thread = iterations / thread_count;
+                                if(iterations_per_thread==0) iterations_per_thread = 1;
+                                bool csvAddHeader = true;
+                                for(uint64_t &responsesize : responsesizes){
+                                    for(uint64_t &packet_size : packetsizes){
+                                        // RPC Test (request size given by packet size)
+                                        std::string testName = "RPC";
+                                        rdma::PerfTest *test = new rdma::RPCPerfTest(FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, FLAGS_clients, thread_count, packet_size, (responsesize==0 ? packet_size : responsesize), outstanding, iterations_per_thread);
+                                        testCounter++;
+                                        runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                        csvAddHeader = false;
+                                    }
+                                }
+                            }
+                        }
+                        continue;
+                    }
 
-                        for(rdma::WriteMode &write_mode : write_modes){
-                            csvAddHeader = true;
+                    if(t == UD_BANDWIDTH_TEST || t == UD_LATENCY_TEST){
+                        if(gpui > 0) continue; // messages are always in main memory
+                        const bool bandwidth = (t == UD_BANDWIDTH_TEST);
+                        for(uint64_t &size : (bandwidth ? transfersizes : iteration_counts)){
+                            bool csvAddHeader = true;
                             for(uint64_t &packet_size : packetsizes){
-                                test = nullptr;
-                                uint64_t iterations_per_thread = (uint64_t)((long double)transfersize / (long double)packet_size + 0.5);
-                                if(FLAGS_maxiterations > 0 && iterations_per_thread > (uint64_t)FLAGS_maxiterations) iterations_per_thread = FLAGS_maxiterations;
-                                iterations_per_thread = (uint64_t)((long double)iterations_per_thread / (long double)thread_count + 0.5);
+                                if(rdma::UnreliablePerfTest::messageSize(packet_size) > rdma::Config::RDMA_UD_MTU){
+                                    std::cerr << "UD messages cannot be bigger than Config::RDMA_UD_MTU=" << rdma::Config::RDMA_UD_MTU << " therefore packet size " << packet_size << " will be skipped" << std::endl;
+                                    testCounter++; csvAddHeader = true; continue;
+                                }
+                                uint64_t iterations_per_thread = size;
+                                if(bandwidth){
+                                    iterations_per_thread = (uint64_t)((long double)size / (long double)packet_size + 0.5);
+                                    if(FLAGS_maxiterations > 0 && iterations_per_thread > (uint64_t)FLAGS_maxiterations) iterations_per_thread = FLAGS_maxiterations;
+                                    iterations_per_thread = (uint64_t)((long double)iterations_per_thread / (long double)thread_count + 0.5);
+                                } else {
+                                    iterations_per_thread = size / thread_count;
+                                }
                                 if(iterations_per_thread==0) iterations_per_thread = 1;
 
-                                if(t == BANDWIDTH_TEST){
-                                    if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
-                                        testCounter++; csvAddHeader = true; continue;
-                                    }
-                                    // Bandwidth Test
-                                    testName = "Bandwidth";
-                                    test = new rdma::BandwidthPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, buffer_slots, iterations_per_thread, write_mode);
+                                // UD Bandwidth/Latency Test (unicast send/receive and multicast)
+                                std::string testName = (bandwidth ? "UD Bandwidth" : "UD Latency");
+                                rdma::PerfTest *test = new rdma::UnreliablePerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, mcastAddress, FLAGS_clients, thread_count, packet_size, iterations_per_thread, (bandwidth ? rdma::UD_BANDWIDTH_MODE : rdma::UD_LATENCY_MODE));
+                                testCounter++;
+                                runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                csvAddHeader = false;
+                            }
+                        }
+                        continue;
+                    }
 
-                                } else if(t == OPERATIONS_COUNT_TEST){
+                    if(t == QP_SCALABILITY_TEST){
+                        for(uint64_t &qps : qp_counts){
+                            for(uint64_t &iterations : iteration_counts){
+                                uint64_t iterations_per_thread = iterations / thread_count;
+                                if(iterations_per_thread==0) iterations_per_thread = 1;
+                                bool csvAddHeader = true;
+                                for(uint64_t &packet_size : packetsizes){
                                     if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
                                         testCounter++; csvAddHeader = true; continue;
                                     }
-                                    // Operations Count Test
-                                    testName = "Operations Count";
-                                    test = new rdma::OperationsCountPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, buffer_slots, iterations_per_thread, write_mode);
-                                }
-
-                                if(test != nullptr){
+                                    // QP Scalability Test
+                                    std::string testName = "QP Scalability";
+                                    rdma::PerfTest *test = new rdma::QPScalabilityPerfTest(FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, qps, iterations_per_thread);
                                     testCounter++;
                                     runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
                                     csvAddHeader = false;
                                 }
                             }
                         }
+                        continue;
                     }
 
-                    csvAddHeader = true;
-                    for(uint64_t &iterations : iteration_counts){
-                        rdma::PerfTest *test = nullptr;
-                        std::string testName;
-
-                        uint64_t iterations_per_thread = iterations / thread_count;
-                        if(iterations_per_thread==0) iterations_per_thread = 1;
-                        
-                        if(t == ATOMICS_BANDWIDTH_TEST){
-                            // Atomics Bandwidth Test
-                            testName = "Atomics Bandwidth";
-                            test = new rdma::AtomicsBandwidthPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, buffer_slots, iterations_per_thread);
-
-                        } else if(t == ATOMICS_LATENCY_TEST){
-                            // Atomics Latency Test
-                            testName = "Atomics Latency";
-                            test = new rdma::AtomicsLatencyPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, buffer_slots, iterations_per_thread);
-
-                        } else if(t == ATOMICS_OPERATIONS_COUNT_TEST){
-                            // Atomics Operations Count Test
-                            testName = "Atomics Operations Count";
-                            test = new rdma::AtomicsOperationsCountPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, buffer_slots, iterations_per_thread);
+                    if(t == WORKLOAD_TEST){
+                        for(rdma::WorkloadKeys &distribution : distributions){
+                            for(uint64_t &keys : key_counts){
+                                for(uint64_t &iterations : iteration_counts){
+                                    uint64_t iterations_per_thread = iterations / thread_count;
+                                    if(iterations_per_thread==0) iterations_per_thread = 1;
+                                    bool csvAddHeader = true;
+                                    for(uint64_t &packet_size : packetsizes){
+                                        if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
+                                            testCounter++; csvAddHeader = true; continue;
+                                        }
+                                        // Workload Test (object size given by packet size)
+                                        std::string testName = "Workload";
+                                        rdma::WorkloadKeys workloadKeys = distribution;
+                                        workloadKeys.keys = keys;
+                                        rdma::PerfTest *test = new rdma::WorkloadPerfTest(FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, workloadKeys, mix, iterations_per_thread);
+                                        testCounter++;
+                                        runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                        csvAddHeader = false;
+                                    }
+                                }
+                            }
                         }
+                        continue;
+                    }
 
-                        if(test != nullptr){
-                            testCounter++;
-                            runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
-                            csvAddHeader = false;
-                            continue;
+                    if(t == SCAN_TEST){
+                        for(uint64_t &prefetch : prefetches){
+                            bool csvAddHeader = true;
+                            for(uint64_t &packet_size : packetsizes){
+                                if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
+                                    testCounter++; csvAddHeader = true; continue;
+                                }
+                                // Scan Test (page size given by packet size)
+                                std::string testName = "Scan";
+                                rdma::PerfTest *test = new rdma::ScanPerfTest(FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, scansize, prefetch);
+                                testCounter++;
+                                runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                csvAddHeader = false;
+                            }
                         }
+                        continue;
+                    }
 
-                        for(rdma::WriteMode &write_mode : write_modes){
-                            csvAddHeader = true;
-                            for(uint64_t &packet_size : packetsizes){
-                                test = nullptr;
+                    for(int &buffer_slots : bufferslots){
+                        bool csvAddHeader = true;
+                    
+                        for(uint64_t &transfersize : transfersizes){
+                            rdma::PerfTest *test = nullptr;
+                            std::string testName;
+
+                            for(rdma::WriteMode &write_mode : write_modes){
+                                csvAddHeader = true;
+                                for(uint64_t &packet_size : packetsizes){
+                                    test = nullptr;
+                                    uint64_t iterations_per_thread = (uint64_t)((long double)transfersize / (long double)packet_size + 0.5);
+                                    if(FLAGS_maxiterations > 0 && iterations_per_thread > (uint64_t)FLAGS_maxiterations) iterations_per_thread = FLAGS_maxiterations;
+                                    iterations_per_thread = (uint64_t)((long double)iterations_per_thread / (long double)thread_count + 0.5);
+                                    if(iterations_per_thread==0) iterations_per_thread = 1;
+
+                                    if(t == BANDWIDTH_TEST){
+                                        if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
+                                            testCounter++; csvAddHeader = true; continue;
+                                        }
+                                        // Bandwidth Test
+                                        testName = "Bandwidth";
+                                        test = new rdma::BandwidthPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, buffer_slots, iterations_per_thread, write_mode);
+
+                                    } else if(t == OPERATIONS_COUNT_TEST){
+                                        if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
+                                            testCounter++; csvAddHeader = true; continue;
+                                        }
+                                        // Operations Count Test
+                                        testName = "Operations Count";
+                                        test = new rdma::OperationsCountPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, buffer_slots, iterations_per_thread, write_mode);
+                                    }
 
-                                if(maxtransfersize > 0){
-                                    uint64_t maxiters = (uint64_t)((long double)maxtransfersize / (long double)packet_size + 0.5);
-                                    if(iterations > maxiters){
-                                        iterations_per_thread = maxiters / thread_count;
-                                        if(iterations_per_thread==0) iterations_per_thread = 1;
+                                    if(test != nullptr){
+                                        testCounter++;
+                                        runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                        csvAddHeader = false;
                                     }
                                 }
+                            }
+                        }
+
+                        csvAddHeader = true;
+                        for(uint64_t &iterations : iteration_counts){
+                            rdma::PerfTest *test = nullptr;
+                            std::string testName;
 
-                                if(t == LATENCY_TEST){
+                            uint64_t iterations_per_thread = iterations / thread_count;
+                            if(iterations_per_thread==0) iterations_per_thread = 1;
+                        
+                            if(t == ATOMICS_BANDWIDTH_TEST){
+                                // Atomics Bandwidth Test
+                                testName = "Atomics Bandwidth";
+                                test = new rdma::AtomicsBandwidthPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, buffer_slots, iterations_per_thread);
+
+                            } else if(t == ATOMICS_LATENCY_TEST){
+                                // Atomics Latency Test
+                                testName = "Atomics Latency";
+                                test = new rdma::AtomicsLatencyPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, buffer_slots, iterations_per_thread);
+
+                            } else if(t == ATOMICS_OPERATIONS_COUNT_TEST){
+                                // Atomics Operations Count Test
+                                testName = "Atomics Operations Count";
+                                test = new rdma::AtomicsOperationsCountPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, buffer_slots, iterations_per_thread);
+                            }
+
+                            if(test != nullptr){
+                                testCounter++;
+                                runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                csvAddHeader = false;
+                                continue;
+                            }
+
+                            if(t == OPEN_LOOP_TEST){
+                                for(uint64_t &packet_size : packetsizes){
                                     if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
-                                        testCounter++; csvAddHeader = true; continue;
+                                        testCounter += rates.size(); continue;
+                                    }
+                                    // Open Loop Test (one CSV block per packet size with offered load as x-axis)
+                                    csvAddHeader = true;
+                                    for(uint64_t &rate : rates){
+                                        testName = "Open Loop";
+                                        test = new rdma::OpenLoopPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, buffer_slots, iterations_per_thread, rate, arrival);
+                                        testCounter++;
+                                        runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                        csvAddHeader = false;
                                     }
-                                    // Latency Test
-                                    testName = "Latency";
-                                    test = new rdma::LatencyPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, buffer_slots, iterations_per_thread, write_mode);
-
                                 }
+                                continue;
+                            }
 
-                                if(test != nullptr){
-                                    testCounter++;
-                                    runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
-                                    csvAddHeader = false;
+                            for(rdma::WriteMode &write_mode : write_modes){
+                                csvAddHeader = true;
+                                for(uint64_t &packet_size : packetsizes){
+                                    test = nullptr;
+
+                                    if(maxtransfersize > 0){
+                                        uint64_t maxiters = (uint64_t)((long double)maxtransfersize / (long double)packet_size + 0.5);
+                                        if(iterations > maxiters){
+                                            iterations_per_thread = maxiters / thread_count;
+                                            if(iterations_per_thread==0) iterations_per_thread = 1;
+                                        }
+                                    }
+
+                                    if(t == LATENCY_TEST){
+                                        if(checkInvalidTestParams(packet_size, local_gpu_index, remote_gpu_index)){
+                                            testCounter++; csvAddHeader = true; continue;
+                                        }
+                                        // Latency Test
+                                        testName = "Latency";
+                                        test = new rdma::LatencyPerfTest(test_ops, FLAGS_server, addresses, FLAGS_port, ownIpPort, sequencerIpAddr, local_gpu_index, remote_gpu_index, FLAGS_clients, thread_count, packet_size, buffer_slots, iterations_per_thread, write_mode);
+
+                                    }
+
+                                    if(test != nullptr){
+                                        testCounter++;
+                                        runTest(testCounter, testIterations, testName, test, csvFileName, csvAddHeader);
+                                        csvAddHeader = false;
+                                    }
                                 }
                             }
                         }
                     }
                 }
             }
+            ++testIt;
         }
-        ++testIt;
     }
 
     int64_t totalDuration = rdma::PerfTest::stopTimer(totalStart);
     std::cout << std::endl << "TOTAL EXECUTION TIME " << rdma::PerfTest::convertTime(totalDuration) << std::endl;
+
+    // JSON report and regressions
+    int exitCode = finishReport(baseline);
+
+    // wait until server side of loopback is done
+    if(loopbackServerPid > 0){
+        while(loopbackServerStatus < 0) usleep(rdma::Config::RDMA_SLEEP_INTERVAL);
+    }
     delete config;
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,426 @@
+#include "OpenLoopPerfTest.h"
+
+#include "../src/memory/BaseMemory.h"
+#include "../src/memory/MainMemory.h"
+#include "../src/memory/CudaMemory.h"
+#include "../src/utils/Config.h"
+
+mutex rdma::OpenLoopPerfTest::waitLock;
+condition_variable rdma::OpenLoopPerfTest::waitCv;
+bool rdma::OpenLoopPerfTest::signaled;
+rdma::TestOperation rdma::OpenLoopPerfTest::testOperation;
+size_t rdma::OpenLoopPerfTest::client_count;
+size_t rdma::OpenLoopPerfTest::thread_count;
+
+/*	LT: Local Thread, RT: Remote Thread, B: BufferSlot, C: Connection, R: Receive Packet Size, S: Send Packet Size
+ *
+ *	Client Memory:	LT1{ C1[ S(B1, B2, ...), R(B1, B2, ...) ], C2[ S(B1, B2, ...), R(B1, B2, ...) ], ... }, LT2{ ... }, ...
+ *	Server Memory:	LT1{ B1[ R ], B2[ R ], ... }, LT2{ ... }, ..., RT1{ B1[ S ], B2[ S ], ... }, RT2{ ... }, ...
+ *
+ *	Slots are at least ATOMICS_SIZE bytes big such that atomics fit into them.
+ *	The first four bytes of a message are zero except for the stop message.
+ */
+
+static size_t slotSize(size_t packet_size){
+	return (packet_size < (size_t)rdma::ATOMICS_SIZE ? (size_t)rdma::ATOMICS_SIZE : packet_size);
+}
+
+
+rdma::OpenLoopPerfClientThread::OpenLoopPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t packet_size, int buffer_slots, size_t iterations_per_thread, uint64_t rate, ArrivalMode arrival) {
+	this->m_client = new RDMAClient<ReliableRDMA>(memory, "OpenLoopPerfTestClient", ownIpPort, sequencerIpPort);
+	this->m_rdma_addresses = rdma_addresses;
+	this->m_packet_size = packet_size;
+	this->m_slot_size = slotSize(packet_size);
+	this->m_buffer_slots = buffer_slots;
+	this->m_remote_memory_size_per_thread = m_slot_size * buffer_slots;
+	this->m_memory_size_per_thread = m_remote_memory_size_per_thread * rdma_addresses.size() * 2; // *2 because send/recv separat
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_rate = rate;
+	this->m_arrival = arrival;
+	this->m_remOffsets = new size_t[m_rdma_addresses.size()];
+
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		NodeID nodeId = 0;
+		string conn = m_rdma_addresses[i];
+		if(!m_client->connect(conn, nodeId)) {
+			std::cerr << "OpenLoopPerfThread::OpenLoopPerfThread(): Could not connect to '" << conn << "'" << std::endl;
+			throw invalid_argument("OpenLoopPerfThread connection failed");
+		}
+		m_addr.push_back(nodeId);
+		m_client->remoteAlloc(conn, m_remote_memory_size_per_thread, m_remOffsets[i]);
+	}
+
+	m_local_memory = m_client->localMalloc(m_memory_size_per_thread);
+	m_local_memory->openContext();
+	m_local_memory->setMemory(0);
+}
+
+rdma::OpenLoopPerfClientThread::~OpenLoopPerfClientThread() {
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		string addr = m_rdma_addresses[i];
+		m_client->remoteFree(addr, m_remote_memory_size_per_thread, m_remOffsets[i]);
+	}
+	delete m_remOffsets;
+	delete m_local_memory; // implicitly deletes local allocs in RDMAClient
+	delete m_client;
+}
+
+void rdma::OpenLoopPerfClientThread::run() {
+	rdma::PerfTest::global_barrier_client(m_client, m_addr); // global barrier
+	unique_lock<mutex> lck(OpenLoopPerfTest::waitLock); // local barrier
+	if (!OpenLoopPerfTest::signaled) {
+		m_ready = true;
+		OpenLoopPerfTest::waitCv.wait(lck);
+	}
+	lck.unlock();
+	m_ready = false;
+
+	const TestOperation operation = OpenLoopPerfTest::testOperation;
+	size_t opIdx = 0;
+	while(OPEN_LOOP_OPERATIONS[opIdx] != operation){
+		if(++opIdx >= OPEN_LOOP_OPERATION_COUNT) throw invalid_argument("OpenLoopPerfClientThread unknown test mode");
+	}
+
+	if(operation == SEND_RECEIVE_OPERATION){
+		for(size_t connIdx=0; connIdx < m_addr.size(); connIdx++){
+			m_client->receive(m_addr[connIdx], m_local_memory->pointer((connIdx * 2 + 1) * m_remote_memory_size_per_thread), m_packet_size);
+		}
+	}
+
+	// intended send times are independent of completions, waiting for them is part of the latency
+	std::mt19937_64 generator(std::random_device{}());
+	std::exponential_distribution<double> exponential(1.0);
+	const double interarrivalNs = (double)NANO_SEC / m_rate;
+	double intendedNs = 0;
+	auto begin = rdma::PerfTest::startTimer();
+	for(size_t i = 0; i < m_iterations_per_thread; i++){
+		intendedNs += (m_arrival == ARRIVAL_POISSON ? exponential(generator) * interarrivalNs : interarrivalNs);
+		auto intended = begin + std::chrono::nanoseconds((int64_t)intendedNs);
+		while(std::chrono::high_resolution_clock::now() < intended){} // spinning because sleeping is too coarse
+		issue(operation, i);
+		m_histograms[opIdx].record(rdma::PerfTest::stopTimer(intended));
+	}
+	m_elapsedNs[opIdx] = rdma::PerfTest::stopTimer(begin);
+
+	// stop the echo server threads
+	if(operation == SEND_RECEIVE_OPERATION){
+		for(size_t connIdx=0; connIdx < m_addr.size(); connIdx++){
+			size_t sendOffset = connIdx * 2 * m_remote_memory_size_per_thread;
+			m_local_memory->set((uint32_t)1, sendOffset);
+			m_client->send(m_addr[connIdx], m_local_memory->pointer(sendOffset), m_packet_size, true); // true=signaled
+			m_client->pollReceive(m_addr[connIdx], true); // true=poll
+			m_local_memory->set((uint32_t)0, sendOffset);
+		}
+	}
+}
+
+void rdma::OpenLoopPerfClientThread::issue(TestOperation operation, size_t i){
+	const size_t connIdx = i % m_addr.size();
+	const size_t slot = (i / m_addr.size()) % m_buffer_slots;
+	const size_t sendOffset = connIdx * 2 * m_remote_memory_size_per_thread + slot * m_slot_size;
+	const size_t receiveOffset = sendOffset + m_remote_memory_size_per_thread;
+	const size_t remoteOffset = m_remOffsets[connIdx] + slot * m_slot_size;
+	switch(operation){
+		case WRITE_OPERATION:
+			m_client->write(m_addr[connIdx], remoteOffset, m_local_memory->pointer(sendOffset), m_packet_size, true); // true=signaled
+			break;
+		case READ_OPERATION:
+			m_client->read(m_addr[connIdx], remoteOffset, m_local_memory->pointer(receiveOffset), m_packet_size, true); // true=signaled
+			break;
+		case SEND_RECEIVE_OPERATION:
+			m_client->send(m_addr[connIdx], m_local_memory->pointer(sendOffset), m_packet_size, true); // true=signaled
+			m_client->pollReceive(m_addr[connIdx], true); // true=poll
+			m_client->receive(m_addr[connIdx], m_local_memory->pointer(receiveOffset), m_packet_size);
+			break;
+		case FETCH_ADD_OPERATION:
+			m_client->fetchAndAdd(m_addr[connIdx], remoteOffset, m_local_memory->pointer(receiveOffset), 2, rdma::ATOMICS_SIZE, true); // true=signaled
+			break;
+		case COMPARE_SWAP_OPERATION:
+			m_client->compareAndSwap(m_addr[connIdx], remoteOffset, m_local_memory->pointer(receiveOffset), i, i+1, rdma::ATOMICS_SIZE, true); // true=signaled
+			break;
+		default: throw invalid_argument("OpenLoopPerfClientThread unknown test mode");
+	}
+}
+
+
+
+rdma::OpenLoopPerfServerThread::OpenLoopPerfServerThread(RDMAServer<ReliableRDMA> *server, size_t packet_size, int buffer_slots) {
+	this->m_server = server;
+	this->m_packet_size = packet_size;
+	this->m_buffer_slots = buffer_slots;
+	this->m_local_memory = server->localMalloc(slotSize(packet_size) * buffer_slots);
+	this->m_local_memory->openContext();
+	this->m_local_memory->setMemory(0);
+}
+
+rdma::OpenLoopPerfServerThread::~OpenLoopPerfServerThread() {
+	delete m_local_memory;  // implicitly deletes local allocs in RDMAServer
+}
+
+void rdma::OpenLoopPerfServerThread::run() {
+	unique_lock<mutex> lck(OpenLoopPerfTest::waitLock);
+	if (!OpenLoopPerfTest::signaled) {
+		m_ready = true;
+		OpenLoopPerfTest::waitCv.wait(lck);
+	}
+	lck.unlock();
+	m_ready = false;
+
+	// one-sided operations don't need the server
+	if(OpenLoopPerfTest::testOperation != SEND_RECEIVE_OPERATION) return;
+
+	// echo every message until the stop message
+	m_server->receive(m_respond_conn_id, m_local_memory->pointer(), m_packet_size);
+	for(size_t i = 0; ; i++){
+		size_t offset = (i % m_buffer_slots) * m_packet_size;
+		size_t nextOffset = ((i + 1) % m_buffer_slots) * m_packet_size;
+		m_server->pollReceive(m_respond_conn_id, true); // true=poll
+		bool stop = (m_local_memory->getUInt32(offset) != 0);
+		if(!stop) m_server->receive(m_respond_conn_id, m_local_memory->pointer(nextOffset), m_packet_size);
+		m_server->send(m_respond_conn_id, m_local_memory->pointer(offset), m_packet_size, true); // true=signaled
+		if(stop) break;
+	}
+	m_local_memory->setMemory(0);
+}
+
+
+
+rdma::OpenLoopPerfTest::OpenLoopPerfTest(int testOperations, bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t packet_size, int buffer_slots, uint64_t iterations_per_thread, uint64_t rate, ArrivalMode arrival) : PerfTest(testOperations){
+	if(is_server) thread_count *= client_count;
+	if(rate == 0) throw invalid_argument("OpenLoopPerfTest rate must be greater than zero");
+
+	this->m_is_server = is_server;
+	this->m_rdma_port = rdma_port;
+	this->m_ownIpPort = ownIpPort;
+	this->m_sequencerIpPort = sequencerIpPort;
+	this->m_local_gpu_index = local_gpu_index;
+	this->m_actual_gpu_index = -1;
+	this->m_remote_gpu_index = remote_gpu_index;
+	this->client_count = client_count;
+	this->thread_count = thread_count;
+	this->m_packet_size = packet_size;
+	this->m_buffer_slots = buffer_slots;
+	this->m_memory_size = thread_count * slotSize(packet_size) * buffer_slots * rdma_addresses.size() * 2; // two times because send & receive
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_rate = rate;
+	this->m_arrival = arrival;
+	this->m_rdma_addresses = rdma_addresses;
+}
+rdma::OpenLoopPerfTest::~OpenLoopPerfTest(){
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		delete m_client_threads[i];
+	}
+	m_client_threads.clear();
+	for (size_t i = 0; i < m_server_threads.size(); i++) {
+		delete m_server_threads[i];
+	}
+	m_server_threads.clear();
+	if(m_is_server)
+		delete m_server;
+	delete m_memory;
+}
+
+std::string rdma::OpenLoopPerfTest::getTestParameters(bool forCSV){
+	std::ostringstream oss;
+	oss << (m_is_server ? "Server" : "Client") << ", threads=" << thread_count << ", bufferslots=" << m_buffer_slots;
+	if(!forCSV){
+		oss << ", packetsize=" << m_packet_size;
+		oss << ", memory=" << m_memory_size << " (2x " << thread_count << "x " << m_buffer_slots << "x ";
+		if(!m_is_server){ oss << m_rdma_addresses.size() << "x "; } oss << slotSize(m_packet_size) << ")";
+	}
+	oss << ", memory_type=" << getMemoryName(m_local_gpu_index, m_actual_gpu_index) << (m_remote_gpu_index!=-404 ? "->"+getMemoryName(m_remote_gpu_index) : "");
+	oss << ", iterations=" << (m_iterations_per_thread*thread_count) << ", arrival=" << (m_arrival==ARRIVAL_POISSON ? "Poisson" : "Constant");
+	if(!forCSV){
+		oss << ", rate=" << m_rate << "/thread";
+		oss << ", clients=" << client_count << ", servers=" << m_rdma_addresses.size();
+	}
+	return oss.str();
+}
+std::string rdma::OpenLoopPerfTest::getTestParameters(){
+	return getTestParameters(false);
+}
+
+void rdma::OpenLoopPerfTest::makeThreadsReady(TestOperation testOperation){
+	OpenLoopPerfTest::testOperation = testOperation;
+	OpenLoopPerfTest::signaled = false;
+	if(m_is_server){
+		// Server
+		for(OpenLoopPerfServerThread* perfThread : m_server_threads){ perfThread->start(); }
+		for(OpenLoopPerfServerThread* perfThread : m_server_threads){ while(!perfThread->ready()) usleep(Config::RDMA_SLEEP_INTERVAL); }
+		rdma::PerfTest::global_barrier_server(m_server, (size_t)thread_count);
+
+		// every server thread echoes the messages of one client thread
+		std::vector<size_t> connIDs = m_server->getConnectedConnIDs();
+		std::sort(connIDs.begin(), connIDs.end());
+		for(size_t i = 0; i < m_server_threads.size() && i < connIDs.size(); i++){
+			m_server_threads[i]->setRespondConnID(connIDs[i]);
+		}
+
+	} else {
+		// Client
+		for(OpenLoopPerfClientThread* perfThread : m_client_threads){ perfThread->start(); }
+		for(OpenLoopPerfClientThread* perfThread : m_client_threads){ while(!perfThread->ready()) usleep(Config::RDMA_SLEEP_INTERVAL); }
+	}
+}
+
+void rdma::OpenLoopPerfTest::runThreads(){
+	OpenLoopPerfTest::signaled = false;
+	unique_lock<mutex> lck(OpenLoopPerfTest::waitLock);
+	OpenLoopPerfTest::waitCv.notify_all();
+	OpenLoopPerfTest::signaled = true;
+	lck.unlock();
+	for (size_t i = 0; i < m_server_threads.size(); i++) {
+		m_server_threads[i]->join();
+	}
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		m_client_threads[i]->join();
+	}
+}
+
+void rdma::OpenLoopPerfTest::setupTest(){
+	m_actual_gpu_index = -1;
+	#ifdef CUDA_ENABLED /* defined in CMakeLists.txt to globally enable/disable CUDA support */
+		if(m_local_gpu_index <= -3){
+			m_memory = new rdma::MainMemory(m_memory_size);
+		} else {
+			rdma::CudaMemory *mem = new rdma::CudaMemory(m_memory_size, m_local_gpu_index);
+			m_memory = mem;
+			m_actual_gpu_index = mem->getDeviceIndex();
+		}
+	#else
+		m_memory = (rdma::BaseMemory*)new MainMemory(m_memory_size);
+	#endif
+
+	if(m_is_server){
+		// Server
+		m_server = new RDMAServer<ReliableRDMA>("OpenLoopTestRDMAServer", m_rdma_port, Network::getAddressOfConnection(m_ownIpPort), m_memory, m_sequencerIpPort);
+		for (size_t thread_id = 0; thread_id < thread_count; thread_id++) {
+			OpenLoopPerfServerThread* perfThread = new OpenLoopPerfServerThread(m_server, m_packet_size, m_buffer_slots);
+			m_server_threads.push_back(perfThread);
+		}
+
+	} else {
+		// Client
+		for (size_t thread_id = 0; thread_id < thread_count; thread_id++) {
+			OpenLoopPerfClientThread* perfThread = new OpenLoopPerfClientThread(m_memory, m_rdma_addresses, m_ownIpPort, m_sequencerIpPort, m_packet_size, m_buffer_slots, m_iterations_per_thread, m_rate, m_arrival);
+			m_client_threads.push_back(perfThread);
+		}
+	}
+}
+
+void rdma::OpenLoopPerfTest::runTest(){
+	if(m_is_server){
+		// Server
+		std::cout << "Starting server on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "' . . ." << std::endl;
+		if(!m_server->startServer()){
+			std::cerr << "OpenLoopPerfTest::runTest(): Could not start server" << std::endl;
+			throw invalid_argument("OpenLoopPerfTest server startup failed");
+		} else {
+			std::cout << "Server running on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "'" << std::endl;
+		}
+
+		for(size_t op = 0; op < OPEN_LOOP_OPERATION_COUNT; op++){
+			if(hasTestOperation(OPEN_LOOP_OPERATIONS[op])){
+				makeThreadsReady(OPEN_LOOP_OPERATIONS[op]);
+				runThreads();
+			}
+		}
+
+		// wait until server is done
+		while (m_server->isRunning() && m_server->getConnectedConnIDs().size() > 0) usleep(Config::RDMA_SLEEP_INTERVAL);
+		std::cout << "Server stopped" << std::endl;
+
+	} else {
+		// Client
+		for(size_t op = 0; op < OPEN_LOOP_OPERATION_COUNT; op++){
+			if(hasTestOperation(OPEN_LOOP_OPERATIONS[op])){
+				preparePerfEvents();
+				makeThreadsReady(OPEN_LOOP_OPERATIONS[op]);
+				usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first post the receives
+				startPerfEvents();
+				runThreads();
+				stopPerfEvents(OPEN_LOOP_OPERATIONS[op], m_iterations_per_thread * thread_count, thread_count);
+			}
+		}
+	}
+}
+
+
+std::string rdma::OpenLoopPerfTest::getTestResults(std::string csvFileName, bool csvAddHeader){
+	if(m_is_server){
+		return "only client";
+	} else {
+
+		// threads recorded into their own histograms, achieved throughputs of the threads add up
+		LatencyHistogram histograms[OPEN_LOOP_OPERATION_COUNT];
+		long double achieved[OPEN_LOOP_OPERATION_COUNT] = { 0 };
+		for(size_t i=0; i<m_client_threads.size(); i++){
+			OpenLoopPerfClientThread *thr = m_client_threads[i];
+			for(size_t op = 0; op < OPEN_LOOP_OPERATION_COUNT; op++){
+				histograms[op].merge(thr->m_histograms[op]);
+				if(thr->m_elapsedNs[op] > 0) achieved[op] += (long double)m_iterations_per_thread * NANO_SEC / thr->m_elapsedNs[op];
+			}
+		}
+		const uint64_t offered = m_rate * thread_count;
+
+		// write results into CSV file
+		if(!csvFileName.empty()){
+			const long double ustu = 1000; // nanosec to microsec
+			std::ofstream ofs;
+			ofs.open(csvFileName, std::ofstream::out | std::ofstream::app);
+			ofs << rdma::CSV_PRINT_NOTATION << rdma::CSV_PRINT_PRECISION;
+			if(csvAddHeader){
+				ofs << std::endl << "OPEN LOOP, " << getTestParameters(true) << ", packetsize=" << m_packet_size << std::endl;
+				ofs << "Offered Load [Op/s]";
+				for(size_t op = 0; op < OPEN_LOOP_OPERATION_COUNT; op++){
+					if(!hasTestOperation(OPEN_LOOP_OPERATIONS[op])) continue;
+					std::string name = OPEN_LOOP_OPERATION_NAMES[op];
+					ofs << ", Achieved " << name << " [Op/s], Avg " << name << " [usec], Median " << name << " [usec], Min " << name << " [usec], Max " << name << " [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, name);
+				}
+				writePerfEventsCSVHeader(ofs);
+				ofs << std::endl;
+			}
+			ofs << offered; // offered load Op/s
+			for(size_t op = 0; op < OPEN_LOOP_OPERATION_COUNT; op++){
+				if(!hasTestOperation(OPEN_LOOP_OPERATIONS[op])) continue;
+				ofs << ", " << round(achieved[op]) << ", "; // achieved Op/s
+				ofs << (round(histograms[op].getAverage()/ustu * 10)/10.0) << ", "; // avg us
+				ofs << (round(histograms[op].getMedian()/ustu * 10)/10.0) << ", "; // median us
+				ofs << (round(histograms[op].getMin()/ustu * 10)/10.0) << ", "; // min us
+				ofs << (round(histograms[op].getMax()/ustu * 10)/10.0); // max us
+				rdma::PerfTest::writePercentilesCSV(ofs, histograms[op]);
+			}
+			writePerfEventsCSV(ofs);
+			ofs << std::endl; ofs.close();
+		}
+
+		// write full histograms
+		if(!histogramFileName.empty()){
+			std::ofstream ofs;
+			ofs.open(histogramFileName, std::ofstream::out | std::ofstream::app);
+			ofs << std::endl << "OPEN LOOP HISTOGRAM, " << getTestParameters(true) << ", packetsize=" << m_packet_size << ", offered=" << offered << std::endl;
+			LatencyHistogram::writeBucketsHeader(ofs);
+			for(size_t op = 0; op < OPEN_LOOP_OPERATION_COUNT; op++){
+				if(hasTestOperation(OPEN_LOOP_OPERATIONS[op])) histograms[op].writeBuckets(ofs, OPEN_LOOP_OPERATION_NAMES[op]);
+			}
+			ofs.close();
+		}
+
+		// generate result string
+		std::ostringstream oss;
+		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
+		oss << "Measured as 'round-trip time' latency from the intended send time, offered load = " << rdma::PerfTest::convertCountPerSec(offered);
+		oss << " (" << (m_arrival==ARRIVAL_POISSON ? "Poisson" : "constant") << " arrivals):" << std::endl;
+		for(size_t op = 0; op < OPEN_LOOP_OPERATION_COUNT; op++){
+			if(!hasTestOperation(OPEN_LOOP_OPERATIONS[op])) continue;
+			std::string name = std::string(OPEN_LOOP_OPERATION_NAMES[op]) + ":";
+			oss << " - " << std::left << std::setw(17) << name << std::right << "achieved = " << rdma::PerfTest::convertCountPerSec(achieved[op]);
+			oss << "    average = " << rdma::PerfTest::convertTime(histograms[op].getAverage()) << "    median = " << rdma::PerfTest::convertTime(histograms[op].getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(histograms[op].getMin()) << " - " << rdma::PerfTest::convertTime(histograms[op].getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(histograms[op]) << std::endl;
+		}
+		return oss.str();
+	}
+	return NULL;
+}
@@ -0,0 +1,138 @@
+#ifndef OpenLoopPerfTest_H
+#define OpenLoopPerfTest_H
+
+#include "PerfTest.h"
+#include "LatencyHistogram.h"
+#include "../src/memory/LocalBaseMemoryStub.h"
+#include "../src/rdma/RDMAClient.h"
+#include "../src/rdma/RDMAServer.h"
+#include "../src/thread/Thread.h"
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+namespace rdma {
+
+enum ArrivalMode { ARRIVAL_CONSTANT=0, ARRIVAL_POISSON=1 };
+
+const size_t OPEN_LOOP_OPERATION_COUNT = 5;
+const TestOperation OPEN_LOOP_OPERATIONS[OPEN_LOOP_OPERATION_COUNT] = { WRITE_OPERATION, READ_OPERATION, SEND_RECEIVE_OPERATION, FETCH_ADD_OPERATION, COMPARE_SWAP_OPERATION };
+const char* const OPEN_LOOP_OPERATION_NAMES[OPEN_LOOP_OPERATION_COUNT] = { "Write", "Read", "Send/Recv", "Fetch&Add", "Comp&Swap" };
+
+/* Class: OpenLoopPerfClientThread
+ * ----------------
+ * Issues operations at intended send times given by the target rate
+ * instead of directly after the previous operation completed.
+ * Latency is measured from the intended send time, so an operation
+ * that has to wait for a slow predecessor includes that waiting time
+ * (no coordinated omission). Operations are distributed round-robin
+ * over the connections.
+ */
+class OpenLoopPerfClientThread : public Thread {
+public:
+	OpenLoopPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t packet_size, int buffer_slots, size_t iterations_per_thread, uint64_t rate, ArrivalMode arrival);
+	~OpenLoopPerfClientThread();
+	void run();
+	bool ready() {
+		return m_ready;
+	}
+
+	// recorded without locking per operation, merged after run
+	LatencyHistogram m_histograms[OPEN_LOOP_OPERATION_COUNT];
+	int64_t m_elapsedNs[OPEN_LOOP_OPERATION_COUNT] = { 0 };
+
+private:
+	bool m_ready = false;
+	RDMAClient<ReliableRDMA> *m_client;
+	LocalBaseMemoryStub *m_local_memory;
+	size_t m_packet_size;
+	size_t m_slot_size;
+	int m_buffer_slots;
+	size_t m_remote_memory_size_per_thread;
+	size_t m_memory_size_per_thread;
+	size_t m_iterations_per_thread;
+	uint64_t m_rate;
+	ArrivalMode m_arrival;
+	std::vector<std::string> m_rdma_addresses;
+	std::vector<NodeID> m_addr;
+	size_t* m_remOffsets;
+
+	void issue(TestOperation operation, size_t i);
+};
+
+
+/* Class: OpenLoopPerfServerThread
+ * ----------------
+ * Echoes the messages of one client thread for the
+ * send/receive operation until a stop message arrives
+ */
+class OpenLoopPerfServerThread : public Thread {
+public:
+	OpenLoopPerfServerThread(RDMAServer<ReliableRDMA> *server, size_t packet_size, int buffer_slots);
+	~OpenLoopPerfServerThread();
+	void run();
+	bool ready(){
+		return m_ready;
+	}
+	void setRespondConnID(NodeID connID){
+		m_respond_conn_id = connID;
+	}
+
+private:
+	bool m_ready = false;
+	size_t m_packet_size;
+	int m_buffer_slots;
+	NodeID m_respond_conn_id = 0;
+	RDMAServer<ReliableRDMA> *m_server;
+	LocalBaseMemoryStub *m_local_memory;
+};
+
+
+class OpenLoopPerfTest : public rdma::PerfTest {
+public:
+	OpenLoopPerfTest(int testOperations, bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t packet_size, int buffer_slots, uint64_t iterations_per_thread, uint64_t rate, ArrivalMode arrival);
+	virtual ~OpenLoopPerfTest();
+	std::string getTestParameters();
+	void setupTest();
+	void runTest();
+	std::string getTestResults(std::string csvFileName="", bool csvAddHeader=true);
+
+	static mutex waitLock;
+	static condition_variable waitCv;
+	static bool signaled;
+	static TestOperation testOperation;
+	static size_t thread_count, client_count;
+
+private:
+	bool m_is_server;
+	std::vector<std::string> m_rdma_addresses;
+	int m_rdma_port;
+	std::string m_ownIpPort;
+	std::string m_sequencerIpPort;
+	int m_local_gpu_index;
+	int m_actual_gpu_index;
+	int m_remote_gpu_index;
+	uint64_t m_packet_size;
+	int m_buffer_slots;
+	uint64_t m_memory_size;
+	uint64_t m_iterations_per_thread;
+	uint64_t m_rate;
+	ArrivalMode m_arrival;
+	std::vector<OpenLoopPerfClientThread*> m_client_threads;
+	std::vector<OpenLoopPerfServerThread*> m_server_threads;
+
+	BaseMemory *m_memory;
+	RDMAServer<ReliableRDMA>* m_server;
+
+	std::string getTestParameters(bool forCSV);
+	void makeThreadsReady(TestOperation testOperation);
+	void runThreads();
+};
+
+}
+
+#endif
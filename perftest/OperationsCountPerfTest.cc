@@ -490,28 +490,37 @@ void rdma::OperationsCountPerfTest::runTest(){
 
         // Measure operations/s for writing
 		if(hasTestOperation(WRITE_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(WRITE_OPERATION); // write
 			usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first post the receives if writeImm
+			startPerfEvents();
 			auto startWrite = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedWrite = rdma::PerfTest::stopTimer(startWrite);
+			stopPerfEvents(WRITE_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure operations/s for reading
 		if(hasTestOperation(READ_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(READ_OPERATION); // read
+			startPerfEvents();
 			auto startRead = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedRead = rdma::PerfTest::stopTimer(startRead);
+			stopPerfEvents(READ_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 
 		// Measure operations/s for sending
 		if(hasTestOperation(SEND_RECEIVE_OPERATION)){
+			preparePerfEvents();
 			makeThreadsReady(SEND_RECEIVE_OPERATION); // send
 			usleep(Config::PERFORMANCE_TEST_SERVER_TIME_ADVANTAGE); // let server first post the receives
+			startPerfEvents();
 			auto startSend = rdma::PerfTest::startTimer();
 			runThreads();
 			m_elapsedSend = rdma::PerfTest::stopTimer(startSend);
+			stopPerfEvents(SEND_RECEIVE_OPERATION, m_iterations_per_thread * thread_count * m_rdma_addresses.size(), thread_count);
 		}
 	}
 }
@@ -588,6 +597,7 @@ std::string rdma::OperationsCountPerfTest::getTestResults(std::string csvFileNam
 					ofs << ", Send/Recv [megaOp/s], Min Send/Recv [megaOp/s], Max Send/Recv [megaOp/s], Avg Send/Recv [megaOp/s], Median Send/Recv [megaOp/s], ";
 					ofs << "Send/Recv [Sec], Min Send/Recv [Sec], Max Send/Recv [Sec], Avg Send/Recv [Sec], Median Send/Recv [Sec]";
 				}
+				writePerfEventsCSVHeader(ofs);
 				ofs << std::endl;
 			}
 			ofs << m_packet_size; // packet size Bytes
@@ -627,6 +637,7 @@ std::string rdma::OperationsCountPerfTest::getTestResults(std::string csvFileNam
 				ofs << (round(avgSendNs/tu * 100000)/100000.0) << ", "; // avg send Sec
 				ofs << (round(medianSendNs/tu * 100000)/100000.0); // median send Sec
 			}
+			writePerfEventsCSV(ofs);
 			ofs << std::endl; ofs.close();
 		}
 
@@ -0,0 +1,176 @@
+/*
+
+Copyright (c) 2018 Viktor Leis
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+#ifndef PerfEvent_H
+#define PerfEvent_H
+
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#if defined(__linux__)
+#include <asm/unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace rdma {
+
+/* Class: PerfEvent
+ * ----------------
+ * Hardware counters of the Linux perf_event_open interface (adapted from
+ * perftest_old/PerfEvent.hpp) and the CPU time of the process (getrusage).
+ *
+ * Counters are inherited by the threads the process creates after they
+ * have been opened and are summed up over all of them. Therefore a
+ * PerfEvent has to be constructed before the client threads of a test
+ * phase get started while start() and stop() just enclose the phase.
+ * Counters the kernel doesn't permit (e.g. perf_event_paranoid or VMs)
+ * are reported as -1.
+ */
+class PerfEvent {
+public:
+    static const size_t COUNTER_COUNT = 5;
+    static constexpr const char* COUNTER_NAMES[COUNTER_COUNT] = { "Cycles", "Instructions", "L1 Misses", "LLC Misses", "Branch Misses" };
+    enum Counter { CYCLES=0, INSTRUCTIONS=1, L1_MISSES=2, LLC_MISSES=3, BRANCH_MISSES=4 };
+
+    PerfEvent(){
+        #if defined(__linux__)
+        open(CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(L1_MISSES, PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D|(PERF_COUNT_HW_CACHE_OP_READ<<8)|(PERF_COUNT_HW_CACHE_RESULT_MISS<<16));
+        open(LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        open(BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        #endif
+    }
+
+    ~PerfEvent(){
+        #if defined(__linux__)
+        for(size_t i = 0; i < COUNTER_COUNT; i++){
+            if(m_fds[i] >= 0) close(m_fds[i]);
+        }
+        #endif
+    }
+
+    void start(){
+        #if defined(__linux__)
+        for(size_t i = 0; i < COUNTER_COUNT; i++){
+            if(m_fds[i] < 0) continue;
+            ioctl(m_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            if(read(m_fds[i], &m_start[i], sizeof(ReadFormat)) != sizeof(ReadFormat)) m_fds[i] = -1;
+        }
+        #endif
+        getrusage(RUSAGE_SELF, &m_usageStart);
+        m_startTime = std::chrono::steady_clock::now();
+    }
+
+    void stop(){
+        m_stopTime = std::chrono::steady_clock::now();
+        getrusage(RUSAGE_SELF, &m_usageStop);
+        #if defined(__linux__)
+        for(size_t i = 0; i < COUNTER_COUNT; i++){
+            if(m_fds[i] < 0) continue;
+            if(read(m_fds[i], &m_stop[i], sizeof(ReadFormat)) != sizeof(ReadFormat)) m_fds[i] = -1;
+            ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+        #endif
+    }
+
+    // corrected by the share of time a counter was scheduled if the kernel had to multiplex them
+    double getCounter(Counter counter) const {
+        if(m_fds[counter] < 0) return -1;
+        const ReadFormat &start = m_start[counter], &stop = m_stop[counter];
+        if(stop.time_running == start.time_running) return 0;
+        double multiplexingCorrection = (double)(stop.time_enabled - start.time_enabled) / (stop.time_running - start.time_running);
+        return (stop.value - start.value) * multiplexingCorrection;
+    }
+
+    double getDuration() const {
+        return std::chrono::duration<double>(m_stopTime - m_startTime).count();
+    }
+
+    // CPU seconds of all threads in user and kernel mode
+    double getUserTime() const {
+        return toSeconds(m_usageStop.ru_utime) - toSeconds(m_usageStart.ru_utime);
+    }
+    double getSystemTime() const {
+        return toSeconds(m_usageStop.ru_stime) - toSeconds(m_usageStart.ru_stime);
+    }
+
+private:
+    struct ReadFormat {
+        uint64_t value = 0;
+        uint64_t time_enabled = 0;
+        uint64_t time_running = 0;
+    };
+
+    int m_fds[COUNTER_COUNT] = { -1, -1, -1, -1, -1 };
+    ReadFormat m_start[COUNTER_COUNT];
+    ReadFormat m_stop[COUNTER_COUNT];
+    struct rusage m_usageStart, m_usageStop;
+    std::chrono::steady_clock::time_point m_startTime, m_stopTime;
+
+    static double toSeconds(const struct timeval &time){
+        return time.tv_sec + time.tv_usec / 1000000.0;
+    }
+
+    #if defined(__linux__)
+    void open(Counter counter, uint32_t type, uint64_t config){
+        struct perf_event_attr pe;
+        memset(&pe, 0, sizeof(struct perf_event_attr));
+        pe.type = type;
+        pe.size = sizeof(struct perf_event_attr);
+        pe.config = config;
+        pe.disabled = true;
+        pe.inherit = 1; // count threads created afterwards
+        pe.inherit_stat = 0;
+        pe.exclude_kernel = false;
+        pe.exclude_hv = false;
+        pe.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        m_fds[counter] = syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+        if(m_fds[counter] < 0){
+            pe.exclude_kernel = true; // unprivileged users may only count user space
+            pe.exclude_hv = true;
+            m_fds[counter] = syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+        }
+        if(m_fds[counter] < 0 && !s_warned){
+            s_warned = true;
+            std::cerr << "Could not open hardware counter '" << COUNTER_NAMES[counter] << "' (see /proc/sys/kernel/perf_event_paranoid) therefore reported as -1" << std::endl;
+        }
+    }
+    #endif
+
+    static inline bool s_warned = false;
+};
+
+}
+
+#endif
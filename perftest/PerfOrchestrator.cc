@@ -0,0 +1,425 @@
+#include "PerfOrchestrator.h"
+
+#include "../src/rdma/NodeIDSequencer.h"
+#include "../src/utils/Config.h"
+#include "../src/utils/StringHelper.h"
+
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <climits>
+#include <cerrno>
+#include <mutex>
+#include <condition_variable>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+namespace {
+
+// seconds the controller waits for a response longer than the agent waits for a run
+const int64_t AGENT_RESPONSE_GRACE = 30;
+
+std::string readFile(const std::string &fileName){
+	std::ifstream ifs(fileName);
+	if(!ifs.good()) return "";
+	std::stringstream buffer;
+	buffer << ifs.rdbuf();
+	return buffer.str();
+}
+
+}
+
+
+
+rdma::PerfAgent::PerfAgent(std::string ownIpPort, std::string sequencerIpPort, std::vector<std::string> localArgs) : ProtoServer(NAME, Network::getPortOfConnection(ownIpPort)){
+	this->m_ownIpPort = ownIpPort;
+	this->m_sequencerIpPort = sequencerIpPort;
+	this->m_localArgs = localArgs;
+
+	// runs are executed by the same binary
+	char path[PATH_MAX];
+	ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if(length <= 0) throw std::runtime_error("PerfAgent could not determine the path of its executable");
+	path[length] = '\0';
+	this->m_executable = path;
+
+	if(!startServer()) throw std::runtime_error("PerfAgent could not listen on port " + std::to_string(m_port));
+
+	// controller finds the agents by their name at the sequencer
+	m_sequencer.connectProto(sequencerIpPort);
+	Any nodeIDRequest = ProtoMessageFactory::createNodeIDRequest(ownIpPort, NAME, NodeType::Enum::CLIENT);
+	Any rcvAny;
+	m_sequencer.exchangeProtoMsg(sequencerIpPort, &nodeIDRequest, &rcvAny);
+	if(!rcvAny.Is<NodeIDResponse>()) throw std::runtime_error("PerfAgent could not register at NodeIDSequencer " + sequencerIpPort);
+	NodeIDResponse nodeIDResponse;
+	rcvAny.UnpackTo(&nodeIDResponse);
+	this->m_nodeID = nodeIDResponse.nodeid();
+	this->m_registered = true;
+}
+
+rdma::PerfAgent::~PerfAgent(){
+	stopServer();
+	if(m_registered){
+		try {
+			Any releaseAny = ProtoMessageFactory::createNodeIDReleaseRequest(m_nodeID);
+			Any rcvAny;
+			m_sequencer.exchangeProtoMsg(m_sequencerIpPort, &releaseAny, &rcvAny);
+		} catch (std::runtime_error &e){
+			Logging::debug(__FILE__, __LINE__, std::string("PerfAgent could not release NodeID: ") + e.what());
+		}
+	}
+}
+
+void rdma::PerfAgent::handle(Any *sendMsg, Any *respMsg){
+	if(!sendMsg->Is<PerfAgentRunRequest>()){
+		Logging::error(__FILE__, __LINE__, "PerfAgent got unknown message!");
+		return;
+	}
+	PerfAgentRunRequest runRequest;
+	sendMsg->UnpackTo(&runRequest);
+	PerfAgentRunResponse runResponse;
+
+	if(runRequest.result()){
+		if(m_run.pid < 0){
+			runResponse.set_exit_code(-1);
+			runResponse.set_output("No run started on agent " + m_ownIpPort + "\n");
+		} else {
+			finishRun(runResponse);
+		}
+		respMsg->PackFrom(runResponse);
+		return;
+	}
+
+	if(m_run.pid >= 0){
+		// result of the former run was never requested, e.g. controller got killed
+		kill(m_run.pid, SIGKILL);
+		PerfAgentRunResponse ignored;
+		finishRun(ignored);
+	}
+
+	if(runRequest.stop()){
+		std::cout << "Stopped by controller" << std::endl;
+		runResponse.set_exit_code(0);
+		respMsg->PackFrom(runResponse);
+		m_stopped = true;
+		return;
+	}
+
+	std::vector<std::string> args(runRequest.args().begin(), runRequest.args().end());
+	std::string error;
+	if(!validateArgs(args, error)){
+		std::cout << "REJECTED RUN: " << error << std::endl;
+		runResponse.set_exit_code(-1);
+		runResponse.set_output("Run rejected by agent " + m_ownIpPort + ": " + error + "\n");
+		respMsg->PackFrom(runResponse);
+		return;
+	}
+
+	m_run.counter = ++m_runCounter;
+	m_run.prefix = "/tmp/perf_test_agent_" + std::to_string(getpid()) + "_" + std::to_string(m_run.counter);
+	m_run.timeout = runRequest.timeout();
+	std::remove((m_run.prefix + ".csv").c_str());
+	std::remove((m_run.prefix + ".json").c_str());
+
+	args.insert(args.end(), m_localArgs.begin(), m_localArgs.end());
+	args.push_back("--csvfile=" + m_run.prefix + ".csv");
+	args.push_back("--json=" + m_run.prefix + ".json");
+	int readyPipe[2] = { -1, -1 };
+	if(runRequest.report_ready()){
+		if(pipe(readyPipe) != 0){
+			runResponse.set_exit_code(-1);
+			runResponse.set_output("Agent " + m_ownIpPort + " could not create pipe for readiness of run\n");
+			respMsg->PackFrom(runResponse);
+			return;
+		}
+		args.push_back("--readyfd=" + std::to_string(readyPipe[1]));
+	}
+
+	std::ostringstream oss;
+	for(const std::string &arg : runRequest.args()) oss << " " << arg;
+	std::cout << "RUN " << m_run.counter << ":" << oss.str() << std::endl;
+
+	bool started = startRun(args, readyPipe[0]);
+	if(readyPipe[1] >= 0) close(readyPipe[1]);
+	bool ready = false;
+	if(readyPipe[0] >= 0){
+		ready = started && waitForReady(readyPipe[0]);
+		close(readyPipe[0]);
+	}
+
+	if(ready){
+		std::cout << "RUN " << m_run.counter << " READY" << std::endl;
+		runResponse.set_ready(true);
+	} else {
+		finishRun(runResponse);
+	}
+	respMsg->PackFrom(runResponse);
+}
+
+bool rdma::PerfAgent::validateArgs(const std::vector<std::string> &args, std::string &error){
+	for(const std::string &arg : args){
+		if(arg == "--server") continue;
+		size_t separator = arg.find('=');
+		if(arg.compare(0, 2, "--") != 0 || separator == std::string::npos){
+			error = "flag '" + arg + "' is not of the form --name=value";
+			return false;
+		}
+		const std::string name = arg.substr(2, separator - 2), value = arg.substr(separator + 1);
+		const std::vector<std::string> &testFlags = PerfController::TEST_FLAGS, &roleFlags = PerfController::ROLE_FLAGS;
+		if(std::find(testFlags.begin(), testFlags.end(), name) == testFlags.end() &&
+				std::find(roleFlags.begin(), roleFlags.end(), name) == roleFlags.end()){
+			error = "flag '--" + name + "' is not allowed";
+			return false;
+		}
+		for(char c : value){
+			if(!isalnum((unsigned char)c) && std::string(".,:=_+-").find(c) == std::string::npos){
+				error = "value '" + value + "' of flag '--" + name + "' contains invalid characters";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool rdma::PerfAgent::startRun(const std::vector<std::string> &args, int closeFd){
+	// everything the child needs is prepared before forking as it may only call async-signal-safe functions
+	std::vector<char*> argv;
+	argv.push_back(const_cast<char*>(m_executable.c_str()));
+	for(const std::string &arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+	argv.push_back(nullptr);
+	const std::string outputFileName = m_run.prefix + ".log";
+	const char *executable = m_executable.c_str(), *output = outputFileName.c_str();
+
+	m_run.start = std::chrono::steady_clock::now();
+	m_run.pid = fork();
+	if(m_run.pid < 0) return false;
+	if(m_run.pid == 0){
+		prctl(PR_SET_PDEATHSIG, SIGKILL); // don't outlive the agent
+		if(closeFd >= 0) close(closeFd);
+		int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if(fd >= 0){
+			dup2(fd, STDOUT_FILENO);
+			dup2(fd, STDERR_FILENO);
+			close(fd);
+		}
+		execv(executable, argv.data());
+		_exit(127);
+	}
+	return true;
+}
+
+bool rdma::PerfAgent::waitForReady(int readyFd){
+	while(true){
+		int timeoutMs = -1;
+		if(m_run.timeout > 0){
+			auto remaining = std::chrono::seconds(m_run.timeout) - (std::chrono::steady_clock::now() - m_run.start);
+			timeoutMs = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count());
+		}
+		struct pollfd pfd = { readyFd, POLLIN, 0 };
+		int result = poll(&pfd, 1, timeoutMs);
+		if(result < 0 && errno == EINTR) continue;
+		if(result <= 0) return false;
+
+		// EOF if the run exited before it was ready
+		char ready = 0;
+		ssize_t received;
+		while((received = read(readyFd, &ready, 1)) < 0 && errno == EINTR){}
+		return received == 1;
+	}
+}
+
+void rdma::PerfAgent::finishRun(PerfAgentRunResponse &runResponse){
+	int exitCode = -1;
+	if(m_run.pid > 0){
+		int status = 0;
+		while(true){
+			pid_t result = waitpid(m_run.pid, &status, (m_run.timeout > 0 ? WNOHANG : 0));
+			if(result == m_run.pid){
+				exitCode = (WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+				break;
+			}
+			if(result < 0 && errno != EINTR) break;
+			if(m_run.timeout > 0 && std::chrono::steady_clock::now() - m_run.start >= std::chrono::seconds(m_run.timeout)){
+				kill(m_run.pid, SIGKILL);
+				waitpid(m_run.pid, &status, 0);
+				break;
+			}
+			if(result == 0) usleep(Config::RDMA_SLEEP_INTERVAL);
+		}
+	}
+	m_run.pid = -1;
+	std::cout << "RUN " << m_run.counter << " DONE (exit code " << exitCode << ")" << std::endl;
+
+	const std::string outputFileName = m_run.prefix + ".log", csvFileName = m_run.prefix + ".csv", jsonFileName = m_run.prefix + ".json";
+	std::string output = readFile(outputFileName);
+	if(exitCode < 0 && m_run.timeout > 0) output += "\nRun killed by agent " + m_ownIpPort + " after " + std::to_string(m_run.timeout) + " seconds\n";
+	runResponse.set_exit_code(exitCode);
+	runResponse.set_output(output);
+	runResponse.set_csv(readFile(csvFileName));
+	runResponse.set_report(readFile(jsonFileName));
+
+	std::remove(outputFileName.c_str());
+	std::remove(csvFileName.c_str());
+	std::remove(jsonFileName.c_str());
+}
+
+
+
+const std::vector<std::string> rdma::PerfController::TEST_FLAGS = { "test", "packetsize", "bufferslots", "threads", "iterations", "maxtransfersize", "transfersize",
+		"maxiterations", "writemode", "rate", "arrival", "prefetch", "scansize", "responsesize", "outstanding", "mcastaddr", "mix", "keys",
+		"distribution", "zipftheta", "hotset", "hotops", "qps", "perfevents", "repetitions", "confidence", "ignoreerrors", "port", "servercores", "clientcores" };
+
+const std::vector<std::string> rdma::PerfController::ROLE_FLAGS = { "server", "clients", "addr", "memtype", "remote_memtype" };
+
+rdma::PerfController::PerfController(std::string sequencerIpPort){
+	this->m_sequencerIpPort = sequencerIpPort;
+	m_sequencer.connectProto(sequencerIpPort);
+}
+
+std::vector<std::string> rdma::PerfController::waitForAgents(size_t count, int timeoutSec){
+	auto start = std::chrono::steady_clock::now();
+	while(true){
+		Any getAllRequest = ProtoMessageFactory::createGetAllNodeIDsRequest(0);
+		Any rcvAny;
+		m_sequencer.exchangeProtoMsg(m_sequencerIpPort, &getAllRequest, &rcvAny);
+		if(!rcvAny.Is<GetAllNodeIDsResponse>()) throw std::runtime_error("PerfController could not request nodes from NodeIDSequencer " + m_sequencerIpPort);
+		GetAllNodeIDsResponse getAllResponse;
+		rcvAny.UnpackTo(&getAllResponse);
+
+		std::vector<std::pair<NodeID, std::string>> agents;
+		for(const NodeIDStruct &entry : getAllResponse.nodeid_entries()){
+			if(entry.name() == PerfAgent::NAME) agents.emplace_back(entry.node_id(), entry.ip());
+		}
+		if(agents.size() >= count){
+			std::sort(agents.begin(), agents.end());
+			std::vector<std::string> ipPorts;
+			for(size_t i = 0; i < count; i++) ipPorts.push_back(agents[i].second);
+			return ipPorts;
+		}
+
+		if(std::chrono::steady_clock::now() - start >= std::chrono::seconds(timeoutSec)){
+			throw std::runtime_error("Only " + std::to_string(agents.size()) + " of " + std::to_string(count) + " agents registered at NodeIDSequencer " + m_sequencerIpPort);
+		}
+		usleep(5 * Config::RDMA_SLEEP_INTERVAL);
+	}
+}
+
+void rdma::PerfController::run(std::vector<AgentRun> &runs, uint32_t timeout){
+	// clients are started once all servers accept them
+	std::mutex readyLock;
+	std::condition_variable readyCondition;
+	size_t pendingServers = 0;
+	bool serverFailed = false;
+	auto onReady = [&](bool ready){
+		std::unique_lock<std::mutex> lck(readyLock);
+		pendingServers--;
+		if(!ready) serverFailed = true;
+		readyCondition.notify_all();
+	};
+
+	std::vector<std::thread> threads;
+	for(AgentRun &run : runs){
+		if(!run.server) continue;
+		pendingServers++;
+		threads.emplace_back(exchange, std::ref(run), timeout, onReady);
+	}
+	{
+		std::unique_lock<std::mutex> lck(readyLock);
+		readyCondition.wait(lck, [&](){ return pendingServers == 0; });
+	}
+	for(AgentRun &run : runs){
+		if(run.server) continue;
+		if(serverFailed){
+			run.exitCode = -1;
+			run.output = "Run not started on agent " + run.agent + " as a server run failed\n";
+			continue;
+		}
+		threads.emplace_back(exchange, std::ref(run), timeout, nullptr);
+	}
+	for(std::thread &thread : threads) thread.join();
+}
+
+void rdma::PerfController::exchange(AgentRun &run, uint32_t timeout, std::function<void(bool)> onReady){
+	// every agent gets its own socket so that the runs are executed in parallel
+	bool reportedReady = false;
+	try {
+		ProtoClient client;
+		client.connectProto(run.agent);
+		if(timeout > 0) client.setRecvTimeout((timeout + AGENT_RESPONSE_GRACE) * 1000, run.agent);
+		Any runRequest = ProtoMessageFactory::createPerfAgentRunRequest(run.args, timeout, onReady != nullptr);
+		Any rcvAny;
+		client.exchangeProtoMsg(run.agent, &runRequest, &rcvAny);
+		if(!rcvAny.Is<PerfAgentRunResponse>()) throw std::runtime_error("received wrong response type");
+		PerfAgentRunResponse runResponse;
+		rcvAny.UnpackTo(&runResponse);
+		if(runResponse.ready()){
+			reportedReady = true;
+			onReady(true);
+			Any resultRequest = ProtoMessageFactory::createPerfAgentResultRequest();
+			rcvAny.Clear();
+			client.exchangeProtoMsg(run.agent, &resultRequest, &rcvAny);
+			if(!rcvAny.Is<PerfAgentRunResponse>()) throw std::runtime_error("received wrong response type");
+			rcvAny.UnpackTo(&runResponse);
+		}
+		run.exitCode = runResponse.exit_code();
+		run.output = runResponse.output();
+		run.csv = runResponse.csv();
+		run.report = runResponse.report();
+	} catch (const std::exception &ex){
+		run.exitCode = -1;
+		run.output = "Could not execute run on agent " + run.agent + ": " + ex.what() + "\n";
+	}
+	if(onReady && !reportedReady) onReady(false);
+}
+
+void rdma::PerfController::stopAgents(const std::vector<std::string> &agents){
+	for(const std::string &agent : agents){
+		try {
+			ProtoClient client;
+			client.connectProto(agent);
+			client.setRecvTimeout(AGENT_RESPONSE_GRACE * 1000, agent);
+			Any stopRequest = ProtoMessageFactory::createPerfAgentStopRequest();
+			Any rcvAny;
+			client.exchangeProtoMsg(agent, &stopRequest, &rcvAny);
+		} catch (const std::exception &ex){
+			Logging::warn(std::string("PerfController could not stop agent " + agent + ": ") + ex.what());
+		}
+	}
+}
+
+std::vector<std::vector<std::pair<std::string, std::string>>> rdma::PerfController::expandMatrix(const std::vector<std::pair<std::string, std::string>> &flags, const std::vector<std::string> &matrix){
+	std::vector<std::vector<std::pair<std::string, std::string>>> combinations = { flags };
+	for(const std::string &name : matrix){
+		auto isFlag = [&name](const std::pair<std::string, std::string> &flag){ return flag.first == name; };
+		if(std::find_if(flags.begin(), flags.end(), isFlag) == flags.end()){
+			throw std::invalid_argument("Matrix flag '" + name + "' is not a test flag");
+		}
+
+		std::vector<std::vector<std::pair<std::string, std::string>>> expanded;
+		for(const auto &combination : combinations){
+			auto flag = std::find_if(combination.begin(), combination.end(), isFlag);
+			std::vector<std::string> values;
+			for(std::string value : StringHelper::split(flag->second, ",")){
+				value = StringHelper::trim(value);
+				if(!value.empty()) values.push_back(value);
+			}
+			if(values.empty()){
+				expanded.push_back(combination);
+				continue;
+			}
+			for(const std::string &value : values){
+				expanded.push_back(combination);
+				std::find_if(expanded.back().begin(), expanded.back().end(), isFlag)->second = value;
+			}
+		}
+		combinations = expanded;
+	}
+	return combinations;
+}
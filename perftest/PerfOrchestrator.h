@@ -0,0 +1,180 @@
+#ifndef PerfOrchestrator_H
+#define PerfOrchestrator_H
+
+#include "../src/proto/ProtoServer.h"
+#include "../src/proto/ProtoClient.h"
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <sys/types.h>
+
+namespace rdma {
+
+/* Class: PerfAgent
+ * ----------------
+ * Runs the tests of a PerfController on one node. The agent registers
+ * itself with its ip:port at the NodeIDSequencer, executes every run
+ * it receives as separate perf_test process with the flags of the
+ * controller plus the node-local flags (config, own address, sequencer)
+ * and responds with the exit code, console output, CSV and JSON report
+ * of the run. A run is a separate process so that the RDMA resources,
+ * static barriers and thread pinning of the tests are the same as if
+ * perf_test was started by hand. Only the test and role flags of the
+ * controller are accepted (no files, config or flag files).
+ *
+ * A server run can report when it accepts clients: the agent responds
+ * to the run request at that point and to a following result request
+ * once the run exited.
+ */
+class PerfAgent : public ProtoServer {
+public:
+    static constexpr const char* NAME = "PerfTestAgent";
+
+    PerfAgent(std::string ownIpPort, std::string sequencerIpPort, std::vector<std::string> localArgs);
+    ~PerfAgent();
+
+    void handle(Any *sendMsg, Any *respMsg) override;
+    bool isStopped(){ return m_stopped; }
+
+    /* Function: validateArgs
+     * ----------------
+     * Checks that the flags of a run are test or role flags of the
+     * controller in the form --name=value (or --server) whose values
+     * consist of letters, digits and . , : = _ + - only.
+     *
+     * error:  set to the reason if the flags are rejected
+     *
+     * return:  true if the flags can be passed to perf_test
+     */
+    static bool validateArgs(const std::vector<std::string> &args, std::string &error);
+
+private:
+    // started run whose result was not requested yet
+    struct Run {
+        pid_t pid = -1;
+        size_t counter = 0;
+        std::string prefix; // of its output, CSV and JSON file
+        std::chrono::steady_clock::time_point start;
+        uint32_t timeout = 0;
+    };
+
+    std::string m_ownIpPort;
+    std::string m_sequencerIpPort;
+    std::vector<std::string> m_localArgs; // appended to the flags of every run
+    std::string m_executable;
+    ProtoClient m_sequencer;
+    NodeID m_nodeID = 0;
+    bool m_registered = false;
+    size_t m_runCounter = 0;
+    Run m_run;
+    std::atomic<bool> m_stopped {false};
+
+    /* Function: startRun
+     * ----------------
+     * Starts perf_test with the given flags as m_run. Output
+     * is written into the output file of the run.
+     *
+     * closeFd:  file descriptor the child closes (-1 for none)
+     *
+     * return:  false if the process could not be started
+     */
+    bool startRun(const std::vector<std::string> &args, int closeFd);
+
+    /* Function: waitForReady
+     * ----------------
+     * Waits until the server run writes a byte into the pipe
+     *
+     * return:  false if the run exited or timed out before
+     */
+    bool waitForReady(int readyFd);
+
+    /* Function: finishRun
+     * ----------------
+     * Waits until m_run exits (killed after its timeout) and fills
+     * in its exit code, output, CSV and JSON report. The exit code
+     * is -1 if the run was killed or not started.
+     */
+    void finishRun(PerfAgentRunResponse &runResponse);
+};
+
+
+/* Class: PerfController
+ * ----------------
+ * Orchestrates the tests on the agents that registered at the
+ * NodeIDSequencer. Every run is started on the server agents first
+ * and on the client agents once all servers reported that they accept
+ * clients. The controller waits until all agents finished the run
+ * before it starts the next one, so the runs of a test matrix never
+ * overlap.
+ */
+class PerfController {
+public:
+    struct AgentRun {
+        std::string agent; // ip:port of the agent
+        bool server = false;
+        std::vector<std::string> args;
+        int exitCode = -1;
+        std::string output;
+        std::string csv;
+        std::string report;
+    };
+
+    static const std::vector<std::string> TEST_FLAGS; // passed to every run, see expandMatrix
+    static const std::vector<std::string> ROLE_FLAGS; // set per agent by the controller
+
+    PerfController(std::string sequencerIpPort);
+
+    /* Function: waitForAgents
+     * ----------------
+     * Polls the NodeIDSequencer until the given amount of agents
+     * registered or the timeout exceeded.
+     *
+     * return:  ip:port of the agents ordered by their node id
+     */
+    std::vector<std::string> waitForAgents(size_t count, int timeoutSec);
+
+    /* Function: run
+     * ----------------
+     * Executes the runs synchronously on their agents and fills
+     * in their results. Client runs are started once all server
+     * runs accept clients and are not started at all if a server
+     * run failed before.
+     *
+     * timeout:  seconds until the agents kill a run, 0 waits forever
+     */
+    void run(std::vector<AgentRun> &runs, uint32_t timeout);
+
+    void stopAgents(const std::vector<std::string> &agents);
+
+    /* Function: expandMatrix
+     * ----------------
+     * Splits the comma separated values of the matrix flags so that
+     * every combination is a separate run. Other flags are passed
+     * unchanged to every run. The first matrix flag varies slowest.
+     *
+     * flags:   name and value of the flags of a run
+     * matrix:  names of the flags to expand
+     *
+     * return:  flags of every combination
+     */
+    static std::vector<std::vector<std::pair<std::string, std::string>>> expandMatrix(const std::vector<std::pair<std::string, std::string>> &flags, const std::vector<std::string> &matrix);
+
+private:
+    std::string m_sequencerIpPort;
+    ProtoClient m_sequencer;
+
+    /* Function: exchange
+     * ----------------
+     * Executes a run on its agent. Server runs report when they
+     * accept clients (or failed before) through onReady.
+     */
+    static void exchange(AgentRun &run, uint32_t timeout, std::function<void(bool)> onReady);
+};
+
+}
+
+#endif
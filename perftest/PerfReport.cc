@@ -0,0 +1,544 @@
+#include "PerfReport.h"
+
+#include "../src/utils/Config.h"
+#include "../src/utils/Filehelper.h"
+#include "../src/utils/StringHelper.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <stdexcept>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+#ifndef PERFTEST_GIT_REVISION
+#define PERFTEST_GIT_REVISION "unknown"
+#endif
+
+namespace {
+
+// two-sided quantiles of the Student's t-distribution for 1..30 degrees of freedom, normal distribution above
+const size_t T_TABLE_SIZE = 30;
+const double T_TABLE_90[T_TABLE_SIZE+1] = { 6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812, 1.796, 1.782, 1.771, 1.761, 1.753,
+											1.746, 1.740, 1.734, 1.729, 1.725, 1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699, 1.697, 1.645 };
+const double T_TABLE_95[T_TABLE_SIZE+1] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+											2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042, 1.960 };
+const double T_TABLE_99[T_TABLE_SIZE+1] = { 63.657, 9.925, 5.841, 4.604, 4.032, 3.707, 3.499, 3.355, 3.250, 3.169, 3.106, 3.055, 3.012, 2.977, 2.947,
+											2.921, 2.898, 2.878, 2.861, 2.845, 2.831, 2.819, 2.807, 2.797, 2.787, 2.779, 2.771, 2.763, 2.756, 2.750, 2.576 };
+
+std::string escapeJSON(const std::string &str){
+	std::ostringstream oss;
+	for(const char &c : str){
+		switch(c){
+			case '"': oss << "\\\""; break;
+			case '\\': oss << "\\\\"; break;
+			case '\n': oss << "\\n"; break;
+			case '\r': oss << "\\r"; break;
+			case '\t': oss << "\\t"; break;
+			default:
+				if((unsigned char)c < 0x20){
+					oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+				} else { oss << c; }
+		}
+	} return oss.str();
+}
+
+std::string numberJSON(long double value){
+	if(!std::isfinite(value)) return "null";
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(6) << value;
+	return oss.str();
+}
+
+std::string readFirstLine(const std::string &fileName){
+	std::ifstream ifs(fileName);
+	std::string line;
+	if(ifs.good()) std::getline(ifs, line);
+	return rdma::StringHelper::trim(line);
+}
+
+
+/* Struct: JSONValue
+ * ----------------
+ * Parsed JSON value, just as much as needed to read reports back.
+ */
+struct JSONValue {
+	enum Type { NONE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT } type = NONE;
+	long double number = 0;
+	std::string str;
+	std::vector<JSONValue> array;
+	std::vector<std::pair<std::string, JSONValue>> object;
+
+	const JSONValue* get(const std::string &key) const {
+		for(auto &entry : object){
+			if(entry.first == key) return &entry.second;
+		} return nullptr;
+	}
+	std::string getString(const std::string &key) const {
+		const JSONValue *value = get(key);
+		return (value != nullptr && value->type == STRING ? value->str : "");
+	}
+};
+
+class JSONParser {
+public:
+	JSONParser(const std::string &text) : m_text(text) {}
+
+	JSONValue parse(){
+		JSONValue value = parseValue();
+		skipWhitespaces();
+		if(m_pos != m_text.length()) fail("unexpected trailing characters");
+		return value;
+	}
+
+private:
+	const std::string &m_text;
+	size_t m_pos = 0;
+
+	void fail(const std::string &reason){
+		throw std::runtime_error("Could not parse JSON at position " + std::to_string(m_pos) + ": " + reason);
+	}
+
+	void skipWhitespaces(){
+		while(m_pos < m_text.length() && std::isspace((unsigned char)m_text[m_pos])) m_pos++;
+	}
+
+	bool consume(const std::string &token){
+		skipWhitespaces();
+		if(m_text.compare(m_pos, token.length(), token) != 0) return false;
+		m_pos += token.length();
+		return true;
+	}
+
+	void expect(const std::string &token){
+		if(!consume(token)) fail("expected '" + token + "'");
+	}
+
+	JSONValue parseValue(){
+		JSONValue value;
+		skipWhitespaces();
+		if(m_pos >= m_text.length()) fail("unexpected end");
+		const char c = m_text[m_pos];
+		if(c == '{'){
+			value.type = JSONValue::OBJECT;
+			expect("{");
+			if(consume("}")) return value;
+			do {
+				skipWhitespaces();
+				std::string key = parseString();
+				expect(":");
+				value.object.emplace_back(key, parseValue());
+			} while(consume(","));
+			expect("}");
+		} else if(c == '['){
+			value.type = JSONValue::ARRAY;
+			expect("[");
+			if(consume("]")) return value;
+			do {
+				value.array.push_back(parseValue());
+			} while(consume(","));
+			expect("]");
+		} else if(c == '"'){
+			value.type = JSONValue::STRING;
+			value.str = parseString();
+		} else if(consume("true")){
+			value.type = JSONValue::BOOLEAN; value.number = 1;
+		} else if(consume("false")){
+			value.type = JSONValue::BOOLEAN; value.number = 0;
+		} else if(consume("null")){
+			value.type = JSONValue::NONE;
+		} else {
+			const char *start = m_text.c_str() + m_pos;
+			char *end = nullptr;
+			value.number = std::strtold(start, &end);
+			if(end == start) fail("unexpected character");
+			value.type = JSONValue::NUMBER;
+			m_pos += (end - start);
+		}
+		return value;
+	}
+
+	std::string parseString(){
+		if(m_pos >= m_text.length() || m_text[m_pos] != '"') fail("expected string");
+		m_pos++;
+		std::string str;
+		while(m_pos < m_text.length() && m_text[m_pos] != '"'){
+			char c = m_text[m_pos++];
+			if(c == '\\'){
+				if(m_pos >= m_text.length()) break;
+				c = m_text[m_pos++];
+				switch(c){
+					case 'n': str += '\n'; break;
+					case 'r': str += '\r'; break;
+					case 't': str += '\t'; break;
+					case 'b': str += '\b'; break;
+					case 'f': str += '\f'; break;
+					case 'u': {
+						if(m_pos + 4 > m_text.length()) fail("invalid escape sequence");
+						unsigned long code = std::stoul(m_text.substr(m_pos, 4), nullptr, 16);
+						m_pos += 4;
+						str += (code < 0x80 ? (char)code : '?'); // reports only escape control characters
+						break;
+					}
+					default: str += c; // quote, backslash and slash
+				}
+			} else { str += c; }
+		}
+		if(m_pos >= m_text.length()) fail("unterminated string");
+		m_pos++;
+		return str;
+	}
+};
+
+}
+
+
+
+long double rdma::PerfReport::Metric::getMean() const {
+	if(samples.empty()) return 0;
+	long double sum = 0;
+	for(const long double &sample : samples) sum += sample;
+	return sum / samples.size();
+}
+
+long double rdma::PerfReport::Metric::getStdDev() const {
+	if(samples.size() < 2) return 0;
+	const long double mean = getMean();
+	long double sum = 0;
+	for(const long double &sample : samples) sum += (sample - mean) * (sample - mean);
+	return std::sqrt(sum / (samples.size() - 1)); // sample standard deviation
+}
+
+long double rdma::PerfReport::Metric::getConfidence(double level) const {
+	if(samples.size() < 2) return 0;
+	const double *table = (level < 0.925 ? T_TABLE_90 : (level < 0.97 ? T_TABLE_95 : T_TABLE_99));
+	const size_t degrees = samples.size() - 1;
+	const double t = table[degrees <= T_TABLE_SIZE ? degrees-1 : T_TABLE_SIZE];
+	return t * getStdDev() / std::sqrt((long double)samples.size());
+}
+
+rdma::PerfReport::Metric* rdma::PerfReport::Result::getMetric(const std::string &name){
+	for(Metric &metric : metrics){
+		if(metric.name == name) return &metric;
+	} return nullptr;
+}
+
+const rdma::PerfReport::Metric* rdma::PerfReport::Result::getMetric(const std::string &name) const {
+	for(const Metric &metric : metrics){
+		if(metric.name == name) return &metric;
+	} return nullptr;
+}
+
+
+
+rdma::PerfReport::PerfReport(std::string commandLine, double confidence){
+	this->m_commandLine = commandLine;
+	this->m_confidence = confidence;
+	char timestr[255];
+	std::time_t systime = std::time(NULL);
+	std::strftime(timestr, 255, "%FT%T%z", std::localtime(&systime));
+	this->m_started = timestr;
+}
+
+bool rdma::PerfReport::addResult(std::string test, std::string parameters, std::string csvFileName){
+	std::ifstream ifs(csvFileName);
+	if(!ifs.good()) return false;
+
+	// title, column names, values (see getTestResults() of the tests)
+	std::vector<std::string> lines;
+	std::string line;
+	while(std::getline(ifs, line)){
+		if(!StringHelper::trim(line).empty()) lines.push_back(line);
+	}
+	ifs.close();
+	if(lines.size() < 3) return false;
+
+	Result *result = nullptr;
+	for(Result &r : m_results){
+		if(r.test == test && r.parameters == parameters){ result = &r; break; }
+	}
+	if(result == nullptr){
+		m_results.emplace_back();
+		result = &m_results.back();
+		result->test = test;
+		result->title = lines[0];
+		result->parameters = parameters;
+	}
+
+	std::vector<std::string> columns = StringHelper::split(lines[1], ",");
+	std::vector<std::string> values = StringHelper::split(lines[2], ",");
+	for(size_t i = 0; i < columns.size() && i < values.size(); i++){
+		std::string name = StringHelper::trim(columns[i]);
+		std::string value = StringHelper::trim(values[i]);
+		char *end = nullptr;
+		long double number = std::strtold(value.c_str(), &end);
+		if(name.empty() || end == value.c_str()) continue;
+
+		Metric *metric = result->getMetric(name);
+		if(metric == nullptr){
+			result->metrics.emplace_back();
+			metric = &result->metrics.back();
+			metric->name = name;
+		}
+		metric->samples.push_back(number);
+	}
+	return true;
+}
+
+void rdma::PerfReport::addResults(const std::vector<Result> &results, std::string node){
+	for(const Result &other : results){
+		const std::string parameters = other.parameters + ", node=" + node;
+		Result *result = nullptr;
+		for(Result &r : m_results){
+			if(r.test == other.test && r.parameters == parameters){ result = &r; break; }
+		}
+		if(result == nullptr){
+			m_results.emplace_back();
+			result = &m_results.back();
+			result->test = other.test;
+			result->title = other.title + ", node=" + node;
+			result->parameters = parameters;
+		}
+		for(const Metric &otherMetric : other.metrics){
+			Metric *metric = result->getMetric(otherMetric.name);
+			if(metric == nullptr){
+				result->metrics.push_back(otherMetric);
+			} else {
+				metric->samples.insert(metric->samples.end(), otherMetric.samples.begin(), otherMetric.samples.end());
+			}
+		}
+	}
+}
+
+void rdma::PerfReport::addNode(std::string node, const std::map<std::string, std::string> &environment){
+	m_nodes[node] = environment;
+}
+
+void rdma::PerfReport::writeJSON(std::string fileName){
+	std::ofstream ofs(fileName, std::ofstream::out | std::ofstream::trunc);
+	if(!ofs.good()) throw std::runtime_error("Could not write report into '" + fileName + "'");
+
+	ofs << "{" << std::endl;
+	ofs << "  \"tool\": \"perf_test\"," << std::endl;
+	ofs << "  \"started\": \"" << escapeJSON(m_started) << "\"," << std::endl;
+	ofs << "  \"command\": \"" << escapeJSON(m_commandLine) << "\"," << std::endl;
+	ofs << "  \"confidence\": " << numberJSON(m_confidence) << "," << std::endl;
+
+	ofs << "  \"environment\": {";
+	std::map<std::string, std::string> environment = getEnvironment();
+	for(auto it = environment.begin(); it != environment.end(); ++it){
+		ofs << (it == environment.begin() ? "" : ",") << std::endl << "    \"" << escapeJSON(it->first) << "\": \"" << escapeJSON(it->second) << "\"";
+	}
+	ofs << std::endl << "  }," << std::endl;
+
+	if(!m_nodes.empty()){
+		ofs << "  \"nodes\": {";
+		for(auto node = m_nodes.begin(); node != m_nodes.end(); ++node){
+			ofs << (node == m_nodes.begin() ? "" : ",") << std::endl << "    \"" << escapeJSON(node->first) << "\": {";
+			for(auto it = node->second.begin(); it != node->second.end(); ++it){
+				ofs << (it == node->second.begin() ? "" : ",") << std::endl << "      \"" << escapeJSON(it->first) << "\": \"" << escapeJSON(it->second) << "\"";
+			}
+			ofs << std::endl << "    }";
+		}
+		ofs << std::endl << "  }," << std::endl;
+	}
+
+	ofs << "  \"results\": [";
+	for(size_t r = 0; r < m_results.size(); r++){
+		const Result &result = m_results[r];
+		ofs << (r == 0 ? "" : ",") << std::endl << "    {" << std::endl;
+		ofs << "      \"test\": \"" << escapeJSON(result.test) << "\"," << std::endl;
+		ofs << "      \"title\": \"" << escapeJSON(result.title) << "\"," << std::endl;
+		ofs << "      \"parameters\": \"" << escapeJSON(result.parameters) << "\"," << std::endl;
+		ofs << "      \"metrics\": {";
+		for(size_t m = 0; m < result.metrics.size(); m++){
+			const Metric &metric = result.metrics[m];
+			ofs << (m == 0 ? "" : ",") << std::endl << "        \"" << escapeJSON(metric.name) << "\": { ";
+			ofs << "\"mean\": " << numberJSON(metric.getMean()) << ", \"stddev\": " << numberJSON(metric.getStdDev());
+			ofs << ", \"ci\": " << numberJSON(metric.getConfidence(m_confidence)) << ", \"samples\": [";
+			for(size_t s = 0; s < metric.samples.size(); s++){
+				ofs << (s == 0 ? "" : ", ") << numberJSON(metric.samples[s]);
+			}
+			ofs << "] }";
+		}
+		ofs << std::endl << "      }" << std::endl << "    }";
+	}
+	ofs << std::endl << "  ]" << std::endl << "}" << std::endl;
+	ofs.close();
+}
+
+std::vector<rdma::PerfReport::Result> rdma::PerfReport::readJSON(std::string fileName){
+	std::ifstream ifs(fileName);
+	if(!ifs.good()) throw std::runtime_error("Could not read report '" + fileName + "'");
+	std::stringstream buffer;
+	buffer << ifs.rdbuf();
+	try {
+		return parseJSON(buffer.str());
+	} catch (const std::runtime_error &ex){
+		throw std::runtime_error("Report '" + fileName + "': " + ex.what());
+	}
+}
+
+std::vector<rdma::PerfReport::Result> rdma::PerfReport::parseJSON(const std::string &text, std::map<std::string, std::string> *environment){
+	JSONValue root = JSONParser(text).parse();
+
+	std::vector<Result> results;
+	const JSONValue *resultsValue = root.get("results");
+	if(resultsValue == nullptr || resultsValue->type != JSONValue::ARRAY){
+		throw std::runtime_error("Report contains no results");
+	}
+	for(const JSONValue &resultValue : resultsValue->array){
+		Result result;
+		result.test = resultValue.getString("test");
+		result.title = resultValue.getString("title");
+		result.parameters = resultValue.getString("parameters");
+		const JSONValue *metricsValue = resultValue.get("metrics");
+		if(metricsValue != nullptr){
+			for(auto &entry : metricsValue->object){
+				Metric metric;
+				metric.name = entry.first;
+				const JSONValue *samples = entry.second.get("samples");
+				if(samples != nullptr){
+					for(const JSONValue &sample : samples->array){
+						if(sample.type == JSONValue::NUMBER) metric.samples.push_back(sample.number);
+					}
+				}
+				const JSONValue *mean = entry.second.get("mean");
+				if(metric.samples.empty() && mean != nullptr && mean->type == JSONValue::NUMBER){
+					metric.samples.push_back(mean->number);
+				}
+				result.metrics.push_back(metric);
+			}
+		}
+		results.push_back(result);
+	}
+
+	const JSONValue *environmentValue = root.get("environment");
+	if(environment != nullptr && environmentValue != nullptr){
+		for(auto &entry : environmentValue->object){
+			if(entry.second.type == JSONValue::STRING) (*environment)[entry.first] = entry.second.str;
+		}
+	}
+	return results;
+}
+
+int rdma::PerfReport::getDirection(const std::string &metricName){
+	size_t open = metricName.rfind('['), close = metricName.rfind(']');
+	if(open == std::string::npos || close == std::string::npos || close < open) return 0;
+	std::string unit = metricName.substr(open+1, close-open-1);
+	if(unit.rfind("/s") == unit.length()-2 && unit.length() > 2) return 1; // MB/s, Op/s, ...
+	if(unit.rfind("/Op") == unit.length()-3 && unit.length() > 3) return -1; // costs per operation
+	if(unit == "usec" || unit == "Sec" || unit == "ns" || unit == "%") return -1;
+	return 0;
+}
+
+size_t rdma::PerfReport::compare(const std::vector<Result> &baseline, std::string thresholds, std::ostream &out){
+	// default threshold and thresholds per unit
+	long double defaultThreshold = 5;
+	std::map<std::string, long double> unitThresholds;
+	for(std::string threshold : StringHelper::split(thresholds, ",")){
+		threshold = StringHelper::trim(threshold);
+		if(threshold.empty()) continue;
+		size_t eq = threshold.find('=');
+		if(eq == std::string::npos){
+			defaultThreshold = std::stold(threshold);
+		} else {
+			unitThresholds[threshold.substr(0, eq)] = std::stold(threshold.substr(eq+1));
+		}
+	}
+
+	size_t regressions = 0, improvements = 0, compared = 0, missing = 0;
+	out << std::fixed << std::setprecision(3);
+	for(const Result &result : m_results){
+		const Result *base = nullptr;
+		for(const Result &b : baseline){
+			if(b.getKey() == result.getKey()){ base = &b; break; }
+		}
+		if(base == nullptr){ missing++; continue; }
+
+		for(const Metric &metric : result.metrics){
+			const int direction = getDirection(metric.name);
+			const Metric *baseMetric = base->getMetric(metric.name);
+			if(direction == 0 || baseMetric == nullptr || baseMetric->samples.empty() || metric.samples.empty()) continue;
+
+			const long double baseMean = baseMetric->getMean(), mean = metric.getMean();
+			if(baseMean == 0) continue;
+			compared++;
+
+			long double threshold = defaultThreshold;
+			size_t open = metric.name.rfind('['), close = metric.name.rfind(']');
+			auto unitIt = unitThresholds.find(metric.name.substr(open+1, close-open-1));
+			if(unitIt != unitThresholds.end()) threshold = unitIt->second;
+
+			// only significant if the confidence intervals don't overlap (single samples have none)
+			const long double change = (mean - baseMean) / std::fabs(baseMean) * 100;
+			const bool significant = std::fabs(mean - baseMean) > metric.getConfidence(m_confidence) + baseMetric->getConfidence(m_confidence);
+			if(!significant || std::fabs(change) <= threshold) continue;
+
+			const bool worse = (direction > 0 ? change < 0 : change > 0);
+			if(worse) regressions++; else improvements++;
+			out << (worse ? "REGRESSION   " : "IMPROVEMENT  ") << result.test << " (" << result.parameters << ")  " << metric.name << ":  ";
+			out << baseMean << " -> " << mean << "  (" << (change > 0 ? "+" : "") << change << "%, threshold " << threshold << "%)" << std::endl;
+		}
+	}
+	out << "Compared " << compared << " metrics of " << (m_results.size() - missing) << " tests with baseline: ";
+	out << regressions << " regressions, " << improvements << " improvements";
+	if(missing > 0) out << ", " << missing << " tests without baseline";
+	out << std::endl;
+	return regressions;
+}
+
+std::map<std::string, std::string> rdma::PerfReport::getEnvironment(){
+	std::map<std::string, std::string> environment;
+
+	char hostname[256];
+	if(gethostname(hostname, sizeof(hostname)) == 0){
+		hostname[sizeof(hostname)-1] = '\0';
+		environment["hostname"] = hostname;
+	}
+	struct utsname uts;
+	if(uname(&uts) == 0){
+		environment["kernel"] = std::string(uts.sysname) + " " + uts.release;
+		environment["architecture"] = uts.machine;
+	}
+
+	std::ifstream cpuinfo("/proc/cpuinfo");
+	std::string line;
+	while(std::getline(cpuinfo, line)){
+		if(line.rfind("model name", 0) == 0 && line.find(':') != std::string::npos){
+			std::string model = line.substr(line.find(':') + 1);
+			environment["cpu"] = StringHelper::trim(model);
+			break;
+		}
+	}
+	environment["cpu_count"] = std::to_string(std::thread::hardware_concurrency());
+	environment["git_revision"] = PERFTEST_GIT_REVISION;
+
+	// device is known after the first memory has been registered otherwise the first one of the NUMA node
+	std::string device = Config::RDMA_DEVICE_FILE_PATH;
+	if(device.empty()){
+		const std::string sysfs = "/sys/class/infiniband/";
+		DIR *dir = opendir(sysfs.c_str());
+		if(dir != nullptr){
+			struct dirent *entry;
+			while(device.empty() && (entry = readdir(dir)) != nullptr){
+				std::string name = entry->d_name;
+				if(name == "." || name == "..") continue;
+				if(readFirstLine(sysfs + name + "/device/numa_node") == std::to_string(Config::RDMA_NUMAREGION)) device = sysfs + name;
+			}
+			closedir(dir);
+		}
+	}
+	const std::string port = device + "/ports/" + std::to_string(Config::RDMA_IBPORT);
+	environment["rdma_device"] = (device.empty() ? "unknown" : Filehelper::getFileName(device));
+	environment["rdma_port"] = std::to_string(Config::RDMA_IBPORT);
+	environment["port_rate"] = (device.empty() ? "" : readFirstLine(port + "/rate"));
+	environment["link_layer"] = (device.empty() ? "" : readFirstLine(port + "/link_layer"));
+	environment["numa_node"] = std::to_string(Config::RDMA_NUMAREGION);
+	environment["interface"] = Config::RDMA_INTERFACE;
+	return environment;
+}
@@ -0,0 +1,107 @@
+#ifndef PerfReport_H
+#define PerfReport_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <ostream>
+
+namespace rdma {
+
+/* Class: PerfReport
+ * ----------------
+ * Machine-readable record of a perf_test run. Every test writes one CSV
+ * row (title with parameters, column names, values) and the report keeps
+ * these rows as metrics together with metadata of the host and stores
+ * them as JSON. Repetitions of the same test are aggregated, so every
+ * metric has its samples, mean, standard deviation and confidence interval.
+ *
+ * A report of an earlier run can be loaded as baseline to flag metrics
+ * that got worse by more than a threshold and whose confidence intervals
+ * don't overlap.
+ */
+class PerfReport {
+public:
+    struct Metric {
+        std::string name; // CSV column incl. unit, e.g. 'Write [MB/s]'
+        std::vector<long double> samples;
+
+        long double getMean() const;
+        long double getStdDev() const;
+        long double getConfidence(double level) const; // half width of the confidence interval of the mean
+    };
+
+    struct Result {
+        std::string test; // e.g. 'Bandwidth'
+        std::string title; // CSV title with the parameters
+        std::string parameters; // identifies the test together with its name
+        std::vector<Metric> metrics;
+
+        std::string getKey() const { return test + " | " + parameters; }
+        Metric* getMetric(const std::string &name);
+        const Metric* getMetric(const std::string &name) const;
+    };
+
+    PerfReport(std::string commandLine, double confidence);
+
+    /* Function: addResult
+     * ----------------
+     * Reads the CSV row a test wrote into the given file and
+     * adds its values as samples of the result with the same
+     * test name and parameters.
+     *
+     * return:  false if file contains no result
+     */
+    bool addResult(std::string test, std::string parameters, std::string csvFileName);
+
+    /* Function: addResults
+     * ----------------
+     * Adds the results of another node (see parseJSON) whose
+     * parameters are extended by the node, so that the same
+     * test of different nodes are separate results.
+     */
+    void addResults(const std::vector<Result> &results, std::string node);
+    void addNode(std::string node, const std::map<std::string, std::string> &environment);
+
+    void writeJSON(std::string fileName);
+
+    /* Function: compare
+     * ----------------
+     * Compares every metric that has a direction with the same
+     * metric of the baseline and prints the regressions.
+     *
+     * baseline:    results of an earlier report (see readJSON)
+     * thresholds:  allowed change in percent, either a number
+     *              or per unit like '5,usec=10,%=1' where the
+     *              unit is matched inside the brackets of a metric
+     *
+     * return:  number of regressions
+     */
+    size_t compare(const std::vector<Result> &baseline, std::string thresholds, std::ostream &out);
+
+    std::vector<Result>& getResults(){ return m_results; }
+
+    static std::vector<Result> readJSON(std::string fileName);
+    static std::vector<Result> parseJSON(const std::string &text, std::map<std::string, std::string> *environment = nullptr);
+
+    /* Function: getDirection
+     * ----------------
+     * Derived from the unit of a metric: rates are better if
+     * higher (1), times, percentages and costs per operation if
+     * lower (-1). Metrics like sizes are not compared (0).
+     */
+    static int getDirection(const std::string &metricName);
+
+    static std::map<std::string, std::string> getEnvironment();
+
+private:
+    std::string m_commandLine;
+    std::string m_started;
+    double m_confidence;
+    std::vector<Result> m_results;
+    std::map<std::string, std::map<std::string, std::string>> m_nodes; // environment of other nodes
+};
+
+}
+
+#endif
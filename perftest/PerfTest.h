@@ -4,6 +4,8 @@
 #include "../src/rdma/ReliableRDMA.h"
 #include "../src/rdma/RDMAClient.h"
 #include "../src/rdma/RDMAServer.h"
+#include "LatencyHistogram.h"
+#include "PerfEvent.h"
 #include <string>
 #include <sstream>
 #include <iomanip>
@@ -11,10 +13,12 @@
 #include <fstream>
 #include <cmath>
 #include <chrono>
+#include <vector>
+#include <memory>
 
 namespace rdma {
 
-enum TestOperation { WRITE_OPERATION=1, READ_OPERATION=2, SEND_RECEIVE_OPERATION=4, FETCH_ADD_OPERATION=8, COMPARE_SWAP_OPERATION=16 };
+enum TestOperation { WRITE_OPERATION=1, READ_OPERATION=2, SEND_RECEIVE_OPERATION=4, FETCH_ADD_OPERATION=8, COMPARE_SWAP_OPERATION=16, MULTICAST_OPERATION=32 };
 enum WriteMode { WRITE_MODE_AUTO=0x00, WRITE_MODE_NORMAL=0x01, WRITE_MODE_IMMEDIATE=0x02 };
 const int ATOMICS_SIZE = 8; // 8 bytes = 64bit
 const uint64_t NANO_SEC = 1000000000;
@@ -31,6 +35,8 @@ protected:
 
 public:
     int testOperations;
+    std::string histogramFileName; // if set then latency tests append their full histograms
+    bool perfEvents = false; // if set then the client threads are measured with hardware counters per operation
 
     virtual ~PerfTest() = default;
 
@@ -46,6 +52,107 @@ public:
         return testOperations == (testOperations | (int)op);
     }
 
+    static std::string getOperationName(TestOperation op){
+        switch(op){
+            case WRITE_OPERATION: return "Write";
+            case READ_OPERATION: return "Read";
+            case SEND_RECEIVE_OPERATION: return "Send/Recv";
+            case FETCH_ADD_OPERATION: return "Fetch&Add";
+            case COMPARE_SWAP_OPERATION: return "Comp&Swap";
+            case MULTICAST_OPERATION: return "Multicast";
+        } return "???";
+    }
+
+    /* Function: getPerfEventsResults
+     * ----------------
+     * Hardware counters and CPU time per operation of every
+     * measured test phase for the console (empty if none)
+     */
+    std::string getPerfEventsResults(){
+        std::ostringstream oss;
+        oss << rdma::CONSOLE_PRINT_NOTATION << std::setprecision(2);
+        for(const PerfEventsResult &result : m_perfEventsResults){
+            oss << " - " << std::left << std::setw(11) << (result.operation + ":") << std::right;
+            for(size_t i=0; i<PerfEvent::COUNTER_COUNT; i++){
+                oss << PerfEvent::COUNTER_NAMES[i] << "/op = " << result.perOperation(result.counters[i]) << "   ";
+            }
+            oss << "IPC = " << result.getIPC() << "   CPU = " << result.getUtilization() << "% per thread (" << convertTime((long double)result.getCPUTime()*1000) << "/op)" << std::endl;
+        } return oss.str();
+    }
+
+protected:
+    struct PerfEventsResult {
+        std::string operation;
+        uint64_t operations;
+        size_t threads;
+        double counters[PerfEvent::COUNTER_COUNT];
+        double duration, userTime, systemTime; // seconds
+
+        double perOperation(double counter) const { return (counter < 0 ? -1 : counter / (operations > 0 ? operations : 1)); }
+        double getIPC() const { return (counters[PerfEvent::CYCLES] > 0 ? counters[PerfEvent::INSTRUCTIONS] / counters[PerfEvent::CYCLES] : -1); }
+        double getUtilization() const { return (duration > 0 ? (userTime + systemTime) / (duration * threads) * 100 : 0); } // percent of one core per thread
+        double getCPUTime() const { return perOperation((userTime + systemTime) * 1000000); } // microseconds per operation
+    };
+    std::vector<PerfEventsResult> m_perfEventsResults;
+    std::unique_ptr<PerfEvent> m_perfEvent;
+
+    /* Function: preparePerfEvents, startPerfEvents, stopPerfEvents
+     * ----------------
+     * Measure one test phase if perfEvents is set. Counters are only inherited
+     * by threads started afterwards, so prepare has to be called before the
+     * client threads get started while start and stop enclose runThreads()
+     *
+     * op:          operation of the test phase (or name of a mixed phase)
+     * operations:  how many operations all threads performed together
+     * threads:     how many client threads performed them
+     */
+    void preparePerfEvents(){
+        if(perfEvents) m_perfEvent.reset(new PerfEvent());
+    }
+    void startPerfEvents(){
+        if(m_perfEvent) m_perfEvent->start();
+    }
+    void stopPerfEvents(TestOperation op, uint64_t operations, size_t threads){
+        stopPerfEvents(getOperationName(op), operations, threads);
+    }
+    void stopPerfEvents(std::string op, uint64_t operations, size_t threads){
+        if(!m_perfEvent) return;
+        m_perfEvent->stop();
+        PerfEventsResult result;
+        result.operation = op;
+        result.operations = operations;
+        result.threads = threads;
+        for(size_t i=0; i<PerfEvent::COUNTER_COUNT; i++){
+            result.counters[i] = m_perfEvent->getCounter((PerfEvent::Counter)i);
+        }
+        result.duration = m_perfEvent->getDuration();
+        result.userTime = m_perfEvent->getUserTime();
+        result.systemTime = m_perfEvent->getSystemTime();
+        m_perfEventsResults.push_back(result);
+        m_perfEvent.reset();
+    }
+
+    // appended to the CSV header and row of a test if perfEvents is set
+    void writePerfEventsCSVHeader(std::ofstream &ofs){
+        for(const PerfEventsResult &result : m_perfEventsResults){
+            for(size_t i=0; i<PerfEvent::COUNTER_COUNT; i++){
+                ofs << ", " << result.operation << " " << PerfEvent::COUNTER_NAMES[i] << " [count/Op]";
+            }
+            ofs << ", " << result.operation << " IPC, " << result.operation << " CPU [%], " << result.operation << " CPU [usec/Op]";
+        }
+    }
+    void writePerfEventsCSV(std::ofstream &ofs){
+        for(const PerfEventsResult &result : m_perfEventsResults){
+            for(size_t i=0; i<PerfEvent::COUNTER_COUNT; i++){
+                ofs << ", " << (round(result.perOperation(result.counters[i]) * 100)/100.0);
+            }
+            ofs << ", " << (round(result.getIPC() * 1000)/1000.0) << ", " << (round(result.getUtilization() * 100)/100.0);
+            ofs << ", " << (round(result.getCPUTime() * 1000)/1000.0);
+        }
+    }
+
+public:
+
     static std::chrono::high_resolution_clock::time_point startTimer(){
         return std::chrono::high_resolution_clock::now();
     }
@@ -154,6 +261,29 @@ public:
         } oss << nanoseconds << "ns"; return oss.str();
     }
 
+    static std::string convertPercentiles(const LatencyHistogram &histogram){
+        std::ostringstream oss;
+        oss << "                   ";
+        for(size_t i=0; i<sizeof(LatencyHistogram::PERCENTILES)/sizeof(double); i++){
+            std::string name = LatencyHistogram::PERCENTILE_NAMES[i];
+            name[0] = 'p';
+            oss << " " << name << " = " << convertTime(histogram.getPercentile(LatencyHistogram::PERCENTILES[i])) << "   ";
+        } return oss.str();
+    }
+
+    static void writePercentilesCSVHeader(std::ofstream &ofs, std::string operation){
+        for(size_t i=0; i<sizeof(LatencyHistogram::PERCENTILES)/sizeof(double); i++){
+            ofs << ", " << LatencyHistogram::PERCENTILE_NAMES[i] << " " << operation << " [usec]";
+        }
+    }
+
+    static void writePercentilesCSV(std::ofstream &ofs, const LatencyHistogram &histogram){
+        const long double ustu = 1000; // nanosec to microsec
+        for(size_t i=0; i<sizeof(LatencyHistogram::PERCENTILES)/sizeof(double); i++){
+            ofs << ", " << (round(histogram.getPercentile(LatencyHistogram::PERCENTILES[i])/ustu * 10)/10.0);
+        }
+    }
+
     static std::string convertByteSize(uint64_t bytes){
         std::ostringstream oss;
         long double b = (long double) bytes;
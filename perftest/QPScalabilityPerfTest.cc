@@ -0,0 +1,314 @@
+#include "QPScalabilityPerfTest.h"
+
+#include "../src/memory/BaseMemory.h"
+#include "../src/memory/MainMemory.h"
+#include "../src/memory/CudaMemory.h"
+#include "../src/utils/Config.h"
+
+#include <random>
+
+mutex rdma::QPScalabilityPerfTest::waitLock;
+condition_variable rdma::QPScalabilityPerfTest::waitCv;
+bool rdma::QPScalabilityPerfTest::signaled;
+size_t rdma::QPScalabilityPerfTest::client_count;
+size_t rdma::QPScalabilityPerfTest::thread_count;
+
+/*	LT: Local Thread, Q: Queue Pair, S: Amount of Servers
+ *
+ *	Client Memory:	LT1{ Write Packet, Read Packet }, LT2{ ... }, ...
+ *	Server Memory:	Packet (accessed by all QPs of all client threads)
+ *
+ *	Every client thread opens its share of the QPs to each server: the first one
+ *	by connecting the client, the others with a reserved connection id. All operations
+ *	access the same remote packet, so only the amount of QPs changes.
+ */
+
+
+rdma::QPScalabilityPerfClientThread::QPScalabilityPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t packet_size, size_t qps_per_server, size_t iterations_per_thread) {
+	this->m_client = new RDMAClient<ReliableRDMA>(memory, "QPScalabilityPerfTestClient", ownIpPort, sequencerIpPort);
+	this->m_rdma_addresses = rdma_addresses;
+	this->m_packet_size = packet_size;
+	this->m_qps_per_server = qps_per_server;
+	this->m_iterations_per_thread = iterations_per_thread;
+
+	// QPs are opened one after another, so the setup time of a QP doesn't include waiting for other threads
+	auto setupStart = rdma::PerfTest::startTimer();
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		NodeID nodeId = 0;
+		string conn = m_rdma_addresses[i];
+		auto start = rdma::PerfTest::startTimer();
+		if(!m_client->connect(conn, nodeId)) {
+			std::cerr << "QPScalabilityPerfThread::QPScalabilityPerfThread(): Could not connect to '" << conn << "'" << std::endl;
+			throw invalid_argument("QPScalabilityPerfThread connection failed");
+		}
+		m_setupHistogram.record(rdma::PerfTest::stopTimer(start));
+		m_conns.push_back(nodeId);
+
+		for(size_t q = 1; q < m_qps_per_server; q++){
+			NodeID connId = 0;
+			start = rdma::PerfTest::startTimer();
+			if(!m_client->connectAdditionalQP(nodeId, connId)) {
+				std::cerr << "QPScalabilityPerfThread::QPScalabilityPerfThread(): Could not open QP " << (q+1) << " to '" << conn << "'" << std::endl;
+				throw invalid_argument("QPScalabilityPerfThread connection failed");
+			}
+			m_setupHistogram.record(rdma::PerfTest::stopTimer(start));
+			m_conns.push_back(connId);
+		}
+	}
+	m_setupNs = rdma::PerfTest::stopTimer(setupStart);
+
+	m_local_memory = m_client->localMalloc(m_packet_size * 2);
+	m_local_memory->openContext();
+	m_local_memory->setMemory(1);
+}
+
+rdma::QPScalabilityPerfClientThread::~QPScalabilityPerfClientThread() {
+	delete m_local_memory; // implicitly deletes local allocs in RDMAClient
+	delete m_client;
+}
+
+void rdma::QPScalabilityPerfClientThread::run() {
+	rdma::PerfTest::global_barrier_client(m_client, m_conns); // global barrier over all QPs
+	unique_lock<mutex> lck(QPScalabilityPerfTest::waitLock); // local barrier
+	if (!QPScalabilityPerfTest::signaled) {
+		m_ready = true;
+		QPScalabilityPerfTest::waitCv.wait(lck);
+	}
+	lck.unlock();
+	m_ready = false;
+
+	std::random_device seeds;
+	std::mt19937_64 generator(((uint64_t)seeds() << 32) | seeds());
+	std::uniform_int_distribution<size_t> qps(0, m_conns.size() - 1);
+
+	for(size_t op = 0; op < QP_SCALABILITY_OPERATION_COUNT; op++){
+		auto start = rdma::PerfTest::startTimer();
+		for(size_t i = 0; i < m_iterations_per_thread; i++){
+			const NodeID conn = m_conns[qps(generator)];
+			auto opStart = rdma::PerfTest::startTimer();
+			if(QP_SCALABILITY_OPERATIONS[op] == WRITE_OPERATION){
+				m_client->write(conn, 0, m_local_memory->pointer(), m_packet_size, true); // true=signaled
+			} else {
+				m_client->read(conn, 0, m_local_memory->pointer(m_packet_size), m_packet_size, true); // true=signaled
+			}
+			m_histograms[op].record(rdma::PerfTest::stopTimer(opStart));
+		}
+		m_elapsedNs[op] = rdma::PerfTest::stopTimer(start);
+	}
+}
+
+
+
+rdma::QPScalabilityPerfTest::QPScalabilityPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t packet_size, uint64_t qp_count, uint64_t iterations_per_thread) : PerfTest((int)WRITE_OPERATION | (int)READ_OPERATION){
+	if(qp_count < (uint64_t)thread_count) throw invalid_argument("QPScalabilityPerfTest requires at least one QP per thread");
+	this->m_qps_per_thread = qp_count / thread_count; // remainder is dropped so that every thread has the same amount of QPs
+	if(is_server) thread_count *= client_count;
+
+	this->m_is_server = is_server;
+	this->m_rdma_port = rdma_port;
+	this->m_ownIpPort = ownIpPort;
+	this->m_sequencerIpPort = sequencerIpPort;
+	this->m_local_gpu_index = local_gpu_index;
+	this->m_actual_gpu_index = -1;
+	this->m_remote_gpu_index = remote_gpu_index;
+	this->client_count = client_count;
+	this->thread_count = thread_count;
+	this->m_packet_size = packet_size;
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_rdma_addresses = rdma_addresses;
+	this->m_memory_size = (is_server ? packet_size : thread_count * packet_size * 2); // write and read packet per thread
+}
+rdma::QPScalabilityPerfTest::~QPScalabilityPerfTest(){
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		delete m_client_threads[i];
+	}
+	m_client_threads.clear();
+	if(m_is_server)
+		delete m_server;
+	delete m_memory;
+}
+
+std::string rdma::QPScalabilityPerfTest::getTestParameters(bool forCSV){
+	std::ostringstream oss;
+	oss << (m_is_server ? "Server" : "Client") << ", threads=" << thread_count;
+	oss << ", qps=" << (m_qps_per_thread * thread_count) << (m_is_server ? "" : " per server");
+	if(!forCSV){
+		oss << " (" << m_qps_per_thread << " per thread)";
+		oss << ", packetsize=" << m_packet_size;
+		oss << ", memory=" << m_memory_size;
+	}
+	oss << ", memory_type=" << getMemoryName(m_local_gpu_index, m_actual_gpu_index) << (m_remote_gpu_index!=-404 ? "->"+getMemoryName(m_remote_gpu_index) : "");
+	oss << ", iterations=" << (m_iterations_per_thread*thread_count);
+	if(!forCSV){ oss << ", clients=" << client_count << ", servers=" << m_rdma_addresses.size(); }
+	return oss.str();
+}
+std::string rdma::QPScalabilityPerfTest::getTestParameters(){
+	return getTestParameters(false);
+}
+
+void rdma::QPScalabilityPerfTest::makeThreadsReady(){
+	QPScalabilityPerfTest::signaled = false;
+	if(m_is_server){
+		rdma::PerfTest::global_barrier_server(m_server, (size_t)(thread_count * m_qps_per_thread)); // every QP takes part in the barrier
+	} else {
+		for(QPScalabilityPerfClientThread* perfThread : m_client_threads){ perfThread->start(); }
+		for(QPScalabilityPerfClientThread* perfThread : m_client_threads){ while(!perfThread->ready()) usleep(Config::RDMA_SLEEP_INTERVAL); }
+	}
+}
+
+void rdma::QPScalabilityPerfTest::runThreads(){
+	QPScalabilityPerfTest::signaled = false;
+	unique_lock<mutex> lck(QPScalabilityPerfTest::waitLock);
+	QPScalabilityPerfTest::waitCv.notify_all();
+	QPScalabilityPerfTest::signaled = true;
+	lck.unlock();
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		m_client_threads[i]->join();
+	}
+}
+
+void rdma::QPScalabilityPerfTest::setupTest(){
+	m_actual_gpu_index = -1;
+	#ifdef CUDA_ENABLED /* defined in CMakeLists.txt to globally enable/disable CUDA support */
+		if(m_local_gpu_index <= -3){
+			m_memory = new rdma::MainMemory(m_memory_size);
+		} else {
+			rdma::CudaMemory *mem = new rdma::CudaMemory(m_memory_size, m_local_gpu_index);
+			m_memory = mem;
+			m_actual_gpu_index = mem->getDeviceIndex();
+		}
+	#else
+		m_memory = (rdma::BaseMemory*)new MainMemory(m_memory_size);
+	#endif
+
+	if(m_is_server){
+		// Server
+		m_memory->setMemory(0);
+		m_server = new RDMAServer<ReliableRDMA>("QPScalabilityTestRDMAServer", m_rdma_port, Network::getAddressOfConnection(m_ownIpPort), m_memory, m_sequencerIpPort);
+
+	} else {
+		// Client
+		for (size_t i = 0; i < thread_count; i++) {
+			QPScalabilityPerfClientThread* perfThread = new QPScalabilityPerfClientThread(m_memory, m_rdma_addresses, m_ownIpPort, m_sequencerIpPort, m_packet_size, m_qps_per_thread, m_iterations_per_thread);
+			m_client_threads.push_back(perfThread);
+		}
+	}
+}
+
+void rdma::QPScalabilityPerfTest::runTest(){
+	if(m_is_server){
+		// Server
+		std::cout << "Starting server on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "' . . ." << std::endl;
+		if(!m_server->startServer()){
+			std::cerr << "QPScalabilityPerfTest::runTest(): Could not start server" << std::endl;
+			throw invalid_argument("QPScalabilityPerfTest server startup failed");
+		} else {
+			std::cout << "Server running on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "'" << std::endl;
+		}
+
+		makeThreadsReady();
+		runThreads();
+
+		// wait until clients have finished
+		while (m_server->isRunning() && m_server->getConnectedConnIDs().size() > 0) usleep(Config::RDMA_SLEEP_INTERVAL);
+		std::cout << "Server stopped" << std::endl;
+
+	} else {
+		// Client
+		preparePerfEvents();
+		makeThreadsReady();
+		startPerfEvents();
+		runThreads();
+		stopPerfEvents("QPScalability", m_iterations_per_thread * thread_count * QP_SCALABILITY_OPERATION_COUNT, thread_count);
+	}
+}
+
+
+std::string rdma::QPScalabilityPerfTest::getTestResults(std::string csvFileName, bool csvAddHeader){
+	if(m_is_server){
+		return "only client";
+	} else {
+
+		// threads recorded into their own histograms, throughputs are the sum of the rates of the threads
+		const long double tu = (long double)NANO_SEC; // 1sec (nano to seconds as time unit)
+		LatencyHistogram setupHistogram, histograms[QP_SCALABILITY_OPERATION_COUNT];
+		long double opsPerSec[QP_SCALABILITY_OPERATION_COUNT] = { 0 };
+		int64_t setupNs = 0;
+		for(size_t i=0; i<m_client_threads.size(); i++){
+			setupHistogram.merge(m_client_threads[i]->m_setupHistogram);
+			setupNs += m_client_threads[i]->m_setupNs;
+			for(size_t op = 0; op < QP_SCALABILITY_OPERATION_COUNT; op++){
+				histograms[op].merge(m_client_threads[i]->m_histograms[op]);
+				if(m_client_threads[i]->m_elapsedNs[op] > 0) opsPerSec[op] += m_iterations_per_thread * tu / m_client_threads[i]->m_elapsedNs[op];
+			}
+		}
+		const uint64_t qps = setupHistogram.getCount();
+
+		// write results into CSV file
+		if(!csvFileName.empty()){
+			const long double ustu = 1000; // nanosec to microsec
+			std::ofstream ofs;
+			ofs.open(csvFileName, std::ofstream::out | std::ofstream::app);
+			ofs << rdma::CSV_PRINT_NOTATION << rdma::CSV_PRINT_PRECISION;
+			if(csvAddHeader){
+				ofs << std::endl << "QP SCALABILITY, " << getTestParameters(true) << std::endl;
+				ofs << "QPs, PacketSize [Bytes], Setup [QP/s], Avg Setup [usec], Median Setup [usec], Min Setup [usec], Max Setup [usec]";
+				rdma::PerfTest::writePercentilesCSVHeader(ofs, "Setup");
+				for(size_t op = 0; op < QP_SCALABILITY_OPERATION_COUNT; op++){
+					std::string name = QP_SCALABILITY_OPERATION_NAMES[op];
+					ofs << ", " << name << " [Op/s], Avg " << name << " [usec], Median " << name << " [usec], Min " << name << " [usec], Max " << name << " [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, name);
+				}
+				writePerfEventsCSVHeader(ofs);
+				ofs << std::endl;
+			}
+			ofs << qps << ", " << m_packet_size << ", " << round(qps*tu/setupNs) << ", "; // QPs, packet size Bytes, QP/s
+			ofs << (round(setupHistogram.getAverage()/ustu * 10)/10.0) << ", "; // avg us
+			ofs << (round(setupHistogram.getMedian()/ustu * 10)/10.0) << ", "; // median us
+			ofs << (round(setupHistogram.getMin()/ustu * 10)/10.0) << ", "; // min us
+			ofs << (round(setupHistogram.getMax()/ustu * 10)/10.0); // max us
+			rdma::PerfTest::writePercentilesCSV(ofs, setupHistogram);
+			for(size_t op = 0; op < QP_SCALABILITY_OPERATION_COUNT; op++){
+				ofs << ", " << round(opsPerSec[op]) << ", "; // Op/s
+				ofs << (round(histograms[op].getAverage()/ustu * 10)/10.0) << ", "; // avg us
+				ofs << (round(histograms[op].getMedian()/ustu * 10)/10.0) << ", "; // median us
+				ofs << (round(histograms[op].getMin()/ustu * 10)/10.0) << ", "; // min us
+				ofs << (round(histograms[op].getMax()/ustu * 10)/10.0); // max us
+				rdma::PerfTest::writePercentilesCSV(ofs, histograms[op]);
+			}
+			writePerfEventsCSV(ofs);
+			ofs << std::endl; ofs.close();
+		}
+
+		// write full histograms
+		if(!histogramFileName.empty()){
+			std::ofstream ofs;
+			ofs.open(histogramFileName, std::ofstream::out | std::ofstream::app);
+			ofs << std::endl << "QP SCALABILITY HISTOGRAM, " << getTestParameters(true) << ", packetsize=" << m_packet_size << std::endl;
+			LatencyHistogram::writeBucketsHeader(ofs);
+			setupHistogram.writeBuckets(ofs, "Setup");
+			for(size_t op = 0; op < QP_SCALABILITY_OPERATION_COUNT; op++){
+				histograms[op].writeBuckets(ofs, QP_SCALABILITY_OPERATION_NAMES[op]);
+			}
+			ofs.close();
+		}
+
+		// generate result string
+		std::ostringstream oss;
+		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
+		oss << "Setup of " << qps << " QPs measured per QP, operations as 'round-trip time' latency on a random QP:" << std::endl;
+		oss << " - Setup:     QPs = " << rdma::PerfTest::convertCountPerSec(qps*tu/setupNs);
+		oss << "    average = " << rdma::PerfTest::convertTime(setupHistogram.getAverage()) << "    median = " << rdma::PerfTest::convertTime(setupHistogram.getMedian());
+		oss << "    range = " <<  rdma::PerfTest::convertTime(setupHistogram.getMin()) << " - " << rdma::PerfTest::convertTime(setupHistogram.getMax()) << std::endl;
+		oss << rdma::PerfTest::convertPercentiles(setupHistogram) << std::endl;
+		for(size_t op = 0; op < QP_SCALABILITY_OPERATION_COUNT; op++){
+			std::string name = std::string(QP_SCALABILITY_OPERATION_NAMES[op]) + ":";
+			oss << " - " << std::left << std::setw(11) << name << std::right << "operations = " << rdma::PerfTest::convertCountPerSec(opsPerSec[op]);
+			oss << "    average = " << rdma::PerfTest::convertTime(histograms[op].getAverage()) << "    median = " << rdma::PerfTest::convertTime(histograms[op].getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(histograms[op].getMin()) << " - " << rdma::PerfTest::convertTime(histograms[op].getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(histograms[op]) << std::endl;
+		}
+		return oss.str();
+	}
+	return NULL;
+}
@@ -0,0 +1,97 @@
+#ifndef QPScalabilityPerfTest_H
+#define QPScalabilityPerfTest_H
+
+#include "PerfTest.h"
+#include "LatencyHistogram.h"
+#include "../src/memory/LocalBaseMemoryStub.h"
+#include "../src/rdma/RDMAClient.h"
+#include "../src/rdma/RDMAServer.h"
+#include "../src/thread/Thread.h"
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+namespace rdma {
+
+const size_t QP_SCALABILITY_OPERATION_COUNT = 2;
+const TestOperation QP_SCALABILITY_OPERATIONS[QP_SCALABILITY_OPERATION_COUNT] = { WRITE_OPERATION, READ_OPERATION };
+const char* const QP_SCALABILITY_OPERATION_NAMES[QP_SCALABILITY_OPERATION_COUNT] = { "Write", "Read" };
+
+
+/* Class: QPScalabilityPerfClientThread
+ * ----------------
+ * Opens its share of the QPs to every server and measures how long
+ * the setup of each QP takes (connection id reservation and QP info exchange via the
+ * control plane as well as the state transitions to RTS). Afterwards
+ * every operation is issued on a QP picked at random from all QPs of
+ * the thread, so the NIC has to switch QP contexts all the time.
+ */
+class QPScalabilityPerfClientThread : public Thread {
+public:
+	QPScalabilityPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t packet_size, size_t qps_per_server, size_t iterations_per_thread);
+	~QPScalabilityPerfClientThread();
+	void run();
+	bool ready() {
+		return m_ready;
+	}
+
+	// recorded without locking per QP or operation, merged after run
+	LatencyHistogram m_setupHistogram;
+	LatencyHistogram m_histograms[QP_SCALABILITY_OPERATION_COUNT];
+	int64_t m_setupNs = 0;
+	int64_t m_elapsedNs[QP_SCALABILITY_OPERATION_COUNT] = { 0 };
+
+private:
+	bool m_ready = false;
+	RDMAClient<ReliableRDMA> *m_client;
+	LocalBaseMemoryStub *m_local_memory;
+	size_t m_packet_size;
+	size_t m_qps_per_server;
+	size_t m_iterations_per_thread;
+	std::vector<std::string> m_rdma_addresses;
+	std::vector<NodeID> m_conns; // connection ids of all QPs
+};
+
+
+class QPScalabilityPerfTest : public rdma::PerfTest {
+public:
+	QPScalabilityPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t packet_size, uint64_t qp_count, uint64_t iterations_per_thread);
+	virtual ~QPScalabilityPerfTest();
+	std::string getTestParameters();
+	void setupTest();
+	void runTest();
+	std::string getTestResults(std::string csvFileName="", bool csvAddHeader=true);
+
+	static mutex waitLock;
+	static condition_variable waitCv;
+	static bool signaled;
+	static size_t thread_count, client_count;
+
+private:
+	bool m_is_server;
+	std::vector<std::string> m_rdma_addresses;
+	int m_rdma_port;
+	std::string m_ownIpPort;
+	std::string m_sequencerIpPort;
+	int m_local_gpu_index;
+	int m_actual_gpu_index;
+	int m_remote_gpu_index;
+	uint64_t m_packet_size;
+	uint64_t m_qps_per_thread; // per server
+	uint64_t m_memory_size;
+	uint64_t m_iterations_per_thread;
+	std::vector<QPScalabilityPerfClientThread*> m_client_threads;
+
+	BaseMemory *m_memory;
+	RDMAServer<ReliableRDMA>* m_server;
+
+	std::string getTestParameters(bool forCSV);
+	void makeThreadsReady();
+	void runThreads();
+};
+
+}
+
+#endif
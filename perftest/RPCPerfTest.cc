@@ -0,0 +1,349 @@
+#include "RPCPerfTest.h"
+
+#include "../src/memory/BaseMemory.h"
+#include "../src/memory/MainMemory.h"
+#include "../src/utils/Config.h"
+
+mutex rdma::RPCPerfTest::waitLock;
+condition_variable rdma::RPCPerfTest::waitCv;
+bool rdma::RPCPerfTest::signaled;
+size_t rdma::RPCPerfTest::client_count;
+size_t rdma::RPCPerfTest::thread_count;
+
+/*	LT: Local Thread, C: Connection, O: Outstanding Slot, Q: Request, P: Response
+ *
+ *	Client Memory:	LT1{ C1[ Q(O1, O2, ...), P(O1, O2, ...) ], C2[ ... ], ... }, LT2{ ... }, ...
+ *	Server Memory:	Q(Receive1, Receive2, ...), Intermediate Q, P(Receive1, Receive2, ...)
+ *
+ *	Requests and responses are always in main memory because the
+ *	RPC handler and the clients access the request id with the CPU.
+ */
+
+
+rdma::RPCPerfHandlerThread::RPCPerfHandlerThread(RDMAServer<ReliableRDMA> *server, size_t request_size, size_t response_size, size_t max_messages, size_t expected_barrier_count) :
+		RPCVoidHandlerThread<ReliableRDMA>(server, RPCPerfTest::messageSize(request_size), max_messages){
+	this->m_response_size = RPCPerfTest::messageSize(response_size);
+	this->m_expected_barrier_count = expected_barrier_count;
+	this->m_responses = (char*)server->localAlloc(m_response_size * max_messages);
+	memset(m_responses, 0, m_response_size * max_messages);
+}
+
+rdma::RPCPerfHandlerThread::~RPCPerfHandlerThread() {
+	m_rdmaServer->localFree(m_responses);
+}
+
+void rdma::RPCPerfHandlerThread::handleRDMARPCVoid(void *message, NodeID &returnAdd){
+	uint64_t id = *(uint64_t*)message;
+	if(id != RPCPerfTest::BARRIER_ID){
+		respond(returnAdd, id);
+		return;
+	}
+
+	// answer the barrier requests as soon as every client thread sent one
+	m_barrier.push_back(returnAdd);
+	if(m_barrier.size() < m_expected_barrier_count) return;
+	for(NodeID &nodeID : m_barrier){
+		respond(nodeID, id);
+	}
+	m_barrier.clear();
+}
+
+void rdma::RPCPerfHandlerThread::respond(NodeID &returnAdd, uint64_t id){
+	char *response = m_responses + (m_response_idx % m_maxNumberMsgs) * m_response_size;
+	m_response_idx++;
+	*(uint64_t*)response = id;
+	m_rdmaServer->send(returnAdd, response, m_response_size, false); // false=unsignaled
+}
+
+
+
+rdma::RPCPerfClientThread::RPCPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t request_size, size_t response_size, size_t outstanding, size_t iterations_per_thread) {
+	this->m_client = new RDMAClient<ReliableRDMA>(memory, "RPCPerfTestClient", ownIpPort, sequencerIpPort);
+	this->m_rdma_addresses = rdma_addresses;
+	this->m_request_size = RPCPerfTest::messageSize(request_size);
+	this->m_response_size = RPCPerfTest::messageSize(response_size);
+	this->m_outstanding = outstanding;
+	this->m_memory_size_per_connection = (m_request_size + m_response_size) * outstanding;
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_sendTimes.resize(rdma_addresses.size() * outstanding);
+	this->m_issued.resize(rdma_addresses.size(), 0);
+	this->m_completed.resize(rdma_addresses.size(), 0);
+
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		NodeID nodeId = 0;
+		string conn = m_rdma_addresses[i];
+		if(!m_client->connect(conn, nodeId)) {
+			std::cerr << "RPCPerfThread::RPCPerfThread(): Could not connect to '" << conn << "'" << std::endl;
+			throw invalid_argument("RPCPerfThread connection failed");
+		}
+		m_addr.push_back(nodeId);
+	}
+
+	m_local_memory = m_client->localMalloc(m_memory_size_per_connection * m_rdma_addresses.size());
+	m_local_memory->openContext();
+	m_local_memory->setMemory(0);
+}
+
+rdma::RPCPerfClientThread::~RPCPerfClientThread() {
+	delete m_local_memory; // implicitly deletes local allocs in RDMAClient
+	delete m_client;
+}
+
+char* rdma::RPCPerfClientThread::requestPointer(size_t connIdx, uint64_t id){
+	return (char*)m_local_memory->pointer(connIdx * m_memory_size_per_connection + (id % m_outstanding) * m_request_size);
+}
+
+char* rdma::RPCPerfClientThread::responsePointer(size_t connIdx, size_t receiveIdx){
+	return (char*)m_local_memory->pointer(connIdx * m_memory_size_per_connection + m_outstanding * m_request_size + (receiveIdx % m_outstanding) * m_response_size);
+}
+
+void rdma::RPCPerfClientThread::sendRequest(size_t connIdx, uint64_t id, bool signaled){
+	// slot of the request id-outstanding is free because its response already arrived
+	char *request = requestPointer(connIdx, id);
+	*(uint64_t*)request = id;
+	m_sendTimes[connIdx * m_outstanding + id % m_outstanding] = std::chrono::high_resolution_clock::now();
+	m_client->send(m_addr[connIdx], request, m_request_size, signaled);
+}
+
+void rdma::RPCPerfClientThread::run() {
+	// responses of a connection fill the posted receives in order
+	for(size_t connIdx = 0; connIdx < m_addr.size(); connIdx++){
+		for(size_t i = 0; i < m_outstanding; i++){
+			m_client->receive(m_addr[connIdx], responsePointer(connIdx, i), m_response_size);
+		}
+	}
+
+	// global barrier through the RPC handler, its response takes the first receive
+	for(size_t connIdx = 0; connIdx < m_addr.size(); connIdx++){
+		sendRequest(connIdx, RPCPerfTest::BARRIER_ID, true); // true=signaled
+	}
+	for(size_t connIdx = 0; connIdx < m_addr.size(); connIdx++){
+		m_client->pollReceive(m_addr[connIdx], true); // true=poll
+		m_client->receive(m_addr[connIdx], responsePointer(connIdx, 0), m_response_size);
+	}
+
+	unique_lock<mutex> lck(RPCPerfTest::waitLock); // local barrier
+	if (!RPCPerfTest::signaled) {
+		m_ready = true;
+		RPCPerfTest::waitCv.wait(lck);
+	}
+	lck.unlock();
+	m_ready = false;
+
+	size_t issued = 0, completed = 0;
+	auto start = rdma::PerfTest::startTimer();
+	for(size_t i = 0; i < m_outstanding; i++){
+		for(size_t connIdx = 0; connIdx < m_addr.size() && issued < m_iterations_per_thread; connIdx++, issued++){
+			sendRequest(connIdx, m_issued[connIdx]++, false); // false=unsignaled
+		}
+	}
+	while(completed < m_iterations_per_thread){
+		for(size_t connIdx = 0; connIdx < m_addr.size(); connIdx++){
+			if(m_client->pollReceive(m_addr[connIdx], false) == 0) continue; // false=no poll
+
+			// +1 because the barrier response took the first receive
+			char *response = responsePointer(connIdx, m_completed[connIdx] + 1);
+			uint64_t id = *(uint64_t*)response;
+			if(id != m_completed[connIdx]){
+				throw runtime_error("RPCPerfClientThread received response " + to_string(id) + " but expected " + to_string(m_completed[connIdx]));
+			}
+			m_histogram.record(rdma::PerfTest::stopTimer(m_sendTimes[connIdx * m_outstanding + id % m_outstanding]));
+			m_completed[connIdx]++;
+			completed++;
+
+			m_client->receive(m_addr[connIdx], response, m_response_size);
+			if(issued < m_iterations_per_thread){
+				sendRequest(connIdx, m_issued[connIdx]++, false); // false=unsignaled
+				issued++;
+			}
+		}
+	}
+	m_elapsedNs = rdma::PerfTest::stopTimer(start);
+}
+
+
+
+rdma::RPCPerfTest::RPCPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int client_count, int thread_count, uint64_t request_size, uint64_t response_size, uint64_t outstanding, uint64_t iterations_per_thread) : PerfTest((int)SEND_RECEIVE_OPERATION){
+	if(is_server) thread_count *= client_count;
+	if(outstanding == 0) throw invalid_argument("RPCPerfTest outstanding requests must be greater than zero");
+
+	this->m_is_server = is_server;
+	this->m_rdma_port = rdma_port;
+	this->m_ownIpPort = ownIpPort;
+	this->m_sequencerIpPort = sequencerIpPort;
+	this->client_count = client_count;
+	this->thread_count = thread_count;
+	this->m_request_size = request_size;
+	this->m_response_size = response_size;
+	this->m_outstanding = outstanding;
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_rdma_addresses = rdma_addresses;
+
+	if(is_server){
+		// one more receive than requests in flight because the handler reposts after responding
+		this->m_max_messages = thread_count * outstanding + 1;
+		if(m_max_messages > Config::RDMA_MAX_WR){
+			throw invalid_argument("RPCPerfTest threads*clients*outstanding must be smaller than Config::RDMA_MAX_WR");
+		}
+		this->m_memory_size = (messageSize(request_size) + messageSize(response_size)) * m_max_messages + messageSize(request_size);
+	} else {
+		this->m_max_messages = 0;
+		this->m_memory_size = thread_count * (messageSize(request_size) + messageSize(response_size)) * outstanding * rdma_addresses.size();
+	}
+}
+rdma::RPCPerfTest::~RPCPerfTest(){
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		delete m_client_threads[i];
+	}
+	m_client_threads.clear();
+	if(m_is_server){
+		delete m_handler;
+		delete m_server;
+	}
+	delete m_memory;
+}
+
+std::string rdma::RPCPerfTest::getTestParameters(bool forCSV){
+	std::ostringstream oss;
+	oss << (m_is_server ? "Server" : "Client") << ", threads=" << thread_count << ", outstanding=" << m_outstanding;
+	if(!forCSV){
+		oss << ", requestsize=" << messageSize(m_request_size) << ", responsesize=" << messageSize(m_response_size);
+		oss << ", memory=" << m_memory_size;
+	}
+	oss << ", memory_type=" << getMemoryName(-3) << ", iterations=" << (m_iterations_per_thread*thread_count);
+	if(!forCSV){
+		oss << ", clients=" << client_count << ", servers=" << m_rdma_addresses.size();
+	}
+	return oss.str();
+}
+std::string rdma::RPCPerfTest::getTestParameters(){
+	return getTestParameters(false);
+}
+
+void rdma::RPCPerfTest::makeThreadsReady(){
+	RPCPerfTest::signaled = false;
+	for(RPCPerfClientThread* perfThread : m_client_threads){ perfThread->start(); }
+	for(RPCPerfClientThread* perfThread : m_client_threads){ while(!perfThread->ready()) usleep(Config::RDMA_SLEEP_INTERVAL); }
+}
+
+void rdma::RPCPerfTest::runThreads(){
+	RPCPerfTest::signaled = false;
+	unique_lock<mutex> lck(RPCPerfTest::waitLock);
+	RPCPerfTest::waitCv.notify_all();
+	RPCPerfTest::signaled = true;
+	lck.unlock();
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		m_client_threads[i]->join();
+	}
+}
+
+void rdma::RPCPerfTest::setupTest(){
+	m_memory = (rdma::BaseMemory*)new MainMemory(m_memory_size);
+
+	if(m_is_server){
+		// Server (handler activates its SRQ such that all client connections share it)
+		m_server = new RDMAServer<ReliableRDMA>("RPCTestRDMAServer", m_rdma_port, Network::getAddressOfConnection(m_ownIpPort), m_memory, m_sequencerIpPort);
+		m_handler = new RPCPerfHandlerThread(m_server, m_request_size, m_response_size, m_max_messages, thread_count);
+
+	} else {
+		// Client
+		for (size_t i = 0; i < thread_count; i++) {
+			RPCPerfClientThread* perfThread = new RPCPerfClientThread(m_memory, m_rdma_addresses, m_ownIpPort, m_sequencerIpPort, m_request_size, m_response_size, m_outstanding, m_iterations_per_thread);
+			m_client_threads.push_back(perfThread);
+		}
+	}
+}
+
+void rdma::RPCPerfTest::runTest(){
+	if(m_is_server){
+		// Server
+		std::cout << "Starting server on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "' . . ." << std::endl;
+		if(!m_server->startServer()){
+			std::cerr << "RPCPerfTest::runTest(): Could not start server" << std::endl;
+			throw invalid_argument("RPCPerfTest server startup failed");
+		} else {
+			std::cout << "Server running on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "'" << std::endl;
+		}
+		if(!m_handler->startHandler()){
+			throw runtime_error("RPCPerfTest handler startup failed");
+		}
+
+		// wait until all client threads have connected and finished again
+		while (m_server->isRunning() && m_server->getConnectedConnIDs().size() < thread_count) usleep(Config::RDMA_SLEEP_INTERVAL);
+		while (m_server->isRunning() && m_server->getConnectedConnIDs().size() > 0) usleep(Config::RDMA_SLEEP_INTERVAL);
+		m_handler->stopHandler();
+		std::cout << "Server stopped" << std::endl;
+
+	} else {
+		// Client
+		preparePerfEvents();
+		makeThreadsReady();
+		startPerfEvents();
+		auto start = rdma::PerfTest::startTimer();
+		runThreads();
+		m_elapsedNs = rdma::PerfTest::stopTimer(start);
+		stopPerfEvents(SEND_RECEIVE_OPERATION, m_iterations_per_thread * thread_count, thread_count);
+	}
+}
+
+
+std::string rdma::RPCPerfTest::getTestResults(std::string csvFileName, bool csvAddHeader){
+	if(m_is_server){
+		return "only client";
+	} else {
+
+		// threads recorded into their own histograms, throughput over the time of all threads together
+		LatencyHistogram histogram;
+		for(size_t i=0; i<m_client_threads.size(); i++){
+			histogram.merge(m_client_threads[i]->m_histogram);
+		}
+		const long double tu = (long double)NANO_SEC; // 1sec (nano to seconds as time unit)
+		const uint64_t requests = m_iterations_per_thread * thread_count;
+		const long double opsPerSec = (m_elapsedNs > 0 ? requests*tu/m_elapsedNs : 0);
+
+		// write results into CSV file
+		if(!csvFileName.empty()){
+			const long double ustu = 1000; // nanosec to microsec
+			std::ofstream ofs;
+			ofs.open(csvFileName, std::ofstream::out | std::ofstream::app);
+			ofs << rdma::CSV_PRINT_NOTATION << rdma::CSV_PRINT_PRECISION;
+			if(csvAddHeader){
+				ofs << std::endl << "RPC, " << getTestParameters(true) << std::endl;
+				ofs << "RequestSize [Bytes], ResponseSize [Bytes], RPC [Op/s], Avg RPC [usec], Median RPC [usec], Min RPC [usec], Max RPC [usec]";
+				rdma::PerfTest::writePercentilesCSVHeader(ofs, "RPC");
+				writePerfEventsCSVHeader(ofs);
+				ofs << std::endl;
+			}
+			ofs << messageSize(m_request_size) << ", " << messageSize(m_response_size) << ", "; // request & response size Bytes
+			ofs << round(opsPerSec) << ", "; // RPC Op/s
+			ofs << (round(histogram.getAverage()/ustu * 10)/10.0) << ", "; // avg us
+			ofs << (round(histogram.getMedian()/ustu * 10)/10.0) << ", "; // median us
+			ofs << (round(histogram.getMin()/ustu * 10)/10.0) << ", "; // min us
+			ofs << (round(histogram.getMax()/ustu * 10)/10.0); // max us
+			rdma::PerfTest::writePercentilesCSV(ofs, histogram);
+			writePerfEventsCSV(ofs);
+			ofs << std::endl; ofs.close();
+		}
+
+		// write full histogram
+		if(!histogramFileName.empty()){
+			std::ofstream ofs;
+			ofs.open(histogramFileName, std::ofstream::out | std::ofstream::app);
+			ofs << std::endl << "RPC HISTOGRAM, " << getTestParameters(true) << ", requestsize=" << messageSize(m_request_size) << ", responsesize=" << messageSize(m_response_size) << std::endl;
+			LatencyHistogram::writeBucketsHeader(ofs);
+			histogram.writeBuckets(ofs, "RPC");
+			ofs.close();
+		}
+
+		// generate result string
+		std::ostringstream oss;
+		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
+		oss << "Measured as 'round-trip time' latency from sending the request until its response arrived:" << std::endl;
+		oss << " - RPC:          operations = " << rdma::PerfTest::convertCountPerSec(opsPerSec);
+		oss << "    average = " << rdma::PerfTest::convertTime(histogram.getAverage()) << "    median = " << rdma::PerfTest::convertTime(histogram.getMedian());
+		oss << "    range = " <<  rdma::PerfTest::convertTime(histogram.getMin()) << " - " << rdma::PerfTest::convertTime(histogram.getMax()) << std::endl;
+		oss << rdma::PerfTest::convertPercentiles(histogram) << std::endl;
+		return oss.str();
+	}
+	return NULL;
+}
@@ -0,0 +1,135 @@
+#ifndef RPCPerfTest_H
+#define RPCPerfTest_H
+
+#include "PerfTest.h"
+#include "LatencyHistogram.h"
+#include "../src/memory/LocalBaseMemoryStub.h"
+#include "../src/rdma/RDMAClient.h"
+#include "../src/rdma/RDMAServer.h"
+#include "../src/RPC/RPCVoidHandlerThread.h"
+#include "../src/thread/Thread.h"
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <chrono>
+
+namespace rdma {
+
+/* Class: RPCPerfHandlerThread
+ * ----------------
+ * RPCVoidHandlerThread of the server that answers every request with a
+ * response of the configured size carrying the request id. Responses are
+ * taken round-robin from a ring with one slot per receive buffer, so a
+ * slot is only reused after the client got the response of the slot.
+ *
+ * Also acts as global barrier: requests with id BARRIER_ID are only
+ * answered once all expected client threads sent one, because the
+ * connections of an SRQ cannot post the receives of global_barrier_server
+ */
+class RPCPerfHandlerThread : public RPCVoidHandlerThread<ReliableRDMA> {
+public:
+	RPCPerfHandlerThread(RDMAServer<ReliableRDMA> *server, size_t request_size, size_t response_size, size_t max_messages, size_t expected_barrier_count);
+	~RPCPerfHandlerThread();
+	void handleRDMARPCVoid(void *message, NodeID &returnAdd);
+
+private:
+	size_t m_response_size;
+	size_t m_response_idx = 0;
+	char *m_responses;
+	size_t m_expected_barrier_count;
+	std::vector<NodeID> m_barrier;
+
+	void respond(NodeID &returnAdd, uint64_t id);
+};
+
+
+/* Class: RPCPerfClientThread
+ * ----------------
+ * Keeps up to outstanding requests in flight on every connection.
+ * Responses of a connection arrive in the order of the requests, so the
+ * receive buffers are consumed as a ring and the id in the response
+ * identifies the send time of the request.
+ */
+class RPCPerfClientThread : public Thread {
+public:
+	RPCPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t request_size, size_t response_size, size_t outstanding, size_t iterations_per_thread);
+	~RPCPerfClientThread();
+	void run();
+	bool ready() {
+		return m_ready;
+	}
+
+	// recorded without locking per request, merged after run
+	LatencyHistogram m_histogram;
+	int64_t m_elapsedNs = 0;
+
+private:
+	bool m_ready = false;
+	RDMAClient<ReliableRDMA> *m_client;
+	LocalBaseMemoryStub *m_local_memory;
+	size_t m_request_size;
+	size_t m_response_size;
+	size_t m_outstanding;
+	size_t m_memory_size_per_connection;
+	size_t m_iterations_per_thread;
+	std::vector<std::string> m_rdma_addresses;
+	std::vector<NodeID> m_addr;
+	std::vector<std::chrono::high_resolution_clock::time_point> m_sendTimes;
+	std::vector<size_t> m_issued; // per connection
+	std::vector<size_t> m_completed; // per connection
+
+	char* requestPointer(size_t connIdx, uint64_t id);
+	char* responsePointer(size_t connIdx, size_t receiveIdx);
+	void sendRequest(size_t connIdx, uint64_t id, bool signaled);
+};
+
+
+class RPCPerfTest : public rdma::PerfTest {
+public:
+	RPCPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int client_count, int thread_count, uint64_t request_size, uint64_t response_size, uint64_t outstanding, uint64_t iterations_per_thread);
+	virtual ~RPCPerfTest();
+	std::string getTestParameters();
+	void setupTest();
+	void runTest();
+	std::string getTestResults(std::string csvFileName="", bool csvAddHeader=true);
+
+	// requests and responses start with the 64bit request id
+	static const uint64_t BARRIER_ID = UINT64_MAX;
+	static size_t messageSize(size_t size){
+		return (size < sizeof(uint64_t) ? sizeof(uint64_t) : size);
+	}
+
+	static mutex waitLock;
+	static condition_variable waitCv;
+	static bool signaled;
+	static size_t thread_count, client_count;
+
+private:
+	bool m_is_server;
+	std::vector<std::string> m_rdma_addresses;
+	int m_rdma_port;
+	std::string m_ownIpPort;
+	std::string m_sequencerIpPort;
+	uint64_t m_request_size;
+	uint64_t m_response_size;
+	uint64_t m_outstanding;
+	uint64_t m_max_messages;
+	uint64_t m_memory_size;
+	uint64_t m_iterations_per_thread;
+	int64_t m_elapsedNs = 0;
+	std::vector<RPCPerfClientThread*> m_client_threads;
+
+	BaseMemory *m_memory;
+	RDMAServer<ReliableRDMA>* m_server = nullptr;
+	RPCPerfHandlerThread* m_handler = nullptr;
+
+	std::string getTestParameters(bool forCSV);
+	void makeThreadsReady();
+	void runThreads();
+};
+
+}
+
+#endif
@@ -0,0 +1,305 @@
+#include "ScanPerfTest.h"
+
+#include "../src/memory/BaseMemory.h"
+#include "../src/memory/MainMemory.h"
+#include "../src/memory/CudaMemory.h"
+#include "../src/utils/Config.h"
+
+mutex rdma::ScanPerfTest::waitLock;
+condition_variable rdma::ScanPerfTest::waitCv;
+bool rdma::ScanPerfTest::signaled;
+size_t rdma::ScanPerfTest::client_count;
+size_t rdma::ScanPerfTest::thread_count;
+
+/*	LT: Local Thread, RT: Remote Thread, P: Page, W: Prefetch Window Slot, C: Connection
+ *
+ *	Client Memory:	LT1{ W1, W2, ... }, LT2{ W1, W2, ... }, ...
+ *	Server Memory:	RT1{ P1, P2, ... }, RT2{ P1, P2, ... }, ...
+ *
+ *	Page i of a thread is read from connection i % C
+ */
+
+
+rdma::ScanPerfClientThread::ScanPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t page_size, size_t pages_per_thread, size_t prefetch) {
+	this->m_client = new RDMAClient<ReliableRDMA>(memory, "ScanPerfTestClient", ownIpPort, sequencerIpPort);
+	this->m_rdma_addresses = rdma_addresses;
+	this->m_page_size = page_size;
+	this->m_pages_per_thread = pages_per_thread;
+	this->m_prefetch = prefetch;
+	this->m_remote_memory_size_per_thread = page_size * ((pages_per_thread + rdma_addresses.size() - 1) / rdma_addresses.size());
+	this->m_remOffsets = new size_t[m_rdma_addresses.size()];
+
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		NodeID nodeId = 0;
+		string conn = m_rdma_addresses[i];
+		if(!m_client->connect(conn, nodeId)) {
+			std::cerr << "ScanPerfThread::ScanPerfThread(): Could not connect to '" << conn << "'" << std::endl;
+			throw invalid_argument("ScanPerfThread connection failed");
+		}
+		m_addr.push_back(nodeId);
+		m_client->remoteAlloc(conn, m_remote_memory_size_per_thread, m_remOffsets[i]);
+	}
+
+	m_local_memory = m_client->localMalloc(m_page_size * m_prefetch);
+	m_local_memory->openContext();
+	m_local_memory->setMemory(0);
+}
+
+rdma::ScanPerfClientThread::~ScanPerfClientThread() {
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		string addr = m_rdma_addresses[i];
+		m_client->remoteFree(addr, m_remote_memory_size_per_thread, m_remOffsets[i]);
+	}
+	delete m_remOffsets;
+	delete m_local_memory; // implicitly deletes local allocs in RDMAClient
+	delete m_client;
+}
+
+void rdma::ScanPerfClientThread::prefetch(){
+	while(m_writeIdx - m_readIdx < m_prefetch && m_writeIdx < m_pages_per_thread){
+		size_t connIdx = m_writeIdx % m_addr.size();
+		size_t remoteOffset = m_remOffsets[connIdx] + (m_writeIdx / m_addr.size()) * m_page_size;
+		m_client->requestRead(m_addr[connIdx], remoteOffset, m_local_memory->pointer((m_writeIdx % m_prefetch) * m_page_size), m_page_size);
+		m_writeIdx++;
+	}
+}
+
+void rdma::ScanPerfClientThread::run() {
+	rdma::PerfTest::global_barrier_client(m_client, m_addr); // global barrier
+	unique_lock<mutex> lck(ScanPerfTest::waitLock); // local barrier
+	if (!ScanPerfTest::signaled) {
+		m_ready = true;
+		ScanPerfTest::waitCv.wait(lck);
+	}
+	lck.unlock();
+	m_ready = false;
+
+	// tuples can only be processed by the CPU in main memory
+	const bool process = m_local_memory->isMainMemory();
+	const size_t tuplesPerPage = m_page_size / sizeof(uint64_t);
+	uint64_t total = 0;
+	m_readIdx = 0;
+	m_writeIdx = 0;
+	m_stallNs = 0;
+	m_processNs = 0;
+
+	auto start = rdma::PerfTest::startTimer();
+	prefetch();
+	while(m_readIdx < m_pages_per_thread){
+		// reads of a connection complete in order, the next page is the oldest outstanding of its connection
+		auto stallStart = rdma::PerfTest::startTimer();
+		m_client->pollSend(m_addr[m_readIdx % m_addr.size()], true); // true=poll
+		auto processStart = rdma::PerfTest::startTimer();
+		m_stallNs += rdma::PerfTest::stopTimer(stallStart, processStart);
+
+		if(process){
+			const uint64_t *tuples = (const uint64_t*)m_local_memory->pointer((m_readIdx % m_prefetch) * m_page_size);
+			for(size_t i = 0; i < tuplesPerPage; i++){
+				total += tuples[i];
+			}
+		}
+		m_readIdx++;
+		m_processNs += rdma::PerfTest::stopTimer(processStart);
+
+		prefetch();
+	}
+	m_elapsedNs = rdma::PerfTest::stopTimer(start);
+	m_checksum = total;
+
+	uint64_t tuple = 0;
+	memset(&tuple, ScanPerfTest::TABLE_BYTE, sizeof(tuple));
+	if(process && m_checksum != tuple * tuplesPerPage * m_pages_per_thread){
+		throw runtime_error("ScanPerfClientThread scanned unexpected data! Checksum: " + to_string(m_checksum));
+	}
+}
+
+
+
+rdma::ScanPerfTest::ScanPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t page_size, uint64_t scan_size_per_thread, uint64_t prefetch) : PerfTest((int)READ_OPERATION){
+	if(is_server) thread_count *= client_count;
+	if(prefetch == 0) throw invalid_argument("ScanPerfTest prefetch must be greater than zero");
+	if(prefetch > Config::RDMA_MAX_WR) throw invalid_argument("ScanPerfTest prefetch must not exceed Config::RDMA_MAX_WR");
+
+	this->m_is_server = is_server;
+	this->m_rdma_port = rdma_port;
+	this->m_ownIpPort = ownIpPort;
+	this->m_sequencerIpPort = sequencerIpPort;
+	this->m_local_gpu_index = local_gpu_index;
+	this->m_actual_gpu_index = -1;
+	this->m_remote_gpu_index = remote_gpu_index;
+	this->client_count = client_count;
+	this->thread_count = thread_count;
+	this->m_page_size = page_size;
+	this->m_pages_per_thread = scan_size_per_thread / page_size;
+	if(m_pages_per_thread == 0) m_pages_per_thread = 1;
+	this->m_prefetch = prefetch;
+	this->m_rdma_addresses = rdma_addresses;
+	if(is_server){
+		this->m_memory_size = thread_count * m_pages_per_thread * page_size; // table partitions of all client threads
+	} else {
+		this->m_memory_size = thread_count * prefetch * page_size; // prefetch windows
+	}
+	this->m_elapsedNs = -1;
+}
+rdma::ScanPerfTest::~ScanPerfTest(){
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		delete m_client_threads[i];
+	}
+	m_client_threads.clear();
+	if(m_is_server)
+		delete m_server;
+	delete m_memory;
+}
+
+std::string rdma::ScanPerfTest::getTestParameters(bool forCSV){
+	std::ostringstream oss;
+	oss << (m_is_server ? "Server" : "Client") << ", threads=" << thread_count << ", prefetch=" << m_prefetch;
+	if(!forCSV){
+		oss << ", pagesize=" << m_page_size << ", pages=" << (m_pages_per_thread*thread_count);
+		oss << ", memory=" << m_memory_size << " (" << thread_count << "x " << (m_is_server ? m_pages_per_thread : m_prefetch) << "x " << m_page_size << ")";
+	}
+	oss << ", scansize=" << (m_pages_per_thread*m_page_size) << "/thread";
+	oss << ", memory_type=" << getMemoryName(m_local_gpu_index, m_actual_gpu_index) << (m_remote_gpu_index!=-404 ? "->"+getMemoryName(m_remote_gpu_index) : "");
+	if(!forCSV){ oss << ", clients=" << client_count << ", servers=" << m_rdma_addresses.size(); }
+	return oss.str();
+}
+std::string rdma::ScanPerfTest::getTestParameters(){
+	return getTestParameters(false);
+}
+
+void rdma::ScanPerfTest::makeThreadsReady(){
+	ScanPerfTest::signaled = false;
+	if(m_is_server){
+		rdma::PerfTest::global_barrier_server(m_server, (size_t)thread_count);
+	} else {
+		for(ScanPerfClientThread* perfThread : m_client_threads){ perfThread->start(); }
+		for(ScanPerfClientThread* perfThread : m_client_threads){ while(!perfThread->ready()) usleep(Config::RDMA_SLEEP_INTERVAL); }
+	}
+}
+
+void rdma::ScanPerfTest::runThreads(){
+	ScanPerfTest::signaled = false;
+	unique_lock<mutex> lck(ScanPerfTest::waitLock);
+	ScanPerfTest::waitCv.notify_all();
+	ScanPerfTest::signaled = true;
+	lck.unlock();
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		m_client_threads[i]->join();
+	}
+}
+
+void rdma::ScanPerfTest::setupTest(){
+	m_elapsedNs = -1;
+	m_actual_gpu_index = -1;
+	#ifdef CUDA_ENABLED /* defined in CMakeLists.txt to globally enable/disable CUDA support */
+		if(m_local_gpu_index <= -3){
+			m_memory = new rdma::MainMemory(m_memory_size);
+		} else {
+			rdma::CudaMemory *mem = new rdma::CudaMemory(m_memory_size, m_local_gpu_index);
+			m_memory = mem;
+			m_actual_gpu_index = mem->getDeviceIndex();
+		}
+	#else
+		m_memory = (rdma::BaseMemory*)new MainMemory(m_memory_size);
+	#endif
+
+	if(m_is_server){
+		// Server
+		m_memory->setMemory(TABLE_BYTE); // table which is scanned by the clients
+		m_server = new RDMAServer<ReliableRDMA>("ScanTestRDMAServer", m_rdma_port, Network::getAddressOfConnection(m_ownIpPort), m_memory, m_sequencerIpPort);
+
+	} else {
+		// Client
+		for (size_t i = 0; i < thread_count; i++) {
+			ScanPerfClientThread* perfThread = new ScanPerfClientThread(m_memory, m_rdma_addresses, m_ownIpPort, m_sequencerIpPort, m_page_size, m_pages_per_thread, m_prefetch);
+			m_client_threads.push_back(perfThread);
+		}
+	}
+}
+
+void rdma::ScanPerfTest::runTest(){
+	if(m_is_server){
+		// Server
+		std::cout << "Starting server on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "' . . ." << std::endl;
+		if(!m_server->startServer()){
+			std::cerr << "ScanPerfTest::runTest(): Could not start server" << std::endl;
+			throw invalid_argument("ScanPerfTest server startup failed");
+		} else {
+			std::cout << "Server running on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "'" << std::endl;
+		}
+
+		makeThreadsReady();
+		runThreads();
+
+		// wait until clients have finished
+		while (m_server->isRunning() && m_server->getConnectedConnIDs().size() > 0) usleep(Config::RDMA_SLEEP_INTERVAL);
+		std::cout << "Server stopped" << std::endl;
+
+	} else {
+		// Client
+		preparePerfEvents();
+		makeThreadsReady();
+		startPerfEvents();
+		auto start = rdma::PerfTest::startTimer();
+		runThreads();
+		m_elapsedNs = rdma::PerfTest::stopTimer(start);
+		stopPerfEvents(READ_OPERATION, m_pages_per_thread * thread_count, thread_count);
+	}
+}
+
+
+std::string rdma::ScanPerfTest::getTestResults(std::string csvFileName, bool csvAddHeader){
+	if(m_is_server){
+		return "only client";
+	} else {
+
+		/*	Bandwidth of all threads together, the stall and processing
+			shares are the averages over the threads. A small stall share
+			means that the prefetching hides the network behind processing.
+		*/
+
+		const long double tu = (long double)NANO_SEC; // 1sec (nano to seconds as time unit)
+		const uint64_t scannedBytes = thread_count * m_pages_per_thread * m_page_size;
+		const uint64_t scannedTuples = scannedBytes / sizeof(uint64_t);
+		long double stallShare = 0, processShare = 0;
+		for(size_t i=0; i<m_client_threads.size(); i++){
+			ScanPerfClientThread *thr = m_client_threads[i];
+			if(thr->m_elapsedNs <= 0) continue;
+			stallShare += (long double)thr->m_stallNs / thr->m_elapsedNs / m_client_threads.size();
+			processShare += (long double)thr->m_processNs / thr->m_elapsedNs / m_client_threads.size();
+		}
+
+		// write results into CSV file
+		if(!csvFileName.empty()){
+			const long double su = 1024*1024; // size unit for MebiBytes
+			std::ofstream ofs;
+			ofs.open(csvFileName, std::ofstream::out | std::ofstream::app);
+			ofs << rdma::CSV_PRINT_NOTATION << rdma::CSV_PRINT_PRECISION;
+			if(csvAddHeader){
+				ofs << std::endl << "SCAN, " << getTestParameters(true) << std::endl;
+				ofs << "PageSize [Bytes], Scanned [Bytes], Scan [MB/s], Tuples [Op/s], Scan [Sec], Stall [%], Processing [%]";
+				writePerfEventsCSVHeader(ofs);
+				ofs << std::endl;
+			}
+			ofs << m_page_size << ", " << scannedBytes << ", "; // page size Bytes
+			ofs << (round(scannedBytes*tu/su/m_elapsedNs * 100000)/100000.0) << ", "; // scan MB/s
+			ofs << (round(scannedTuples*tu/m_elapsedNs * 100)/100.0) << ", "; // tuples/s
+			ofs << (round(m_elapsedNs/tu * 100000)/100000.0) << ", "; // scan seconds
+			ofs << (round(stallShare * 1000)/10.0) << ", "; // stall %
+			ofs << (round(processShare * 1000)/10.0); // processing %
+			writePerfEventsCSV(ofs);
+			ofs << std::endl; ofs.close();
+		}
+
+		// generate result string
+		std::ostringstream oss;
+		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
+		oss << " - Scan:         bandwidth = " << rdma::PerfTest::convertBandwidth(scannedBytes*tu/m_elapsedNs);
+		oss << "    tuples = " << rdma::PerfTest::convertCountPerSec(scannedTuples*tu/m_elapsedNs);
+		oss << "    time = " << rdma::PerfTest::convertTime(m_elapsedNs) << std::endl;
+		oss << "                 stalled = " << (round(stallShare * 1000)/10.0) << "%    processing = " << (round(processShare * 1000)/10.0) << "%";
+		oss << " (share of the thread time waiting for pages resp. summing up tuples)" << std::endl;
+		return oss.str();
+	}
+	return NULL;
+}
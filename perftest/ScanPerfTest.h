@@ -0,0 +1,100 @@
+#ifndef ScanPerfTest_H
+#define ScanPerfTest_H
+
+#include "PerfTest.h"
+#include "../src/memory/LocalBaseMemoryStub.h"
+#include "../src/rdma/RDMAClient.h"
+#include "../src/rdma/RDMAServer.h"
+#include "../src/thread/Thread.h"
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+namespace rdma {
+
+/* Class: ScanPerfClientThread
+ * ----------------
+ * Scans the remote table partition of the thread page by page.
+ * Up to prefetch pages are read ahead (requestRead) into a ring of
+ * local pages, so the network transfers overlap with summing up the
+ * 64bit tuples of the current page. Pages are distributed round-robin
+ * over the connections.
+ */
+class ScanPerfClientThread : public Thread {
+public:
+	ScanPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t page_size, size_t pages_per_thread, size_t prefetch);
+	~ScanPerfClientThread();
+	void run();
+	bool ready() {
+		return m_ready;
+	}
+
+	int64_t m_elapsedNs = 0;
+	int64_t m_stallNs = 0; // waiting for the next page
+	int64_t m_processNs = 0; // summing up the tuples
+	uint64_t m_checksum = 0;
+
+private:
+	bool m_ready = false;
+	RDMAClient<ReliableRDMA> *m_client;
+	LocalBaseMemoryStub *m_local_memory;
+	size_t m_page_size;
+	size_t m_pages_per_thread;
+	size_t m_prefetch;
+	size_t m_remote_memory_size_per_thread;
+	std::vector<std::string> m_rdma_addresses;
+	std::vector<NodeID> m_addr;
+	size_t* m_remOffsets;
+
+	size_t m_readIdx;
+	size_t m_writeIdx;
+
+	void prefetch();
+};
+
+
+class ScanPerfTest : public rdma::PerfTest {
+public:
+	ScanPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t page_size, uint64_t scan_size_per_thread, uint64_t prefetch);
+	virtual ~ScanPerfTest();
+	std::string getTestParameters();
+	void setupTest();
+	void runTest();
+	std::string getTestResults(std::string csvFileName="", bool csvAddHeader=true);
+
+	static const uint8_t TABLE_BYTE = 1; // every byte of the remote table
+
+	static mutex waitLock;
+	static condition_variable waitCv;
+	static bool signaled;
+	static size_t thread_count, client_count;
+
+private:
+	bool m_is_server;
+	std::vector<std::string> m_rdma_addresses;
+	int m_rdma_port;
+	std::string m_ownIpPort;
+	std::string m_sequencerIpPort;
+	int m_local_gpu_index;
+	int m_actual_gpu_index;
+	int m_remote_gpu_index;
+	uint64_t m_page_size;
+	uint64_t m_pages_per_thread;
+	uint64_t m_prefetch;
+	uint64_t m_memory_size;
+	int64_t m_elapsedNs;
+	std::vector<ScanPerfClientThread*> m_client_threads;
+
+	BaseMemory *m_memory;
+	RDMAServer<ReliableRDMA>* m_server;
+
+	std::string getTestParameters(bool forCSV);
+	void makeThreadsReady();
+	void runThreads();
+};
+
+}
+
+#endif
@@ -0,0 +1,487 @@
+#include "UnreliablePerfTest.h"
+
+#include "../src/utils/Config.h"
+
+mutex rdma::UnreliablePerfTest::waitLock;
+condition_variable rdma::UnreliablePerfTest::waitCv;
+bool rdma::UnreliablePerfTest::signaled;
+rdma::TestOperation rdma::UnreliablePerfTest::testOperation;
+size_t rdma::UnreliablePerfTest::client_count;
+size_t rdma::UnreliablePerfTest::thread_count;
+
+/*	S: Slot of message size, G: Config::RDMA_UD_OFFSET bytes for the global routing header of a receive
+ *
+ *	Client Memory:	LT1{ Data S, Control S }, LT1{ G S, G S, ... receive slots }, LT2{ ... }, ...
+ *	Server Memory:	{ G S, G S, ... UD receives }, { G S, G S, ... multicast receives }, { S, S, ... answers }
+ *
+ *	Messages are always in main memory because both sides read the header with the CPU.
+ */
+
+static size_t receiveStride(size_t packet_size){
+	return rdma::UnreliablePerfTest::messageSize(packet_size) + rdma::Config::RDMA_UD_OFFSET;
+}
+
+static size_t operationIndex(rdma::TestOperation operation){
+	for(size_t opIdx = 0; opIdx < rdma::UD_OPERATION_COUNT; opIdx++){
+		if(rdma::UD_OPERATIONS[opIdx] == operation) return opIdx;
+	}
+	throw invalid_argument("UnreliablePerfTest unknown test mode");
+}
+
+
+rdma::UnreliablePerfClientThread::UnreliablePerfClientThread(std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, std::string mcastAddress, size_t packet_size, size_t iterations_per_thread, UnreliableTestMode mode) {
+	this->m_rdma_addresses = rdma_addresses;
+	this->m_packet_size = UnreliablePerfTest::messageSize(packet_size);
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_mode = mode;
+	this->m_receive_slots = std::max<size_t>(64, 4 * rdma_addresses.size()); // answers of all servers plus retransmitted ones
+	this->m_serverCounts.resize(rdma_addresses.size(), 0);
+
+	size_t memory_size = 2 * m_packet_size + m_receive_slots * receiveStride(m_packet_size) + 2 * Config::RDMA_UD_OFFSET;
+	this->m_client = new RDMAClient<UnreliableRDMA>(memory_size, "UnreliablePerfTestClient", ownIpPort, sequencerIpPort);
+
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		NodeID nodeId = 0;
+		string conn = m_rdma_addresses[i];
+		if(!m_client->connect(conn, nodeId)) {
+			std::cerr << "UnreliablePerfThread::UnreliablePerfThread(): Could not connect to '" << conn << "'" << std::endl;
+			throw invalid_argument("UnreliablePerfThread connection failed");
+		}
+		m_addr.push_back(nodeId);
+	}
+	if(!mcastAddress.empty()){
+		m_client->joinMCastGroup(mcastAddress, m_mcastConn);
+		m_mcast = true;
+	}
+
+	m_send = (char*)m_client->localAlloc(2 * m_packet_size);
+	m_receive = (char*)m_client->localAlloc(m_receive_slots * receiveStride(m_packet_size));
+	memset(m_send, 0, 2 * m_packet_size);
+
+	// all answers arrive on the single UD queue pair, receives complete in the order they were posted
+	for(size_t i = 0; i < m_receive_slots; i++){
+		m_client->receive(m_addr[0], m_receive + i * receiveStride(m_packet_size), m_packet_size);
+	}
+}
+
+rdma::UnreliablePerfClientThread::~UnreliablePerfClientThread() {
+	delete m_client; // implicitly frees local allocs and leaves multicast group
+}
+
+void rdma::UnreliablePerfClientThread::sendData(size_t opIdx, uint64_t seq, bool signaled){
+	if(UD_OPERATIONS[opIdx] == MULTICAST_OPERATION){
+		m_client->sendMCast(m_mcastConn, m_send, m_packet_size, signaled);
+	} else {
+		m_client->send(m_addr[seq % m_addr.size()], m_send, m_packet_size, signaled);
+	}
+}
+
+size_t rdma::UnreliablePerfClientThread::awaitAnswers(UnreliableMessageType type, size_t opIdx, uint64_t seq, std::vector<bool> &answered, int64_t timeoutNs){
+	size_t missing = std::count(answered.begin(), answered.end(), false);
+	auto start = rdma::PerfTest::startTimer();
+	while(missing > 0 && rdma::PerfTest::stopTimer(start) < timeoutNs){
+		if(m_client->pollReceive(m_addr[0], false) == 0) continue; // false=no poll
+
+		char *slot = m_receive + (m_received % m_receive_slots) * receiveStride(m_packet_size);
+		m_received++;
+		UnreliablePerfMessage answer = *(UnreliablePerfMessage*)slot;
+		m_client->receive(m_addr[0], slot, m_packet_size);
+
+		// answers of retransmissions or timed out requests
+		if(answer.type != (uint32_t)type || answer.operation != opIdx || answer.seq != seq) continue;
+		auto it = std::find(m_addr.begin(), m_addr.end(), answer.sender);
+		if(it == m_addr.end() || answered[it - m_addr.begin()]) continue;
+		answered[it - m_addr.begin()] = true;
+		m_serverCounts[it - m_addr.begin()] = answer.count;
+		missing--;
+	}
+	return missing;
+}
+
+void rdma::UnreliablePerfClientThread::control(UnreliableMessageType type, size_t opIdx){
+	UnreliablePerfMessage *message = (UnreliablePerfMessage*)(m_send + m_packet_size);
+	message->type = type;
+	message->operation = opIdx;
+	message->seq = 0;
+	message->sender = m_client->getOwnNodeID();
+	message->count = 0;
+
+	// retransmit until every server answered
+	std::vector<bool> answered(m_addr.size(), false);
+	const int64_t timeoutNs = (int64_t)Config::RDMA_UD_RPC_TIMEOUT * 1000;
+	do {
+		for(size_t i = 0; i < m_addr.size(); i++){
+			if(!answered[i]) m_client->send(m_addr[i], message, sizeof(UnreliablePerfMessage), true); // true=signaled
+		}
+	} while(awaitAnswers(type, opIdx, 0, answered, timeoutNs) > 0);
+}
+
+void rdma::UnreliablePerfClientThread::run() {
+	const size_t opIdx = operationIndex(UnreliablePerfTest::testOperation);
+	control(UD_MESSAGE_BARRIER, opIdx); // global barrier
+	unique_lock<mutex> lck(UnreliablePerfTest::waitLock); // local barrier
+	if (!UnreliablePerfTest::signaled) {
+		m_ready = true;
+		UnreliablePerfTest::waitCv.wait(lck);
+	}
+	lck.unlock();
+	m_ready = false;
+
+	const bool multicast = (UD_OPERATIONS[opIdx] == MULTICAST_OPERATION);
+	UnreliablePerfMessage *message = (UnreliablePerfMessage*)m_send;
+	message->type = UD_MESSAGE_DATA;
+	message->operation = opIdx;
+	message->seq = 0;
+	message->sender = m_client->getOwnNodeID();
+	message->count = 0;
+
+	if(m_mode == UD_BANDWIDTH_MODE){
+		// as fast as possible, everything the receivers cannot keep up with gets dropped
+		auto start = rdma::PerfTest::startTimer();
+		for(size_t i = 0; i < m_iterations_per_thread; i++){
+			sendData(opIdx, i, i+1 == m_iterations_per_thread); // last one signaled, waits until all data messages left
+		}
+		m_elapsedNs[opIdx] = rdma::PerfTest::stopTimer(start);
+
+	} else {
+		// ping-pong, requests whose answers don't arrive in time are lost
+		const int64_t timeoutNs = (int64_t)Config::RDMA_UD_RPC_TIMEOUT * 1000;
+		std::vector<bool> answered(m_addr.size());
+		auto start = rdma::PerfTest::startTimer();
+		for(size_t i = 0; i < m_iterations_per_thread; i++){
+			message->seq = i;
+			for(size_t s = 0; s < m_addr.size(); s++){
+				answered[s] = !(multicast || s == i % m_addr.size()); // multicast is answered by every server
+			}
+			auto sent = rdma::PerfTest::startTimer();
+			sendData(opIdx, i, false); // false=unsignaled
+			if(awaitAnswers(UD_MESSAGE_DATA, opIdx, i, answered, timeoutNs) == 0){
+				m_histograms[opIdx].record(rdma::PerfTest::stopTimer(sent));
+			} else {
+				m_lost[opIdx]++;
+			}
+		}
+		m_elapsedNs[opIdx] = rdma::PerfTest::stopTimer(start);
+	}
+
+	// servers report how many data messages arrived
+	control(UD_MESSAGE_END, opIdx);
+	m_delivered[opIdx] = 0;
+	for(uint64_t count : m_serverCounts){
+		m_delivered[opIdx] += count;
+	}
+}
+
+
+
+rdma::UnreliablePerfTest::UnreliablePerfTest(int testOperations, bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, std::string mcastAddress, int client_count, int thread_count, uint64_t packet_size, uint64_t iterations_per_thread, UnreliableTestMode mode) : PerfTest(testOperations){
+	if(is_server) thread_count *= client_count;
+	if(messageSize(packet_size) > Config::RDMA_UD_MTU){
+		throw invalid_argument("UnreliablePerfTest packet size " + to_string(packet_size) + " is bigger than Config::RDMA_UD_MTU");
+	}
+
+	this->m_is_server = is_server;
+	this->m_rdma_port = rdma_port;
+	this->m_ownIpPort = ownIpPort;
+	this->m_sequencerIpPort = sequencerIpPort;
+	this->m_mcastAddress = (hasTestOperation(MULTICAST_OPERATION) ? mcastAddress : "");
+	this->client_count = client_count;
+	this->thread_count = thread_count;
+	this->m_packet_size = packet_size;
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_mode = mode;
+	this->m_rdma_addresses = rdma_addresses;
+
+	const uint64_t slot = messageSize(packet_size);
+	if(is_server){
+		this->m_memory_size = 2 * Config::RDMA_MAX_WR * receiveStride(packet_size) + Config::RDMA_MAX_WR * slot + 3 * Config::RDMA_UD_OFFSET;
+	} else {
+		this->m_memory_size = thread_count * (2 * slot + std::max<size_t>(64, 4 * rdma_addresses.size()) * receiveStride(packet_size) + 2 * Config::RDMA_UD_OFFSET);
+	}
+}
+rdma::UnreliablePerfTest::~UnreliablePerfTest(){
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		delete m_client_threads[i];
+	}
+	m_client_threads.clear();
+	if(m_is_server)
+		delete m_server; // implicitly frees local allocs and leaves multicast group
+}
+
+std::string rdma::UnreliablePerfTest::getTestParameters(bool forCSV){
+	std::ostringstream oss;
+	oss << (m_is_server ? "Server" : "Client") << ", threads=" << thread_count;
+	if(!forCSV){
+		oss << ", packetsize=" << messageSize(m_packet_size) << ", memory=" << m_memory_size;
+	}
+	oss << ", memory_type=" << getMemoryName(-3) << ", iterations=" << (m_iterations_per_thread*thread_count);
+	if(!forCSV){
+		if(!m_mcastAddress.empty()) oss << ", mcastaddr=" << m_mcastAddress;
+		oss << ", clients=" << client_count << ", servers=" << m_rdma_addresses.size();
+	}
+	return oss.str();
+}
+std::string rdma::UnreliablePerfTest::getTestParameters(){
+	return getTestParameters(false);
+}
+
+void rdma::UnreliablePerfTest::makeThreadsReady(TestOperation testOperation){
+	UnreliablePerfTest::testOperation = testOperation;
+	UnreliablePerfTest::signaled = false;
+	for(UnreliablePerfClientThread* perfThread : m_client_threads){ perfThread->start(); }
+	for(UnreliablePerfClientThread* perfThread : m_client_threads){ while(!perfThread->ready()) usleep(Config::RDMA_SLEEP_INTERVAL); }
+}
+
+void rdma::UnreliablePerfTest::runThreads(){
+	UnreliablePerfTest::signaled = false;
+	unique_lock<mutex> lck(UnreliablePerfTest::waitLock);
+	UnreliablePerfTest::waitCv.notify_all();
+	UnreliablePerfTest::signaled = true;
+	lck.unlock();
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		m_client_threads[i]->join();
+	}
+}
+
+void rdma::UnreliablePerfTest::setupTest(){
+	if(m_is_server){
+		// Server
+		const size_t slot = messageSize(m_packet_size);
+		m_server = new RDMAServer<UnreliableRDMA>("UnreliableTestRDMAServer", m_rdma_port, Network::getAddressOfConnection(m_ownIpPort), m_memory_size, m_sequencerIpPort);
+		m_receive = (char*)m_server->localAlloc(Config::RDMA_MAX_WR * receiveStride(m_packet_size));
+		m_answers = (char*)m_server->localAlloc(Config::RDMA_MAX_WR * slot);
+		memset(m_answers, 0, Config::RDMA_MAX_WR * slot);
+		for(size_t i = 0; i < Config::RDMA_MAX_WR; i++){
+			m_server->receive(0, m_receive + i * receiveStride(m_packet_size), slot);
+		}
+		if(!m_mcastAddress.empty()){
+			m_server->joinMCastGroup(m_mcastAddress, m_mcastConn);
+			m_mcast = true;
+			m_mcastReceive = (char*)m_server->localAlloc(Config::RDMA_MAX_WR * receiveStride(m_packet_size));
+			for(size_t i = 0; i < Config::RDMA_MAX_WR; i++){
+				m_server->receiveMCast(m_mcastConn, m_mcastReceive + i * receiveStride(m_packet_size), slot);
+			}
+		}
+
+	} else {
+		// Client
+		for (size_t i = 0; i < thread_count; i++) {
+			UnreliablePerfClientThread* perfThread = new UnreliablePerfClientThread(m_rdma_addresses, m_ownIpPort, m_sequencerIpPort, m_mcastAddress, m_packet_size, m_iterations_per_thread, m_mode);
+			m_client_threads.push_back(perfThread);
+		}
+	}
+}
+
+bool rdma::UnreliablePerfTest::serve(){
+	// receives of a queue pair complete in the order they were posted
+	const size_t slot = messageSize(m_packet_size);
+	bool handled = false;
+	if(m_mcast && m_server->pollReceiveMCast(m_mcastConn, false) > 0){ // false=no poll
+		char *receive = m_mcastReceive + (m_mcastReceived++ % Config::RDMA_MAX_WR) * receiveStride(m_packet_size);
+		UnreliablePerfMessage message = *(UnreliablePerfMessage*)receive;
+		m_server->receiveMCast(m_mcastConn, receive, slot);
+		handle(&message);
+		handled = true;
+	}
+	if(m_server->pollReceive(0, false) > 0){ // false=no poll
+		char *receive = m_receive + (m_received++ % Config::RDMA_MAX_WR) * receiveStride(m_packet_size);
+		UnreliablePerfMessage message = *(UnreliablePerfMessage*)receive;
+		m_server->receive(0, receive, slot);
+		handle(&message);
+		handled = true;
+	}
+	return handled;
+}
+
+void rdma::UnreliablePerfTest::handle(UnreliablePerfMessage *message){
+	if(message->operation >= UD_OPERATION_COUNT) return;
+	const size_t opIdx = message->operation;
+	switch(message->type){
+		case UD_MESSAGE_DATA:
+			m_dataCounts[opIdx][message->sender]++;
+			if(m_mode == UD_LATENCY_MODE) answer(*message, messageSize(m_packet_size));
+			break;
+		case UD_MESSAGE_BARRIER: {
+			// answered as soon as all client threads arrived, retransmissions afterwards directly
+			bool complete = (m_barrier[opIdx].size() >= thread_count);
+			m_barrier[opIdx].insert(message->sender);
+			if(complete){
+				answer(*message, sizeof(UnreliablePerfMessage));
+			} else if(m_barrier[opIdx].size() >= thread_count){
+				UnreliablePerfMessage barrier = *message;
+				for(const NodeID &sender : m_barrier[opIdx]){
+					barrier.sender = sender;
+					answer(barrier, sizeof(UnreliablePerfMessage));
+				}
+			}
+			break;
+		}
+		case UD_MESSAGE_END: {
+			m_ended[opIdx].insert(message->sender);
+			UnreliablePerfMessage end = *message;
+			end.count = m_dataCounts[opIdx][message->sender];
+			answer(end, sizeof(UnreliablePerfMessage));
+			break;
+		}
+		default: break;
+	}
+}
+
+void rdma::UnreliablePerfTest::answer(const UnreliablePerfMessage &message, size_t size){
+	// unsignaled sends are regularly signaled and awaited, so a slot is free again after a full round
+	char *slot = m_answers + (m_answered++ % Config::RDMA_MAX_WR) * messageSize(m_packet_size);
+	memcpy(slot, &message, sizeof(UnreliablePerfMessage));
+	((UnreliablePerfMessage*)slot)->sender = m_server->getOwnNodeID();
+	m_server->send(message.sender, slot, size, false); // false=unsignaled
+}
+
+void rdma::UnreliablePerfTest::runTest(){
+	if(m_is_server){
+		// Server
+		std::cout << "Starting server on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "' . . ." << std::endl;
+		if(!m_server->startServer()){
+			std::cerr << "UnreliablePerfTest::runTest(): Could not start server" << std::endl;
+			throw invalid_argument("UnreliablePerfTest server startup failed");
+		} else {
+			std::cout << "Server running on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "'" << std::endl;
+		}
+
+		for(size_t opIdx = 0; opIdx < UD_OPERATION_COUNT; opIdx++){
+			if(!hasTestOperation(UD_OPERATIONS[opIdx])) continue;
+			while(m_ended[opIdx].size() < thread_count){
+				serve();
+			}
+		}
+
+		// keep answering retransmitted end messages until clients are done
+		while (m_server->isRunning() && m_server->getConnectedConnIDs().size() > 0){
+			if(!serve()) usleep(Config::RDMA_SLEEP_INTERVAL);
+		}
+		std::cout << "Server stopped" << std::endl;
+
+	} else {
+		// Client
+		for(size_t opIdx = 0; opIdx < UD_OPERATION_COUNT; opIdx++){
+			if(hasTestOperation(UD_OPERATIONS[opIdx])){
+				preparePerfEvents();
+				makeThreadsReady(UD_OPERATIONS[opIdx]);
+				startPerfEvents();
+				runThreads();
+				stopPerfEvents(UD_OPERATIONS[opIdx], m_iterations_per_thread * thread_count, thread_count);
+			}
+		}
+	}
+}
+
+
+std::string rdma::UnreliablePerfTest::getTestResults(std::string csvFileName, bool csvAddHeader){
+	if(m_is_server){
+		return "only client";
+	} else {
+
+		/*	Every thread sent iterations data messages. A multicast message
+			should arrive at every server, so its deliveries are averaged
+			over the servers. Rates of the threads add up.
+		*/
+
+		const long double tu = (long double)NANO_SEC; // 1sec (nano to seconds as time unit)
+		const uint64_t sent = m_iterations_per_thread * thread_count;
+		const size_t packet_size = messageSize(m_packet_size);
+		LatencyHistogram histograms[UD_OPERATION_COUNT];
+		long double sentRate[UD_OPERATION_COUNT] = { 0 }, deliveredRate[UD_OPERATION_COUNT] = { 0 };
+		long double delivered[UD_OPERATION_COUNT] = { 0 }, lost[UD_OPERATION_COUNT] = { 0 };
+		for(size_t opIdx = 0; opIdx < UD_OPERATION_COUNT; opIdx++){
+			long double receivers = (UD_OPERATIONS[opIdx] == MULTICAST_OPERATION ? m_rdma_addresses.size() : 1);
+			for(size_t i=0; i<m_client_threads.size(); i++){
+				UnreliablePerfClientThread *thr = m_client_threads[i];
+				histograms[opIdx].merge(thr->m_histograms[opIdx]);
+				delivered[opIdx] += thr->m_delivered[opIdx] / receivers;
+				lost[opIdx] += thr->m_lost[opIdx];
+				if(thr->m_elapsedNs[opIdx] <= 0) continue;
+				sentRate[opIdx] += m_iterations_per_thread * tu / thr->m_elapsedNs[opIdx];
+				deliveredRate[opIdx] += thr->m_delivered[opIdx] / receivers * tu / thr->m_elapsedNs[opIdx];
+			}
+		}
+		auto lossPercent = [&](size_t opIdx){
+			long double loss = (m_mode == UD_BANDWIDTH_MODE ? (sent - delivered[opIdx]) / sent : lost[opIdx] / sent);
+			return round((loss < 0 ? 0 : loss) * 100000)/1000.0;
+		};
+
+		// write results into CSV file
+		if(!csvFileName.empty()){
+			const long double su = 1024*1024; // size unit for MebiBytes
+			const long double ustu = 1000; // nanosec to microsec
+			std::ofstream ofs;
+			ofs.open(csvFileName, std::ofstream::out | std::ofstream::app);
+			ofs << rdma::CSV_PRINT_NOTATION << rdma::CSV_PRINT_PRECISION;
+			if(csvAddHeader){
+				ofs << std::endl << (m_mode == UD_BANDWIDTH_MODE ? "UD BANDWIDTH, " : "UD LATENCY, ") << getTestParameters(true) << std::endl;
+				ofs << "PacketSize [Bytes]";
+				for(size_t opIdx = 0; opIdx < UD_OPERATION_COUNT; opIdx++){
+					if(!hasTestOperation(UD_OPERATIONS[opIdx])) continue;
+					std::string name = UD_OPERATION_NAMES[opIdx];
+					if(m_mode == UD_BANDWIDTH_MODE){
+						ofs << ", Sent " << name << " [MB/s], Delivered " << name << " [MB/s], Sent " << name << " [Op/s], Delivered " << name << " [Op/s]";
+					} else {
+						ofs << ", Avg " << name << " [usec], Median " << name << " [usec], Min " << name << " [usec], Max " << name << " [usec]";
+						rdma::PerfTest::writePercentilesCSVHeader(ofs, name);
+					}
+					ofs << ", Loss " << name << " [%]";
+				}
+				writePerfEventsCSVHeader(ofs);
+				ofs << std::endl;
+			}
+			ofs << packet_size; // packet size Bytes
+			for(size_t opIdx = 0; opIdx < UD_OPERATION_COUNT; opIdx++){
+				if(!hasTestOperation(UD_OPERATIONS[opIdx])) continue;
+				if(m_mode == UD_BANDWIDTH_MODE){
+					ofs << ", " << (round(sentRate[opIdx]*packet_size/su * 100000)/100000.0); // sent MB/s
+					ofs << ", " << (round(deliveredRate[opIdx]*packet_size/su * 100000)/100000.0); // delivered MB/s
+					ofs << ", " << round(sentRate[opIdx]) << ", " << round(deliveredRate[opIdx]); // sent & delivered Op/s
+				} else {
+					ofs << ", " << (round(histograms[opIdx].getAverage()/ustu * 10)/10.0); // avg us
+					ofs << ", " << (round(histograms[opIdx].getMedian()/ustu * 10)/10.0); // median us
+					ofs << ", " << (round(histograms[opIdx].getMin()/ustu * 10)/10.0); // min us
+					ofs << ", " << (round(histograms[opIdx].getMax()/ustu * 10)/10.0); // max us
+					rdma::PerfTest::writePercentilesCSV(ofs, histograms[opIdx]);
+				}
+				ofs << ", " << lossPercent(opIdx); // loss %
+			}
+			writePerfEventsCSV(ofs);
+			ofs << std::endl; ofs.close();
+		}
+
+		// write full histograms
+		if(m_mode == UD_LATENCY_MODE && !histogramFileName.empty()){
+			std::ofstream ofs;
+			ofs.open(histogramFileName, std::ofstream::out | std::ofstream::app);
+			ofs << std::endl << "UD LATENCY HISTOGRAM, " << getTestParameters(true) << ", packetsize=" << packet_size << std::endl;
+			LatencyHistogram::writeBucketsHeader(ofs);
+			for(size_t opIdx = 0; opIdx < UD_OPERATION_COUNT; opIdx++){
+				if(hasTestOperation(UD_OPERATIONS[opIdx])) histograms[opIdx].writeBuckets(ofs, UD_OPERATION_NAMES[opIdx]);
+			}
+			ofs.close();
+		}
+
+		// generate result string
+		std::ostringstream oss;
+		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
+		if(m_mode == UD_LATENCY_MODE) oss << "Measured as 'round-trip time' latency, multicast until all servers answered:" << std::endl;
+		for(size_t opIdx = 0; opIdx < UD_OPERATION_COUNT; opIdx++){
+			if(!hasTestOperation(UD_OPERATIONS[opIdx])) continue;
+			std::string name = std::string(UD_OPERATION_NAMES[opIdx]) + ":";
+			oss << " - " << std::left << std::setw(14) << name << std::right;
+			if(m_mode == UD_BANDWIDTH_MODE){
+				oss << "sent = " << rdma::PerfTest::convertBandwidth(sentRate[opIdx]*packet_size) << " (" << rdma::PerfTest::convertCountPerSec(sentRate[opIdx]) << ")";
+				oss << "    delivered = " << rdma::PerfTest::convertBandwidth(deliveredRate[opIdx]*packet_size) << " (" << rdma::PerfTest::convertCountPerSec(deliveredRate[opIdx]) << ")";
+			} else {
+				oss << "average = " << rdma::PerfTest::convertTime(histograms[opIdx].getAverage()) << "    median = " << rdma::PerfTest::convertTime(histograms[opIdx].getMedian());
+				oss << "    range = " <<  rdma::PerfTest::convertTime(histograms[opIdx].getMin()) << " - " << rdma::PerfTest::convertTime(histograms[opIdx].getMax());
+			}
+			oss << "    loss = " << lossPercent(opIdx) << "%" << std::endl;
+			if(m_mode == UD_LATENCY_MODE) oss << rdma::PerfTest::convertPercentiles(histograms[opIdx]) << std::endl;
+		}
+		return oss.str();
+	}
+	return NULL;
+}
@@ -0,0 +1,143 @@
+#ifndef UnreliablePerfTest_H
+#define UnreliablePerfTest_H
+
+#include "PerfTest.h"
+#include "LatencyHistogram.h"
+#include "../src/rdma/RDMAClient.h"
+#include "../src/rdma/RDMAServer.h"
+#include "../src/thread/Thread.h"
+
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+namespace rdma {
+
+enum UnreliableTestMode { UD_BANDWIDTH_MODE=0, UD_LATENCY_MODE=1 };
+
+const size_t UD_OPERATION_COUNT = 2;
+const TestOperation UD_OPERATIONS[UD_OPERATION_COUNT] = { SEND_RECEIVE_OPERATION, MULTICAST_OPERATION };
+const char* const UD_OPERATION_NAMES[UD_OPERATION_COUNT] = { "Send/Recv", "Multicast" };
+
+enum UnreliableMessageType { UD_MESSAGE_DATA=1, UD_MESSAGE_BARRIER=2, UD_MESSAGE_END=3 };
+
+/* Struct: UnreliablePerfMessage
+ * ----------------
+ * Header of every message of the UD tests. The server answers
+ * control messages (barrier, end) with the same header, the
+ * answer of the end message carries how many data messages of
+ * the sender arrived.
+ */
+struct UnreliablePerfMessage {
+	uint32_t type;
+	uint32_t operation; // index into UD_OPERATIONS
+	uint64_t seq;
+	NodeID sender;
+	uint64_t count;
+};
+
+
+/* Class: UnreliablePerfClientThread
+ * ----------------
+ * Sends UD messages to the servers (round-robin) or to the multicast
+ * group they joined. UD gives no delivery guarantee, so the barrier and
+ * end control messages are retransmitted until every server answered
+ * and latency requests without answer in time count as lost.
+ */
+class UnreliablePerfClientThread : public Thread {
+public:
+	UnreliablePerfClientThread(std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, std::string mcastAddress, size_t packet_size, size_t iterations_per_thread, UnreliableTestMode mode);
+	~UnreliablePerfClientThread();
+	void run();
+	bool ready() {
+		return m_ready;
+	}
+
+	// recorded without locking per operation, merged after run
+	LatencyHistogram m_histograms[UD_OPERATION_COUNT];
+	int64_t m_elapsedNs[UD_OPERATION_COUNT] = { 0 };
+	uint64_t m_delivered[UD_OPERATION_COUNT] = { 0 }; // data messages counted by all servers together
+	uint64_t m_lost[UD_OPERATION_COUNT] = { 0 }; // latency requests without all answers
+
+private:
+	bool m_ready = false;
+	RDMAClient<UnreliableRDMA> *m_client;
+	size_t m_packet_size;
+	size_t m_iterations_per_thread;
+	UnreliableTestMode m_mode;
+	std::vector<std::string> m_rdma_addresses;
+	std::vector<NodeID> m_addr;
+	NodeID m_mcastConn = 0;
+	bool m_mcast = false;
+
+	char *m_send; // data message, control message
+	char *m_receive; // ring of receive slots
+	size_t m_receive_slots;
+	size_t m_received = 0;
+	std::vector<uint64_t> m_serverCounts;
+
+	void sendData(size_t opIdx, uint64_t seq, bool signaled);
+	void control(UnreliableMessageType type, size_t opIdx);
+	size_t awaitAnswers(UnreliableMessageType type, size_t opIdx, uint64_t seq, std::vector<bool> &answered, int64_t timeoutNs);
+};
+
+
+class UnreliablePerfTest : public rdma::PerfTest {
+public:
+	UnreliablePerfTest(int testOperations, bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, std::string mcastAddress, int client_count, int thread_count, uint64_t packet_size, uint64_t iterations_per_thread, UnreliableTestMode mode);
+	virtual ~UnreliablePerfTest();
+	std::string getTestParameters();
+	void setupTest();
+	void runTest();
+	std::string getTestResults(std::string csvFileName="", bool csvAddHeader=true);
+
+	// messages are at least as big as the header
+	static size_t messageSize(size_t size){
+		return (size < sizeof(UnreliablePerfMessage) ? sizeof(UnreliablePerfMessage) : size);
+	}
+
+	static mutex waitLock;
+	static condition_variable waitCv;
+	static bool signaled;
+	static TestOperation testOperation;
+	static size_t thread_count, client_count;
+
+private:
+	bool m_is_server;
+	std::vector<std::string> m_rdma_addresses;
+	int m_rdma_port;
+	std::string m_ownIpPort;
+	std::string m_sequencerIpPort;
+	std::string m_mcastAddress;
+	uint64_t m_packet_size;
+	uint64_t m_memory_size;
+	uint64_t m_iterations_per_thread;
+	UnreliableTestMode m_mode;
+	std::vector<UnreliablePerfClientThread*> m_client_threads;
+
+	// server
+	RDMAServer<UnreliableRDMA>* m_server = nullptr;
+	NodeID m_mcastConn = 0;
+	bool m_mcast = false;
+	char *m_receive = nullptr; // receive ring of the UD queue pair
+	char *m_mcastReceive = nullptr; // receive ring of the multicast queue pair
+	char *m_answers = nullptr; // ring of answers
+	size_t m_received = 0, m_mcastReceived = 0, m_answered = 0;
+	std::unordered_map<NodeID, uint64_t> m_dataCounts[UD_OPERATION_COUNT];
+	std::set<NodeID> m_barrier[UD_OPERATION_COUNT];
+	std::set<NodeID> m_ended[UD_OPERATION_COUNT];
+
+	std::string getTestParameters(bool forCSV);
+	void makeThreadsReady(TestOperation testOperation);
+	void runThreads();
+	bool serve();
+	void handle(UnreliablePerfMessage *message);
+	void answer(const UnreliablePerfMessage &message, size_t size);
+};
+
+}
+
+#endif
@@ -0,0 +1,445 @@
+#include "WorkloadPerfTest.h"
+
+#include "../src/memory/BaseMemory.h"
+#include "../src/memory/MainMemory.h"
+#include "../src/memory/CudaMemory.h"
+#include "../src/utils/Config.h"
+#include "../src/utils/StringHelper.h"
+
+#include <algorithm>
+
+mutex rdma::WorkloadPerfTest::waitLock;
+condition_variable rdma::WorkloadPerfTest::waitCv;
+bool rdma::WorkloadPerfTest::signaled;
+size_t rdma::WorkloadPerfTest::client_count;
+size_t rdma::WorkloadPerfTest::thread_count;
+
+/*	LT: Local Thread, O: Object, K: Key, S: Amount of Servers
+ *
+ *	Client Memory:	LT1{ Write Object, Read Object }, LT2{ ... }, ...
+ *	Server Memory:	O1, O2, ... (table shared by all client threads)
+ *
+ *	Key K is object K / S of server K % S. The server doesn't know how many servers
+ *	share the key space, therefore it allocates all keys but only K / S are accessed.
+ */
+
+
+rdma::WorkloadKeyGenerator::WorkloadKeyGenerator(const WorkloadKeys &keys, uint64_t seed) : m_generator(seed), m_uniform(0.0, 1.0) {
+	this->m_keys = keys;
+	this->m_hotKeys = (uint64_t)(keys.hotSet * keys.keys);
+	if(m_hotKeys == 0) m_hotKeys = 1;
+	if(m_hotKeys > keys.keys) m_hotKeys = keys.keys;
+	this->m_zeta2 = zeta(2, keys.theta);
+	this->m_alpha = 1.0 / (1.0 - keys.theta);
+	this->m_eta = (keys.zetan > m_zeta2 ? (1 - std::pow(2.0 / keys.keys, 1 - keys.theta)) / (1 - m_zeta2 / keys.zetan) : 0);
+}
+
+uint64_t rdma::WorkloadKeyGenerator::next(){
+	const uint64_t n = m_keys.keys;
+	switch(m_keys.distribution){
+		case DISTRIBUTION_UNIFORM:
+			return (uint64_t)(m_uniform(m_generator) * n) % n;
+		case DISTRIBUTION_ZIPFIAN: {
+			double u = m_uniform(m_generator);
+			double uz = u * m_keys.zetan;
+			uint64_t rank;
+			if(uz < 1.0){
+				rank = 0;
+			} else if(uz < 1.0 + std::pow(0.5, m_keys.theta)){
+				rank = 1;
+			} else {
+				rank = (uint64_t)(n * std::pow(m_eta * u - m_eta + 1, m_alpha));
+			}
+			return fnvHash(rank < n ? rank : n - 1) % n;
+		}
+		case DISTRIBUTION_HOTSPOT:
+			if(m_hotKeys >= n || m_uniform(m_generator) < m_keys.hotOps){
+				return (uint64_t)(m_uniform(m_generator) * m_hotKeys) % m_hotKeys;
+			}
+			return m_hotKeys + (uint64_t)(m_uniform(m_generator) * (n - m_hotKeys)) % (n - m_hotKeys);
+	}
+	throw invalid_argument("WorkloadKeyGenerator unknown distribution");
+}
+
+double rdma::WorkloadKeyGenerator::zeta(uint64_t n, double theta){
+	double sum = 0;
+	for(uint64_t i = 1; i <= n; i++){
+		sum += 1.0 / std::pow((double)i, theta);
+	}
+	return sum;
+}
+
+uint64_t rdma::WorkloadKeyGenerator::fnvHash(uint64_t value){
+	uint64_t hash = 0xCBF29CE484222325ULL; // FNV-1a 64bit offset basis
+	for(int i = 0; i < 8; i++){
+		hash ^= (value & 0xFF);
+		hash *= 1099511628211ULL; // FNV 64bit prime
+		value >>= 8;
+	}
+	return hash;
+}
+
+
+
+rdma::WorkloadPerfClientThread::WorkloadPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t object_size, const WorkloadKeys &keys, const std::vector<uint32_t> &mix, size_t iterations_per_thread) {
+	this->m_client = new RDMAClient<ReliableRDMA>(memory, "WorkloadPerfTestClient", ownIpPort, sequencerIpPort);
+	this->m_rdma_addresses = rdma_addresses;
+	this->m_object_size = object_size;
+	this->m_slot_size = WorkloadPerfTest::slotSize(object_size);
+	this->m_keys = keys;
+	this->m_mix = mix;
+	this->m_iterations_per_thread = iterations_per_thread;
+
+	for (size_t i = 0; i < m_rdma_addresses.size(); ++i) {
+		NodeID nodeId = 0;
+		string conn = m_rdma_addresses[i];
+		if(!m_client->connect(conn, nodeId)) {
+			std::cerr << "WorkloadPerfThread::WorkloadPerfThread(): Could not connect to '" << conn << "'" << std::endl;
+			throw invalid_argument("WorkloadPerfThread connection failed");
+		}
+		m_addr.push_back(nodeId);
+	}
+
+	m_local_memory = m_client->localMalloc(m_slot_size * 2);
+	m_local_memory->openContext();
+	m_local_memory->setMemory(0);
+}
+
+rdma::WorkloadPerfClientThread::~WorkloadPerfClientThread() {
+	delete m_local_memory; // implicitly deletes local allocs in RDMAClient
+	delete m_client;
+}
+
+void rdma::WorkloadPerfClientThread::run() {
+	rdma::PerfTest::global_barrier_client(m_client, m_addr); // global barrier
+	unique_lock<mutex> lck(WorkloadPerfTest::waitLock); // local barrier
+	if (!WorkloadPerfTest::signaled) {
+		m_ready = true;
+		WorkloadPerfTest::waitCv.wait(lck);
+	}
+	lck.unlock();
+	m_ready = false;
+
+	// operation types are picked by their cumulative weights
+	uint32_t cumulative[WORKLOAD_OPERATION_COUNT], total = 0;
+	for(size_t op = 0; op < WORKLOAD_OPERATION_COUNT; op++){
+		total += m_mix[op];
+		cumulative[op] = total;
+	}
+	std::random_device seeds;
+	WorkloadKeyGenerator keys(m_keys, ((uint64_t)seeds() << 32) | seeds());
+	std::mt19937_64 generator(seeds());
+	std::uniform_int_distribution<uint32_t> weights(0, total - 1);
+
+	auto start = rdma::PerfTest::startTimer();
+	for(size_t i = 0; i < m_iterations_per_thread; i++){
+		const uint64_t key = keys.next();
+		const uint32_t weight = weights(generator);
+		size_t opIdx = 0;
+		while(weight >= cumulative[opIdx]) opIdx++;
+
+		auto opStart = rdma::PerfTest::startTimer();
+		issue(opIdx, key, i);
+		m_histograms[opIdx].record(rdma::PerfTest::stopTimer(opStart));
+	}
+	m_elapsedNs = rdma::PerfTest::stopTimer(start);
+}
+
+void rdma::WorkloadPerfClientThread::issue(size_t opIdx, uint64_t key, size_t i){
+	const size_t connIdx = key % m_addr.size();
+	const size_t remoteOffset = (key / m_addr.size()) * m_slot_size;
+	switch(WORKLOAD_OPERATIONS[opIdx]){
+		case READ_OPERATION:
+			m_client->read(m_addr[connIdx], remoteOffset, m_local_memory->pointer(m_slot_size), m_object_size, true); // true=signaled
+			break;
+		case WRITE_OPERATION:
+			m_client->write(m_addr[connIdx], remoteOffset, m_local_memory->pointer(), m_object_size, true); // true=signaled
+			break;
+		case FETCH_ADD_OPERATION:
+			m_client->fetchAndAdd(m_addr[connIdx], remoteOffset, m_local_memory->pointer(m_slot_size), 1, rdma::ATOMICS_SIZE, true); // true=signaled
+			break;
+		case COMPARE_SWAP_OPERATION:
+			m_client->compareAndSwap(m_addr[connIdx], remoteOffset, m_local_memory->pointer(m_slot_size), i, i+1, rdma::ATOMICS_SIZE, true); // true=signaled
+			break;
+		default: throw invalid_argument("WorkloadPerfClientThread unknown operation");
+	}
+}
+
+
+
+static int workloadTestOperations(const std::vector<uint32_t> &mix){
+	int testOperations = 0;
+	for(size_t op = 0; op < rdma::WORKLOAD_OPERATION_COUNT && op < mix.size(); op++){
+		if(mix[op] > 0) testOperations |= (int)rdma::WORKLOAD_OPERATIONS[op];
+	} return testOperations;
+}
+
+rdma::WorkloadPerfTest::WorkloadPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t object_size, WorkloadKeys keys, std::vector<uint32_t> mix, uint64_t iterations_per_thread) : PerfTest(workloadTestOperations(mix)){
+	if(is_server) thread_count *= client_count;
+	if(mix.size() != WORKLOAD_OPERATION_COUNT || testOperations == 0) throw invalid_argument("WorkloadPerfTest mix must contain at least one operation");
+	if(keys.keys == 0) throw invalid_argument("WorkloadPerfTest requires at least one key");
+	if(keys.theta <= 0 || keys.theta >= 1) throw invalid_argument("WorkloadPerfTest zipfian theta must be between 0 and 1 (exclusive)");
+	if(keys.hotSet <= 0 || keys.hotSet > 1 || keys.hotOps < 0 || keys.hotOps > 1) throw invalid_argument("WorkloadPerfTest hotspot fractions must be between 0 and 1");
+
+	this->m_is_server = is_server;
+	this->m_rdma_port = rdma_port;
+	this->m_ownIpPort = ownIpPort;
+	this->m_sequencerIpPort = sequencerIpPort;
+	this->m_local_gpu_index = local_gpu_index;
+	this->m_actual_gpu_index = -1;
+	this->m_remote_gpu_index = remote_gpu_index;
+	this->client_count = client_count;
+	this->thread_count = thread_count;
+	this->m_object_size = object_size;
+	this->m_keys = keys;
+	this->m_mix = mix;
+	this->m_iterations_per_thread = iterations_per_thread;
+	this->m_rdma_addresses = rdma_addresses;
+	if(is_server){
+		this->m_memory_size = keys.keys * slotSize(object_size); // table
+	} else {
+		this->m_memory_size = thread_count * slotSize(object_size) * 2; // write and read object per thread
+		if(keys.distribution == DISTRIBUTION_ZIPFIAN) m_keys.zetan = WorkloadKeyGenerator::zeta(keys.keys, keys.theta);
+	}
+	this->m_elapsedNs = -1;
+}
+rdma::WorkloadPerfTest::~WorkloadPerfTest(){
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		delete m_client_threads[i];
+	}
+	m_client_threads.clear();
+	if(m_is_server)
+		delete m_server;
+	delete m_memory;
+}
+
+std::vector<uint32_t> rdma::WorkloadPerfTest::parseMix(std::string mix){
+	std::vector<uint32_t> weights(WORKLOAD_OPERATION_COUNT, 0);
+	std::transform(mix.begin(), mix.end(), mix.begin(), ::tolower);
+	if(mix == "a" || mix == "ycsb-a"){
+		weights[0] = 50; weights[1] = 50;
+		return weights;
+	} else if(mix == "b" || mix == "ycsb-b"){
+		weights[0] = 95; weights[1] = 5;
+		return weights;
+	} else if(mix == "c" || mix == "ycsb-c"){
+		weights[0] = 100;
+		return weights;
+	}
+
+	for(std::string &part : StringHelper::split(mix)){
+		size_t sep = part.find('=');
+		if(sep == std::string::npos) throw invalid_argument("Workload mix '" + part + "' has no weight (e.g. 'read=95')");
+		std::string name = part.substr(0, sep);
+		StringHelper::trim(name);
+		size_t op;
+		if(name.find("read") == 0 || name.find("get") == 0){
+			op = 0;
+		} else if(name.find("wri") == 0 || name.find("upd") == 0 || name.find("put") == 0){
+			op = 1;
+		} else if(name.find("fet") == 0 || name.find("add") == 0 || name.find("ato") == 0){
+			op = 2;
+		} else if(name.find("com") == 0 || name.find("swa") == 0 || name.find("cas") == 0){
+			op = 3;
+		} else {
+			throw invalid_argument("No workload operation with name '" + name + "' found");
+		}
+		weights[op] += (uint32_t)std::stoul(part.substr(sep + 1));
+	}
+	return weights;
+}
+
+std::string rdma::WorkloadPerfTest::getMixName(const std::vector<uint32_t> &mix){
+	std::ostringstream oss;
+	for(size_t op = 0; op < WORKLOAD_OPERATION_COUNT && op < mix.size(); op++){
+		if(mix[op] == 0) continue;
+		if(oss.tellp() > 0) oss << "/";
+		oss << WORKLOAD_OPERATION_NAMES[op] << ":" << mix[op];
+	} return oss.str();
+}
+
+std::string rdma::WorkloadPerfTest::getDistributionName(const WorkloadKeys &keys){
+	std::ostringstream oss;
+	switch(keys.distribution){
+		case DISTRIBUTION_UNIFORM: oss << "Uniform"; break;
+		case DISTRIBUTION_ZIPFIAN: oss << "Zipfian(" << keys.theta << ")"; break;
+		case DISTRIBUTION_HOTSPOT: oss << "Hotspot(" << keys.hotSet << ":" << keys.hotOps << ")"; break;
+	} return oss.str();
+}
+
+std::string rdma::WorkloadPerfTest::getTestParameters(bool forCSV){
+	std::ostringstream oss;
+	oss << (m_is_server ? "Server" : "Client") << ", threads=" << thread_count;
+	if(!forCSV){
+		oss << ", objectsize=" << m_object_size;
+		oss << ", memory=" << m_memory_size << " (";
+		if(m_is_server){ oss << m_keys.keys << "x "; } else { oss << "2x " << thread_count << "x "; } oss << slotSize(m_object_size) << ")";
+	}
+	oss << ", memory_type=" << getMemoryName(m_local_gpu_index, m_actual_gpu_index) << (m_remote_gpu_index!=-404 ? "->"+getMemoryName(m_remote_gpu_index) : "");
+	oss << ", iterations=" << (m_iterations_per_thread*thread_count) << ", keys=" << m_keys.keys;
+	oss << ", distribution=" << getDistributionName(m_keys) << ", mix=" << getMixName(m_mix);
+	if(!forCSV){ oss << ", clients=" << client_count << ", servers=" << m_rdma_addresses.size(); }
+	return oss.str();
+}
+std::string rdma::WorkloadPerfTest::getTestParameters(){
+	return getTestParameters(false);
+}
+
+void rdma::WorkloadPerfTest::makeThreadsReady(){
+	WorkloadPerfTest::signaled = false;
+	if(m_is_server){
+		rdma::PerfTest::global_barrier_server(m_server, (size_t)thread_count);
+	} else {
+		for(WorkloadPerfClientThread* perfThread : m_client_threads){ perfThread->start(); }
+		for(WorkloadPerfClientThread* perfThread : m_client_threads){ while(!perfThread->ready()) usleep(Config::RDMA_SLEEP_INTERVAL); }
+	}
+}
+
+void rdma::WorkloadPerfTest::runThreads(){
+	WorkloadPerfTest::signaled = false;
+	unique_lock<mutex> lck(WorkloadPerfTest::waitLock);
+	WorkloadPerfTest::waitCv.notify_all();
+	WorkloadPerfTest::signaled = true;
+	lck.unlock();
+	for (size_t i = 0; i < m_client_threads.size(); i++) {
+		m_client_threads[i]->join();
+	}
+}
+
+void rdma::WorkloadPerfTest::setupTest(){
+	m_elapsedNs = -1;
+	m_actual_gpu_index = -1;
+	#ifdef CUDA_ENABLED /* defined in CMakeLists.txt to globally enable/disable CUDA support */
+		if(m_local_gpu_index <= -3){
+			m_memory = new rdma::MainMemory(m_memory_size);
+		} else {
+			rdma::CudaMemory *mem = new rdma::CudaMemory(m_memory_size, m_local_gpu_index);
+			m_memory = mem;
+			m_actual_gpu_index = mem->getDeviceIndex();
+		}
+	#else
+		m_memory = (rdma::BaseMemory*)new MainMemory(m_memory_size);
+	#endif
+
+	if(m_is_server){
+		// Server
+		m_memory->setMemory(0); // table which is accessed by the clients
+		m_server = new RDMAServer<ReliableRDMA>("WorkloadTestRDMAServer", m_rdma_port, Network::getAddressOfConnection(m_ownIpPort), m_memory, m_sequencerIpPort);
+
+	} else {
+		// Client
+		for (size_t i = 0; i < thread_count; i++) {
+			WorkloadPerfClientThread* perfThread = new WorkloadPerfClientThread(m_memory, m_rdma_addresses, m_ownIpPort, m_sequencerIpPort, m_object_size, m_keys, m_mix, m_iterations_per_thread);
+			m_client_threads.push_back(perfThread);
+		}
+	}
+}
+
+void rdma::WorkloadPerfTest::runTest(){
+	if(m_is_server){
+		// Server
+		std::cout << "Starting server on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "' . . ." << std::endl;
+		if(!m_server->startServer()){
+			std::cerr << "WorkloadPerfTest::runTest(): Could not start server" << std::endl;
+			throw invalid_argument("WorkloadPerfTest server startup failed");
+		} else {
+			std::cout << "Server running on '" << rdma::Config::getIP(rdma::Config::RDMA_INTERFACE) << ":" << m_rdma_port << "'" << std::endl;
+		}
+
+		makeThreadsReady();
+		runThreads();
+
+		// wait until clients have finished
+		while (m_server->isRunning() && m_server->getConnectedConnIDs().size() > 0) usleep(Config::RDMA_SLEEP_INTERVAL);
+		std::cout << "Server stopped" << std::endl;
+
+	} else {
+		// Client
+		preparePerfEvents();
+		makeThreadsReady();
+		startPerfEvents();
+		auto start = rdma::PerfTest::startTimer();
+		runThreads();
+		m_elapsedNs = rdma::PerfTest::stopTimer(start);
+		stopPerfEvents("Workload", m_iterations_per_thread * thread_count, thread_count);
+	}
+}
+
+
+std::string rdma::WorkloadPerfTest::getTestResults(std::string csvFileName, bool csvAddHeader){
+	if(m_is_server){
+		return "only client";
+	} else {
+
+		// threads recorded into their own histograms, throughputs are relative to the time of all threads together
+		const long double tu = (long double)NANO_SEC; // 1sec (nano to seconds as time unit)
+		LatencyHistogram histograms[WORKLOAD_OPERATION_COUNT];
+		for(size_t i=0; i<m_client_threads.size(); i++){
+			for(size_t op = 0; op < WORKLOAD_OPERATION_COUNT; op++){
+				histograms[op].merge(m_client_threads[i]->m_histograms[op]);
+			}
+		}
+		const uint64_t operations = m_iterations_per_thread * thread_count;
+
+		// write results into CSV file
+		if(!csvFileName.empty()){
+			const long double ustu = 1000; // nanosec to microsec
+			std::ofstream ofs;
+			ofs.open(csvFileName, std::ofstream::out | std::ofstream::app);
+			ofs << rdma::CSV_PRINT_NOTATION << rdma::CSV_PRINT_PRECISION;
+			if(csvAddHeader){
+				ofs << std::endl << "WORKLOAD, " << getTestParameters(true) << std::endl;
+				ofs << "ObjectSize [Bytes], Total [Op/s]";
+				for(size_t op = 0; op < WORKLOAD_OPERATION_COUNT; op++){
+					if(!hasTestOperation(WORKLOAD_OPERATIONS[op])) continue;
+					std::string name = WORKLOAD_OPERATION_NAMES[op];
+					ofs << ", " << name << " [Op/s], Avg " << name << " [usec], Median " << name << " [usec], Min " << name << " [usec], Max " << name << " [usec]";
+					rdma::PerfTest::writePercentilesCSVHeader(ofs, name);
+				}
+				writePerfEventsCSVHeader(ofs);
+				ofs << std::endl;
+			}
+			ofs << m_object_size << ", " << round(operations*tu/m_elapsedNs); // object size Bytes, total Op/s
+			for(size_t op = 0; op < WORKLOAD_OPERATION_COUNT; op++){
+				if(!hasTestOperation(WORKLOAD_OPERATIONS[op])) continue;
+				ofs << ", " << round(histograms[op].getCount()*tu/m_elapsedNs) << ", "; // Op/s
+				ofs << (round(histograms[op].getAverage()/ustu * 10)/10.0) << ", "; // avg us
+				ofs << (round(histograms[op].getMedian()/ustu * 10)/10.0) << ", "; // median us
+				ofs << (round(histograms[op].getMin()/ustu * 10)/10.0) << ", "; // min us
+				ofs << (round(histograms[op].getMax()/ustu * 10)/10.0); // max us
+				rdma::PerfTest::writePercentilesCSV(ofs, histograms[op]);
+			}
+			writePerfEventsCSV(ofs);
+			ofs << std::endl; ofs.close();
+		}
+
+		// write full histograms
+		if(!histogramFileName.empty()){
+			std::ofstream ofs;
+			ofs.open(histogramFileName, std::ofstream::out | std::ofstream::app);
+			ofs << std::endl << "WORKLOAD HISTOGRAM, " << getTestParameters(true) << ", objectsize=" << m_object_size << std::endl;
+			LatencyHistogram::writeBucketsHeader(ofs);
+			for(size_t op = 0; op < WORKLOAD_OPERATION_COUNT; op++){
+				if(hasTestOperation(WORKLOAD_OPERATIONS[op])) histograms[op].writeBuckets(ofs, WORKLOAD_OPERATION_NAMES[op]);
+			}
+			ofs.close();
+		}
+
+		// generate result string
+		std::ostringstream oss;
+		oss << rdma::CONSOLE_PRINT_NOTATION << rdma::CONSOLE_PRINT_PRECISION;
+		oss << "Measured as 'round-trip time' latency per operation, " << getDistributionName(m_keys) << " over " << m_keys.keys << " keys:" << std::endl;
+		oss << " - Total:           operations = " << rdma::PerfTest::convertCountPerSec(operations*tu/m_elapsedNs);
+		oss << "    time = " << rdma::PerfTest::convertTime(m_elapsedNs) << std::endl;
+		for(size_t op = 0; op < WORKLOAD_OPERATION_COUNT; op++){
+			if(!hasTestOperation(WORKLOAD_OPERATIONS[op])) continue;
+			std::string name = std::string(WORKLOAD_OPERATION_NAMES[op]) + ":";
+			oss << " - " << std::left << std::setw(17) << name << std::right << "operations = " << rdma::PerfTest::convertCountPerSec(histograms[op].getCount()*tu/m_elapsedNs);
+			oss << "    average = " << rdma::PerfTest::convertTime(histograms[op].getAverage()) << "    median = " << rdma::PerfTest::convertTime(histograms[op].getMedian());
+			oss << "    range = " <<  rdma::PerfTest::convertTime(histograms[op].getMin()) << " - " << rdma::PerfTest::convertTime(histograms[op].getMax()) << std::endl;
+			oss << rdma::PerfTest::convertPercentiles(histograms[op]) << std::endl;
+		}
+		return oss.str();
+	}
+	return NULL;
+}
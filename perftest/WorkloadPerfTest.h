@@ -0,0 +1,161 @@
+#ifndef WorkloadPerfTest_H
+#define WorkloadPerfTest_H
+
+#include "PerfTest.h"
+#include "LatencyHistogram.h"
+#include "../src/memory/LocalBaseMemoryStub.h"
+#include "../src/rdma/RDMAClient.h"
+#include "../src/rdma/RDMAServer.h"
+#include "../src/thread/Thread.h"
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <random>
+
+namespace rdma {
+
+enum KeyDistribution { DISTRIBUTION_UNIFORM=0, DISTRIBUTION_ZIPFIAN=1, DISTRIBUTION_HOTSPOT=2 };
+
+const size_t WORKLOAD_OPERATION_COUNT = 4;
+const TestOperation WORKLOAD_OPERATIONS[WORKLOAD_OPERATION_COUNT] = { READ_OPERATION, WRITE_OPERATION, FETCH_ADD_OPERATION, COMPARE_SWAP_OPERATION };
+const char* const WORKLOAD_OPERATION_NAMES[WORKLOAD_OPERATION_COUNT] = { "Read", "Write", "Fetch&Add", "Comp&Swap" };
+
+/* Struct: WorkloadKeys
+ * ----------------
+ * Key space of the workload test and how the keys are drawn from it
+ */
+struct WorkloadKeys {
+	KeyDistribution distribution = DISTRIBUTION_ZIPFIAN;
+	uint64_t keys = 1000000;
+	double theta = 0.99; // zipfian skew, 0 < theta < 1
+	double hotSet = 0.2; // hotspot: share of the keys that are hot
+	double hotOps = 0.8; // hotspot: share of the operations on hot keys
+	double zetan = 0; // zipfian: zeta(keys, theta) computed once per test
+};
+
+
+/* Class: WorkloadKeyGenerator
+ * ----------------
+ * Draws keys like the YCSB generators. Zipfian keys follow the
+ * algorithm of Gray et al. ("Quickly Generating Billion-Record
+ * Synthetic Databases") and are scrambled with a FNV hash, so the
+ * popular keys are spread over the key space and the servers instead
+ * of being the first ones. Hotspot keys are the first hotSet share of
+ * the key space and get hotOps of the operations.
+ */
+class WorkloadKeyGenerator {
+public:
+	WorkloadKeyGenerator(const WorkloadKeys &keys, uint64_t seed);
+	uint64_t next();
+
+	static double zeta(uint64_t n, double theta);
+
+private:
+	WorkloadKeys m_keys;
+	std::mt19937_64 m_generator;
+	std::uniform_real_distribution<double> m_uniform;
+	uint64_t m_hotKeys;
+	double m_alpha, m_eta, m_zeta2;
+
+	static uint64_t fnvHash(uint64_t value);
+};
+
+
+/* Class: WorkloadPerfClientThread
+ * ----------------
+ * Accesses the objects of the key-value table on the servers in a
+ * closed loop. Every operation picks a key from the distribution and
+ * an operation type by the weights of the mix. Key k is the object
+ * k / S of server k % S (S servers), atomics use its first 8 bytes.
+ */
+class WorkloadPerfClientThread : public Thread {
+public:
+	WorkloadPerfClientThread(BaseMemory *memory, std::vector<std::string>& rdma_addresses, std::string ownIpPort, std::string sequencerIpPort, size_t object_size, const WorkloadKeys &keys, const std::vector<uint32_t> &mix, size_t iterations_per_thread);
+	~WorkloadPerfClientThread();
+	void run();
+	bool ready() {
+		return m_ready;
+	}
+
+	// recorded without locking per operation, merged after run
+	LatencyHistogram m_histograms[WORKLOAD_OPERATION_COUNT];
+	int64_t m_elapsedNs = 0;
+
+private:
+	bool m_ready = false;
+	RDMAClient<ReliableRDMA> *m_client;
+	LocalBaseMemoryStub *m_local_memory;
+	size_t m_object_size;
+	size_t m_slot_size;
+	WorkloadKeys m_keys;
+	std::vector<uint32_t> m_mix;
+	size_t m_iterations_per_thread;
+	std::vector<std::string> m_rdma_addresses;
+	std::vector<NodeID> m_addr;
+
+	void issue(size_t opIdx, uint64_t key, size_t i);
+};
+
+
+class WorkloadPerfTest : public rdma::PerfTest {
+public:
+	WorkloadPerfTest(bool is_server, std::vector<std::string> rdma_addresses, int rdma_port, std::string ownIpPort, std::string sequencerIpPort, int local_gpu_index, int remote_gpu_index, int client_count, int thread_count, uint64_t object_size, WorkloadKeys keys, std::vector<uint32_t> mix, uint64_t iterations_per_thread);
+	virtual ~WorkloadPerfTest();
+	std::string getTestParameters();
+	void setupTest();
+	void runTest();
+	std::string getTestResults(std::string csvFileName="", bool csvAddHeader=true);
+
+	/* Function: parseMix
+	 * ----------------
+	 * Parses weights of the operations like 'read=50,write=45,fetch=5'
+	 * (read, write/update, fetch/add, swap/cas) or the YCSB workloads
+	 * 'a' (50% reads, 50% updates), 'b' (95%, 5%) and 'c' (only reads)
+	 *
+	 * return:  weights in order of WORKLOAD_OPERATIONS
+	 */
+	static std::vector<uint32_t> parseMix(std::string mix);
+	static std::string getMixName(const std::vector<uint32_t> &mix);
+	static std::string getDistributionName(const WorkloadKeys &keys);
+
+	// objects are at least ATOMICS_SIZE bytes big and aligned for atomics
+	static size_t slotSize(size_t object_size){
+		size_t size = (object_size + ATOMICS_SIZE - 1) / ATOMICS_SIZE * ATOMICS_SIZE;
+		return (size < (size_t)ATOMICS_SIZE ? (size_t)ATOMICS_SIZE : size);
+	}
+
+	static mutex waitLock;
+	static condition_variable waitCv;
+	static bool signaled;
+	static size_t thread_count, client_count;
+
+private:
+	bool m_is_server;
+	std::vector<std::string> m_rdma_addresses;
+	int m_rdma_port;
+	std::string m_ownIpPort;
+	std::string m_sequencerIpPort;
+	int m_local_gpu_index;
+	int m_actual_gpu_index;
+	int m_remote_gpu_index;
+	uint64_t m_object_size;
+	WorkloadKeys m_keys;
+	std::vector<uint32_t> m_mix;
+	uint64_t m_memory_size;
+	uint64_t m_iterations_per_thread;
+	int64_t m_elapsedNs;
+	std::vector<WorkloadPerfClientThread*> m_client_threads;
+
+	BaseMemory *m_memory;
+	RDMAServer<ReliableRDMA>* m_server;
+
+	std::string getTestParameters(bool forCSV);
+	void makeThreadsReady();
+	void runThreads();
+};
+
+}
+
+#endif
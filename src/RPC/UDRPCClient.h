@@ -0,0 +1,165 @@
+#ifndef SRC_DB_UTILS_UDRPCCLIENT_H_
+#define SRC_DB_UTILS_UDRPCCLIENT_H_
+
+#include "../utils/Config.h"
+#include "UDRPCMessage.h"
+
+#include "../rdma/RDMAClient.h"
+#include "../rdma/SegmentedUnreliableRDMA.h"
+
+#include <chrono>
+#include <mutex>
+#include <set>
+
+namespace rdma {
+
+/*
+ * RDMAClients in use by a UDRPCClient (of any message type)
+ */
+    struct ud_rpc_clients_t {
+        static bool acquire(const void *rdmaClient) {
+            std::unique_lock<std::mutex> lck(lock());
+            return inUse().insert(rdmaClient).second;
+        }
+
+        static void release(const void *rdmaClient) {
+            std::unique_lock<std::mutex> lck(lock());
+            inUse().erase(rdmaClient);
+        }
+
+    private:
+        static std::mutex &lock() {
+            static std::mutex lock;
+            return lock;
+        }
+
+        static std::set<const void*> &inUse() {
+            static std::set<const void*> inUse;
+            return inUse;
+        }
+    };
+
+/*
+ * Client of a UDRPCHandlerThread. A call sends the request over UD and
+ * waits for the response, which is the acknowledgement of the request.
+ * Without response the request is retransmitted after
+ * Config::RDMA_UD_RPC_TIMEOUT microseconds (doubled for every retry),
+ * the server suppresses the duplicates.
+ *
+ * Requests carry the creation time of the client as epoch, so a
+ * recreated client of the same RDMAClient doesn't share its request IDs
+ * with its predecessor at the server. Responses are not demultiplexed
+ * between clients, i.e. a RDMAClient can only be used by one UDRPCClient
+ * at a time (the constructor throws otherwise). The client must be the
+ * only user of the messages of its RDMAClient and must only be used by
+ * one thread at a time.
+ */
+    template <class MessageType>
+    class UDRPCClient {
+    public:
+        UDRPCClient(RDMAClient<SegmentedUnreliableRDMA> *rdmaClient, NodeID serverID)
+                : m_rdmaClient(acquireClient(rdmaClient)),
+                  m_serverID(serverID),
+                  m_msgSize(sizeof(ud_rpc_hdr_t) + sizeof(MessageType)),
+                  m_request((char*) rdmaClient->localAlloc(m_msgSize)),
+                  m_rspBuffer((char*) rdmaClient->localAlloc(m_msgSize * RSP_BUFFERS)),
+                  m_epoch(createEpoch()) {
+
+            for (size_t i = 0; i < RSP_BUFFERS; i++) {
+                m_rdmaClient->receiveMessage(m_rspBuffer + i * m_msgSize, m_msgSize);
+            }
+        };
+
+        ~UDRPCClient() {
+            // posted response buffers must not outlive the client
+            for (size_t i = 0; i < RSP_BUFFERS; i++) {
+                m_rdmaClient->cancelReceiveMessage(m_rspBuffer + i * m_msgSize);
+            }
+            m_rdmaClient->localFree(m_rspBuffer);
+            m_rdmaClient->localFree(m_request);
+            ud_rpc_clients_t::release(m_rdmaClient);
+        };
+
+        /* Function: call
+         * ----------------
+         * Sends a request and waits for its response
+         *
+         * request:   request to send
+         * response:  buffer for the response
+         * return:    false if no response arrived after
+         *            Config::RDMA_UD_RPC_RETRIES retransmissions
+         */
+        bool call(const MessageType *request, MessageType *response) {
+            auto hdr = (ud_rpc_hdr_t*) m_request;
+            hdr->reqID = ++m_reqID;
+            hdr->epoch = m_epoch;
+            hdr->nodeID = m_rdmaClient->getOwnNodeID();
+            memcpy(m_request + sizeof(ud_rpc_hdr_t), request, sizeof(MessageType));
+
+            auto timeout = std::chrono::microseconds(Config::RDMA_UD_RPC_TIMEOUT);
+            for (uint32_t attempt = 0; attempt <= Config::RDMA_UD_RPC_RETRIES; attempt++) {
+                if (attempt > 0) {
+                    m_retransmissions++;
+                    timeout *= 2;
+                }
+                m_rdmaClient->sendMessage(m_serverID, m_request, m_msgSize);
+
+                auto deadline = std::chrono::steady_clock::now() + timeout;
+                do {
+                    SegmentedUnreliableRDMA::ud_message_t message;
+                    if (!m_rdmaClient->pollReceiveMessage(message, false)) {
+                        continue;
+                    }
+                    auto rspHdr = (ud_rpc_hdr_t*) message.memAddr;
+                    bool matches = message.size == m_msgSize && rspHdr->reqID == m_reqID && rspHdr->epoch == m_epoch;
+                    if (matches) {
+                        memcpy(response, (char*) message.memAddr + sizeof(ud_rpc_hdr_t), sizeof(MessageType));
+                    }
+                    // responses of earlier retransmissions or of a predecessor are dropped
+                    m_rdmaClient->receiveMessage(message.memAddr, m_msgSize);
+                    if (matches) {
+                        return true;
+                    }
+                } while (std::chrono::steady_clock::now() < deadline);
+
+                Logging::debug(__FILE__, __LINE__, "UD RPC: request " + to_string(m_reqID) + " timed out");
+            }
+            return false;
+        };
+
+        size_t getRetransmissions() {
+            return m_retransmissions;
+        }
+
+    private:
+        // a duplicate response can arrive while the next one is awaited
+        static const size_t RSP_BUFFERS = 4;
+
+        static RDMAClient<SegmentedUnreliableRDMA> *acquireClient(RDMAClient<SegmentedUnreliableRDMA> *rdmaClient) {
+            if (!ud_rpc_clients_t::acquire(rdmaClient)) {
+                throw runtime_error("UDRPCClient: RDMAClient is already used by another UDRPCClient");
+            }
+            return rdmaClient;
+        }
+
+        // increases with every client instance, the server drops requests of older ones
+        static uint64_t createEpoch() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        RDMAClient<SegmentedUnreliableRDMA> *m_rdmaClient;
+        NodeID m_serverID;
+
+        const size_t m_msgSize;
+        char *m_request;
+        char *m_rspBuffer;
+
+        const uint64_t m_epoch;
+        uint64_t m_reqID = 0;
+        size_t m_retransmissions = 0;
+    };
+
+} /* namespace rdma */
+
+#endif /* SRC_DB_UTILS_UDRPCCLIENT_H_ */
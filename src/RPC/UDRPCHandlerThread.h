@@ -0,0 +1,186 @@
+#ifndef SRC_DB_UTILS_UDRPCHANDLER_H_
+#define SRC_DB_UTILS_UDRPCHANDLER_H_
+
+
+
+#include "../utils/Config.h"
+#include "../thread/Thread.h"
+#include "UDRPCMessage.h"
+
+#include "../rdma/RDMAServer.h"
+#include "../rdma/SegmentedUnreliableRDMA.h"
+
+#include <map>
+
+
+
+namespace rdma
+{
+
+    /*
+     * RPC handler over the UD QP of a RDMAServer<SegmentedUnreliableRDMA>,
+     * clients use UDRPCClient. Instead of a RC QP per client the server only
+     * needs an address handle per client, so one handler thread serves any
+     * number of clients.
+     *
+     * Every client has at most one outstanding request. The response is
+     * cached per client until the next request arrives (which acknowledges
+     * it), a retransmitted request is answered from the cache without calling
+     * handleRDMARPC again and older requests are dropped. A node has one
+     * client at a time (see UDRPCClient): a request with a newer epoch
+     * replaces the state of the former client of the node and requests
+     * of older epochs are dropped.
+     *
+     * The handler thread is the only user of the messages of the server.
+     */
+    template <class MessageType>
+    class UDRPCHandlerThread : public Thread
+    {
+
+    public:
+        UDRPCHandlerThread(RDMAServer<SegmentedUnreliableRDMA> *rdmaServer, size_t maxNumberMsgs)
+                : m_rdmaServer(rdmaServer),
+                  m_msgSize(sizeof(ud_rpc_hdr_t) + sizeof(MessageType)),
+                  m_maxNumberMsgs(maxNumberMsgs),
+                  m_rpcBuffer((char*)m_rdmaServer->localAlloc(m_msgSize * maxNumberMsgs))
+
+        {
+            initMemory();
+        };
+
+        ~UDRPCHandlerThread(){
+            stopHandler();
+
+            for (auto &client : m_clients) {
+                m_rdmaServer->localFree(client.second.response);
+            }
+            // withdraw the posted request buffers before freeing them
+            for (std::size_t i = 0; i < m_maxNumberMsgs; i++) {
+                m_rdmaServer->cancelReceiveMessage(m_rpcBuffer + i * m_msgSize);
+            }
+            m_rdmaServer->localFree(m_rpcBuffer);
+        };
+
+        size_t getMsgSize(){
+            return m_msgSize;
+        }
+
+        bool startHandler(){
+            if(m_processing){
+                return true;
+            }
+            Thread::start();
+
+            stringstream ss;
+            while (!m_processing) {
+                if (Thread::killed()) {
+                    ss << "UD RPC handler Thread" << " starting failed  \n";
+                    Logging::error(__FILE__, __LINE__, ss.str());
+                    return false;
+                }
+                ss << "UD RPC handler Thread" << " starting done  \n";
+                Logging::debug(__FILE__, __LINE__, ss.str());
+                usleep(Config::RDMA_SLEEP_INTERVAL);
+            }
+            return  true;
+        };
+
+        void stopHandler(){
+            if (m_processing) {
+                Thread::stop();
+                Thread::join();
+            }
+            Logging::debug(__FILE__, __LINE__, "UD RPC handler Thread stopping done");
+        };
+
+        //provide the receive buffers for requests
+        bool initMemory()
+        {
+            for (std::size_t i = 0; i < m_maxNumberMsgs; i++)
+            {
+                m_rdmaServer->receiveMessage(m_rpcBuffer + i * m_msgSize, m_msgSize);
+            }
+            return true;
+        }
+
+        void  run() override {
+            m_processing = true;
+            while (!Thread::killed()) {
+                SegmentedUnreliableRDMA::ud_message_t message;
+                // does not block, so the thread can be stopped
+                if (m_rdmaServer->pollReceiveMessage(message, false)) {
+                    handleRequest(message);
+                    m_rdmaServer->receiveMessage(message.memAddr, m_msgSize);
+                }
+            }
+            m_processing = false;
+        }
+
+        //This Message needs to be implemented in subclass to handle the messages,
+        //the response has to be written to m_intermediateRspBuffer
+        virtual void  handleRDMARPC(MessageType* message,NodeID & returnAdd) =0;
+
+    protected:
+        struct client_t {
+            uint64_t epoch = 0;
+            uint64_t reqID = 0;  // last handled request
+            char *response = nullptr;  // header and response of the last request
+        };
+
+        void handleRequest(SegmentedUnreliableRDMA::ud_message_t &message)
+        {
+            if (message.size != m_msgSize) {
+                Logging::debug(__FILE__, __LINE__, "UD RPC: dropped request of size " + to_string(message.size));
+                return;
+            }
+            auto hdr = (ud_rpc_hdr_t*) message.memAddr;
+            NodeID returnAdd = hdr->nodeID;
+            client_t &client = m_clients[returnAdd];
+            if (client.response == nullptr) {
+                client.response = (char*) m_rdmaServer->localAlloc(m_msgSize);
+            }
+            if (hdr->epoch < client.epoch) {
+                // request of a former client of the node
+                return;
+            }
+            if (hdr->epoch > client.epoch) {
+                client.epoch = hdr->epoch;
+                client.reqID = 0;
+            }
+
+            if (hdr->reqID < client.reqID) {
+                // retransmission of an already acknowledged request
+                return;
+            }
+            if (hdr->reqID > client.reqID) {
+                client.reqID = hdr->reqID;
+                auto rspHdr = (ud_rpc_hdr_t*) client.response;
+                rspHdr->reqID = hdr->reqID;
+                rspHdr->epoch = hdr->epoch;
+                rspHdr->nodeID = m_rdmaServer->getOwnNodeID();
+                m_intermediateRspBuffer = (MessageType*) (client.response + sizeof(ud_rpc_hdr_t));
+                handleRDMARPC((MessageType*) ((char*) message.memAddr + sizeof(ud_rpc_hdr_t)), returnAdd);
+            }
+            // the response of a retransmitted request was lost, send it again
+            m_rdmaServer->sendMessage(returnAdd, client.response, m_msgSize);
+        }
+
+        RDMAServer<SegmentedUnreliableRDMA> *m_rdmaServer;
+
+        MessageType *m_intermediateRspBuffer = nullptr;
+
+        const size_t m_msgSize;
+        size_t m_maxNumberMsgs;
+
+        char *m_rpcBuffer;
+
+        std::map<NodeID, client_t> m_clients;  // by node
+
+        std::atomic<bool> m_processing {false};
+    };
+
+
+
+} /* namespace rdma */
+
+#endif /* SRC_DB_UTILS_UDRPCHANDLER_H_ */
@@ -0,0 +1,19 @@
+#ifndef SRC_DB_UTILS_UDRPCMESSAGE_H_
+#define SRC_DB_UTILS_UDRPCMESSAGE_H_
+
+#include "../utils/Config.h"
+
+namespace rdma {
+
+/*
+ * Header in front of every request and response of UD RPCs
+ */
+    struct ud_rpc_hdr_t {
+        uint64_t reqID;  // increasing per client, starts at 1
+        uint64_t epoch;  // creation time of the client instance, increases per node
+        NodeID nodeID;  // sender, the server answers to this node
+    };
+
+} /* namespace rdma */
+
+#endif /* SRC_DB_UTILS_UDRPCMESSAGE_H_ */
@@ -0,0 +1,125 @@
+#include "SharedMemory.h"
+#include <atomic>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef LINUX
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+using namespace rdma;
+
+#ifndef HUGEPAGE
+#define HUGEPAGE false
+#endif
+
+static std::atomic<uint32_t> s_nextSegmentID {0};
+
+// constructors
+SharedMemory::SharedMemory(size_t mem_size) : SharedMemory(mem_size, (bool)HUGEPAGE){}
+SharedMemory::SharedMemory(size_t mem_size, bool huge) : SharedMemory(mem_size, huge, Config::RDMA_NUMAREGION){}
+SharedMemory::SharedMemory(size_t mem_size, bool huge, int numa_node) : SharedMemory(true, mem_size, huge, numa_node){}
+SharedMemory::SharedMemory(bool register_ibv, size_t mem_size, bool huge, int numa_node) : AbstractBaseMemory(mem_size), AbstractMainMemory(mem_size), BaseMemory(register_ibv, mem_size, numa_node){
+    this->huge = huge;
+    this->m_segmentID = s_nextSegmentID++;
+    this->m_name = getSegmentName(getpid(), this->m_segmentID);
+
+    this->preInit();
+
+    // allocate memory (zeroed by ftruncate)
+    this->buffer = createSegment(this->m_name, this->mem_size);
+    if(huge){
+        madvise(this->buffer, this->mem_size, MADV_HUGEPAGE);
+    }
+    #ifdef LINUX
+        if(numa_available() != -1 && this->numa_node <= numa_max_node()){
+            numa_tonode_memory(this->buffer, this->mem_size, this->numa_node);
+        }
+    #endif
+
+    this->postInit();
+}
+
+// destructor
+SharedMemory::~SharedMemory(){
+    closeSegment(this->m_name, this->buffer, this->mem_size, true);
+    this->buffer = nullptr;
+}
+
+bool SharedMemory::isHuge(){
+    return this->huge;
+}
+
+uint32_t SharedMemory::getSegmentID(){
+    return this->m_segmentID;
+}
+
+std::string SharedMemory::getName(){
+    return this->m_name;
+}
+
+std::string SharedMemory::getSegmentName(uint32_t pid, uint32_t segmentID){
+    return "/rdma-manager." + to_string(pid) + "." + to_string(segmentID);
+}
+
+void* SharedMemory::createSegment(const std::string &name, size_t size){
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        throw runtime_error("Cannot create shared memory segment " + name + "! errno: " + to_string(errno));
+    }
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw runtime_error("Cannot allocate shared memory! Requested size: " + to_string(size));
+    }
+    void *ptr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw runtime_error("Cannot map shared memory segment " + name + "! errno: " + to_string(errno));
+    }
+    return ptr;
+}
+
+void* SharedMemory::openSegment(const std::string &name, size_t &retSize){
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw runtime_error("Cannot open shared memory segment " + name + "! errno: " + to_string(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw runtime_error("Cannot stat shared memory segment " + name);
+    }
+    retSize = (size_t)st.st_size;
+    void *ptr = mmap(NULL, retSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        throw runtime_error("Cannot map shared memory segment " + name + "! errno: " + to_string(errno));
+    }
+    return ptr;
+}
+
+void SharedMemory::closeSegment(const std::string &name, void *ptr, size_t size, bool unlink){
+    if (ptr != nullptr) {
+        munmap(ptr, size);
+    }
+    if (unlink) {
+        shm_unlink(name.c_str());
+    }
+}
+
+LocalBaseMemoryStub *SharedMemory::malloc(size_t size){
+    size_t rootOffset = (size_t)alloc(size) - (size_t)this->buffer;
+    return (LocalBaseMemoryStub*) new LocalMainMemoryStub(this->buffer, rootOffset, size, [this](const void* ptr){
+      free(ptr);
+    });
+}
+
+LocalBaseMemoryStub *SharedMemory::createStub(void* rootBuffer, size_t rootOffset, size_t mem_size, std::function<void(const void* buffer)> freeFunc){
+    return (LocalBaseMemoryStub*) new LocalMainMemoryStub(rootBuffer, rootOffset, mem_size, freeFunc);
+}
@@ -0,0 +1,133 @@
+#ifndef SharedMemory_H_
+#define SharedMemory_H_
+
+#include "AbstractMainMemory.h"
+#include "LocalMainMemoryStub.h"
+#include "BaseMemory.h"
+
+#include <string>
+
+namespace rdma {
+
+/* Class: SharedMemory
+ * ----------------
+ * Main memory that is allocated as a POSIX shared memory segment
+ * so that other processes on the same host can map it. The segment
+ * is identified by the PID of the creating process and a segment ID
+ * and is removed again when the memory gets destroyed.
+ */
+class SharedMemory : virtual public AbstractMainMemory, virtual public BaseMemory {
+
+protected:
+    bool huge;
+    uint32_t m_segmentID;
+    std::string m_name;
+
+public:
+
+    /* Constructor
+     * --------------
+     * Allocates a shared memory segment.
+     *
+     * mem_size:  size how much memory should be allocated
+     *
+     */
+    SharedMemory(size_t mem_size);
+
+    /* Constructor
+     * --------------
+     * Allocates a shared memory segment.
+     *
+     * mem_size:  size how much memory should be allocated
+     * huge:      If true then transparent huge pages are
+     *            requested for the segment
+     *
+     */
+    SharedMemory(size_t mem_size, bool huge);
+
+    /* Constructor
+     * --------------
+     * Allocates a shared memory segment.
+     *
+     * mem_size:  size how much memory should be allocated
+     * huge:      If true then transparent huge pages are
+     *            requested for the segment
+     * numa_node: Index of the NUMA node where the memory
+     *            should be allocated on (LINUX only)
+     *
+     */
+    SharedMemory(size_t mem_size, bool huge, int numa_node);
+
+    /* Constructor
+     * --------------
+     * Allocates a shared memory segment.
+     *
+     * register_ibv:  If memory should be registered with IBV
+     * mem_size:  size how much memory should be allocated
+     * huge:      If true then transparent huge pages are
+     *            requested for the segment
+     * numa_node: Index of the NUMA node where the memory
+     *            should be allocated on (LINUX only)
+     *
+     */
+    SharedMemory(bool register_ibv, size_t mem_size, bool huge, int numa_node);
+
+    // destructor
+    virtual ~SharedMemory();
+
+    virtual bool isHuge();
+
+    /* Function: getSegmentID
+     * ---------------
+     * Returns the ID of the segment which is unique
+     * within the creating process
+     */
+    uint32_t getSegmentID();
+
+    std::string getName();
+
+    /* Function: getSegmentName
+     * ---------------
+     * Returns the name of a segment created by another process
+     *
+     * pid:        process which created the segment
+     * segmentID:  ID of the segment in that process
+     * return:     name to be passed to openSegment()
+     */
+    static std::string getSegmentName(uint32_t pid, uint32_t segmentID);
+
+    /* Function: createSegment
+     * ---------------
+     * Creates and maps a zeroed shared memory segment
+     *
+     * name:    name of the segment (must start with '/')
+     * size:    size of the segment in bytes
+     * return:  pointer to the mapped segment
+     */
+    static void* createSegment(const std::string &name, size_t size);
+
+    /* Function: openSegment
+     * ---------------
+     * Maps an existing shared memory segment
+     *
+     * name:     name of the segment
+     * retSize:  size of the mapped segment
+     * return:   pointer to the mapped segment
+     */
+    static void* openSegment(const std::string &name, size_t &retSize);
+
+    /* Function: closeSegment
+     * ---------------
+     * Unmaps a segment and removes it if
+     * the caller is the owner (unlink=true)
+     */
+    static void closeSegment(const std::string &name, void *ptr, size_t size, bool unlink);
+
+    LocalBaseMemoryStub *malloc(size_t size) override;
+
+    LocalBaseMemoryStub *createStub(void* rootBuffer, size_t rootOffset, size_t mem_size, std::function<void(const void* buffer)> freeFunc=nullptr) override;
+};
+
+} // namespace rdma
+
+#endif /* SharedMemory_H_ */
@@ -19,6 +19,11 @@
 #include "NodeIDResponse.pb.h"
 #include "GetNodeIDForIpPortRequest.pb.h"
 #include "GetNodeIDForIpPortResponse.pb.h"
+#include "NodeIDReleaseRequest.pb.h"
+#include "ConnIDReserveRequest.pb.h"
+#include "MembershipUpdate.pb.h"
+#include "PerfAgentRunRequest.pb.h"
+#include "PerfAgentRunResponse.pb.h"
 
 #include "ErrorMessage.pb.h"
 
@@ -38,6 +43,15 @@ enum Enum : int
 };
 }
 
+namespace MembershipUpdateKind
+{
+enum Enum : int
+{
+  NODE_JOINED,
+  NODE_LEFT,
+};
+}
+
 class ProtoMessageFactory
 {
 public:
@@ -105,6 +119,71 @@ public:
     anyMessage.PackFrom(resReq);
     return anyMessage;
   }
+
+  static Any createConnIDReserveRequest(uint32_t count)
+  {
+    ConnIDReserveRequest resReq;
+    resReq.set_count(count);
+    Any anyMessage;
+    anyMessage.PackFrom(resReq);
+    return anyMessage;
+  }
+
+  static Any createNodeIDReleaseRequest(NodeID nodeID)
+  {
+    NodeIDReleaseRequest resReq;
+    resReq.set_node_id(nodeID);
+    Any anyMessage;
+    anyMessage.PackFrom(resReq);
+    return anyMessage;
+  }
+
+  static Any createMembershipUpdate(int kind, uint64_t version, std::string ip,
+                                    std::string name, NodeID nodeID, int nodeTypeEnum)
+  {
+    MembershipUpdate update;
+    update.set_kind(kind);
+    update.set_version(version);
+    update.set_ip(ip);
+    update.set_name(name);
+    update.set_node_id(nodeID);
+    update.set_node_type_enum(nodeTypeEnum);
+    Any anyMessage;
+    anyMessage.PackFrom(update);
+    return anyMessage;
+  }
+
+  static Any createPerfAgentRunRequest(const std::vector<std::string> &args, uint32_t timeout, bool reportReady = false)
+  {
+    PerfAgentRunRequest runReq;
+    for (const std::string &arg : args)
+    {
+      runReq.add_args(arg);
+    }
+    runReq.set_timeout(timeout);
+    runReq.set_report_ready(reportReady);
+    Any anyMessage;
+    anyMessage.PackFrom(runReq);
+    return anyMessage;
+  }
+
+  static Any createPerfAgentResultRequest()
+  {
+    PerfAgentRunRequest runReq;
+    runReq.set_result(true);
+    Any anyMessage;
+    anyMessage.PackFrom(runReq);
+    return anyMessage;
+  }
+
+  static Any createPerfAgentStopRequest()
+  {
+    PerfAgentRunRequest runReq;
+    runReq.set_stop(true);
+    Any anyMessage;
+    anyMessage.PackFrom(runReq);
+    return anyMessage;
+  }
 };
 // end class
 } // end namespace rdma
@@ -54,22 +54,30 @@ void ProtoServer::run() {
   }
   m_running = true;
 
-  while (!killed()) {
+  // request and response are reused for all messages so that their
+  // buffers are only allocated once and kept in the arena
+  google::protobuf::Arena arena;
+  Any* rcvMsg = google::protobuf::Arena::CreateMessage<Any>(&arena);
+  Any* respMsg = google::protobuf::Arena::CreateMessage<Any>(&arena);
 
+  while (!killed()) {
+    // the context is shared by the process, so the server wakes up
+    // periodically to check if it has been stopped
+    if (!m_pSocket->poll(Config::PROTO_POLL_INTERVAL)) {
+      continue;
+    }
 
-    Any rcvMsg;
-    Any respMsg;
+    rcvMsg->Clear();
+    respMsg->Clear();
 
     unique_lock<mutex> lck(m_handleLock);
-    if (!m_pSocket->receive(&rcvMsg)) {
+    if (!m_pSocket->receive(rcvMsg)) {
       break;
-    } else {
-      handle(&rcvMsg, &respMsg);
-      m_pSocket->send(&respMsg);
     }
-    m_handleLock.unlock();
+    handle(rcvMsg, respMsg);
+    m_pSocket->send(respMsg);
   }
-    m_running = false;
+  m_running = false;
 }
 
 bool ProtoServer::isRunning() { return m_running; }
@@ -80,9 +88,7 @@ void ProtoServer::stopServer() {
 
   if (m_running) {
 
-    // m_pSocket->close();
     stop();
-    m_pSocket->closeContext();
     join();
   }
   ss << m_name << " stopping done \n";
@@ -12,6 +12,8 @@
 #include <sstream>
 #include <string>
 
+#include <google/protobuf/arena.h>
+
 #include "../message/ProtoMessageFactory.h"
 #include "../thread/Thread.h"
 #include "../utils/Config.h"
@@ -7,10 +7,11 @@
 using namespace rdma;
 
 ProtoSocket::ProtoSocket(string ip, int port, int sockType)
-    : m_sockType(sockType), m_isOpen(false) {
-  m_pCtx = new zmq::context_t(1, Config::PROTO_MAX_SOCKETS);
+    : ProtoSocket("tcp://" + ip + ":" + to_string(port), sockType) {}
 
-  m_pSock = new zmq::socket_t(*m_pCtx, m_sockType);
+ProtoSocket::ProtoSocket(string endpoint, int sockType)
+    : m_conn(endpoint), m_sockType(sockType), m_isOpen(false) {
+  m_pSock = new zmq::socket_t(sharedContext(), m_sockType);
   int hwm = 0;
   int linger = 0; // after close how long unsent messages should be kept in memory
   m_pSock->setsockopt(ZMQ_SNDHWM, &hwm, sizeof(hwm));
@@ -18,17 +19,22 @@ ProtoSocket::ProtoSocket(string ip, int port, int sockType)
   m_pSock->setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
 
   if (m_sockType == ZMQ_SUB) m_pSock->setsockopt(ZMQ_SUBSCRIBE, NULL, 0);
-
-  m_conn = "tcp://" + ip + ":" + to_string(port);
 }
 
 ProtoSocket::~ProtoSocket() {
-  if (m_isOpen) {
+  if (m_pSock != nullptr) {
     this->close();
-    this->closeContext();
   }
 }
 
+zmq::context_t& ProtoSocket::sharedContext() {
+  // never destroyed: zmq_ctx_term() would block on sockets
+  // that are still owned by statically allocated objects
+  static zmq::context_t* ctx =
+      new zmq::context_t(Config::PROTO_IO_THREADS, Config::PROTO_MAX_SOCKETS);
+  return *ctx;
+}
+
 bool ProtoSocket::bind() {
   try {
     m_pSock->bind(m_conn.c_str());
@@ -55,37 +61,32 @@ bool ProtoSocket::connect() {
 
 bool ProtoSocket::isOpen() { return m_isOpen; }
 
+bool ProtoSocket::serialize(Any* msg, zmq::message_t& zmsg) {
+  // serialize directly into the buffer owned by the zmq message
+  size_t size = msg->ByteSizeLong();
+  zmsg.rebuild(size);
+  return msg->SerializeToArray(zmsg.data(), size);
+}
+
 bool ProtoSocket::sendMore(Any* msg) {
   if (msg == nullptr) return false;
 
-  string* data = new string();
-  if (!msg->SerializeToString(data)) {
-    delete data;
-    data = nullptr;
+  zmq::message_t zmsg;
+  if (!serialize(msg, zmsg)) {
     return false;
   }
 
-  zmq::message_t zmsg(data->size());
-  memcpy(zmsg.data(), data->data(), data->size());
-  bool send = m_pSock->send(&zmsg, ZMQ_SNDMORE);
-
-  delete data;
-  data = nullptr;
-  return send > 0;
+  return m_pSock->send(zmsg, ZMQ_SNDMORE);
 }
 
 bool ProtoSocket::send(Any* msg) {
   if (msg == nullptr) return false;
 
-  string* data = new string();
-  if (!msg->SerializeToString(data)) {
-    delete data;
-    data = nullptr;
+  zmq::message_t zmsg;
+  if (!serialize(msg, zmsg)) {
     return false;
   }
 
-  zmq::message_t zmsg(data->size());
-  memcpy(zmsg.data(), data->data(), data->size());
   bool send = false;
   try {
     send = m_pSock->send(zmsg);
@@ -93,8 +94,6 @@ bool ProtoSocket::send(Any* msg) {
     Logging::error(__FILE__, __LINE__, e.what());
   }
 
-  delete data;
-  data = nullptr;
   return send;
 }
 
@@ -124,24 +123,27 @@ bool ProtoSocket::receive(Any* msg) {
   return recv;
 }
 
-bool ProtoSocket::close() {
-  // Calls the zmq_close() function, as described in zmq_close(3)
+bool ProtoSocket::poll(long timeoutMs) {
+  if (m_pSock == nullptr) return false;
+
+  zmq::pollitem_t items[] = {{static_cast<void*>(*m_pSock), 0, ZMQ_POLLIN, 0}};
   try {
-    delete m_pSock;
-    m_pSock = nullptr;
-    m_isOpen = false;
-    return true;
+    zmq::poll(items, 1, timeoutMs);
   } catch (zmq::error_t& e) {
-    Logging::error(__FILE__, __LINE__, e.what());
+    if (e.num() != EINTR) {
+      Logging::error(__FILE__, __LINE__, e.what());
+    }
+    return false;
   }
-
-  return false;
+  return (items[0].revents & ZMQ_POLLIN) != 0;
 }
 
-bool ProtoSocket::closeContext() {
+bool ProtoSocket::close() {
+  // Calls the zmq_close() function, as described in zmq_close(3)
   try {
-    delete m_pCtx;
-    m_pCtx = nullptr;
+    delete m_pSock;
+    m_pSock = nullptr;
+    m_isOpen = false;
     return true;
   } catch (zmq::error_t& e) {
     Logging::error(__FILE__, __LINE__, e.what());
@@ -25,6 +25,13 @@ class ProtoSocket {
  public:
   ProtoSocket(string addr, int port, int sockType);
 
+  /* Function: ProtoSocket
+   * ----------------
+   * Socket on any ZMQ endpoint, e.g. "inproc://name" between
+   * threads of this process (they share sharedContext())
+   */
+  ProtoSocket(string endpoint, int sockType);
+
   ~ProtoSocket();
 
   bool bind();
@@ -39,9 +46,23 @@ class ProtoSocket {
 
   bool receive(Any* msg);
 
+  /* Function: poll
+   * ----------------
+   * Waits until a message can be received from the socket
+   *
+   * timeoutMs:  maximum time to wait in milliseconds (-1 = infinite)
+   * return:  true if a message is ready to be received
+   */
+  bool poll(long timeoutMs);
+
   bool close();
 
-  bool closeContext();
+  /* Function: sharedContext
+   * ----------------
+   * Returns the process-wide ZMQ context that is shared by
+   * all proto sockets (one set of I/O threads per process)
+   */
+  static zmq::context_t& sharedContext();
 
   bool setOption(int option_name, const void *option_value, size_t option_len = sizeof(int));
 
@@ -56,7 +77,7 @@ class ProtoSocket {
   bool hasConnection();
 
  private:
-  zmq::context_t* m_pCtx;
+  bool serialize(Any* msg, zmq::message_t& zmsg);
 
   string m_conn;
   int64_t m_send_timeout = -1; // needed to detect valid connection
@@ -25,6 +25,7 @@ BaseRDMA::BaseRDMA(BaseMemory *buffer) : BaseRDMA(buffer, false){}
 BaseRDMA::BaseRDMA(BaseMemory *buffer, bool pass_buffer_ownership) {
   m_buffer = buffer;
   m_buffer_owner = pass_buffer_ownership;
+  m_gidIdx = selectGidIndex();
 }
 
 BaseRDMA::BaseRDMA(size_t mem_size) : BaseRDMA(mem_size, HUGEPAGE){}
@@ -53,13 +54,17 @@ BaseRDMA::~BaseRDMA(){
 //------------------------------------------------------------------------------------//
 
 void BaseRDMA::createCQ(ibv_cq *&send_cq, ibv_cq *&rcv_cq) {
+  createCQ(m_buffer->ib_context(), send_cq, rcv_cq);
+}
+
+void BaseRDMA::createCQ(ibv_context *ctx, ibv_cq *&send_cq, ibv_cq *&rcv_cq) {
   // send queue
-  if (!(send_cq = ibv_create_cq(m_buffer->ib_context(), Config::RDMA_MAX_WR + 1, nullptr, nullptr, 0))) {
+  if (!(send_cq = ibv_create_cq(ctx, Config::RDMA_MAX_WR + 1, nullptr, nullptr, 0))) {
     throw runtime_error("Cannot create send CQ!");
   }
 
   // receive queue
-  if (!(rcv_cq = ibv_create_cq(m_buffer->ib_context(), Config::RDMA_MAX_WR + 1, nullptr, nullptr, 0))) {
+  if (!(rcv_cq = ibv_create_cq(ctx, Config::RDMA_MAX_WR + 1, nullptr, nullptr, 0))) {
     throw runtime_error("Cannot create receive CQ!");
   }
 
@@ -90,13 +95,91 @@ void BaseRDMA::destroyCQ(ibv_cq *&send_cq, ibv_cq *&rcv_cq) {
 
 //------------------------------------------------------------------------------------//
 
+int BaseRDMA::selectGidIndex() {
+  if (Config::RDMA_GID_INDEX >= 0) {
+    return Config::RDMA_GID_INDEX;
+  }
+  if (!m_buffer->isIBV()) {
+    return -1;  // no device (e.g. shared memory only)
+  }
+  return selectGidIndex(m_buffer->ib_context(), m_buffer->getIBPort());
+}
+
+int BaseRDMA::selectGidIndex(ibv_context *ctx, int ibPort) {
+  if (Config::RDMA_GID_INDEX >= 0) {
+    return Config::RDMA_GID_INDEX;
+  }
+
+  ibv_port_attr portAttr;
+  if (ibv_query_port(ctx, ibPort, &portAttr) != 0) {
+    throw runtime_error("Query port failed");
+  }
+  if (portAttr.link_layer != IBV_LINK_LAYER_ETHERNET) {
+    return -1;  // InfiniBand uses LID routing
+  }
+
+  // RoCE has no LIDs, pick a GID (RoCEv2 with IPv4 address preferred)
+  int bestIdx = -1;
+  int bestRank = 0;
+  for (int i = 0; i < portAttr.gid_tbl_len; ++i) {
+    struct ibv_gid_entry entry;
+    if (ibv_query_gid_ex(ctx, ibPort, i, &entry, 0) != 0) {
+      continue;  // empty entry
+    }
+    bool isIPv4 = entry.gid.global.subnet_prefix == 0 &&
+                  (entry.gid.raw[10] == 0xff && entry.gid.raw[11] == 0xff);
+    int rank = 1;
+    if (entry.gid_type == IBV_GID_TYPE_ROCE_V2) rank += 2;
+    if (isIPv4) rank += 1;
+    if (rank > bestRank) {
+      bestRank = rank;
+      bestIdx = i;
+    }
+  }
+  if (bestIdx == -1) {
+    throw runtime_error("No valid GID found on RoCE port " + to_string(ibPort));
+  }
+  Logging::debug(__FILE__, __LINE__, "Selected GID index " + to_string(bestIdx) + " for RoCE");
+  return bestIdx;
+}
+
+//------------------------------------------------------------------------------------//
+
+void BaseRDMA::getLocalGid(uint8_t *gid) {
+  getLocalGid(m_buffer->ib_context(), m_buffer->getIBPort(), m_gidIdx, gid);
+}
+
+void BaseRDMA::getLocalGid(ibv_context *ctx, int ibPort, int gidIdx, uint8_t *gid) {
+  union ibv_gid my_gid;
+  memset(&my_gid, 0, sizeof my_gid);
+  if (gidIdx != -1 && ibv_query_gid(ctx, ibPort, gidIdx, &my_gid) != 0) {
+    throw runtime_error("Could not query GID " + to_string(gidIdx));
+  }
+  memcpy(gid, &my_gid, sizeof my_gid);
+}
+
+//------------------------------------------------------------------------------------//
+
+ibv_mtu BaseRDMA::getPathMTU() {
+  return getPathMTU(m_buffer->ib_port_attributes());
+}
+
+ibv_mtu BaseRDMA::getPathMTU(const ibv_port_attr &portAttr) {
+  ibv_mtu activeMtu = portAttr.active_mtu;
+  return activeMtu < IBV_MTU_4096 ? activeMtu : IBV_MTU_4096;
+}
+
+//------------------------------------------------------------------------------------//
+
 void BaseRDMA::setQP(const rdmaConnID rdmaConnID, ib_qp_t &qp) {
   if (m_qps.size() < rdmaConnID + 1) {
     m_qps.resize(rdmaConnID + 1);
     m_countWR.resize(rdmaConnID + 1);
   }
   m_qps[rdmaConnID] = qp;
-  m_qpNum2connID[qp.qp->qp_num] = rdmaConnID;
+  if (qp.qp != nullptr) {
+    m_qpNum2connID[qp.qp->qp_num] = rdmaConnID;
+  }
 }
 
 //------------------------------------------------------------------------------------//
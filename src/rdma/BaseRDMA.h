@@ -59,6 +59,19 @@ struct ib_conn_t {
     uint32_t psn;      /* PSN*/
     struct ibv_ah *ah; /* Route to remote QP*/
   } ud;
+  struct {
+    uint64_t host = 0;    /* Host ID, zero if the buffer is not shared */
+    uint32_t pid = 0;     /* Process which created the segments */
+    uint32_t segment = 0; /* Segment ID of the buffer */
+    uint32_t queue = 0;   /* Segment ID of the receive/completion queues */
+  } shm;
+  struct {
+    uint32_t count = 0; /* Additional rails (see MultiRailRDMA) */
+    uint32_t qp_num[Config::RDMA_MAX_RAILS - 1] = {};
+    uint16_t lid[Config::RDMA_MAX_RAILS - 1] = {};
+    uint32_t rkey[Config::RDMA_MAX_RAILS - 1] = {};
+    uint8_t gid[Config::RDMA_MAX_RAILS - 1][16] = {};
+  } rails;
 };
 
 /* Moved into BaseMemory.h
@@ -296,9 +309,37 @@ class BaseRDMA {
   void setLocalConnData(const rdmaConnID rdmaConnID, ib_conn_t &conn);
 
   void createCQ(ibv_cq *&send_cq, ibv_cq *&rcv_cq);
+  void createCQ(ibv_context *ctx, ibv_cq *&send_cq, ibv_cq *&rcv_cq);
   void destroyCQ(ibv_cq *&send_cq, ibv_cq *&rcv_cq);
   virtual void createQP(struct ib_qp_t *qp) = 0;
 
+  /* Function: selectGidIndex
+   * ----------------
+   * Selects the GID used for routing. Config::RDMA_GID_INDEX is used
+   * if set, otherwise InfiniBand ports use LID routing (-1) and
+   * Ethernet ports (RoCE) prefer a RoCEv2 GID with an IPv4 address.
+   *
+   * return:  GID index or -1 for LID routing
+   */
+  int selectGidIndex();
+  static int selectGidIndex(ibv_context *ctx, int ibPort);
+
+  /* Function: getLocalGid
+   * ----------------
+   * Copies the local GID of m_gidIdx into gid (16 bytes),
+   * zeroed if LID routing is used
+   */
+  void getLocalGid(uint8_t *gid);
+  static void getLocalGid(ibv_context *ctx, int ibPort, int gidIdx, uint8_t *gid);
+
+  /* Function: getPathMTU
+   * ----------------
+   * Returns the MTU to use for connected QPs, which is limited
+   * by the active MTU of the port (e.g. 1024 bytes on RoCE)
+   */
+  ibv_mtu getPathMTU();
+  static ibv_mtu getPathMTU(const ibv_port_attr &portAttr);
+
   inline void __attribute__((always_inline))
   checkSignaled(bool &signaled, rdmaConnID rdmaConnID) {
     if (signaled) 
@@ -307,7 +348,7 @@ class BaseRDMA {
       return;
     }
     ++m_countWR[rdmaConnID];
-    if (m_countWR[rdmaConnID] == Config::RDMA_MAX_WR) {
+    if (m_countWR[rdmaConnID] >= Config::RDMA_MAX_WR) {  // bulk chunks may fill the last slot
       signaled = true;
       m_countWR[rdmaConnID] = 0;
     }
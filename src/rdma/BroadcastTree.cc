@@ -0,0 +1,97 @@
+#include "BroadcastTree.h"
+#include "../utils/Logging.h"
+
+#include <algorithm>
+
+using namespace rdma;
+
+//------------------------------------------------------------------------------------//
+
+BroadcastTree::BroadcastTree(ReliableRDMA *rdma, NodeID ownID, const std::vector<NodeID> &members,
+                             Topology topology)
+    : m_rdma(rdma) {
+  auto own = std::find(members.begin(), members.end(), ownID);
+  if (own == members.end()) {
+    throw runtime_error("BroadcastTree: node " + to_string(ownID) + " is not a member");
+  }
+  m_rank = own - members.begin();
+
+  if (topology == CHAIN) {
+    m_parent = m_rank > 0 ? members[m_rank - 1] : ownID;
+    if (m_rank + 1 < members.size()) {
+      m_children.push_back(members[m_rank + 1]);
+    }
+  } else {
+    // the parent has the highest bit of the rank cleared
+    size_t bit = 1;
+    while (bit <= m_rank) {
+      bit <<= 1;
+    }
+    m_parent = m_rank > 0 ? members[m_rank - (bit >> 1)] : ownID;
+    // largest subtree first
+    for (; m_rank + bit < members.size(); bit <<= 1) {
+      m_children.push_back(members[m_rank + bit]);
+    }
+  }
+
+  m_ready = (bcast_ready_t *)m_rdma->localAlloc(sizeof(bcast_ready_t) * (m_children.size() + 1));
+  if (m_ready == nullptr) {
+    throw runtime_error("BroadcastTree: allocating memory failed!");
+  }
+  m_childrenReady = m_ready + 1;
+  for (size_t i = 0; i < m_children.size(); ++i) {
+    m_rdma->receive(m_children[i], &m_childrenReady[i], sizeof(bcast_ready_t));
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+BroadcastTree::~BroadcastTree() {
+  // the receives for the next broadcast stay posted, so the memory is not freed
+}
+
+//------------------------------------------------------------------------------------//
+
+void BroadcastTree::broadcast(void *memAddr, size_t size) {
+  // at most one receive per chunk and RDMA_MAX_WR receives per QP
+  size_t chunkSize = std::max<size_t>(Config::RDMA_BULK_CHUNK_SIZE, (size + Config::RDMA_MAX_WR - 1) / Config::RDMA_MAX_WR);
+  size_t chunks = std::max<size_t>(1, (size + chunkSize - 1) / chunkSize);
+
+  if (!isRoot()) {
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+      m_rdma->receive(m_parent, nullptr, 0);
+    }
+    m_ready->offset = m_rdma->convertPointerToOffset(memAddr);
+    m_ready->size = size;
+    m_rdma->send(m_parent, m_ready, sizeof(bcast_ready_t), true);
+  }
+
+  std::vector<size_t> offsets(m_children.size());
+  for (size_t i = 0; i < m_children.size(); ++i) {
+    m_rdma->pollReceive(m_children[i], true);
+    if (m_childrenReady[i].size != size) {
+      throw runtime_error("BroadcastTree: node " + to_string(m_children[i]) + " expects " +
+                          to_string(m_childrenReady[i].size) + " bytes instead of " + to_string(size));
+    }
+    offsets[i] = m_childrenReady[i].offset;
+    m_rdma->receive(m_children[i], &m_childrenReady[i], sizeof(bcast_ready_t));
+  }
+
+  for (size_t chunk = 0; chunk < chunks; ++chunk) {
+    if (!isRoot()) {
+      uint32_t imm;
+      m_rdma->pollReceive(m_parent, true, &imm);
+      if (imm != chunk) {
+        throw runtime_error("BroadcastTree: received chunk " + to_string(imm) + " instead of " + to_string(chunk));
+      }
+    }
+
+    size_t pos = chunk * chunkSize;
+    size_t length = std::min(chunkSize, size - pos);
+    bool last = chunk + 1 == chunks;
+    for (size_t i = 0; i < m_children.size(); ++i) {
+      // only the last chunk is waited for, the data must not change before
+      m_rdma->writeImm(m_children[i], offsets[i] + pos, (char *)memAddr + pos, length, chunk, last);
+    }
+  }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file BroadcastTree.h
+ */
+
+#ifndef BroadcastTree_H_
+#define BroadcastTree_H_
+
+#include "../utils/Config.h"
+#include "ReliableRDMA.h"
+
+#include <vector>
+
+namespace rdma {
+
+// sent by a child to its parent when it is ready to receive a broadcast
+struct bcast_ready_t {
+  uint64_t offset;  // destination in the buffer of the child
+  uint64_t size;
+};
+
+/* Class: BroadcastTree
+ * ----------------
+ * Broadcasts data from a root to a group of nodes without hardware
+ * multicast. The members form a tree, every member receives the data
+ * from its parent and forwards it to its children:
+ *
+ * BINOMIAL:  the root reaches all members in log2(N) steps,
+ *            member r is the parent of r + 2^k for all 2^k > r
+ * CHAIN:     member r is the parent of r + 1, the root only sends
+ *            the data once
+ *
+ * The data is sent in chunks of Config::RDMA_BULK_CHUNK_SIZE with
+ * writeImm (the immediate is the chunk number), so a member forwards
+ * a chunk while it still receives the next ones from its parent.
+ *
+ * Before each broadcast every child posts one receive per chunk
+ * and tells its parent the destination of the data, so the parent
+ * never writes before the child is ready. The tree owns the receives
+ * on the connections between parents and children. All members must
+ * have been constructed before the first broadcast. Not thread safe.
+ */
+class BroadcastTree {
+ public:
+  enum Topology { BINOMIAL, CHAIN };
+
+  /* Function: BroadcastTree
+   * ----------------
+   * rdma:      connected to the parent and the children of this member
+   * ownID:     node ID of this member
+   * members:   node IDs of all members, the first one is the root,
+   *            same order on all members
+   * topology:  shape of the tree
+   */
+  BroadcastTree(ReliableRDMA *rdma, NodeID ownID, const std::vector<NodeID> &members,
+                Topology topology = BINOMIAL);
+  ~BroadcastTree();
+
+  /* Function: broadcast
+   * ----------------
+   * Called by all members, returns when the data has arrived and
+   * has been forwarded to the children.
+   *
+   * memAddr:  data to send at the root, destination at the others,
+   *           must be in the buffer of the rdma
+   * size:     size of the data, same on all members
+   */
+  void broadcast(void *memAddr, size_t size);
+
+  bool isRoot() { return m_rank == 0; }
+  NodeID getParent() { return m_parent; }
+  const std::vector<NodeID> &getChildren() { return m_children; }
+
+ private:
+  ReliableRDMA *m_rdma;
+  size_t m_rank;
+  NodeID m_parent;
+  std::vector<NodeID> m_children;
+
+  bcast_ready_t *m_ready;         // sent to the parent
+  bcast_ready_t *m_childrenReady;  // one per child, received
+};
+
+}  // namespace rdma
+
+#endif /* BroadcastTree_H_ */
@@ -0,0 +1,239 @@
+#include "Collectives.h"
+#include "../utils/Logging.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace rdma;
+
+//------------------------------------------------------------------------------------//
+
+Collectives::Collectives(ReliableRDMA *rdma, NodeID ownID, const std::vector<NodeID> &members, size_t maxCount)
+    : m_rdma(rdma), m_members(members), m_maxCount(maxCount) {
+  auto own = std::find(members.begin(), members.end(), ownID);
+  if (own == members.end()) {
+    throw runtime_error("Collectives: node " + to_string(ownID) + " is not a member");
+  }
+  m_rank = own - members.begin();
+  size_t n = members.size();
+
+  m_rounds = 0;
+  while (((size_t)1 << m_rounds) < n) {
+    ++m_rounds;
+  }
+  m_pow2 = 1;
+  while (m_pow2 * 2 <= n) {
+    m_pow2 *= 2;
+  }
+
+  // rounds, fold in and fold out of the members beyond m_pow2
+  m_slotCount = m_rounds + 2;
+  m_slotWords = n * maxCount + 1;
+  size_t words = 2 * m_rounds + 2 * 2 * m_slotCount * m_slotWords;
+  m_area = (uint64_t *)m_rdma->localAlloc(words * sizeof(uint64_t));
+  if (m_area == nullptr) {
+    throw runtime_error("Collectives: allocating memory failed! Size: " + to_string(words * sizeof(uint64_t)));
+  }
+  memset(m_area, 0, words * sizeof(uint64_t));
+  m_flags = m_area;
+  m_flagSrc = m_flags + m_rounds;
+  m_recvSlots = m_flagSrc + m_rounds;
+  m_sendSlots = m_recvSlots + 2 * m_slotCount * m_slotWords;
+
+  std::set<size_t> partners;
+  for (size_t dist = 1; dist < n; dist <<= 1) {
+    partners.insert((m_rank + dist) % n);
+    partners.insert((m_rank + n - dist) % n);
+  }
+  if (m_rank < m_pow2) {
+    for (size_t bit = 1; bit < m_pow2; bit <<= 1) {
+      partners.insert(m_rank ^ bit);
+    }
+    if (m_rank + m_pow2 < n) {
+      partners.insert(m_rank + m_pow2);
+    }
+  } else {
+    partners.insert(m_rank - m_pow2);
+  }
+  partners.erase(m_rank);
+  for (size_t partner : partners) {
+    m_partners.push_back(members[partner]);
+  }
+
+  // the last one is sent to the partners
+  m_partnerOffsets = (uint64_t *)m_rdma->localAlloc((m_partners.size() + 1) * sizeof(uint64_t));
+  if (m_partnerOffsets == nullptr) {
+    throw runtime_error("Collectives: allocating memory failed!");
+  }
+  for (size_t i = 0; i < m_partners.size(); ++i) {
+    m_rdma->receive(m_partners[i], &m_partnerOffsets[i], sizeof(uint64_t));
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+Collectives::~Collectives() {
+  m_rdma->localFree(m_area);
+  // the receives stay posted until the offsets were exchanged
+  if (m_remoteArea.size() == m_partners.size()) {
+    m_rdma->localFree(m_partnerOffsets);
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::exchangeOffsets() {
+  if (m_remoteArea.size() == m_partners.size()) {
+    return;
+  }
+  m_partnerOffsets[m_partners.size()] = m_rdma->convertPointerToOffset(m_area);
+  for (NodeID partner : m_partners) {
+    m_rdma->send(partner, &m_partnerOffsets[m_partners.size()], sizeof(uint64_t), true);
+  }
+  for (size_t i = 0; i < m_partners.size(); ++i) {
+    m_rdma->pollReceive(m_partners[i], true);
+    m_remoteArea[m_partners[i]] = m_partnerOffsets[i];
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::checkCount(size_t count) {
+  if (count > m_maxCount) {
+    throw runtime_error("Collectives: " + to_string(count) + " values exceed the maximum of " + to_string(m_maxCount));
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::put(size_t member, size_t index, const void *values, size_t words) {
+  uint64_t *src = slot(m_sendSlots, index);
+  memcpy(src, values, words * sizeof(uint64_t));
+  // the receiver polls on the epoch, it is written after the values
+  src[words] = m_epoch;
+
+  NodeID nodeID = m_members[member];
+  size_t offset = m_remoteArea[nodeID] + (slot(m_recvSlots, index) - m_area) * sizeof(uint64_t);
+  m_rdma->write(nodeID, offset, src, (words + 1) * sizeof(uint64_t), false);
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::get(size_t index, size_t words, void *values) {
+  uint64_t *dst = slot(m_recvSlots, index);
+  while (*(volatile uint64_t *)&dst[words] != m_epoch) {
+  }
+  memcpy(values, dst, words * sizeof(uint64_t));
+  // a later call with another count must not see an old epoch
+  memset(dst, 0, (words + 1) * sizeof(uint64_t));
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::barrier() {
+  exchangeOffsets();
+  ++m_epoch;
+
+  size_t n = m_members.size();
+  for (size_t k = 0; k < m_rounds; ++k) {
+    size_t dist = (size_t)1 << k;
+    NodeID nodeID = m_members[(m_rank + dist) % n];
+    m_flagSrc[k] = m_epoch;
+    size_t offset = m_remoteArea[nodeID] + (m_flags + k - m_area) * sizeof(uint64_t);
+    m_rdma->write(nodeID, offset, &m_flagSrc[k], sizeof(uint64_t), false);
+
+    // flags only grow, a member already in the next barrier has written a larger epoch
+    while (*(volatile uint64_t *)&m_flags[k] < m_epoch) {
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::allreduce(uint64_t *values, size_t count, ReduceOp op) {
+  reduce(values, count, op);
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::allreduce(int64_t *values, size_t count, ReduceOp op) {
+  reduce(values, count, op);
+}
+
+//------------------------------------------------------------------------------------//
+
+template <typename T>
+void Collectives::reduce(T *values, size_t count, ReduceOp op) {
+  static_assert(sizeof(T) == sizeof(uint64_t), "Collectives only reduce 64-bit values");
+  checkCount(count);
+  exchangeOffsets();
+  ++m_epoch;
+
+  std::vector<T> result(values, values + count);
+  std::vector<T> received(count);
+  auto combine = [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      switch (op) {
+        case SUM:
+          result[i] += received[i];
+          break;
+        case MIN:
+          result[i] = std::min(result[i], received[i]);
+          break;
+        case MAX:
+          result[i] = std::max(result[i], received[i]);
+          break;
+      }
+    }
+  };
+
+  size_t foldIn = m_rounds;
+  size_t foldOut = m_rounds + 1;
+  size_t n = m_members.size();
+
+  if (m_rank >= m_pow2) {
+    put(m_rank - m_pow2, foldIn, result.data(), count);
+    get(foldOut, count, values);
+    return;
+  }
+  if (m_rank + m_pow2 < n) {
+    get(foldIn, count, received.data());
+    combine();
+  }
+  size_t round = 0;
+  for (size_t bit = 1; bit < m_pow2; bit <<= 1, ++round) {
+    put(m_rank ^ bit, round, result.data(), count);
+    get(round, count, received.data());
+    combine();
+  }
+  if (m_rank + m_pow2 < n) {
+    put(m_rank + m_pow2, foldOut, result.data(), count);
+  }
+  memcpy(values, result.data(), count * sizeof(T));
+}
+
+//------------------------------------------------------------------------------------//
+
+void Collectives::allgather(const uint64_t *values, size_t count, uint64_t *result) {
+  checkCount(count);
+  exchangeOffsets();
+  ++m_epoch;
+
+  // block j holds the values of member m_rank + j
+  size_t n = m_members.size();
+  std::vector<uint64_t> blocks(n * count);
+  memcpy(blocks.data(), values, count * sizeof(uint64_t));
+
+  size_t have = 1;
+  size_t round = 0;
+  for (size_t dist = 1; dist < n; dist <<= 1, ++round) {
+    size_t send = std::min(dist, n - dist);
+    put((m_rank + n - dist) % n, round, blocks.data(), send * count);
+    get(round, send * count, blocks.data() + have * count);
+    have += send;
+  }
+
+  for (size_t j = 0; j < n; ++j) {
+    memcpy(result + ((m_rank + j) % n) * count, blocks.data() + j * count, count * sizeof(uint64_t));
+  }
+}
@@ -0,0 +1,124 @@
+/**
+ * @file Collectives.h
+ */
+
+#ifndef Collectives_H_
+#define Collectives_H_
+
+#include "../utils/Config.h"
+#include "ReliableRDMA.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace rdma {
+
+/* Class: Collectives
+ * ----------------
+ * Barrier, allreduce and allgather over a group of connected nodes,
+ * implemented with one-sided writes into flag and slot arrays of
+ * the partners:
+ *
+ * barrier:    dissemination barrier, in round k member r writes
+ *             the epoch into flag k of member r + 2^k (mod N)
+ * allreduce:  recursive doubling between r and r xor 2^k, members
+ *             beyond the largest power of two first fold their
+ *             values into member r - 2^m and get the result back
+ * allgather:  recursive doubling of the gathered blocks (Bruck),
+ *             works for any N with the partners of the barrier
+ *
+ * All need ceil(log2 N) rounds. Every call increments an epoch and
+ * data is written with the epoch behind it, the receiver polls on
+ * the epoch. Slots alternate between even and odd epochs, so a fast
+ * member can start the next call while others still read the slots.
+ *
+ * Members must be connected to their partners (a full mesh always
+ * suffices). Base offsets of the arrays are exchanged with
+ * send/receive at the first call, so all members must have been
+ * constructed before any member calls a collective. All members
+ * call the same collectives in the same order. Not thread safe.
+ */
+class Collectives {
+ public:
+  enum ReduceOp { SUM, MIN, MAX };
+
+  /* Function: Collectives
+   * ----------------
+   * rdma:      connected to the partners of this member
+   * ownID:     node ID of this member
+   * members:   node IDs of all members, same order on all members
+   * maxCount:  maximum number of values per member of a call
+   */
+  Collectives(ReliableRDMA *rdma, NodeID ownID, const std::vector<NodeID> &members, size_t maxCount);
+  ~Collectives();
+
+  /* Function: barrier
+   * ----------------
+   * Returns when all members entered the barrier
+   */
+  void barrier();
+
+  /* Function: allreduce
+   * ----------------
+   * Combines the values of all members element-wise,
+   * afterwards all members have the same result
+   *
+   * values:  count values, replaced by the result
+   * count:   number of values, same on all members
+   * op:      SUM, MIN or MAX
+   */
+  void allreduce(uint64_t *values, size_t count, ReduceOp op);
+  void allreduce(int64_t *values, size_t count, ReduceOp op);
+
+  /* Function: allgather
+   * ----------------
+   * Collects the values of all members
+   *
+   * values:  count values of this member
+   * count:   number of values, same on all members
+   * result:  count values per member, ordered as members
+   */
+  void allgather(const uint64_t *values, size_t count, uint64_t *result);
+
+  size_t getRank() { return m_rank; }
+  size_t getSize() { return m_members.size(); }
+
+ private:
+  template <typename T>
+  void reduce(T *values, size_t count, ReduceOp op);
+
+  void exchangeOffsets();
+  uint64_t *slot(uint64_t *slots, size_t index) {
+    return slots + ((m_epoch & 1) * m_slotCount + index) * m_slotWords;
+  }
+  void put(size_t member, size_t index, const void *values, size_t words);
+  void get(size_t index, size_t words, void *values);
+  void checkCount(size_t count);
+
+  ReliableRDMA *m_rdma;
+  std::vector<NodeID> m_members;
+  size_t m_rank;
+  size_t m_maxCount;
+  size_t m_rounds;  // ceil(log2 N)
+  size_t m_pow2;    // largest power of two <= N
+
+  uint64_t m_epoch = 0;
+
+  // all arrays in one allocation, the partners write into flags and recvSlots
+  uint64_t *m_area;
+  uint64_t *m_flags;      // barrier, one per round
+  uint64_t *m_flagSrc;    // barrier, one per round
+  uint64_t *m_recvSlots;  // [epoch parity][slot], rounds + fold in + fold out
+  uint64_t *m_sendSlots;
+  size_t m_slotCount;
+  size_t m_slotWords;  // N * maxCount values and the epoch
+
+  // base offsets of the arrays of the partners
+  std::vector<NodeID> m_partners;
+  uint64_t *m_partnerOffsets;
+  std::unordered_map<NodeID, size_t> m_remoteArea;
+};
+
+}  // namespace rdma
+
+#endif /* Collectives_H_ */
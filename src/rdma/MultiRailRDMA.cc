@@ -0,0 +1,469 @@
+#include "MultiRailRDMA.h"
+#include "../utils/Logging.h"
+
+#include <fstream>
+#include <sstream>
+
+#ifndef HUGEPAGE
+#define HUGEPAGE false
+#endif
+
+using namespace rdma;
+
+//------------------------------------------------------------------------------------//
+
+MultiRailRDMA::MultiRailRDMA(size_t mem_size) : MultiRailRDMA(mem_size, (int)MEMORY_TYPE::MAIN, HUGEPAGE, (int)Config::RDMA_NUMAREGION) {}
+MultiRailRDMA::MultiRailRDMA(size_t mem_size, int mem_type, bool huge, int numaNode) : ReliableRDMA(mem_size, mem_type, huge, numaNode) {
+  openRails();
+}
+MultiRailRDMA::MultiRailRDMA(BaseMemory *buffer) : ReliableRDMA(buffer) {
+  openRails();
+}
+
+//------------------------------------------------------------------------------------//
+
+MultiRailRDMA::~MultiRailRDMA() {
+  std::unique_lock<std::mutex> lck(m_railLock);
+  for (auto &rails : m_railConns) {
+    for (size_t r = 1; r < rails.size(); ++r) {
+      destroyRailQP(rails[r].qp);
+    }
+  }
+  m_railConns.clear();
+  for (auto &pending : m_pendingRails) {
+    for (auto &qp : pending.second) {
+      destroyRailQP(qp);
+    }
+  }
+  m_pendingRails.clear();
+
+  // the device of the buffer is released by the buffer
+  for (auto &device : m_railDevices) {
+    if (!device.owned) {
+      continue;
+    }
+    if (ibv_dereg_mr(device.mr)) {
+      Logging::error(__FILE__, __LINE__, "Could not deregister memory of rail");
+    }
+    ibv_dealloc_pd(device.pd);
+    ibv_close_device(device.ctx);
+  }
+  m_railDevices.clear();
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::openRails() {
+  if (!m_buffer->isIBV()) {
+    return;
+  }
+
+  // rail 0
+  m_railDevices.push_back(rail_device_t{m_buffer->ib_context(), m_buffer->ib_pd(), m_buffer->ib_mr(), false});
+  m_rails.push_back(rail_t{0, m_buffer->getIBPort(), m_buffer->ib_port_attributes(), m_gidIdx});
+
+  int num_devices = 0;
+  struct ibv_device **dev_list = nullptr;
+  if ((dev_list = ibv_get_device_list(&num_devices)) == nullptr) {
+    throw runtime_error("Get device list failed!");
+  }
+
+  // contexts are opened once per device and shared by its ports
+  auto openContext = [&](ibv_device *dev) -> ibv_context * {
+    for (auto &device : m_railDevices) {
+      if (strcmp(ibv_get_device_name(device.ctx->device), ibv_get_device_name(dev)) == 0) {
+        return device.ctx;
+      }
+    }
+    ibv_context *ctx = ibv_open_device(dev);
+    if (ctx == nullptr) {
+      throw runtime_error("Open device failed!");
+    }
+    return ctx;
+  };
+  auto isContextUsed = [&](ibv_context *ctx) {
+    for (auto &device : m_railDevices) {
+      if (device.ctx == ctx) return true;
+    }
+    return false;
+  };
+
+  try {
+    if (!Config::RDMA_RAILS.empty()) {
+      // explicit rails "device:port"
+      std::istringstream rails(Config::RDMA_RAILS);
+      string rail;
+      while (std::getline(rails, rail, ',')) {
+        size_t pos = rail.find(':');
+        string name = rail.substr(0, pos);
+        int ibPort = (pos == string::npos ? 1 : stoi(rail.substr(pos + 1)));
+
+        ibv_device *dev = nullptr;
+        for (int i = 0; i < num_devices; ++i) {
+          if (name == ibv_get_device_name(dev_list[i])) {
+            dev = dev_list[i];
+          }
+        }
+        if (dev == nullptr) {
+          throw runtime_error("MultiRailRDMA: RDMA device " + name + " of Config::RDMA_RAILS not found");
+        }
+        ibv_context *ctx = openContext(dev);
+        if (ctx == m_buffer->ib_context() && ibPort == m_buffer->getIBPort()) {
+          continue;  // rail 0
+        }
+        try {
+          addRail(ctx, ibPort);
+        } catch (const runtime_error &e) {
+          if (!isContextUsed(ctx)) ibv_close_device(ctx);
+          throw;
+        }
+        if (!isContextUsed(ctx)) {
+          ibv_close_device(ctx);  // more rails than Config::RDMA_MAX_RAILS
+        }
+      }
+    } else {
+      // all active ports of the devices on the NUMA node of the buffer, devices
+      // without NUMA affinity (-1, e.g. single socket or VMs) match any node
+      for (int i = 0; i < num_devices && m_rails.size() < Config::RDMA_MAX_RAILS; ++i) {
+        ifstream numa_node_file;
+        numa_node_file.open(std::string(dev_list[i]->ibdev_path) + "/device/numa_node");
+        int numa = -1;
+        numa_node_file >> numa;
+        if (numa != -1 && numa != m_buffer->getNumaNode()) {
+          continue;
+        }
+
+        ibv_context *ctx = openContext(dev_list[i]);
+        struct ibv_device_attr device_attr;
+        if (ibv_query_device(ctx, &device_attr) == 0) {
+          for (int ibPort = 1; ibPort <= device_attr.phys_port_cnt && m_rails.size() < Config::RDMA_MAX_RAILS; ++ibPort) {
+            struct ibv_port_attr port_attr;
+            if (ctx == m_buffer->ib_context() && ibPort == m_buffer->getIBPort()) {
+              continue;  // rail 0
+            }
+            if (ibv_query_port(ctx, ibPort, &port_attr) != 0 || port_attr.state != IBV_PORT_ACTIVE) {
+              continue;
+            }
+            addRail(ctx, ibPort);
+          }
+        }
+        if (!isContextUsed(ctx)) {
+          ibv_close_device(ctx);
+        }
+      }
+    }
+  } catch (...) {
+    ibv_free_device_list(dev_list);
+    throw;
+  }
+  ibv_free_device_list(dev_list);
+
+  Logging::info("MultiRailRDMA: using " + to_string(m_rails.size()) + " rail(s)");
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::addRail(ibv_context *ctx, int ibPort) {
+  if (m_rails.size() >= Config::RDMA_MAX_RAILS) {
+    Logging::warn("MultiRailRDMA: more rails than Config::RDMA_MAX_RAILS, ignoring " +
+                  string(ibv_get_device_name(ctx->device)) + ":" + to_string(ibPort));
+    return;
+  }
+
+  struct ibv_port_attr port_attr;
+  if ((errno = ibv_query_port(ctx, ibPort, &port_attr)) != 0) {
+    throw runtime_error("Query port failed");
+  }
+  int gidIdx = selectGidIndex(ctx, ibPort);
+
+  // register the buffer once per device
+  size_t device = 0;
+  while (device < m_railDevices.size() && m_railDevices[device].ctx != ctx) {
+    ++device;
+  }
+  if (device == m_railDevices.size()) {
+    ibv_pd *pd = ibv_alloc_pd(ctx);
+    if (pd == nullptr) {
+      throw runtime_error("Cannot create protected domain with InfiniBand");
+    }
+    int mr_flags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ |
+                   IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_REMOTE_ATOMIC;
+    ibv_mr *mr = ibv_reg_mr(pd, m_buffer->pointer(), m_buffer->getSize(), mr_flags);
+    if (mr == nullptr) {
+      ibv_dealloc_pd(pd);
+      throw runtime_error("Cannot register memory for InfiniBand on rail " +
+                          string(ibv_get_device_name(ctx->device)));
+    }
+    m_railDevices.push_back(rail_device_t{ctx, pd, mr, true});
+  }
+
+  m_rails.push_back(rail_t{device, ibPort, port_attr, gidIdx});
+  Logging::debug(__FILE__, __LINE__, "MultiRailRDMA: rail " + to_string(m_rails.size() - 1) + " is " +
+                 string(ibv_get_device_name(ctx->device)) + ":" + to_string(ibPort));
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::initQPWithSuppliedID(const rdmaConnID rdmaConnID) {
+  ReliableRDMA::initQPWithSuppliedID(rdmaConnID);
+  initRailQPs(m_lconns[rdmaConnID]);
+}
+
+void MultiRailRDMA::initQPWithSuppliedID(struct ib_qp_t **qp, struct ib_conn_t **localConn) {
+  ReliableRDMA::initQPWithSuppliedID(qp, localConn);
+  initRailQPs(**localConn);
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::initRailQPs(struct ib_conn_t &localConn) {
+  localConn.rails.count = 0;
+  if (m_rails.size() <= 1) {
+    return;
+  }
+
+  std::vector<ib_qp_t> qps;
+  try {
+    for (size_t r = 1; r < m_rails.size(); ++r) {
+      rail_t &rail = m_rails[r];
+      rail_device_t &device = m_railDevices[rail.device];
+
+      ib_qp_t qp;
+      createCQ(device.ctx, qp.send_cq, qp.recv_cq);
+      try {
+        createQP(&qp, device.pd);
+      } catch (const runtime_error &e) {
+        destroyCQ(qp.send_cq, qp.recv_cq);
+        throw;
+      }
+      qps.push_back(qp);
+      modifyQPToInit(qp.qp, rail.ibPort);
+
+      localConn.rails.qp_num[r - 1] = qp.qp->qp_num;
+      localConn.rails.lid[r - 1] = rail.portAttr.lid;
+      localConn.rails.rkey[r - 1] = device.mr->rkey;
+      getLocalGid(device.ctx, rail.ibPort, rail.gidIdx, localConn.rails.gid[r - 1]);
+    }
+  } catch (const runtime_error &e) {
+    for (auto &qp : qps) {
+      destroyRailQP(qp);
+    }
+    throw;
+  }
+  localConn.rails.count = qps.size();
+
+  std::unique_lock<std::mutex> lck(m_railLock);
+  m_pendingRails[localConn.qp_num] = qps;
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::connectQP(const rdmaConnID rdmaConnID) {
+  bool connected = m_connected.find(rdmaConnID) != m_connected.end();
+  ReliableRDMA::connectQP(rdmaConnID);
+  if (connected) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lck(m_railLock);
+  std::vector<ib_qp_t> qps;
+  auto pending = m_pendingRails.find(m_lconns[rdmaConnID].qp_num);
+  if (pending != m_pendingRails.end()) {
+    qps = pending->second;
+    m_pendingRails.erase(pending);
+  }
+
+  if (m_railConns.size() < rdmaConnID + 1) {
+    m_railConns.resize(rdmaConnID + 1);
+  }
+  auto &rails = m_railConns[rdmaConnID];
+  rails.clear();
+
+  // use the rails both peers have
+  ib_conn_t &remoteConn = m_rconns[rdmaConnID];
+  size_t count = std::min<size_t>(qps.size(), remoteConn.rails.count);
+  if (count > 0) {
+    rail_conn_t rail0;
+    rail0.qp = m_qps[rdmaConnID];
+    rail0.lkey = m_buffer->ib_mr()->lkey;
+    rail0.rkey = remoteConn.rc.rkey;
+    rails.push_back(rail0);
+  }
+  for (size_t r = 0; r < qps.size(); ++r) {
+    if (r >= count) {
+      destroyRailQP(qps[r]);
+      continue;
+    }
+    rail_t &rail = m_rails[r + 1];
+    modifyQPToRTR(qps[r].qp, remoteConn.rails.qp_num[r], remoteConn.rails.lid[r],
+                  remoteConn.rails.gid[r], rail.ibPort, rail.gidIdx, getPathMTU(rail.portAttr));
+    modifyQPToRTS(qps[r].qp);
+
+    rail_conn_t railConn;
+    railConn.qp = qps[r];
+    railConn.lkey = m_railDevices[rail.device].mr->lkey;
+    railConn.rkey = remoteConn.rails.rkey[r];
+    rails.push_back(railConn);
+  }
+  Logging::debug(__FILE__, __LINE__, "MultiRailRDMA: connected " + to_string(getRailCount(rdmaConnID)) + " rail(s)");
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::disconnectQP(const rdmaConnID rdmaConnID) {
+  ReliableRDMA::disconnectQP(rdmaConnID);
+
+  std::unique_lock<std::mutex> lck(m_railLock);
+  if (rdmaConnID < m_railConns.size()) {
+    auto &rails = m_railConns[rdmaConnID];
+    for (size_t r = 1; r < rails.size(); ++r) {
+      destroyRailQP(rails[r].qp);
+    }
+    rails.clear();
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::destroyRailQP(ib_qp_t &qp) {
+  if (qp.qp == nullptr) {
+    return;
+  }
+  if (ibv_destroy_qp(qp.qp) != 0) {
+    throw runtime_error("Error, ibv_destroy_qp() failed while destroying rail QP");
+  }
+  qp.qp = nullptr;
+  destroyCQ(qp.send_cq, qp.recv_cq);
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::write(const rdmaConnID rdmaConnID, size_t offset,
+                          const void *memAddr, size_t size, bool signaled) {
+  railAccess(rdmaConnID, offset, memAddr, size, signaled, IBV_WR_RDMA_WRITE);
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::read(const rdmaConnID rdmaConnID, size_t offset,
+                         const void *memAddr, size_t size, bool signaled) {
+  railAccess(rdmaConnID, offset, memAddr, size, signaled, IBV_WR_RDMA_READ);
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::railAccess(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+                               size_t size, bool signaled, enum ibv_wr_opcode verb) {
+  size_t railCount = getRailCount(rdmaConnID);
+  if (railCount == 1) {
+    // WRs are limited to the max message size of the port
+    for (; size > m_maxMsgSize; size -= m_maxMsgSize) {
+      remoteAccess(rdmaConnID, offset, memAddr, m_maxMsgSize, false, true, verb);
+      offset += m_maxMsgSize;
+      memAddr = (char *)memAddr + m_maxMsgSize;
+    }
+    remoteAccess(rdmaConnID, offset, memAddr, size, signaled, true, verb);
+    return;
+  }
+
+  uint64_t remoteAddr = m_rconns[rdmaConnID].buffer + offset;
+  bool poll[Config::RDMA_MAX_RAILS] = {};
+
+  if (size >= Config::RDMA_STRIPE_THRESHOLD) {
+    // one cache line aligned stripe per rail
+    size_t stripe = (size + railCount - 1) / railCount;
+    stripe = (stripe + Config::CACHELINE_SIZE - 1) / Config::CACHELINE_SIZE * Config::CACHELINE_SIZE;
+    for (size_t r = 0, pos = 0; r < railCount && pos < size; ++r, pos += stripe) {
+      poll[r] = postRail(rdmaConnID, r, remoteAddr + pos, (char *)memAddr + pos,
+                         std::min(stripe, size - pos), signaled, verb);
+    }
+  } else {
+    size_t r = selectRail(offset, railCount);
+    poll[r] = postRail(rdmaConnID, r, remoteAddr, memAddr, size, signaled, verb);
+  }
+
+  if (!signaled) {
+    return;
+  }
+
+  // completions are only ordered per QP: rails with unsignaled WRs
+  // get an empty signaled write, so all rails are complete afterwards
+  for (size_t r = 0; r < railCount; ++r) {
+    if (!poll[r] && unsignaledWRs(rdmaConnID, r) > 0) {
+      poll[r] = postRail(rdmaConnID, r, remoteAddr, nullptr, 0, true, IBV_WR_RDMA_WRITE);
+    }
+  }
+  for (size_t r = 0; r < railCount; ++r) {
+    if (poll[r]) {
+      pollRail(m_railConns[rdmaConnID][r]);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+bool MultiRailRDMA::postRail(const rdmaConnID rdmaConnID, size_t rail, uint64_t remoteAddr,
+                             const void *memAddr, size_t size, bool signaled, enum ibv_wr_opcode verb) {
+  // WRs are limited to the max message size of the port, only the last one may be signaled
+  for (; size > m_maxMsgSize; size -= m_maxMsgSize) {
+    postRail(rdmaConnID, rail, remoteAddr, memAddr, m_maxMsgSize, false, verb);
+    remoteAddr += m_maxMsgSize;
+    memAddr = (char *)memAddr + m_maxMsgSize;
+  }
+
+  rail_conn_t &railConn = m_railConns[rdmaConnID][rail];
+
+  size_t &unsignaled = unsignaledWRs(rdmaConnID, rail);
+  bool forced = false;
+  if (signaled) {
+    unsignaled = 0;
+  } else if (++unsignaled == Config::RDMA_MAX_WR) {
+    forced = true;
+    unsignaled = 0;
+  }
+
+  struct ibv_send_wr sr;
+  struct ibv_sge sge;
+  memset(&sge, 0, sizeof(sge));
+  sge.addr = (uintptr_t)memAddr;
+  sge.lkey = railConn.lkey;
+  sge.length = size;
+  memset(&sr, 0, sizeof(sr));
+  sr.sg_list = &sge;
+  sr.num_sge = (size > 0 ? 1 : 0);
+  sr.opcode = verb;
+  sr.send_flags = ((signaled || forced) ? IBV_SEND_SIGNALED : 0) |
+                  (size < Config::MAX_RC_INLINE_SEND && verb == IBV_WR_RDMA_WRITE ? IBV_SEND_INLINE : 0);
+  sr.wr.rdma.remote_addr = remoteAddr;
+  sr.wr.rdma.rkey = railConn.rkey;
+
+  struct ibv_send_wr *bad_wr = nullptr;
+  if ((errno = ibv_post_send(railConn.qp.qp, &sr, &bad_wr))) {
+    throw runtime_error("RDMA OP not successful on rail " + to_string(rail) + "! error: " + to_string(errno));
+  }
+
+  if (forced) {
+    pollRail(railConn);
+    return false;
+  }
+  return signaled;
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiRailRDMA::pollRail(rail_conn_t &rail) {
+  struct ibv_wc wc;
+  int ne;
+  do {
+    wc.status = IBV_WC_SUCCESS;
+    ne = ibv_poll_cq(rail.qp.send_cq, 1, &wc);
+    if (wc.status != IBV_WC_SUCCESS) {
+      throw runtime_error("RDMA completion event in CQ with error on rail! " +
+                          to_string(wc.status));
+    }
+  } while (ne == 0);
+
+  if (ne < 0) {
+    throw runtime_error("RDMA polling from CQ failed!");
+  }
+}
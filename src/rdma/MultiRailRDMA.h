@@ -0,0 +1,147 @@
+/**
+ * @file MultiRailRDMA.h
+ */
+
+#ifndef MultiRailRDMA_H_
+#define MultiRailRDMA_H_
+
+#include "../utils/Config.h"
+#include "ReliableRDMA.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rdma {
+
+/* Class: MultiRailRDMA
+ * ----------------
+ * Reliable RDMA which uses several NICs or ports (rails) per peer.
+ * Rail 0 is the device and port of the buffer (as in ReliableRDMA),
+ * the other rails are taken from Config::RDMA_RAILS (e.g.
+ * "mlx5_1:1,rxe1:1") or, if empty, are all other active ports of
+ * the devices at the NUMA node of the buffer or without NUMA
+ * affinity. The buffer is registered on every device and every
+ * connection gets one QP per rail. Rails are paired by index (rail
+ * i of both peers must be on the same network) and peers agree on
+ * the smaller rail count, a peer using ReliableRDMA therefore gets
+ * a single rail connection.
+ *
+ * Writes and reads of at least Config::RDMA_STRIPE_THRESHOLD bytes
+ * are striped over all rails. Smaller writes and reads go to one
+ * rail chosen by the remote page, so accesses to the same address
+ * always use the same rail. A signaled write/read waits until all
+ * operations on all rails of the connection completed, i.e. a
+ * striped transfer completes once. Stripes larger than the max
+ * message size of the port are posted as several WRs.
+ *
+ * All other operations (atomics, send/receive, writeImm) use rail 0
+ * like ReliableRDMA and only complete the operations of rail 0.
+ */
+class MultiRailRDMA : public ReliableRDMA {
+ public:
+  MultiRailRDMA(size_t mem_size = Config::RDMA_MEMSIZE);
+  MultiRailRDMA(size_t mem_size, int mem_type, bool huge, int numaNode);
+  MultiRailRDMA(BaseMemory *buffer);
+  ~MultiRailRDMA();
+
+  void initQPWithSuppliedID(const rdmaConnID suppliedID) override;
+  void initQPWithSuppliedID(struct ib_qp_t **qp, struct ib_conn_t **localConn) override;
+
+  void connectQP(const rdmaConnID rdmaConnID) override;
+  void disconnectQP(const rdmaConnID rdmaConnID) override;
+
+  // see ReliableRDMA
+  void write(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+             size_t size, bool signaled);
+  void read(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+            size_t size, bool signaled);
+
+  /* Function: getRailCount
+   * ----------------
+   * Returns the number of local rails (including rail 0)
+   */
+  size_t getRailCount() { return m_rails.size(); }
+
+  /* Function: getRailCount
+   * ----------------
+   * Returns the number of rails used by a connection
+   */
+  size_t getRailCount(const rdmaConnID rdmaConnID) {
+    return rdmaConnID < m_railConns.size() && !m_railConns[rdmaConnID].empty()
+               ? m_railConns[rdmaConnID].size() : 1;
+  }
+
+ protected:
+  // device with the buffer registered on it, shared by its ports
+  struct rail_device_t {
+    ibv_context *ctx;
+    ibv_pd *pd;
+    ibv_mr *mr;
+    bool owned;  // false for the device of the buffer
+  };
+
+  struct rail_t {
+    size_t device;  // index in m_railDevices
+    int ibPort;
+    ibv_port_attr portAttr;
+    int gidIdx;
+  };
+
+  // one rail of a connection, rail 0 is the QP in m_qps
+  struct rail_conn_t {
+    ib_qp_t qp;
+    uint32_t lkey;
+    uint32_t rkey;
+    size_t unsignaled = 0;  // WRs since the last signaled WR
+  };
+
+  void openRails();
+  void addRail(ibv_context *ctx, int ibPort);
+  void initRailQPs(struct ib_conn_t &localConn);
+  void destroyRailQP(ib_qp_t &qp);
+
+  /* Function: railAccess
+   * ----------------
+   * Stripes or hashes a write/read over the rails of the connection
+   */
+  void railAccess(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+                  size_t size, bool signaled, enum ibv_wr_opcode verb);
+
+  /* Function: postRail
+   * ----------------
+   * Posts a write/read on a rail of the connection, split into
+   * WRs of at most the max message size of the port. Every
+   * Config::RDMA_MAX_WR WRs one is signaled and waited for,
+   * so the send queue never overflows.
+   *
+   * return:  true if the last WR is signaled and has to be polled
+   */
+  bool postRail(const rdmaConnID rdmaConnID, size_t rail, uint64_t remoteAddr,
+                const void *memAddr, size_t size, bool signaled, enum ibv_wr_opcode verb);
+  void pollRail(rail_conn_t &rail);
+
+  // rail 0 shares the counter with the operations of ReliableRDMA
+  size_t &unsignaledWRs(const rdmaConnID rdmaConnID, size_t rail) {
+    return rail == 0 ? m_countWR[rdmaConnID] : m_railConns[rdmaConnID][rail].unsignaled;
+  }
+
+  // accesses to the same remote page always use the same rail
+  static size_t selectRail(size_t offset, size_t rails) {
+    return (((offset >> 12) * 0x9E3779B97F4A7C15ULL) >> 32) % rails;
+  }
+
+  std::vector<rail_device_t> m_railDevices;
+  std::vector<rail_t> m_rails;  // rail 0 is the device and port of the buffer
+
+  std::vector<std::vector<rail_conn_t>> m_railConns;  // rdmaConnID is the index of the vector
+
+  // QPs of rails 1..n created in initQP, keyed by the QP number of rail 0
+  std::mutex m_railLock;
+  std::unordered_map<uint64_t, std::vector<ib_qp_t>> m_pendingRails;
+};
+
+}  // namespace rdma
+
+#endif /* MultiRailRDMA_H_ */
@@ -0,0 +1,373 @@
+#include "MultiplexedRDMA.h"
+#include "../utils/Logging.h"
+
+#ifndef HUGEPAGE
+#define HUGEPAGE false
+#endif
+
+using namespace rdma;
+
+// completions routed per call of ibv_poll_cq
+static const int MUX_POLL_BATCH = 16;
+
+//------------------------------------------------------------------------------------//
+
+MultiplexedRDMA::MultiplexedRDMA(size_t mem_size) : MultiplexedRDMA(mem_size, (int)MEMORY_TYPE::MAIN, HUGEPAGE, (int)Config::RDMA_NUMAREGION) {}
+MultiplexedRDMA::MultiplexedRDMA(size_t mem_size, int mem_type, bool huge, int numaNode) : ReliableRDMA(mem_size, mem_type, huge, numaNode) {}
+MultiplexedRDMA::MultiplexedRDMA(BaseMemory *buffer) : ReliableRDMA(buffer) {}
+
+//------------------------------------------------------------------------------------//
+
+MultiplexedRDMA::~MultiplexedRDMA() {
+  std::unique_lock<std::mutex> lck(m_muxLock);
+  m_logicalConns.clear();
+  m_muxPools.clear();
+}
+
+//------------------------------------------------------------------------------------//
+
+MultiplexedRDMA::mux_qp_t *MultiplexedRDMA::createMuxQP(const rdmaConnID rdmaConnID) {
+  std::unique_lock<std::mutex> qpLck(m_qpLock);
+  if (rdmaConnID >= m_qps.size() || m_qps[rdmaConnID].qp == nullptr) {
+    throw runtime_error("MultiplexedRDMA: no QP for connection " + to_string(rdmaConnID));
+  }
+  auto muxQP = new mux_qp_t();
+  muxQP->qp = m_qps[rdmaConnID];
+  muxQP->connID = rdmaConnID;
+  muxQP->remoteBuffer = m_rconns[rdmaConnID].buffer;
+  muxQP->rkey = m_rconns[rdmaConnID].rc.rkey;
+  muxQP->lkey = m_buffer->ib_mr()->lkey;
+  return muxQP;
+}
+
+//------------------------------------------------------------------------------------//
+
+std::vector<std::unique_ptr<MultiplexedRDMA::mux_qp_t>> &MultiplexedRDMA::getPool(const rdmaConnID rdmaConnID) {
+  // the connection of the peer is always the first QP of its pool
+  auto &pool = m_muxPools[rdmaConnID];
+  if (pool.empty()) {
+    try {
+      pool.emplace_back(createMuxQP(rdmaConnID));
+    } catch (...) {
+      m_muxPools.erase(rdmaConnID);
+      throw;
+    }
+    Logging::debug(__FILE__, __LINE__, "MultiplexedRDMA: sharing QP of connection " + to_string(rdmaConnID));
+  }
+  return pool;
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::addToPool(const rdmaConnID rdmaConnID, const size_t pooledConnID) {
+  std::unique_lock<std::mutex> lck(m_muxLock);
+  auto &pool = getPool(rdmaConnID);
+  for (auto &muxQP : pool) {
+    if (muxQP->connID == pooledConnID) {
+      return;
+    }
+  }
+  pool.emplace_back(createMuxQP(pooledConnID));
+  Logging::debug(__FILE__, __LINE__, "MultiplexedRDMA: added QP of connection " + to_string(pooledConnID) +
+                                     " to pool of connection " + to_string(rdmaConnID));
+}
+
+//------------------------------------------------------------------------------------//
+
+size_t MultiplexedRDMA::getPoolSize(const rdmaConnID rdmaConnID) {
+  std::unique_lock<std::mutex> lck(m_muxLock);
+  auto it = m_muxPools.find(rdmaConnID);
+  return it == m_muxPools.end() ? 1 : it->second.size();
+}
+
+//------------------------------------------------------------------------------------//
+
+MultiplexedRDMA::LogicalConnection *MultiplexedRDMA::openLogicalConnection(const rdmaConnID rdmaConnID) {
+  std::unique_lock<std::mutex> lck(m_muxLock);
+  auto &pool = getPool(rdmaConnID);
+  mux_qp_t *muxQP = pool[0].get();
+  for (auto &candidate : pool) {
+    if (candidate->logicalConns < muxQP->logicalConns) {
+      muxQP = candidate.get();
+    }
+  }
+
+  uint64_t id = m_nextLogicalID++;
+  {
+    std::unique_lock<std::mutex> recvLck(muxQP->recvLock);
+    muxQP->recvCompletions[id];
+  }
+  ++muxQP->logicalConns;
+  auto logicalConn = new LogicalConnection(muxQP, id);
+  m_logicalConns[id].reset(logicalConn);
+  return logicalConn;
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::closeLogicalConnection(LogicalConnection *logicalConn) {
+  std::unique_lock<std::mutex> lck(m_muxLock);
+  auto it = m_logicalConns.find(logicalConn->m_id);
+  if (it == m_logicalConns.end()) {
+    return;
+  }
+  mux_qp_t *muxQP = logicalConn->m_qp;
+  {
+    std::unique_lock<std::mutex> recvLck(muxQP->recvLock);
+    muxQP->recvCompletions.erase(logicalConn->m_id);
+  }
+  --muxQP->logicalConns;
+  m_logicalConns.erase(it);
+}
+
+//------------------------------------------------------------------------------------//
+
+uint64_t MultiplexedRDMA::mux_qp_t::postSend(struct ibv_send_wr &sr, bool signaled) {
+  // unsignaled work requests only free their slots with a later signaled one
+  uint64_t signalInterval = std::max<uint64_t>(1, Config::RDMA_MAX_WR / 2);
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lck(postLock);
+      if (posted - completed.load(std::memory_order_acquire) < Config::RDMA_MAX_WR) {
+        uint64_t seq = posted + 1;
+        bool signal = signaled || seq - lastSignaled >= signalInterval;
+        sr.wr_id = seq << 1;
+        if (signal) {
+          sr.send_flags |= IBV_SEND_SIGNALED;
+        }
+
+        struct ibv_send_wr *bad_wr = nullptr;
+        if ((errno = ibv_post_send(qp.qp, &sr, &bad_wr))) {
+          throw runtime_error("RDMA OP not successful! error: " + to_string(errno));
+        }
+        posted = seq;
+        if (signal) {
+          lastSignaled = seq;
+        }
+        return seq;
+      }
+    }
+    // send queue is full, completions of any logical connection free slots
+    pollSendCQ();
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::mux_qp_t::postRecv(struct ibv_recv_wr &wr) {
+  std::unique_lock<std::mutex> lck(postLock);
+  struct ibv_recv_wr *bad_wr = nullptr;
+  if ((errno = ibv_post_recv(qp.qp, &wr, &bad_wr))) {
+    throw runtime_error("RECV has not been posted successfully in receive()! errno: " +
+                        std::string(std::strerror(errno)));
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::mux_qp_t::pollSendCQ() {
+  // only one thread polls, the others wait for the sequence number to advance
+  std::unique_lock<std::mutex> lck(sendPollLock, std::try_to_lock);
+  if (!lck.owns_lock()) {
+    return;
+  }
+
+  struct ibv_wc wc[MUX_POLL_BATCH];
+  int ne = ibv_poll_cq(qp.send_cq, MUX_POLL_BATCH, wc);
+  if (ne < 0) {
+    throw runtime_error("RDMA polling from CQ failed!");
+  }
+  for (int i = 0; i < ne; ++i) {
+    if (wc[i].status != IBV_WC_SUCCESS) {
+      int success = IBV_WC_SUCCESS;
+      sendStatus.compare_exchange_strong(success, wc[i].status);
+    }
+    // completions arrive in posting order
+    completed.store(wc[i].wr_id >> 1, std::memory_order_release);
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::mux_qp_t::pollRecvCQ() {
+  std::unique_lock<std::mutex> lck(recvPollLock, std::try_to_lock);
+  if (!lck.owns_lock()) {
+    return;
+  }
+
+  struct ibv_wc wc[MUX_POLL_BATCH];
+  int ne = ibv_poll_cq(qp.recv_cq, MUX_POLL_BATCH, wc);
+  if (ne < 0) {
+    throw runtime_error("RDMA polling from CQ failed!");
+  }
+  std::unique_lock<std::mutex> recvLck(recvLock);
+  for (int i = 0; i < ne; ++i) {
+    auto it = recvCompletions.find(wc[i].wr_id);
+    if (it == recvCompletions.end()) {
+      Logging::debug(__FILE__, __LINE__, "MultiplexedRDMA: dropped receive of closed logical connection");
+      continue;
+    }
+    it->second.push_back(recv_completion_t{wc[i].status, wc[i].imm_data});
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+MultiplexedRDMA::LogicalConnection::LogicalConnection(mux_qp_t *qp, uint64_t id) : m_qp(qp), m_id(id) {}
+
+size_t MultiplexedRDMA::LogicalConnection::getConnID() {
+  return m_qp->connID;
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::LogicalConnection::postSend(struct ibv_send_wr &sr, bool signaled) {
+  uint64_t seq = m_qp->postSend(sr, signaled);
+  if (signaled) {
+    m_lastSignaled = seq;
+    pollSend(true);
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+bool MultiplexedRDMA::LogicalConnection::pollSend(bool doPoll) {
+  while (m_qp->completed.load(std::memory_order_acquire) < m_lastSignaled) {
+    if (m_qp->sendStatus.load() != IBV_WC_SUCCESS) {
+      break;
+    }
+    m_qp->pollSendCQ();
+    if (!doPoll && m_qp->completed.load(std::memory_order_acquire) < m_lastSignaled) {
+      return false;
+    }
+  }
+  int status = m_qp->sendStatus.load();
+  if (status != IBV_WC_SUCCESS) {
+    throw runtime_error("RDMA completion event in CQ with error! " + to_string(status));
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::LogicalConnection::remoteAccess(size_t offset, const void *memAddr, size_t size,
+                                                      bool signaled, enum ibv_wr_opcode verb, uint32_t *imm) {
+  struct ibv_send_wr sr;
+  struct ibv_sge sge;
+  memset(&sge, 0, sizeof(sge));
+  sge.addr = (uintptr_t)memAddr;
+  sge.lkey = m_qp->lkey;
+  sge.length = size;
+  memset(&sr, 0, sizeof(sr));
+  sr.sg_list = &sge;
+  sr.num_sge = 1;
+  sr.opcode = verb;
+  sr.send_flags = (size < Config::MAX_RC_INLINE_SEND && verb != IBV_WR_RDMA_READ ? IBV_SEND_INLINE : 0);
+  if (verb != IBV_WR_SEND && verb != IBV_WR_SEND_WITH_IMM) {
+    sr.wr.rdma.remote_addr = m_qp->remoteBuffer + offset;
+    sr.wr.rdma.rkey = m_qp->rkey;
+  }
+  if (imm != nullptr) {
+    sr.imm_data = *imm;
+  }
+  postSend(sr, signaled);
+}
+
+void MultiplexedRDMA::LogicalConnection::atomic(size_t offset, const void *memAddr, enum ibv_wr_opcode verb,
+                                                uint64_t compareAdd, uint64_t swap, bool signaled) {
+  struct ibv_send_wr sr;
+  struct ibv_sge sge;
+  memset(&sge, 0, sizeof(sge));
+  sge.addr = (uintptr_t)memAddr;
+  sge.lkey = m_qp->lkey;
+  sge.length = sizeof(uint64_t);
+  memset(&sr, 0, sizeof(sr));
+  sr.sg_list = &sge;
+  sr.num_sge = 1;
+  sr.opcode = verb;
+  sr.wr.atomic.remote_addr = m_qp->remoteBuffer + offset;
+  sr.wr.atomic.rkey = m_qp->rkey;
+  sr.wr.atomic.compare_add = compareAdd;
+  sr.wr.atomic.swap = swap;
+  postSend(sr, signaled);
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::LogicalConnection::write(size_t offset, const void *memAddr, size_t size, bool signaled) {
+  remoteAccess(offset, memAddr, size, signaled, IBV_WR_RDMA_WRITE, nullptr);
+}
+
+void MultiplexedRDMA::LogicalConnection::writeImm(size_t offset, const void *memAddr, size_t size, uint32_t imm, bool signaled) {
+  remoteAccess(offset, memAddr, size, signaled, IBV_WR_RDMA_WRITE_WITH_IMM, &imm);
+}
+
+void MultiplexedRDMA::LogicalConnection::read(size_t offset, const void *memAddr, size_t size, bool signaled) {
+  remoteAccess(offset, memAddr, size, signaled, IBV_WR_RDMA_READ, nullptr);
+}
+
+void MultiplexedRDMA::LogicalConnection::fetchAndAdd(size_t offset, const void *memAddr, uint64_t value_to_add, bool signaled) {
+  atomic(offset, memAddr, IBV_WR_ATOMIC_FETCH_AND_ADD, value_to_add, 0, signaled);
+}
+
+void MultiplexedRDMA::LogicalConnection::compareAndSwap(size_t offset, const void *memAddr, int toCompare, int toSwap, bool signaled) {
+  atomic(offset, memAddr, IBV_WR_ATOMIC_CMP_AND_SWP, (uint64_t)toCompare, (uint64_t)toSwap, signaled);
+}
+
+void MultiplexedRDMA::LogicalConnection::send(const void *memAddr, size_t size, bool signaled) {
+  remoteAccess(0, memAddr, size, signaled, IBV_WR_SEND, nullptr);
+}
+
+void MultiplexedRDMA::LogicalConnection::sendImm(const void *memAddr, size_t size, uint32_t imm, bool signaled) {
+  remoteAccess(0, memAddr, size, signaled, IBV_WR_SEND_WITH_IMM, &imm);
+}
+
+//------------------------------------------------------------------------------------//
+
+void MultiplexedRDMA::LogicalConnection::receive(const void *memAddr, size_t size) {
+  struct ibv_sge sge;
+  struct ibv_recv_wr wr;
+
+  memset(&sge, 0, sizeof(sge));
+  sge.addr = (uintptr_t)memAddr;
+  sge.length = size;
+  sge.lkey = m_qp->lkey;
+
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = m_id;  // routes the completion back to this connection
+  wr.sg_list = &sge;
+  wr.num_sge = 1;
+
+  m_qp->postRecv(wr);
+}
+
+//------------------------------------------------------------------------------------//
+
+int MultiplexedRDMA::LogicalConnection::pollReceive(bool doPoll, uint32_t *imm) {
+  bool polled = false;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lck(m_qp->recvLock);
+      auto &completions = m_qp->recvCompletions[m_id];
+      if (!completions.empty()) {
+        recv_completion_t completion = completions.front();
+        completions.pop_front();
+        lck.unlock();
+        if (completion.status != IBV_WC_SUCCESS) {
+          throw runtime_error("RDMA completion event in CQ with error in pollReceive()! " +
+                              to_string(completion.status));
+        }
+        if (imm != nullptr) {
+          *imm = completion.imm;
+        }
+        return 1;
+      }
+    }
+    if (polled && !doPoll) {
+      return 0;
+    }
+    // routes completions of all logical connections of the QP
+    m_qp->pollRecvCQ();
+    polled = true;
+  }
+}
@@ -0,0 +1,193 @@
+/**
+ * @file MultiplexedRDMA.h
+ */
+
+#ifndef MultiplexedRDMA_H_
+#define MultiplexedRDMA_H_
+
+#include "../utils/Config.h"
+#include "ReliableRDMA.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rdma {
+
+/* Class: MultiplexedRDMA
+ * ----------------
+ * Reliable RDMA whose QPs can be shared by many logical connections
+ * (e.g. one per thread or module) instead of creating a QP per thread
+ * and peer. Logical connections of a peer are spread over a pool of
+ * QPs (the connection of the peer plus the QPs added by addToPool(),
+ * see RDMAClient::connectQPPool()), so the number of active QPs is
+ * bounded by the number of peers times the pool size, independent of
+ * the number of threads.
+ *
+ * Posts to a QP are serialized by a lock per QP. The caller decides
+ * which work requests are signaled like with ReliableRDMA; the QP only
+ * signals an additional one if half of its send queue is unsignaled.
+ * Completions of a QP arrive in posting order, so a signaled completion
+ * completes all earlier work requests of all logical connections of the
+ * QP. Whichever thread waits polls the shared CQ.
+ *
+ * Receives are routed to the logical connection which posted them.
+ * Incoming messages consume the receives of a QP in posting order, i.e.
+ * two-sided messages are only separated per logical connection if the
+ * peer uses one logical connection per QP for them.
+ *
+ * Once a logical connection is opened on a connection, the connection
+ * must only be used through logical connections.
+ */
+class MultiplexedRDMA : public ReliableRDMA {
+ protected:
+  struct mux_qp_t;
+
+ public:
+  /* Class: LogicalConnection
+   * ----------------
+   * Logical connection on a QP of a peer. Same operations as
+   * ReliableRDMA without the connection ID. A logical connection must
+   * only be used by one thread at a time, different logical connections
+   * of the same QP can be used concurrently. Owned by the MultiplexedRDMA
+   * which opened it.
+   */
+  class LogicalConnection {
+   public:
+    void write(size_t offset, const void *memAddr, size_t size, bool signaled);
+    void writeImm(size_t offset, const void *memAddr, size_t size, uint32_t imm, bool signaled);
+    void read(size_t offset, const void *memAddr, size_t size, bool signaled);
+    void fetchAndAdd(size_t offset, const void *memAddr, uint64_t value_to_add, bool signaled);
+    void compareAndSwap(size_t offset, const void *memAddr, int toCompare, int toSwap, bool signaled);
+
+    void send(const void *memAddr, size_t size, bool signaled);
+    void sendImm(const void *memAddr, size_t size, uint32_t imm, bool signaled);
+    void receive(const void *memAddr, size_t size);
+
+    /* Function: pollReceive
+     * ----------------
+     * Checks if one of the receives of this logical
+     * connection completed
+     *
+     * doPoll:  if true then function blocks until
+     *          data has arrived
+     * imm:     received immediate value (optional)
+     * return:  1 if a receive completed, otherwise 0
+     */
+    int pollReceive(bool doPoll = true, uint32_t *imm = nullptr);
+
+    /* Function: pollSend
+     * ----------------
+     * Checks if the last signaled operation of this logical connection
+     * completed, which completes all operations posted before it
+     *
+     * doPoll:  if true then function blocks until it completed
+     * return:  true if it completed
+     */
+    bool pollSend(bool doPoll = true);
+
+    // connection ID of the QP of the pool this logical connection uses
+    size_t getConnID();
+
+   private:
+    friend class MultiplexedRDMA;
+    LogicalConnection(mux_qp_t *qp, uint64_t id);
+
+    void remoteAccess(size_t offset, const void *memAddr, size_t size, bool signaled,
+                      enum ibv_wr_opcode verb, uint32_t *imm);
+    void atomic(size_t offset, const void *memAddr, enum ibv_wr_opcode verb,
+                uint64_t compareAdd, uint64_t swap, bool signaled);
+    void postSend(struct ibv_send_wr &sr, bool signaled);
+
+    mux_qp_t *m_qp;
+    uint64_t m_id;  // wr_id of its receives
+    uint64_t m_lastSignaled = 0;  // sequence number on the QP, only changed by the owner
+  };
+
+  MultiplexedRDMA(size_t mem_size = Config::RDMA_MEMSIZE);
+  MultiplexedRDMA(size_t mem_size, int mem_type, bool huge, int numaNode);
+  MultiplexedRDMA(BaseMemory *buffer);
+  ~MultiplexedRDMA();
+
+  /* Function: openLogicalConnection
+   * ----------------
+   * Creates a logical connection on the QP of the pool of a peer
+   * with the fewest logical connections. Thread safe.
+   *
+   * rdmaConnID:  id of the remote (e.g. node ID returned by connect)
+   * return:  logical connection, valid until it is closed or
+   *          this MultiplexedRDMA is destroyed
+   */
+  LogicalConnection *openLogicalConnection(const rdmaConnID rdmaConnID);
+
+  /* Function: closeLogicalConnection
+   * ----------------
+   * Destroys a logical connection. Completions of its outstanding
+   * receives are dropped. Thread safe.
+   */
+  void closeLogicalConnection(LogicalConnection *logicalConn);
+
+  /* Function: addToPool
+   * ----------------
+   * Adds an (already connected) QP to the same peer, e.g. one opened by
+   * RDMAClient::connectAdditionalQP(), to the pool of a connection.
+   * Thread safe.
+   *
+   * rdmaConnID:    id of the remote
+   * pooledConnID:  id of the additional QP
+   */
+  void addToPool(const rdmaConnID rdmaConnID, const size_t pooledConnID);
+
+  // number of QPs in the pool of a connection, at least the connection itself
+  size_t getPoolSize(const rdmaConnID rdmaConnID);
+
+ protected:
+  struct recv_completion_t {
+    ibv_wc_status status;
+    uint32_t imm;
+  };
+
+  // state of a QP which is shared by logical connections
+  struct mux_qp_t {
+    ib_qp_t qp;
+    size_t connID;
+    uint64_t remoteBuffer;
+    uint32_t rkey;
+    uint32_t lkey;
+    size_t logicalConns = 0;  // open ones, guarded by m_muxLock
+
+    // send work requests carry their sequence number shifted by one bit
+    // as wr_id, so the low bit never looks like BULK_WR_ID_TAG
+    std::mutex postLock;
+    uint64_t posted = 0;        // guarded by postLock
+    uint64_t lastSignaled = 0;  // guarded by postLock
+    std::atomic<uint64_t> completed{0};
+    std::atomic<int> sendStatus{IBV_WC_SUCCESS};  // first error, the QP is unusable afterwards
+    std::mutex sendPollLock;
+
+    // receive work requests carry the id of their logical connection as wr_id
+    std::mutex recvPollLock;
+    std::mutex recvLock;
+    std::unordered_map<uint64_t, std::deque<recv_completion_t>> recvCompletions;
+
+    uint64_t postSend(struct ibv_send_wr &sr, bool signaled);
+    void postRecv(struct ibv_recv_wr &wr);
+    void pollSendCQ();
+    void pollRecvCQ();
+  };
+
+  mux_qp_t *createMuxQP(const rdmaConnID rdmaConnID);
+  std::vector<std::unique_ptr<mux_qp_t>> &getPool(const rdmaConnID rdmaConnID);
+
+  std::mutex m_muxLock;
+  std::unordered_map<rdmaConnID, std::vector<std::unique_ptr<mux_qp_t>>> m_muxPools;  // by connection of the peer
+  std::unordered_map<uint64_t, std::unique_ptr<LogicalConnection>> m_logicalConns;
+  uint64_t m_nextLogicalID = 1;
+};
+
+}  // namespace rdma
+
+#endif /* MultiplexedRDMA_H_ */
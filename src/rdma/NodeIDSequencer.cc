@@ -9,6 +9,11 @@ NodeIDSequencer::NodeIDSequencer(std::string name) : NodeIDSequencer(name, Confi
 NodeIDSequencer::NodeIDSequencer(std::string name, int port) : NodeIDSequencer(name, port, "*"){}
 NodeIDSequencer::NodeIDSequencer(std::string name, int port, std::string addr) : ProtoServer(name, port, addr){
   // std::cout << "Starting NodeIDSequencer" << std::endl;
+  m_pPubSocket = new ProtoSocket(addr, getPublishPort(port), ZMQ_PUB);
+  if (!m_pPubSocket->bind())
+  {
+    Logging::error(__FILE__, __LINE__, "NodeIDSequencer could not bind publish port " + to_string(getPublishPort(port)));
+  }
   if (!ProtoServer::isRunning())
   {
     ProtoServer::startServer();
@@ -17,11 +22,32 @@ NodeIDSequencer::NodeIDSequencer(std::string name, int port, std::string addr) :
 
 NodeIDSequencer::~NodeIDSequencer()
 {
+  // handler thread publishes updates, stop it before closing the socket
+  ProtoServer::stopServer();
+  if (m_pPubSocket != nullptr)
+  {
+    delete m_pPubSocket;
+    m_pPubSocket = nullptr;
+  }
 }
 
 NodeID NodeIDSequencer::getNextNodeID()
 {
-  return m_nextNodeID++; //indexing entries vector relies on nodeIDs being incremented by 1!
+  return m_nextNodeID++;
+}
+
+void NodeIDSequencer::publishUpdate(MembershipUpdateKind::Enum kind, const NodeEntry_t &entry)
+{
+  ++m_version;
+  if (m_pPubSocket == nullptr || !m_pPubSocket->isOpen())
+  {
+    return;
+  }
+  Any update = ProtoMessageFactory::createMembershipUpdate(kind, m_version, entry.IP, entry.name, entry.nodeID, entry.nodeType);
+  if (!m_pPubSocket->send(&update))
+  {
+    Logging::warn("NodeIDSequencer could not publish membership update for NodeID: " + to_string(entry.nodeID));
+  }
 }
 
 void NodeIDSequencer::handle(Any *anyReq, Any *anyResp)
@@ -36,13 +62,14 @@ void NodeIDSequencer::handle(Any *anyReq, Any *anyResp)
     NodeType::Enum nodeType = (NodeType::Enum)connReq.node_type_enum();
     NodeID newNodeID = getNextNodeID();
 
-    NodeEntry_t entry{IP, name, newNodeID, nodeType};
-    m_entries.emplace_back(entry);
+    NodeEntry_t entry{IP, name, newNodeID, nodeType, true};
+    m_entries.emplace(newNodeID, entry);
 
     if (nodeType == NodeType::Enum::SERVER)
     {
       m_ipPortToNodeIDMapping[IP] = newNodeID;
     }
+    publishUpdate(MembershipUpdateKind::NODE_JOINED, entry);
 
     std::ostringstream log;
     log << "Registered new NodeID: " << newNodeID << "(type: " << nodeType << ", IP: " << IP << ", name: \"" << name << "\")";
@@ -53,26 +80,75 @@ void NodeIDSequencer::handle(Any *anyReq, Any *anyResp)
 
     anyResp->PackFrom(connResp);
   }
+  else if (anyReq->Is<ConnIDReserveRequest>())
+  {
+    NodeIDResponse connResp;
+    ConnIDReserveRequest reserveReq;
+    anyReq->UnpackTo(&reserveReq);
+
+    // reserved ids are only skipped, they are neither listed, mapped nor published
+    NodeID firstID = m_nextNodeID;
+    m_nextNodeID += reserveReq.count();
+    Logging::debug(__FILE__, __LINE__, "Reserved " + to_string(reserveReq.count()) + " connection ids from: " + to_string(firstID));
+
+    connResp.set_nodeid(firstID);
+    connResp.set_return_(MessageErrors::NO_ERROR);
+    anyResp->PackFrom(connResp);
+  }
   else if (anyReq->Is<GetAllNodeIDsRequest>())
   {
     GetAllNodeIDsResponse connResp;
     GetAllNodeIDsRequest connReq;
     anyReq->UnpackTo(&connReq);
 
-    std::cout << "NodeIDSequencer.GetAllNodeIDsRequest()" << std::endl; // TODO REMOVE
-
-    for (auto &entry : m_entries)
+    for (auto &idAndEntry : m_entries)
     {
+      NodeEntry_t &entry = idAndEntry.second;
+      if (!entry.active)
+      {
+        continue;
+      }
       auto nodeidEntry = connResp.add_nodeid_entries();
       nodeidEntry->set_name(entry.name);
       nodeidEntry->set_ip(entry.IP);
       nodeidEntry->set_node_id(entry.nodeID);
       nodeidEntry->set_node_type_enum(entry.nodeType);
     }
+    connResp.set_version(m_version);
     connResp.set_return_(MessageErrors::NO_ERROR);
 
     anyResp->PackFrom(connResp);
   }
+  else if (anyReq->Is<NodeIDReleaseRequest>())
+  {
+    ErrorMessage errorResp;
+    NodeIDReleaseRequest releaseReq;
+    anyReq->UnpackTo(&releaseReq);
+    NodeID nodeID = releaseReq.node_id();
+
+    auto it = m_entries.find(nodeID);
+    if (it != m_entries.end() && it->second.active)
+    {
+      NodeEntry_t &entry = it->second;
+      entry.active = false;
+
+      // a newer node might have registered with the same ip:port already
+      auto mapping = m_ipPortToNodeIDMapping.find(entry.IP);
+      if (mapping != m_ipPortToNodeIDMapping.end() && mapping->second == nodeID)
+      {
+        m_ipPortToNodeIDMapping.erase(mapping);
+      }
+      publishUpdate(MembershipUpdateKind::NODE_LEFT, entry);
+
+      Logging::debug(__FILE__, __LINE__, "Released NodeID: " + to_string(nodeID));
+      errorResp.set_return_(MessageErrors::NO_ERROR);
+    }
+    else
+    {
+      errorResp.set_return_(MessageErrors::NODEID_NOT_FOUND);
+    }
+    anyResp->PackFrom(errorResp);
+  }
   else if (anyReq->Is<GetNodeIDForIpPortRequest>())
   {
     GetNodeIDForIpPortResponse connResp;
@@ -85,7 +161,7 @@ void NodeIDSequencer::handle(Any *anyReq, Any *anyResp)
     if (m_ipPortToNodeIDMapping.find(ipPort) != m_ipPortToNodeIDMapping.end())
     {
       NodeID nodeId = m_ipPortToNodeIDMapping[ipPort];
-      auto entry = m_entries[nodeId];
+      auto entry = m_entries.at(nodeId);
       connResp.set_ip(entry.IP);
       connResp.set_name(entry.name);
       connResp.set_node_id(entry.nodeID);
@@ -5,6 +5,8 @@
 #include "../proto/ProtoServer.h"
 #include "../utils/Config.h"
 
+#include <map>
+
 namespace rdma {
 
 namespace NodeType{
@@ -15,6 +17,9 @@ enum Enum : int
 };
 };
 
+// Besides node ids the sequencer hands out connection ids (ConnIDReserveRequest)
+// from the same range, e.g. for additional QPs between two nodes. They are not
+// nodes, so they get no entry and are never listed, mapped to an ip:port or published.
 class NodeIDSequencer : public ProtoServer
 {
 private:
@@ -24,15 +29,26 @@ private:
         std::string name;
         NodeID nodeID;
         NodeType::Enum nodeType;
+        bool active;
     };
 
 protected:
-    std::vector<NodeEntry_t> m_entries; //Indexed with nodeID
+    std::map<NodeID, NodeEntry_t> m_entries; // ids of reserved connection ids are skipped
     std::unordered_map<std::string, NodeID> m_ipPortToNodeIDMapping;
     NodeID m_nextNodeID = 0;
+    ProtoSocket* m_pPubSocket = nullptr; // publishes membership updates
+    uint64_t m_version = 0; // incremented with every membership change
     void handle(Any *anyReq, Any *anyResp) override;
     NodeID getNextNodeID();
+    void publishUpdate(MembershipUpdateKind::Enum kind, const NodeEntry_t &entry);
 public:
+    /* Function: getPublishPort
+     * ----------------
+     * Membership updates are published on the port
+     * following the request port of the sequencer
+     */
+    static int getPublishPort(int port) { return port + 1; }
+
     NodeIDSequencer();
     NodeIDSequencer(int port);
     NodeIDSequencer(int port, std::string addr);
@@ -0,0 +1,175 @@
+#include "NodeMembership.h"
+#include "../utils/Network.h"
+
+#include <algorithm>
+
+using namespace rdma;
+
+NodeMembership::NodeMembership(std::string sequencerIpPort) : m_sequencerIpPort(sequencerIpPort) {}
+
+NodeMembership::~NodeMembership() {
+  stop();
+  join();
+  if (m_pSubSocket != nullptr) {
+    delete m_pSubSocket;
+    m_pSubSocket = nullptr;
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+bool NodeMembership::subscribe() {
+  if (m_pSubSocket != nullptr) {
+    return m_pSubSocket->isOpen();
+  }
+
+  std::string ip = Network::getAddressOfConnection(m_sequencerIpPort);
+  int port = Network::getPortOfConnection(m_sequencerIpPort);
+  m_pSubSocket = new ProtoSocket(ip, NodeIDSequencer::getPublishPort(port), ZMQ_SUB);
+  if (!m_pSubSocket->connect()) {
+    Logging::error(__FILE__, __LINE__, "NodeMembership could not subscribe to sequencer: " + m_sequencerIpPort);
+    return false;
+  }
+  start();
+  return true;
+}
+
+//------------------------------------------------------------------------------------//
+
+void NodeMembership::run() {
+  Any rcvAny;
+  MembershipUpdate update;
+  while (!killed()) {
+    if (!m_pSubSocket->poll(Config::PROTO_POLL_INTERVAL)) {
+      continue;
+    }
+    if (!m_pSubSocket->receive(&rcvAny)) {
+      break;
+    }
+    if (!rcvAny.Is<MembershipUpdate>()) {
+      Logging::warn("NodeMembership received unknown message");
+      continue;
+    }
+    rcvAny.UnpackTo(&update);
+
+    unique_lock<mutex> lck(m_lock);
+    if (!m_synced) {
+      m_pendingUpdates.push_back(update);
+    } else {
+      applyUpdate(update);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void NodeMembership::applyUpdate(const MembershipUpdate &update) {
+  // expects m_lock to be held
+  if (update.version() <= m_version) {
+    return;  // already contained in the snapshot
+  }
+  if (update.version() != m_version + 1) {
+    // an update got lost (e.g. before the subscription was established)
+    Logging::debug(__FILE__, __LINE__, "NodeMembership detected gap at version " + to_string(m_version) + ", resync needed");
+    m_synced = false;
+    m_pendingUpdates.push_back(update);
+    m_changed.notify_all();
+    return;
+  }
+
+  NodeID nodeID = update.node_id();
+  if (update.kind() == MembershipUpdateKind::NODE_JOINED) {
+    MemberEntry_t entry{update.ip(), update.name(), nodeID, (NodeType::Enum)update.node_type_enum()};
+    m_members[nodeID] = entry;
+    if (entry.nodeType == NodeType::Enum::SERVER) {
+      m_serverIpPortToNodeID[entry.ipPort] = nodeID;
+    }
+  } else {
+    m_members.erase(nodeID);
+    auto mapping = m_serverIpPortToNodeID.find(update.ip());
+    if (mapping != m_serverIpPortToNodeID.end() && mapping->second == nodeID) {
+      m_serverIpPortToNodeID.erase(mapping);
+    }
+  }
+  m_version = update.version();
+  m_changed.notify_all();
+}
+
+//------------------------------------------------------------------------------------//
+
+void NodeMembership::applySnapshot(const GetAllNodeIDsResponse &snapshot) {
+  unique_lock<mutex> lck(m_lock);
+  m_members.clear();
+  m_serverIpPortToNodeID.clear();
+  for (auto &nodeEntry : snapshot.nodeid_entries()) {
+    MemberEntry_t entry{nodeEntry.ip(), nodeEntry.name(), nodeEntry.node_id(), (NodeType::Enum)nodeEntry.node_type_enum()};
+    m_members[entry.nodeID] = entry;
+    if (entry.nodeType == NodeType::Enum::SERVER) {
+      m_serverIpPortToNodeID[entry.ipPort] = entry.nodeID;
+    }
+  }
+  m_version = snapshot.version();
+  m_synced = true;
+
+  // apply updates which were published after the snapshot was taken
+  std::vector<MembershipUpdate> pending;
+  pending.swap(m_pendingUpdates);
+  std::sort(pending.begin(), pending.end(), [](const MembershipUpdate &a, const MembershipUpdate &b) {
+    return a.version() < b.version();
+  });
+  for (auto &update : pending) {
+    if (!m_synced) {
+      m_pendingUpdates.push_back(update);
+    } else {
+      applyUpdate(update);
+    }
+  }
+  m_changed.notify_all();
+}
+
+//------------------------------------------------------------------------------------//
+
+bool NodeMembership::needsSync() {
+  unique_lock<mutex> lck(m_lock);
+  return !m_synced;
+}
+
+bool NodeMembership::lookupServer(const std::string &ipPort, NodeID &retNodeID) {
+  unique_lock<mutex> lck(m_lock);
+  auto mapping = m_serverIpPortToNodeID.find(ipPort);
+  if (mapping == m_serverIpPortToNodeID.end()) {
+    return false;
+  }
+  retNodeID = mapping->second;
+  return true;
+}
+
+bool NodeMembership::lookup(NodeID nodeID, MemberEntry_t &retEntry) {
+  unique_lock<mutex> lck(m_lock);
+  auto member = m_members.find(nodeID);
+  if (member == m_members.end()) {
+    return false;
+  }
+  retEntry = member->second;
+  return true;
+}
+
+std::vector<NodeMembership::MemberEntry_t> NodeMembership::getMembers() {
+  unique_lock<mutex> lck(m_lock);
+  std::vector<MemberEntry_t> members;
+  members.reserve(m_members.size());
+  for (auto &member : m_members) {
+    members.push_back(member.second);
+  }
+  return members;
+}
+
+bool NodeMembership::waitForChange(uint64_t version, std::chrono::steady_clock::time_point deadline) {
+  unique_lock<mutex> lck(m_lock);
+  return m_changed.wait_until(lck, deadline, [&] { return m_version != version || !m_synced; });
+}
+
+uint64_t NodeMembership::getVersion() {
+  unique_lock<mutex> lck(m_lock);
+  return m_version;
+}
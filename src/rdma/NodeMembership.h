@@ -0,0 +1,119 @@
+/**
+ * @file NodeMembership.h
+ */
+
+#ifndef NodeMembership_H_
+#define NodeMembership_H_
+
+#include "../message/ProtoMessageFactory.h"
+#include "../proto/ProtoSocket.h"
+#include "../thread/Thread.h"
+#include "../utils/Config.h"
+#include "NodeIDSequencer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rdma {
+
+/* Class: NodeMembership
+ * ----------------
+ * Local membership table of a node. Subscribes to the membership
+ * updates published by the NodeIDSequencer and applies them
+ * incrementally, so that node IDs of servers can be looked up
+ * locally instead of polling the sequencer.
+ *
+ * The table is initialized (and repaired if an update got lost)
+ * with a snapshot (GetAllNodeIDsResponse) which has to be fetched
+ * by the owner, since the request socket to the sequencer is not
+ * owned by the membership thread.
+ */
+class NodeMembership : private Thread {
+ public:
+  struct MemberEntry_t {
+    std::string ipPort;
+    std::string name;
+    NodeID nodeID;
+    NodeType::Enum nodeType;
+  };
+
+  NodeMembership(std::string sequencerIpPort);
+  ~NodeMembership();
+
+  /* Function: subscribe
+   * ----------------
+   * Connects to the publish socket of the sequencer
+   * and starts receiving updates in the background
+   *
+   * return:  true if the subscription was established
+   */
+  bool subscribe();
+
+  /* Function: applySnapshot
+   * ----------------
+   * Replaces the table with the snapshot of the sequencer.
+   * Updates which were received before but are newer than
+   * the snapshot are applied on top of it.
+   */
+  void applySnapshot(const GetAllNodeIDsResponse &snapshot);
+
+  /* Function: needsSync
+   * ----------------
+   * True if no snapshot was applied yet or an update
+   * got lost (gap in the versions)
+   */
+  bool needsSync();
+
+  /* Function: lookupServer
+   * ----------------
+   * Looks up the node ID of the server registered for ipPort
+   *
+   * return:  true if the server is currently a member
+   */
+  bool lookupServer(const std::string &ipPort, NodeID &retNodeID);
+
+  bool lookup(NodeID nodeID, MemberEntry_t &retEntry);
+
+  std::vector<MemberEntry_t> getMembers();
+
+  /* Function: waitForChange
+   * ----------------
+   * Blocks until the table changed since version or
+   * a sync is needed
+   *
+   * version:   last version seen by the caller
+   * deadline:  time point to give up waiting
+   * return:  false if the deadline was reached
+   */
+  bool waitForChange(uint64_t version, std::chrono::steady_clock::time_point deadline);
+
+  uint64_t getVersion();
+
+  void run() override;
+
+ private:
+  void applyUpdate(const MembershipUpdate &update);
+
+  std::string m_sequencerIpPort;
+  ProtoSocket *m_pSubSocket = nullptr;
+
+  std::mutex m_lock;
+  std::condition_variable m_changed;
+  uint64_t m_version = 0;
+  bool m_synced = false;
+  std::unordered_map<NodeID, MemberEntry_t> m_members;
+  std::unordered_map<std::string, NodeID> m_serverIpPortToNodeID;
+  std::vector<MembershipUpdate> m_pendingUpdates; // received before the first snapshot
+
+  using Thread::join;
+  using Thread::killed;
+  using Thread::start;
+  using Thread::stop;
+};
+
+}  // namespace rdma
+
+#endif /* NodeMembership_H_ */
@@ -0,0 +1,259 @@
+#include "RDMACMClient.h"
+#include "../utils/Network.h"
+
+#ifndef HUGEPAGE
+#define HUGEPAGE false
+#endif
+
+using namespace rdma;
+
+//------------------------------------------------------------------------------------//
+
+RDMACMClient::RDMACMClient(size_t mem_size) : RDMACMClient(mem_size, (int)MEMORY_TYPE::MAIN, HUGEPAGE, (int)Config::RDMA_NUMAREGION) {}
+RDMACMClient::RDMACMClient(size_t mem_size, int mem_type, bool huge, int numaNode) : ReliableRDMA(mem_size, mem_type, huge, numaNode) {}
+RDMACMClient::RDMACMClient(BaseMemory *buffer) : ReliableRDMA(buffer) {}
+
+//------------------------------------------------------------------------------------//
+
+RDMACMClient::~RDMACMClient() { closeConnections(); }
+
+//------------------------------------------------------------------------------------//
+
+bool RDMACMClient::connect(const string &ipPort, NodeID &retConnID) {
+  struct rdma_event_channel *channel = rdma_create_event_channel();
+  if (channel == nullptr) {
+    throw runtime_error("RDMACMClient: rdma_create_event_channel failed! errno: " + to_string(errno));
+  }
+  struct rdma_cm_id *id = nullptr;
+  if (rdma_create_id(channel, &id, nullptr, RDMA_PS_TCP) != 0) {
+    rdma_destroy_event_channel(channel);
+    throw runtime_error("RDMACMClient: rdma_create_id failed! errno: " + to_string(errno));
+  }
+
+  struct ib_qp_t qp;
+  struct rdma_cm_event *event = nullptr;
+  try {
+    // resolve address and route (selects device, port and GID)
+    std::string ip = Network::getAddressOfConnection(ipPort);
+    std::string port = to_string(Network::getPortOfConnection(ipPort));
+    struct rdma_addrinfo hints;
+    struct rdma_addrinfo *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_port_space = RDMA_PS_TCP;
+    if (rdma_getaddrinfo(ip.c_str(), port.c_str(), &hints, &res) != 0) {
+      throw runtime_error("rdma_getaddrinfo failed for " + ipPort);
+    }
+    int status = rdma_resolve_addr(id, nullptr, res->ai_dst_addr, Config::RDMA_CM_TIMEOUT);
+    rdma_freeaddrinfo(res);
+    if (status != 0) {
+      throw runtime_error("rdma_resolve_addr failed for " + ipPort);
+    }
+    getCmEvent(channel, RDMA_CM_EVENT_ADDR_RESOLVED, &event);
+    rdma_ack_cm_event(event);
+
+    if (rdma_resolve_route(id, Config::RDMA_CM_TIMEOUT) != 0) {
+      throw runtime_error("rdma_resolve_route failed for " + ipPort);
+    }
+    getCmEvent(channel, RDMA_CM_EVENT_ROUTE_RESOLVED, &event);
+    rdma_ack_cm_event(event);
+
+    // create QP and send connect request with buffer and rkey
+    initQPForCM(id, qp);
+    cm_conn_data_t localData = getLocalConnData();
+    struct rdma_conn_param connParam = createConnParam(qp, localData);
+    if (rdma_connect(id, &connParam) != 0) {
+      throw runtime_error("rdma_connect failed for " + ipPort);
+    }
+
+    // QP is not owned by rdma_cm, it reports a response instead of established
+    getCmEvent(channel, RDMA_CM_EVENT_CONNECT_RESPONSE, &event);
+    cm_conn_data_t remoteData;
+    if (event->param.conn.private_data == nullptr || event->param.conn.private_data_len < sizeof(remoteData)) {
+      rdma_ack_cm_event(event);
+      throw runtime_error("RDMACMServer did not send connection data");
+    }
+    memcpy(&remoteData, event->param.conn.private_data, sizeof(remoteData));
+    rdma_ack_cm_event(event);
+
+    modifyQPWithCM(id, qp.qp, IBV_QPS_RTR);
+    modifyQPWithCM(id, qp.qp, IBV_QPS_RTS);
+    if (rdma_establish(id) != 0) {
+      throw runtime_error("rdma_establish failed for " + ipPort);
+    }
+
+    retConnID = addConnection(id, channel, qp, remoteData);
+  } catch (runtime_error &e) {
+    Logging::error(__FILE__, __LINE__, std::string("RDMACMClient: could not connect: ") + e.what());
+    if (qp.qp != nullptr) {
+      ibv_destroy_qp(qp.qp);
+      destroyCQ(qp.send_cq, qp.recv_cq);
+    }
+    rdma_destroy_id(id);
+    rdma_destroy_event_channel(channel);
+    return false;
+  }
+
+  Logging::debug(__FILE__, __LINE__, "RDMACMClient: connected to " + ipPort);
+  return true;
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMClient::disconnect(const NodeID connID) {
+  {
+    std::unique_lock<std::mutex> lck(m_cmLock);
+    auto conn = m_cmConns.find(connID);
+    if (conn == m_cmConns.end()) {
+      return;
+    }
+    rdma_disconnect(conn->second.id);
+  }
+  destroyConnection(connID);
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMClient::getCmEvent(struct rdma_event_channel *channel,
+                              enum rdma_cm_event_type type,
+                              struct rdma_cm_event **out_ev) {
+  struct rdma_cm_event *event = nullptr;
+  if (rdma_get_cm_event(channel, &event) != 0) {
+    throw runtime_error("rdma_get_cm_event failed!");
+  }
+  if (event->event != type) {
+    std::string msg = std::string("rdma_get_cm_event returned ") + rdma_event_str(event->event) +
+                      " (status " + to_string(event->status) + "), expected: " + rdma_event_str(type);
+    rdma_ack_cm_event(event);
+    throw runtime_error(msg);
+  }
+  *out_ev = event;
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMClient::initQPForCM(struct rdma_cm_id *id, struct ib_qp_t &qp) {
+  // the QP lives in the protection domain of the buffer, which therefore
+  // has to be on the device rdma_cm resolved the address to
+  if (ibv_get_device_guid(id->verbs->device) != ibv_get_device_guid(m_buffer->ib_context()->device)) {
+    throw runtime_error(std::string("rdma_cm resolved to device ") + ibv_get_device_name(id->verbs->device) +
+                        " which is not the device of the RDMA buffer");
+  }
+
+  createCQ(qp.send_cq, qp.recv_cq);
+  createQP(&qp);
+  modifyQPWithCM(id, qp.qp, IBV_QPS_INIT);
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMClient::modifyQPWithCM(struct rdma_cm_id *id, struct ibv_qp *qp, enum ibv_qp_state state) {
+  struct ibv_qp_attr attr;
+  int flags;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = state;
+  if (rdma_init_qp_attr(id, &attr, &flags) != 0) {
+    throw runtime_error("rdma_init_qp_attr failed for state " + to_string(state));
+  }
+  if (state == IBV_QPS_INIT) {
+    // rdma_cm does not enable atomics
+    attr.qp_access_flags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ |
+                           IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_REMOTE_ATOMIC;
+  }
+  if ((errno = ibv_modify_qp(qp, &attr, flags)) != 0) {
+    throw runtime_error("Failed to modify QP to state " + to_string(state) + " with rdma_cm attributes");
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+struct rdma_conn_param RDMACMClient::createConnParam(struct ib_qp_t &qp, cm_conn_data_t &localData) {
+  struct ibv_device_attr device_attr;
+  if (ibv_query_device(m_buffer->ib_context(), &device_attr)) {
+    throw runtime_error("Error, ibv_query_device() failed");
+  }
+
+  struct rdma_conn_param connParam;
+  memset(&connParam, 0, sizeof(connParam));
+  connParam.private_data = &localData;
+  connParam.private_data_len = sizeof(localData);
+  connParam.responder_resources = std::min(device_attr.max_qp_rd_atom, 16);
+  connParam.initiator_depth = std::min(device_attr.max_qp_init_rd_atom, 16);
+  connParam.retry_count = 6;
+  connParam.rnr_retry_count = Config::RDMA_RNR_RETRY;
+  connParam.qp_num = qp.qp->qp_num;
+  return connParam;
+}
+
+//------------------------------------------------------------------------------------//
+
+RDMACMClient::cm_conn_data_t RDMACMClient::getLocalConnData() {
+  cm_conn_data_t localData;
+  localData.buffer = (uint64_t)m_buffer->pointer();
+  localData.rkey = m_buffer->ib_mr()->rkey;
+  return localData;
+}
+
+//------------------------------------------------------------------------------------//
+
+NodeID RDMACMClient::addConnection(struct rdma_cm_id *id, struct rdma_event_channel *channel,
+                                   struct ib_qp_t &qp, const cm_conn_data_t &remoteData) {
+  struct ib_conn_t localConn = ib_conn_t();
+  localConn.buffer = (uint64_t)m_buffer->pointer();
+  localConn.rc.rkey = m_buffer->ib_mr()->rkey;
+  localConn.qp_num = qp.qp->qp_num;
+  localConn.lid = m_buffer->ib_port_attributes().lid;
+  getLocalGid(localConn.gid);
+
+  struct ib_conn_t remoteConn = ib_conn_t();
+  remoteConn.buffer = remoteData.buffer;
+  remoteConn.rc.rkey = remoteData.rkey;
+
+  NodeID connID;
+  {
+    std::unique_lock<std::mutex> lck(m_qpLock);
+    connID = nextConnKey();
+    setQP(connID, qp);
+    setLocalConnData(connID, localConn);
+    setRemoteConnData(connID, remoteConn);
+    m_connected[connID] = true;
+  }
+  std::unique_lock<std::mutex> lck(m_cmLock);
+  m_cmConns[connID] = cm_conn_t{id, channel};
+  return connID;
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMClient::destroyConnection(const NodeID connID) {
+  cm_conn_t conn;
+  {
+    std::unique_lock<std::mutex> lck(m_cmLock);
+    auto entry = m_cmConns.find(connID);
+    if (entry == m_cmConns.end()) {
+      return;
+    }
+    conn = entry->second;
+    m_cmConns.erase(entry);
+  }
+  disconnectQP(connID);
+  rdma_destroy_id(conn.id);
+  if (conn.channel != nullptr) {
+    rdma_destroy_event_channel(conn.channel);
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMClient::closeConnections() {
+  std::vector<NodeID> connIDs;
+  {
+    std::unique_lock<std::mutex> lck(m_cmLock);
+    for (auto &conn : m_cmConns) {
+      rdma_disconnect(conn.second.id);
+      connIDs.push_back(conn.first);
+    }
+  }
+  for (NodeID connID : connIDs) {
+    destroyConnection(connID);
+  }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file RDMACMClient.h
+ */
+
+#ifndef RDMACMClient_H_
+#define RDMACMClient_H_
+
+#include "../utils/Config.h"
+#include "ReliableRDMA.h"
+
+#include <rdma/rdma_cma.h>
+#include <map>
+
+namespace rdma {
+
+/* Class: RDMACMClient
+ * ----------------
+ * Reliable RDMA whose connections are established with the RDMA
+ * connection manager (rdma_cm) instead of the NodeIDSequencer and
+ * protobuf messages. rdma_cm resolves address and route (including
+ * the GID for RoCE) and the buffer address and rkey are exchanged as
+ * private data of the connect request and response.
+ *
+ * The QPs are created on the protection domain of the RDMA buffer and
+ * transitioned with the attributes given by rdma_init_qp_attr(). The
+ * connection ID returned by connect() can be used with all operations
+ * of ReliableRDMA.
+ */
+class RDMACMClient : public ReliableRDMA {
+ public:
+  RDMACMClient(size_t mem_size = Config::RDMA_MEMSIZE);
+  RDMACMClient(size_t mem_size, int mem_type, bool huge, int numaNode);
+  RDMACMClient(BaseMemory *buffer);
+  ~RDMACMClient();
+
+  /* Function: connect
+   * ----------------
+   * Connects to a RDMACMServer. Each call uses its own event
+   * channel, so multiple threads can connect in parallel.
+   *
+   * ipPort:     ip:port of the server (IPoIB or RoCE interface)
+   * retConnID:  id of the new connection
+   * return:  true if the connection was established
+   */
+  bool connect(const string &ipPort, NodeID &retConnID);
+
+  /* Function: disconnect
+   * ----------------
+   * Disconnects and destroys the connection and its QP
+   */
+  void disconnect(const NodeID connID);
+
+ protected:
+  // exchanged as private data of connect request / accept
+  struct cm_conn_data_t {
+    uint64_t buffer;
+    uint32_t rkey;
+  } __attribute__((packed));
+
+  struct cm_conn_t {
+    struct rdma_cm_id *id;
+    struct rdma_event_channel *channel;  // only set if owned by the connection
+  };
+
+  void getCmEvent(struct rdma_event_channel *channel,
+                  enum rdma_cm_event_type type, struct rdma_cm_event **out_ev);
+
+  void initQPForCM(struct rdma_cm_id *id, struct ib_qp_t &qp);
+  void modifyQPWithCM(struct rdma_cm_id *id, struct ibv_qp *qp, enum ibv_qp_state state);
+  struct rdma_conn_param createConnParam(struct ib_qp_t &qp, cm_conn_data_t &localData);
+  cm_conn_data_t getLocalConnData();
+
+  /* Function: addConnection
+   * ----------------
+   * Registers QP and connection data of a new connection
+   *
+   * return:  connection id
+   */
+  NodeID addConnection(struct rdma_cm_id *id, struct rdma_event_channel *channel,
+                       struct ib_qp_t &qp, const cm_conn_data_t &remoteData);
+
+  void destroyConnection(const NodeID connID);
+  void closeConnections();
+
+  std::mutex m_cmLock;
+  std::map<NodeID, cm_conn_t> m_cmConns;
+};
+
+}  // namespace rdma
+
+#endif /* RDMACMClient_H_ */
@@ -0,0 +1,178 @@
+#include "RDMACMServer.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+
+#ifndef HUGEPAGE
+#define HUGEPAGE false
+#endif
+
+using namespace rdma;
+
+//------------------------------------------------------------------------------------//
+
+RDMACMServer::RDMACMServer(int port, size_t mem_size) : RDMACMServer("*", port, mem_size) {}
+RDMACMServer::RDMACMServer(std::string ip, int port, size_t mem_size) : RDMACMServer(ip, port, mem_size, (int)MEMORY_TYPE::MAIN, HUGEPAGE, (int)Config::RDMA_NUMAREGION) {}
+RDMACMServer::RDMACMServer(std::string ip, int port, size_t mem_size, int mem_type, bool huge, int numaNode)
+    : RDMACMClient(mem_size, mem_type, huge, numaNode), m_ip(ip), m_port(port) {}
+
+//------------------------------------------------------------------------------------//
+
+RDMACMServer::~RDMACMServer() {
+  stopServer();
+  // accepted connections use the listen channel, destroy them first
+  closeConnections();
+  if (m_listenID != nullptr) {
+    rdma_destroy_id(m_listenID);
+    m_listenID = nullptr;
+  }
+  if (m_listenChannel != nullptr) {
+    rdma_destroy_event_channel(m_listenChannel);
+    m_listenChannel = nullptr;
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+bool RDMACMServer::startServer() {
+  if (m_running) {
+    return true;
+  }
+
+  m_listenChannel = rdma_create_event_channel();
+  if (m_listenChannel == nullptr) {
+    Logging::error(__FILE__, __LINE__, "RDMACMServer: rdma_create_event_channel failed");
+    return false;
+  }
+  if (rdma_create_id(m_listenChannel, &m_listenID, nullptr, RDMA_PS_TCP) != 0) {
+    Logging::error(__FILE__, __LINE__, "RDMACMServer: rdma_create_id failed");
+    return false;
+  }
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(m_port);
+  if (m_ip == "*") {
+    addr.sin_addr.s_addr = INADDR_ANY;
+  } else if (inet_pton(AF_INET, m_ip.c_str(), &addr.sin_addr) != 1) {
+    Logging::error(__FILE__, __LINE__, "RDMACMServer: invalid ip " + m_ip);
+    return false;
+  }
+  if (rdma_bind_addr(m_listenID, (struct sockaddr *)&addr) != 0) {
+    Logging::error(__FILE__, __LINE__, "RDMACMServer: could not bind " + m_ip + ":" + to_string(m_port));
+    return false;
+  }
+  if (rdma_listen(m_listenID, Config::RDMA_MAX_WR) != 0) {
+    Logging::error(__FILE__, __LINE__, "RDMACMServer: rdma_listen failed");
+    return false;
+  }
+
+  m_running = true;
+  start();
+  Logging::debug(__FILE__, __LINE__, "RDMACMServer: listening on " + m_ip + ":" + to_string(m_port));
+  return true;
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMServer::stopServer() {
+  if (m_running) {
+    stop();
+    join();
+    m_running = false;
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMServer::run() {
+  struct pollfd pfd;
+  pfd.fd = m_listenChannel->fd;
+  pfd.events = POLLIN;
+
+  while (!killed()) {
+    // wake up periodically to check if server has been stopped
+    pfd.revents = 0;
+    if (::poll(&pfd, 1, Config::RDMA_CM_POLL_INTERVAL) <= 0) {
+      continue;
+    }
+
+    struct rdma_cm_event *event = nullptr;
+    if (rdma_get_cm_event(m_listenChannel, &event) != 0) {
+      Logging::error(__FILE__, __LINE__, "RDMACMServer: rdma_get_cm_event failed");
+      break;
+    }
+
+    switch (event->event) {
+      case RDMA_CM_EVENT_CONNECT_REQUEST:
+        handleConnectRequest(event);  // acks event
+        break;
+      case RDMA_CM_EVENT_ESTABLISHED:
+        rdma_ack_cm_event(event);
+        Logging::debug(__FILE__, __LINE__, "RDMACMServer: connection established");
+        break;
+      case RDMA_CM_EVENT_DISCONNECTED: {
+        struct rdma_cm_id *id = event->id;
+        rdma_ack_cm_event(event);
+        auto entry = m_cmIDToConnID.find(id);
+        if (entry != m_cmIDToConnID.end()) {
+          NodeID connID = entry->second;
+          m_cmIDToConnID.erase(entry);
+          destroyConnection(connID);
+        }
+        break;
+      }
+      default:
+        Logging::debug(__FILE__, __LINE__, std::string("RDMACMServer: ignoring event ") + rdma_event_str(event->event));
+        rdma_ack_cm_event(event);
+        break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void RDMACMServer::handleConnectRequest(struct rdma_cm_event *event) {
+  struct rdma_cm_id *id = event->id;
+  cm_conn_data_t remoteData;
+  bool hasData = event->param.conn.private_data != nullptr &&
+                 event->param.conn.private_data_len >= sizeof(remoteData);
+  if (hasData) {
+    memcpy(&remoteData, event->param.conn.private_data, sizeof(remoteData));
+  }
+  rdma_ack_cm_event(event);
+
+  if (!hasData) {
+    Logging::warn("RDMACMServer: rejecting connect request without connection data");
+    rdma_reject(id, nullptr, 0);
+    rdma_destroy_id(id);
+    return;
+  }
+
+  struct ib_qp_t qp;
+  try {
+    // QP has to be ready to receive before the client gets the response
+    initQPForCM(id, qp);
+    modifyQPWithCM(id, qp.qp, IBV_QPS_RTR);
+    modifyQPWithCM(id, qp.qp, IBV_QPS_RTS);
+
+    cm_conn_data_t localData = getLocalConnData();
+    struct rdma_conn_param connParam = createConnParam(qp, localData);
+    if (rdma_accept(id, &connParam) != 0) {
+      throw runtime_error("rdma_accept failed! errno: " + to_string(errno));
+    }
+  } catch (runtime_error &e) {
+    Logging::error(__FILE__, __LINE__, std::string("RDMACMServer: could not accept connection: ") + e.what());
+    if (qp.qp != nullptr) {
+      ibv_destroy_qp(qp.qp);
+      destroyCQ(qp.send_cq, qp.recv_cq);
+    }
+    rdma_reject(id, nullptr, 0);
+    rdma_destroy_id(id);
+    return;
+  }
+
+  // connection uses the listen channel
+  m_cmIDToConnID[id] = addConnection(id, nullptr, qp, remoteData);
+}
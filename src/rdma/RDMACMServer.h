@@ -0,0 +1,62 @@
+/**
+ * @file RDMACMServer.h
+ */
+
+#ifndef RDMACMServer_H_
+#define RDMACMServer_H_
+
+#include "../thread/Thread.h"
+#include "../utils/Config.h"
+#include "RDMACMClient.h"
+
+#include <unordered_map>
+
+namespace rdma {
+
+/* Class: RDMACMServer
+ * ----------------
+ * Accepts connections of RDMACMClients with rdma_listen(). Connect
+ * requests are handled by a background thread, each accepted
+ * connection gets its own QP and connection ID.
+ */
+class RDMACMServer : public RDMACMClient, private Thread {
+ public:
+  RDMACMServer(int port = Config::RDMA_PORT, size_t mem_size = Config::RDMA_MEMSIZE);
+  RDMACMServer(std::string ip, int port, size_t mem_size);
+  RDMACMServer(std::string ip, int port, size_t mem_size, int mem_type, bool huge, int numaNode);
+  ~RDMACMServer();
+
+  /* Function: startServer
+   * ----------------
+   * Binds ip:port and starts listening for connect requests
+   *
+   * return:  true if the server is listening
+   */
+  bool startServer();
+
+  void stopServer();
+
+  bool isRunning() { return m_running; }
+
+  int getPort() { return m_port; }
+
+  void run() override;
+
+ protected:
+  void handleConnectRequest(struct rdma_cm_event *event);
+
+  std::string m_ip;
+  int m_port;
+  struct rdma_event_channel *m_listenChannel = nullptr;
+  struct rdma_cm_id *m_listenID = nullptr;
+  std::unordered_map<struct rdma_cm_id *, NodeID> m_cmIDToConnID;
+
+  using Thread::join;
+  using Thread::killed;
+  using Thread::start;
+  using Thread::stop;
+};
+
+}  // namespace rdma
+
+#endif /* RDMACMServer_H_ */
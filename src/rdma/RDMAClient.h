@@ -13,8 +13,10 @@
 #include "ReliableRDMA.h"
 #include "UnreliableRDMA.h"
 #include "NodeIDSequencer.h"
+#include "NodeMembership.h"
 
 #include <list>
+#include <memory>
 #include <unordered_map>
 
 #ifndef HUGEPAGE
@@ -93,6 +95,20 @@ namespace rdma
 
     ~RDMAClient()
     {
+      // announce leave so that other nodes can update their membership table
+      if (m_registered)
+      {
+        try
+        {
+          Any releaseAny = ProtoMessageFactory::createNodeIDReleaseRequest(m_ownNodeID);
+          Any rcvAny;
+          ProtoClient::exchangeProtoMsg(m_sequencerIpPort, &releaseAny, &rcvAny);
+        }
+        catch (std::runtime_error &e)
+        {
+          Logging::debug(__FILE__, __LINE__, m_name + " could not release NodeID: " + e.what());
+        }
+      }
       // RDMAConnDisconnect disconnMsg;
       // disconnMsg.set_nodeid(m_ownNodeID);
       // for(std::pair<std::string, NodeID> entry : m_connections){
@@ -200,48 +216,11 @@ namespace rdma
 
         ProtoClient::connectProto(ipPort);
 
+        // Lookup nodeID of the server in the local membership table
+        if (!lookupServerNodeID(ipPort, retServerNodeID))
         {
-          // Request nodeID from Sequencer
-          auto getNodeIdReq = ProtoMessageFactory::createGetNodeIDForIpPortRequest(ipPort);
-
-          Any rcvAny;
-          ProtoClient::exchangeProtoMsg(m_sequencerIpPort, &getNodeIdReq, &rcvAny);
-
-          if (rcvAny.Is<GetNodeIDForIpPortResponse>())
-          {
-
-            GetNodeIDForIpPortResponse connResponse;
-            rcvAny.UnpackTo(&connResponse);
-
-            size_t retries = rdma::Config::RDMA_GET_NODE_ID_RETRIES;
-            size_t i = 0;
-            while (i < retries && connResponse.return_() != MessageErrors::NO_ERROR)
-            {
-              ProtoClient::exchangeProtoMsg(m_sequencerIpPort, &getNodeIdReq, &rcvAny);
-              rcvAny.UnpackTo(&connResponse);
-              Logging::debug(__FILE__, __LINE__, "GetNodeIDForIpPortResponse returned an error: " + to_string(connResponse.return_()) + " retry " + to_string(i) + "/" + to_string(retries));
-              usleep(Config::RDMA_SLEEP_INTERVAL * i);
-              ++i;
-            }
-
-            if (connResponse.return_() != MessageErrors::NO_ERROR)
-            {
-              Logging::error(__FILE__, __LINE__, m_name + " could not fetch node id of server on connect! Address: " + ipPort);
-              return false;
-            }
-
-            retServerNodeID = connResponse.node_id();
-
-            if (connResponse.ip() != ipPort)
-            {
-              std::cerr << m_name << ": fetched IP '" << connResponse.ip() << "' from Sequencer did not match requested IP '" << ipPort << "'" << std::endl;
-              throw runtime_error("Fetched IP (" + connResponse.ip() + ") from Sequencer did not match requested IP (" + ipPort + ")");
-            }
-          }
-          else
-          {
-            throw runtime_error("An Error occurred while fetching NodeID for ip: " + ipPort);
-          }
+          Logging::error(__FILE__, __LINE__, m_name + " could not fetch node id of server on connect! Address: " + ipPort);
+          return false;
         }
 
         if (retServerNodeID >= m_nodeIDsConnection.size())
@@ -276,71 +255,9 @@ namespace rdma
         }
         lck.unlock();
 
-        struct ib_qp_t qp;
-        struct ib_conn_t localConn;
-
-        // need to pass pointer of pointers because of UnreliableRDMA
-        // UnreliableRDMA returns a pointer to the member of qp and locaCon
-        auto qpPt = &qp;
-        auto localConnPt = &localConn;
-
-        // srq Server to Server is not yet working
-        // init QP but dont add it to the members yet
-        RDMA_API_T::initQPWithSuppliedID(&qpPt, &localConnPt);
-
-        // exchange QP info
-
-        RDMAConnRequest connRequest;
-        connRequest.set_buffer(localConnPt->buffer);
-        connRequest.set_rkey(localConnPt->rc.rkey);
-        connRequest.set_qp_num(localConnPt->qp_num);
-        connRequest.set_lid(localConnPt->lid);
-        for (int i = 0; i < 16; ++i)
-        {
-          connRequest.add_gid(localConnPt->gid[i]);
-        }
-        connRequest.set_psn(localConnPt->ud.psn);
-        connRequest.set_nodeid(m_ownNodeID);
-
-        Any sendAny;
-        sendAny.PackFrom(connRequest);
-        Any rcvAny;
-
-        ProtoClient::exchangeProtoMsg(ipPort, &sendAny, &rcvAny);
-
-        if (rcvAny.Is<RDMAConnResponse>())
-        {
-          // connect request was successful
-          RDMAConnResponse connResponse;
-          rcvAny.UnpackTo(&connResponse);
-
-          struct ib_conn_t remoteConn;
-          remoteConn.buffer = connResponse.buffer();
-          remoteConn.rc.rkey = connResponse.rkey();
-          remoteConn.qp_num = connResponse.qp_num();
-          remoteConn.lid = connResponse.lid();
-          remoteConn.ud.psn = connResponse.psn();
-          for (int i = 0; i < 16; ++i)
-          {
-            remoteConn.gid[i] = connResponse.gid(i);
-          }
-          // set qp to members
-          RDMA_API_T::setQP(retServerNodeID, *qpPt);
-          RDMA_API_T::setLocalConnData(retServerNodeID, *localConnPt);
-
-          RDMA_API_T::setRemoteConnData(retServerNodeID, remoteConn);
-        }
-        else
+        if (!exchangeQPInfo(ipPort, m_ownNodeID, retServerNodeID))
         {
           // connect request failed because other Server already connected
-          // cleanup
-          if (ibv_destroy_qp(qp.qp) != 0)
-          {
-            throw runtime_error("Error, ibv_destroy_qp() failed after invalid connection build up");
-          }
-          qp.qp = nullptr;
-          RDMA_API_T::destroyCQ(qp.send_cq, qp.recv_cq);
-
           return true;
         }
 
@@ -358,14 +275,164 @@ namespace rdma
       }
     }
 
+    /**
+     * @brief Opens another QP to an RDMAServer the client is already
+     * connected to. The server knows QPs by the nodeId of the client,
+     * therefore every additional QP reserves its own connection id at
+     * the sequencer. The id is not a node: it isn't listed, mapped to
+     * the ip:port of the client or published to the membership.
+     *
+     * @param serverNodeID nodeId of the connected server
+     * @param retConnID connection id of the new QP
+     * @return true success
+     * @return false fail
+     */
+    bool connectAdditionalQP(NodeID serverNodeID, NodeID &retConnID)
+    {
+      if (serverNodeID >= m_nodeIDsConnection.size() || m_nodeIDsConnection[serverNodeID].empty())
+      {
+        Logging::error(__FILE__, __LINE__, m_name + " could not open additional QP since client is not connected to server: " + to_string(serverNodeID));
+        return false;
+      }
+
+      Any reserveRequest = ProtoMessageFactory::createConnIDReserveRequest(1);
+      Any rcvAny;
+      ProtoClient::exchangeProtoMsg(m_sequencerIpPort, &reserveRequest, &rcvAny);
+      if (!rcvAny.Is<NodeIDResponse>())
+      {
+        Logging::error(__FILE__, __LINE__, m_name + " could not reserve connection id of additional QP at NodeIDSequencer");
+        return false;
+      }
+      NodeIDResponse nodeIDResponse;
+      rcvAny.UnpackTo(&nodeIDResponse);
+      retConnID = nodeIDResponse.nodeid();
+
+      if (!exchangeQPInfo(m_nodeIDsConnection[serverNodeID], retConnID, retConnID))
+      {
+        return false;
+      }
+      RDMA_API_T::connectQP(retConnID);
+      return true;
+    }
+
+    /**
+     * @brief Opens additional QPs to a connected server until the pool
+     * of the server has poolSize QPs that logical connections are spread
+     * over. Only available for RDMAClient<MultiplexedRDMA>.
+     *
+     * @param serverNodeID nodeId of the connected server
+     * @param poolSize number of QPs of the pool including the connection
+     * @return true success
+     * @return false fail
+     */
+    bool connectQPPool(NodeID serverNodeID, size_t poolSize = Config::RDMA_MUX_QPS)
+    {
+      while (RDMA_API_T::getPoolSize(serverNodeID) < poolSize)
+      {
+        NodeID connID;
+        if (!connectAdditionalQP(serverNodeID, connID))
+        {
+          return false;
+        }
+        RDMA_API_T::addToPool(serverNodeID, connID);
+      }
+      return true;
+    }
+
     NodeID getOwnNodeID()
     {
       return m_ownNodeID;
     }
 
+    /**
+     * @brief Looks up the nodeID of a server in the local membership table.
+     * Waits up to Config::SEQUENCER_LOOKUP_TIMEOUT for the server to join.
+     * If no update arrives for Config::SEQUENCER_RESYNC_INTERVAL (e.g. it
+     * was lost) the table is resynced and the sequencer is asked directly.
+     *
+     * @param ipPort Ip : port string of the server
+     * @param retServerNodeID nodeId of the server
+     * @return true if the server is a member
+     */
+    bool lookupServerNodeID(const string &ipPort, NodeID &retServerNodeID)
+    {
+      if (m_membership == nullptr)
+      {
+        // subscribe before fetching the snapshot to not miss any update
+        m_membership = std::make_unique<NodeMembership>(m_sequencerIpPort);
+        m_membership->subscribe();
+      }
+
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(Config::SEQUENCER_LOOKUP_TIMEOUT);
+      while (true)
+      {
+        if (m_membership->needsSync())
+        {
+          syncMembership();
+        }
+        uint64_t version = m_membership->getVersion();
+        if (m_membership->lookupServer(ipPort, retServerNodeID))
+        {
+          return true;
+        }
+        auto resync = std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(Config::SEQUENCER_RESYNC_INTERVAL));
+        if (!m_membership->waitForChange(version, resync))
+        {
+          syncMembership();
+          if (m_membership->lookupServer(ipPort, retServerNodeID) || requestServerNodeID(ipPort, retServerNodeID))
+          {
+            return true;
+          }
+          if (std::chrono::steady_clock::now() >= deadline)
+          {
+            return false;
+          }
+        }
+      }
+    }
+
   protected:
     unordered_map<string, NodeID> m_mcast_addr;
     NodeID m_ownNodeID;
+    bool m_registered = false;
+
+    // Local view of all nodes registered at the sequencer
+    std::unique_ptr<NodeMembership> m_membership;
+
+    // Fetches a snapshot of all nodes from the sequencer
+    void syncMembership()
+    {
+      Any getAllReq = ProtoMessageFactory::createGetAllNodeIDsRequest(m_ownNodeID);
+      Any rcvAny;
+      ProtoClient::exchangeProtoMsg(m_sequencerIpPort, &getAllReq, &rcvAny);
+      if (!rcvAny.Is<GetAllNodeIDsResponse>())
+      {
+        throw runtime_error("An Error occurred while fetching all NodeIDs from sequencer: " + m_sequencerIpPort);
+      }
+      GetAllNodeIDsResponse snapshot;
+      rcvAny.UnpackTo(&snapshot);
+      m_membership->applySnapshot(snapshot);
+    }
+    // Asks the sequencer for the nodeID of a server without the membership table
+    bool requestServerNodeID(const string &ipPort, NodeID &retServerNodeID)
+    {
+      Any nodeIDRequest = ProtoMessageFactory::createGetNodeIDForIpPortRequest(ipPort);
+      Any rcvAny;
+      ProtoClient::exchangeProtoMsg(m_sequencerIpPort, &nodeIDRequest, &rcvAny);
+      if (!rcvAny.Is<GetNodeIDForIpPortResponse>())
+      {
+        return false;
+      }
+      GetNodeIDForIpPortResponse response;
+      rcvAny.UnpackTo(&response);
+      if (response.return_() != MessageErrors::NO_ERROR)
+      {
+        return false;
+      }
+      retServerNodeID = response.node_id();
+      return true;
+    }
+
     // Mapping from NodeID to IPs
     vector<string> m_nodeIDsConnection;
 
@@ -442,6 +509,7 @@ namespace rdma
         {
           NodeIDResponse connResponse;
           rcvAny.UnpackTo(&connResponse);
+          m_registered = true;
           return connResponse.nodeid();
         }
         else
@@ -459,6 +527,119 @@ namespace rdma
       }
     }
 
+    /**
+     * @brief Creates a QP, exchanges its info with the RDMAServer and
+     * stores it under the given connection id (without connecting it)
+     *
+     * @param ipPort Ip : port string of the server
+     * @param ownNodeID nodeId the server knows the QP by
+     * @param connID connection id the QP is stored under
+     * @return false if the server rejected the QP because it already connected itself
+     */
+    bool exchangeQPInfo(const string &ipPort, NodeID ownNodeID, NodeID connID)
+    {
+      struct ib_qp_t qp;
+      struct ib_conn_t localConn;
+
+      // need to pass pointer of pointers because of UnreliableRDMA
+      // UnreliableRDMA returns a pointer to the member of qp and locaCon
+      auto qpPt = &qp;
+      auto localConnPt = &localConn;
+
+      // srq Server to Server is not yet working
+      // init QP but dont add it to the members yet
+      RDMA_API_T::initQPWithSuppliedID(&qpPt, &localConnPt);
+
+      // exchange QP info
+
+      RDMAConnRequest connRequest;
+      connRequest.set_buffer(localConnPt->buffer);
+      connRequest.set_rkey(localConnPt->rc.rkey);
+      connRequest.set_qp_num(localConnPt->qp_num);
+      connRequest.set_lid(localConnPt->lid);
+      for (int i = 0; i < 16; ++i)
+      {
+        connRequest.add_gid(localConnPt->gid[i]);
+      }
+      connRequest.set_psn(localConnPt->ud.psn);
+      connRequest.set_nodeid(ownNodeID);
+      connRequest.set_shm_host(localConnPt->shm.host);
+      connRequest.set_shm_pid(localConnPt->shm.pid);
+      connRequest.set_shm_segment(localConnPt->shm.segment);
+      connRequest.set_shm_queue(localConnPt->shm.queue);
+      for (uint32_t r = 0; r < localConnPt->rails.count; ++r)
+      {
+        connRequest.add_rail_qp_num(localConnPt->rails.qp_num[r]);
+        connRequest.add_rail_lid(localConnPt->rails.lid[r]);
+        connRequest.add_rail_rkey(localConnPt->rails.rkey[r]);
+        for (int i = 0; i < 16; ++i)
+        {
+          connRequest.add_rail_gid(localConnPt->rails.gid[r][i]);
+        }
+      }
+
+      Any sendAny;
+      sendAny.PackFrom(connRequest);
+      Any rcvAny;
+
+      ProtoClient::exchangeProtoMsg(ipPort, &sendAny, &rcvAny);
+
+      if (rcvAny.Is<RDMAConnResponse>())
+      {
+        // connect request was successful
+        RDMAConnResponse connResponse;
+        rcvAny.UnpackTo(&connResponse);
+
+        struct ib_conn_t remoteConn;
+        remoteConn.buffer = connResponse.buffer();
+        remoteConn.rc.rkey = connResponse.rkey();
+        remoteConn.qp_num = connResponse.qp_num();
+        remoteConn.lid = connResponse.lid();
+        remoteConn.ud.psn = connResponse.psn();
+        for (int i = 0; i < 16; ++i)
+        {
+          remoteConn.gid[i] = connResponse.gid(i);
+        }
+        remoteConn.shm.host = connResponse.shm_host();
+        remoteConn.shm.pid = connResponse.shm_pid();
+        remoteConn.shm.segment = connResponse.shm_segment();
+        remoteConn.shm.queue = connResponse.shm_queue();
+        remoteConn.rails.count = std::min<uint32_t>(connResponse.rail_qp_num_size(), Config::RDMA_MAX_RAILS - 1);
+        for (uint32_t r = 0; r < remoteConn.rails.count; ++r)
+        {
+          remoteConn.rails.qp_num[r] = connResponse.rail_qp_num(r);
+          remoteConn.rails.lid[r] = connResponse.rail_lid(r);
+          remoteConn.rails.rkey[r] = connResponse.rail_rkey(r);
+          for (int i = 0; i < 16; ++i)
+          {
+            remoteConn.rails.gid[r][i] = connResponse.rail_gid(r * 16 + i);
+          }
+        }
+        // set qp to members
+        RDMA_API_T::setQP(connID, *qpPt);
+        RDMA_API_T::setLocalConnData(connID, *localConnPt);
+
+        RDMA_API_T::setRemoteConnData(connID, remoteConn);
+      }
+      else
+      {
+        // connect request failed because other Server already connected
+        // cleanup (no QP is created for shared memory without a device)
+        if (qp.qp != nullptr)
+        {
+          if (ibv_destroy_qp(qp.qp) != 0)
+          {
+            throw runtime_error("Error, ibv_destroy_qp() failed after invalid connection build up");
+          }
+          qp.qp = nullptr;
+          RDMA_API_T::destroyCQ(qp.send_cq, qp.recv_cq);
+        }
+
+        return false;
+      }
+      return true;
+    }
+
   protected:
     using ProtoClient::connectProto;     // Make private
     using ProtoClient::exchangeProtoMsg; // Make private
@@ -300,6 +300,19 @@ class RDMAServer : public ProtoServer, public RDMAClient<RDMA_API_T> {
       remoteConn.gid[i] = connRequest->gid(i);
     }
     remoteConn.ud.psn = connRequest->psn();
+    remoteConn.shm.host = connRequest->shm_host();
+    remoteConn.shm.pid = connRequest->shm_pid();
+    remoteConn.shm.segment = connRequest->shm_segment();
+    remoteConn.shm.queue = connRequest->shm_queue();
+    remoteConn.rails.count = std::min<uint32_t>(connRequest->rail_qp_num_size(), Config::RDMA_MAX_RAILS - 1);
+    for (uint32_t r = 0; r < remoteConn.rails.count; ++r) {
+      remoteConn.rails.qp_num[r] = connRequest->rail_qp_num(r);
+      remoteConn.rails.lid[r] = connRequest->rail_lid(r);
+      remoteConn.rails.rkey[r] = connRequest->rail_rkey(r);
+      for (int i = 0; i < 16; ++i) {
+        remoteConn.rails.gid[r][i] = connRequest->rail_gid(r * 16 + i);
+      }
+    }
     RDMA_API_T::setRemoteConnData(nodeID, remoteConn);
 
     try
@@ -323,6 +336,18 @@ class RDMAServer : public ProtoServer, public RDMAClient<RDMA_API_T> {
     for (int i = 0; i < 16; ++i) {
       connResponse->add_gid(localConn.gid[i]);
     }
+    connResponse->set_shm_host(localConn.shm.host);
+    connResponse->set_shm_pid(localConn.shm.pid);
+    connResponse->set_shm_segment(localConn.shm.segment);
+    connResponse->set_shm_queue(localConn.shm.queue);
+    for (uint32_t r = 0; r < localConn.rails.count; ++r) {
+      connResponse->add_rail_qp_num(localConn.rails.qp_num[r]);
+      connResponse->add_rail_lid(localConn.rails.lid[r]);
+      connResponse->add_rail_rkey(localConn.rails.rkey[r]);
+      for (int i = 0; i < 16; ++i) {
+        connResponse->add_rail_gid(localConn.rails.gid[r][i]);
+      }
+    }
 
     Logging::debug(__FILE__, __LINE__,
                    "RDMAServer: connected to client!" + to_string(nodeID));
@@ -0,0 +1,279 @@
+#include "ReliableMulticast.h"
+#include "../utils/Logging.h"
+
+using namespace rdma;
+
+//------------------------------------------------------------------------------------//
+
+ReliableMulticastSender::ReliableMulticastSender(UnreliableRDMA *rdma, NodeID mcastID, NodeID ownID,
+                                                 const std::vector<NodeID> &receivers, size_t maxMsgSize)
+    : m_rdma(rdma), m_mcastID(mcastID), m_ownID(ownID), m_maxMsgSize(maxMsgSize) {
+  m_slotSize = sizeof(rmcast_hdr_t) + maxMsgSize;
+  if (m_slotSize > Config::RDMA_UD_MTU) {
+    throw runtime_error("ReliableMulticastSender: message size exceeds UD MTU! Size: " + to_string(maxMsgSize));
+  }
+  m_windowSize = Config::RDMA_MCAST_WINDOW;
+  for (auto receiver : receivers) {
+    m_acks[receiver] = 0;
+  }
+
+  m_window = (char *)m_rdma->localAlloc(m_windowSize * m_slotSize);
+  m_heartbeat = (char *)m_rdma->localAlloc(sizeof(rmcast_hdr_t));
+
+  // every receive needs room for the GRH in front
+  size_t ctrlCount = std::min<size_t>(m_windowSize, Config::RDMA_MAX_WR);
+  size_t stride = sizeof(rmcast_hdr_t) + Config::RDMA_UD_OFFSET;
+  m_ctrlMemory = (char *)m_rdma->localAlloc(ctrlCount * stride);
+  for (size_t i = 0; i < ctrlCount; ++i) {
+    char *buffer = m_ctrlMemory + i * stride;
+    m_rdma->receive(0, buffer, sizeof(rmcast_hdr_t));
+    m_ctrlBuffers.push_back(buffer);
+  }
+  m_lastProgress = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------------//
+
+ReliableMulticastSender::~ReliableMulticastSender() {
+  // the control receives stay posted, so their memory is not freed
+  m_rdma->localFree(m_window);
+  m_rdma->localFree(m_heartbeat);
+}
+
+//------------------------------------------------------------------------------------//
+
+uint64_t ReliableMulticastSender::minAck() {
+  uint64_t ack = m_nextSeq;
+  for (auto &receiver : m_acks) {
+    ack = std::min(ack, receiver.second);
+  }
+  return ack;
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableMulticastSender::send(const void *memAddr, size_t size) {
+  if (size > m_maxMsgSize) {
+    throw runtime_error("ReliableMulticastSender: message too large! Size: " + to_string(size));
+  }
+  // the slot of the message is free once all receivers acknowledged the message one window earlier
+  while (m_nextSeq >= minAck() + m_windowSize) {
+    progress();
+  }
+  if (minAck() == m_nextSeq) {
+    m_lastProgress = std::chrono::steady_clock::now();
+  }
+
+  char *message = slot(m_nextSeq);
+  rmcast_hdr_t hdr{rmcast_hdr_t::DATA, (uint32_t)size, m_nextSeq, m_ownID};
+  memcpy(message, &hdr, sizeof(hdr));
+  memcpy(message + sizeof(hdr), memAddr, size);
+  m_rdma->sendMCast(m_mcastID, message, sizeof(hdr) + size, false);
+  ++m_nextSeq;
+
+  progress();
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableMulticastSender::flush() {
+  while (minAck() < m_nextSeq) {
+    progress();
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableMulticastSender::progress() {
+  while (m_rdma->pollReceive(0, false) > 0) {
+    char *buffer = m_ctrlBuffers.front();
+    m_ctrlBuffers.pop_front();
+    rmcast_hdr_t hdr;
+    memcpy(&hdr, buffer, sizeof(hdr));
+    m_rdma->receive(0, buffer, sizeof(rmcast_hdr_t));
+    m_ctrlBuffers.push_back(buffer);
+
+    handleControl(hdr);
+  }
+
+  // acknowledgements (or the last messages) got lost, receivers answer heartbeats with ACKs and NACKs
+  auto now = std::chrono::steady_clock::now();
+  if (minAck() < m_nextSeq &&
+      now - m_lastProgress > std::chrono::microseconds(Config::RDMA_MCAST_RETRANSMIT_TIMEOUT)) {
+    rmcast_hdr_t hdr{rmcast_hdr_t::HEARTBEAT, 0, m_nextSeq, m_ownID};
+    memcpy(m_heartbeat, &hdr, sizeof(hdr));
+    m_rdma->sendMCast(m_mcastID, m_heartbeat, sizeof(hdr), true);
+    m_lastProgress = now;
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableMulticastSender::handleControl(const rmcast_hdr_t &hdr) {
+  auto receiver = m_acks.find(hdr.nodeID);
+  if (receiver == m_acks.end() || hdr.seq > m_nextSeq) {
+    Logging::debug(__FILE__, __LINE__, "ReliableMulticastSender: dropped control message of node " + to_string(hdr.nodeID));
+    return;
+  }
+
+  // a NACK acknowledges all messages before the first missing one
+  if (hdr.seq > receiver->second) {
+    receiver->second = hdr.seq;
+    m_lastProgress = std::chrono::steady_clock::now();
+  }
+
+  if (hdr.type == rmcast_hdr_t::NACK) {
+    // messages before the acknowledgement might already be overwritten
+    uint64_t end = std::min<uint64_t>(hdr.seq + hdr.size, m_nextSeq);
+    for (uint64_t seq = receiver->second; seq < end; ++seq) {
+      char *message = slot(seq);
+      rmcast_hdr_t msgHdr;
+      memcpy(&msgHdr, message, sizeof(msgHdr));
+      m_rdma->send(hdr.nodeID, message, sizeof(msgHdr) + msgHdr.size, false);
+      ++m_retransmissions;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+ReliableMulticastReceiver::ReliableMulticastReceiver(UnreliableRDMA *rdma, NodeID mcastID, NodeID ownID,
+                                                     NodeID senderID, size_t maxMsgSize)
+    : m_rdma(rdma), m_mcastID(mcastID), m_ownID(ownID), m_senderID(senderID), m_maxMsgSize(maxMsgSize) {
+  m_slotSize = sizeof(rmcast_hdr_t) + maxMsgSize;
+  if (m_slotSize > Config::RDMA_UD_MTU) {
+    throw runtime_error("ReliableMulticastReceiver: message size exceeds UD MTU! Size: " + to_string(maxMsgSize));
+  }
+  m_windowSize = Config::RDMA_MCAST_WINDOW;
+  m_reorder.resize(m_windowSize * m_slotSize);
+  m_present.resize(m_windowSize, false);
+
+  m_ctrl = (char *)m_rdma->localAlloc(sizeof(rmcast_hdr_t));
+
+  // every receive needs room for the GRH in front
+  size_t count = std::min<size_t>(m_windowSize, Config::RDMA_MAX_WR);
+  size_t stride = m_slotSize + Config::RDMA_UD_OFFSET;
+  m_mcastMemory = (char *)m_rdma->localAlloc(count * stride);
+  m_unicastMemory = (char *)m_rdma->localAlloc(count * stride);
+  for (size_t i = 0; i < count; ++i) {
+    m_rdma->receiveMCast(m_mcastID, m_mcastMemory + i * stride, m_slotSize);
+    m_mcastBuffers.push_back(m_mcastMemory + i * stride);
+    m_rdma->receive(0, m_unicastMemory + i * stride, m_slotSize);
+    m_unicastBuffers.push_back(m_unicastMemory + i * stride);
+  }
+  m_lastNackTime = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------------//
+
+ReliableMulticastReceiver::~ReliableMulticastReceiver() {
+  // the receives stay posted, so their memory is not freed
+  m_rdma->localFree(m_ctrl);
+}
+
+//------------------------------------------------------------------------------------//
+
+bool ReliableMulticastReceiver::receive(void *memAddr, size_t &size, bool doPoll) {
+  while (true) {
+    size_t idx = m_expected % m_windowSize;
+    if (m_present[idx]) {
+      const char *message = &m_reorder[idx * m_slotSize];
+      rmcast_hdr_t hdr;
+      memcpy(&hdr, message, sizeof(hdr));
+      memcpy(memAddr, message + sizeof(hdr), hdr.size);
+      size = hdr.size;
+      m_present[idx] = false;
+      ++m_expected;
+
+      if (m_expected - m_lastAck >= std::max<size_t>(m_windowSize / 4, 1)) {
+        sendControl(rmcast_hdr_t::ACK, m_expected, 0);
+      }
+      return true;
+    }
+
+    bool polled = false;
+    while (m_rdma->pollReceiveMCast(m_mcastID, false) > 0) {
+      char *buffer = m_mcastBuffers.front();
+      m_mcastBuffers.pop_front();
+      handleMessage(buffer);
+      m_rdma->receiveMCast(m_mcastID, buffer, m_slotSize);
+      m_mcastBuffers.push_back(buffer);
+      polled = true;
+    }
+    // repairs
+    while (m_rdma->pollReceive(0, false) > 0) {
+      char *buffer = m_unicastBuffers.front();
+      m_unicastBuffers.pop_front();
+      handleMessage(buffer);
+      m_rdma->receive(0, buffer, m_slotSize);
+      m_unicastBuffers.push_back(buffer);
+      polled = true;
+    }
+    checkGap();
+
+    if (!polled && !doPoll) {
+      return false;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableMulticastReceiver::handleMessage(const char *message) {
+  rmcast_hdr_t hdr;
+  memcpy(&hdr, message, sizeof(hdr));
+  if (hdr.nodeID != m_senderID) {
+    return;
+  }
+
+  if (hdr.type == rmcast_hdr_t::HEARTBEAT) {
+    m_highest = std::max(m_highest, hdr.seq);
+    sendControl(rmcast_hdr_t::ACK, m_expected, 0);
+    return;
+  }
+
+  // duplicates and messages beyond the window are dropped
+  if (hdr.type != rmcast_hdr_t::DATA || hdr.seq < m_expected || hdr.seq >= m_expected + m_windowSize ||
+      hdr.size > m_maxMsgSize) {
+    return;
+  }
+  size_t idx = hdr.seq % m_windowSize;
+  if (!m_present[idx]) {
+    memcpy(&m_reorder[idx * m_slotSize], message, sizeof(hdr) + hdr.size);
+    m_present[idx] = true;
+  }
+  m_highest = std::max(m_highest, hdr.seq + 1);
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableMulticastReceiver::checkGap() {
+  if (m_highest <= m_expected || m_present[m_expected % m_windowSize]) {
+    return;
+  }
+
+  // NACKs of the same gap are repeated after the timeout
+  auto now = std::chrono::steady_clock::now();
+  if (m_lastNack == m_expected &&
+      now - m_lastNackTime < std::chrono::microseconds(Config::RDMA_MCAST_RETRANSMIT_TIMEOUT)) {
+    return;
+  }
+
+  uint64_t end = m_expected;
+  while (end < m_highest && !m_present[end % m_windowSize]) {
+    ++end;
+  }
+  sendControl(rmcast_hdr_t::NACK, m_expected, end - m_expected);
+  m_lastNack = m_expected;
+  m_lastNackTime = now;
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableMulticastReceiver::sendControl(uint32_t type, uint64_t seq, uint32_t count) {
+  rmcast_hdr_t hdr{type, count, seq, m_ownID};
+  memcpy(m_ctrl, &hdr, sizeof(hdr));
+  // signaled, the buffer is reused by the next control message
+  m_rdma->send(m_senderID, m_ctrl, sizeof(hdr), true);
+  m_lastAck = m_expected;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file ReliableMulticast.h
+ */
+
+#ifndef ReliableMulticast_H_
+#define ReliableMulticast_H_
+
+#include "../utils/Config.h"
+#include "UnreliableRDMA.h"
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace rdma {
+
+// header in front of every message of the reliable multicast protocol
+struct rmcast_hdr_t {
+  enum Type : uint32_t { DATA, HEARTBEAT, ACK, NACK };
+  uint32_t type;
+  uint32_t size;  // DATA: size of the payload, NACK: number of missing messages
+  uint64_t seq;   // DATA: sequence number, HEARTBEAT: next sequence number,
+                  // ACK: next expected sequence number, NACK: first missing sequence number
+  NodeID nodeID;  // sender of the message
+};
+
+/* Class: ReliableMulticastSender
+ * ----------------
+ * Sends messages to a multicast group such that every receiver
+ * (ReliableMulticastReceiver) gets every message in order.
+ *
+ * Messages get consecutive sequence numbers and are kept in a
+ * retransmit window of Config::RDMA_MCAST_WINDOW messages until all
+ * receivers acknowledged them. Receivers request missing messages
+ * with NACKs, which are repaired with UD unicasts from the window.
+ * A message is only sent if the slowest receiver acknowledged the
+ * message one window earlier. If acknowledgements stop, a heartbeat
+ * with the next sequence number is multicast after
+ * Config::RDMA_MCAST_RETRANSMIT_TIMEOUT, so receivers detect lost
+ * messages at the end of the stream and acknowledge again.
+ *
+ * The sender owns the unicast receives of the UnreliableRDMA, ACKs
+ * and NACKs arrive there. The receivers must be connected (UD) to
+ * the sender. One sender per multicast group, not thread safe.
+ */
+class ReliableMulticastSender {
+ public:
+  /* Function: ReliableMulticastSender
+   * ----------------
+   * rdma:        joined the multicast group and is connected to the receivers
+   * mcastID:     id of the multicast group (joinMCastGroup)
+   * ownID:       node ID of the sender
+   * receivers:   node IDs of all receivers
+   * maxMsgSize:  maximum size of a message, header and message
+   *              must fit into one UD MTU
+   */
+  ReliableMulticastSender(UnreliableRDMA *rdma, NodeID mcastID, NodeID ownID,
+                          const std::vector<NodeID> &receivers, size_t maxMsgSize);
+  ~ReliableMulticastSender();
+
+  /* Function: send
+   * ----------------
+   * Multicasts a message, blocks while the window is full
+   */
+  void send(const void *memAddr, size_t size);
+
+  /* Function: flush
+   * ----------------
+   * Blocks until all receivers acknowledged all messages
+   */
+  void flush();
+
+  /* Function: progress
+   * ----------------
+   * Handles ACKs and NACKs and sends heartbeats,
+   * called by send and flush
+   */
+  void progress();
+
+  uint64_t getRetransmissions() { return m_retransmissions; }
+
+ private:
+  char *slot(uint64_t seq) { return m_window + (seq % m_windowSize) * m_slotSize; }
+  uint64_t minAck();
+  void handleControl(const rmcast_hdr_t &hdr);
+
+  UnreliableRDMA *m_rdma;
+  NodeID m_mcastID;
+  NodeID m_ownID;
+  size_t m_maxMsgSize;
+  size_t m_slotSize;
+  size_t m_windowSize;
+
+  char *m_window;  // retransmit window, message seq in slot seq % m_windowSize
+  uint64_t m_nextSeq = 0;
+  std::unordered_map<NodeID, uint64_t> m_acks;  // next expected sequence number per receiver
+
+  char *m_heartbeat;
+  std::chrono::steady_clock::time_point m_lastProgress;
+
+  // posted unicast receives, completed in posting order
+  std::deque<char *> m_ctrlBuffers;
+  char *m_ctrlMemory;
+
+  uint64_t m_retransmissions = 0;
+};
+
+/* Class: ReliableMulticastReceiver
+ * ----------------
+ * Receives the messages of a ReliableMulticastSender in order.
+ * Messages arriving early are kept until the gap before them is
+ * repaired. Gaps are detected from sequence numbers of later messages
+ * and heartbeats and are requested from the sender with NACKs,
+ * repeated every Config::RDMA_MCAST_RETRANSMIT_TIMEOUT. Delivered
+ * messages are acknowledged every quarter window.
+ *
+ * The receiver owns the multicast and unicast receives of the
+ * UnreliableRDMA. Not thread safe.
+ */
+class ReliableMulticastReceiver {
+ public:
+  /* Function: ReliableMulticastReceiver
+   * ----------------
+   * rdma:        joined the multicast group and is connected to the sender
+   * mcastID:     id of the multicast group (joinMCastGroup)
+   * ownID:       node ID of the receiver
+   * senderID:    node ID of the sender
+   * maxMsgSize:  maximum size of a message, same as at the sender
+   */
+  ReliableMulticastReceiver(UnreliableRDMA *rdma, NodeID mcastID, NodeID ownID,
+                            NodeID senderID, size_t maxMsgSize);
+  ~ReliableMulticastReceiver();
+
+  /* Function: receive
+   * ----------------
+   * Returns the next message in order
+   *
+   * memAddr:  buffer of at least maxMsgSize bytes
+   * size:     size of the received message
+   * doPoll:   if true then function blocks until
+   *           the next message has arrived
+   * return:   true if a message was received
+   */
+  bool receive(void *memAddr, size_t &size, bool doPoll = true);
+
+  uint64_t getNextSeq() { return m_expected; }
+
+ private:
+  void handleMessage(const char *message);
+  void sendControl(uint32_t type, uint64_t seq, uint32_t count);
+  void checkGap();
+
+  UnreliableRDMA *m_rdma;
+  NodeID m_mcastID;
+  NodeID m_ownID;
+  NodeID m_senderID;
+  size_t m_maxMsgSize;
+  size_t m_slotSize;
+  size_t m_windowSize;
+
+  // messages received ahead of m_expected, seq in slot seq % m_windowSize
+  std::vector<char> m_reorder;
+  std::vector<bool> m_present;
+  uint64_t m_expected = 0;
+  uint64_t m_highest = 0;  // highest sequence number known to be sent plus one
+  uint64_t m_lastAck = 0;
+
+  uint64_t m_lastNack = UINT64_MAX;  // first missing sequence number of the last NACK
+  std::chrono::steady_clock::time_point m_lastNackTime;
+
+  char *m_ctrl;  // ACKs and NACKs are sent from here
+
+  // posted receives, completed in posting order
+  std::deque<char *> m_mcastBuffers;
+  std::deque<char *> m_unicastBuffers;
+  char *m_mcastMemory;
+  char *m_unicastMemory;
+};
+
+}  // namespace rdma
+
+#endif /* ReliableMulticast_H_ */
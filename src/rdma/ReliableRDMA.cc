@@ -18,9 +18,15 @@ ReliableRDMA::ReliableRDMA(size_t mem_size, MEMORY_TYPE mem_type) : ReliableRDMA
 ReliableRDMA::ReliableRDMA(size_t mem_size, MEMORY_TYPE mem_type, bool huge, int numaNode) : ReliableRDMA(mem_size, (int)mem_type, huge, numaNode){}
 ReliableRDMA::ReliableRDMA(size_t mem_size, int mem_type, bool huge, int numaNode) : BaseRDMA(mem_size, mem_type, huge, numaNode){
   m_qpType = IBV_QPT_RC;
+  if (m_buffer->isIBV()) {
+    m_maxMsgSize = m_buffer->ib_port_attributes().max_msg_sz;
+  }
 }
 ReliableRDMA::ReliableRDMA(BaseMemory *buffer) : BaseRDMA(buffer) {
   m_qpType = IBV_QPT_RC;
+  if (m_buffer->isIBV()) {
+    m_maxMsgSize = m_buffer->ib_port_attributes().max_msg_sz;
+  }
 }
 
 //------------------------------------------------------------------------------------//
@@ -55,14 +61,11 @@ void ReliableRDMA::initQPWithSuppliedID(const rdmaConnID rdmaConnID) {
 
   // create local connection data
   struct ib_conn_t localConn;
-  union ibv_gid my_gid;
-  memset(&my_gid, 0, sizeof my_gid);
-
   localConn.buffer = (uint64_t)m_buffer->pointer();
   localConn.rc.rkey = m_buffer->ib_mr()->rkey;
   localConn.qp_num = qp.qp->qp_num;
   localConn.lid = m_buffer->ib_port_attributes().lid;
-  memcpy(localConn.gid, &my_gid, sizeof my_gid);
+  getLocalGid(localConn.gid);
 
   // init queue pair
   modifyQPToInit(qp.qp);
@@ -84,14 +87,11 @@ void ReliableRDMA::initQPWithSuppliedID(struct ib_qp_t** qp ,struct ib_conn_t **
 
     // create local connection data
     //struct ib_conn_t localConn;
-    union ibv_gid my_gid;
-    memset(&my_gid, 0, sizeof my_gid);
-
     (*localConn)->buffer = (uint64_t)m_buffer->pointer();
     (*localConn)->rc.rkey = m_buffer->ib_mr()->rkey;
     (*localConn)->qp_num = (*qp)->qp->qp_num;
     (*localConn)->lid = m_buffer->ib_port_attributes().lid;
-    memcpy((*localConn)->gid, &my_gid, sizeof my_gid);
+    getLocalGid((*localConn)->gid);
 
     // init queue pair
     modifyQPToInit((*qp)->qp);
@@ -186,6 +186,10 @@ void ReliableRDMA::destroyQPs() {
 
 void ReliableRDMA::write(const rdmaConnID rdmaConnID, size_t offset,
                          const void *memAddr, size_t size, bool signaled) {
+  if (size > m_maxMsgSize) {
+    throw runtime_error("RDMA write of " + to_string(size) +
+                        " bytes exceeds the max message size of the port, use writeBulk()");
+  }
   remoteAccess(rdmaConnID, offset, memAddr, size, signaled, true,
                IBV_WR_RDMA_WRITE);
 }
@@ -202,6 +206,10 @@ void ReliableRDMA::writeImm(const rdmaConnID rdmaConnID, size_t offset,
 
 void ReliableRDMA::read(const rdmaConnID rdmaConnID, size_t offset,
                         const void *memAddr, size_t size, bool signaled) {
+  if (size > m_maxMsgSize) {
+    throw runtime_error("RDMA read of " + to_string(size) +
+                        " bytes exceeds the max message size of the port, use readBulk()");
+  }
   remoteAccess(rdmaConnID, offset, memAddr, size, signaled, true,
                IBV_WR_RDMA_READ);
 }
@@ -216,6 +224,139 @@ void ReliableRDMA::requestRead(const rdmaConnID rdmaConnID, size_t offset,
 
 //------------------------------------------------------------------------------------//
 
+void ReliableRDMA::writeBulk(const rdmaConnID rdmaConnID, size_t offset,
+                             const void *memAddr, size_t size) {
+  bulk_transfer_t transfer;
+  startBulkWrite(transfer, rdmaConnID, offset, memAddr, size);
+  progressBulk(transfer, true);
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableRDMA::readBulk(const rdmaConnID rdmaConnID, size_t offset,
+                            const void *memAddr, size_t size) {
+  bulk_transfer_t transfer;
+  startBulkRead(transfer, rdmaConnID, offset, memAddr, size);
+  progressBulk(transfer, true);
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableRDMA::startBulkWrite(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                                  size_t offset, const void *memAddr, size_t size) {
+  startBulk(transfer, rdmaConnID, offset, memAddr, size, IBV_WR_RDMA_WRITE);
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableRDMA::startBulkRead(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                                 size_t offset, const void *memAddr, size_t size) {
+  startBulk(transfer, rdmaConnID, offset, memAddr, size, IBV_WR_RDMA_READ);
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableRDMA::startBulk(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID, size_t offset,
+                             const void *memAddr, size_t size, enum ibv_wr_opcode verb) {
+  transfer.connID = rdmaConnID;
+  transfer.remoteAddr = m_rconns[rdmaConnID].buffer + offset;
+  transfer.localAddr = (uint64_t)memAddr;
+  transfer.size = size;
+  transfer.verb = verb;
+  transfer.chunkSize = std::max<size_t>(1, std::min<size_t>(Config::RDMA_BULK_CHUNK_SIZE, m_maxMsgSize));
+  transfer.chunks = (size + transfer.chunkSize - 1) / transfer.chunkSize;
+  transfer.postedChunks = 0;
+  transfer.completedChunks = 0;
+  transfer.retiredChunks = 0;
+  transfer.signaledChunks.clear();
+
+  postBulkChunks(transfer);
+}
+
+//------------------------------------------------------------------------------------//
+
+void ReliableRDMA::postBulkChunks(bulk_transfer_t &transfer) {
+  size_t window = std::max<size_t>(1, std::min(Config::RDMA_BULK_WINDOW, Config::RDMA_MAX_WR));
+  size_t signalInterval = std::max<size_t>(1, window / 2);
+  struct ib_qp_t localQP = m_qps[transfer.connID];
+  uint32_t rkey = m_rconns[transfer.connID].rc.rkey;
+
+  // completed chunks free their slots in the send queue, unless a
+  // signaled operation in between already reset the count
+  size_t &countWR = m_countWR[transfer.connID];
+  countWR -= std::min(countWR, transfer.completedChunks - transfer.retiredChunks);
+  transfer.retiredChunks = transfer.completedChunks;
+
+  // with a full send queue chunks are posted one at a time
+  while (transfer.postedChunks < transfer.chunks &&
+         transfer.postedChunks - transfer.completedChunks < window &&
+         (countWR + 1 < Config::RDMA_MAX_WR || transfer.postedChunks == transfer.completedChunks)) {
+    size_t chunk = transfer.postedChunks;
+    size_t pos = chunk * transfer.chunkSize;
+    bool signaled = (chunk + 1) % signalInterval == 0 || chunk + 1 == transfer.chunks ||
+                    countWR + 2 >= Config::RDMA_MAX_WR;
+
+    struct ibv_send_wr sr;
+    struct ibv_sge sge;
+    memset(&sge, 0, sizeof(sge));
+    sge.addr = transfer.localAddr + pos;
+    sge.lkey = m_buffer->ib_mr()->lkey;
+    sge.length = std::min(transfer.chunkSize, transfer.size - pos);
+    memset(&sr, 0, sizeof(sr));
+    sr.wr_id = (uint64_t)&transfer | BULK_WR_ID_TAG;
+    sr.sg_list = &sge;
+    sr.num_sge = 1;
+    sr.opcode = transfer.verb;
+    sr.send_flags = (signaled ? IBV_SEND_SIGNALED : 0);
+    sr.wr.rdma.remote_addr = transfer.remoteAddr + pos;
+    sr.wr.rdma.rkey = rkey;
+
+    struct ibv_send_wr *bad_wr = nullptr;
+    if ((errno = ibv_post_send(localQP.qp, &sr, &bad_wr))) {
+      throw runtime_error("RDMA OP not successful in bulk transfer! error: " + to_string(errno));
+    }
+    if (signaled) {
+      transfer.signaledChunks.push_back(chunk);
+    }
+    ++transfer.postedChunks;
+    ++countWR;
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+bool ReliableRDMA::progressBulk(bulk_transfer_t &transfer, bool doPoll) {
+  struct ib_qp_t localQP = m_qps[transfer.connID];
+
+  do {
+    postBulkChunks(transfer);
+    if (transfer.isComplete()) {
+      return true;
+    }
+
+    struct ibv_wc wc;
+    wc.status = IBV_WC_SUCCESS;
+    int ne = ibv_poll_cq(localQP.send_cq, 1, &wc);
+    if (ne < 0) {
+      throw runtime_error("RDMA polling from CQ failed!");
+    }
+    if (ne > 0) {
+      if (wc.status != IBV_WC_SUCCESS) {
+        throw runtime_error("RDMA completion event in CQ with error in bulk transfer! " +
+                            to_string(wc.status));
+      }
+      if (!creditBulkCompletion(wc)) {
+        throw runtime_error("Completion of an outstanding operation polled by a bulk transfer!");
+      }
+    }
+  } while (doPoll);
+
+  postBulkChunks(transfer);
+  return transfer.isComplete();
+}
+
+//------------------------------------------------------------------------------------//
+
 void ReliableRDMA::fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
                                const void *memAddr, size_t size,
                                bool signaled) {
@@ -261,7 +402,7 @@ void ReliableRDMA::fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
         throw runtime_error("RDMA completion event in CQ with error!" +
                             to_string(wc.status));
       }
-    } while (ne == 0);
+    } while (ne == 0 || (ne > 0 && creditBulkCompletion(wc)));
 
     if (ne < 0) {
       throw runtime_error("RDMA polling from CQ failed!");
@@ -322,7 +463,7 @@ void ReliableRDMA::compareAndSwap(const rdmaConnID rdmaConnID, size_t offset,
             "RDMA completion event in CQ with error! Error nr: " +
             std::string(std::strerror(errno)));
       }
-    } while (ne == 0);
+    } while (ne == 0 || (ne > 0 && creditBulkCompletion(wc)));
 
     if (ne < 0) {
       throw runtime_error("RDMA polling from CQ failed!");
@@ -389,7 +530,7 @@ void ReliableRDMA::sendImpl(const rdmaConnID rdmaConnID, const void *memAddr, si
                             " errno: " + std::string(std::strerror(errno)));
       }
 
-    } while (ne == 0);
+    } while (ne == 0 || (ne > 0 && creditBulkCompletion(wc)));
 
     if (ne < 0) {
       throw runtime_error("RDMA polling from CQ failed!");
@@ -472,7 +613,7 @@ void ReliableRDMA::pollSend(const rdmaConnID rdmaConnID, bool doPoll, uint32_t *
       throw runtime_error("RDMA completion event in CQ with error! " +
                           to_string(wc.status));
     }
-  } while (ne == 0 && doPoll);
+  } while ((ne == 0 && doPoll) || (ne > 0 && creditBulkCompletion(wc)));
 
   if(imm != nullptr && ne > 0){
     *imm = wc.imm_data;
@@ -492,6 +633,10 @@ void ReliableRDMA::pollSend(const rdmaConnID rdmaConnID, bool doPoll, uint32_t *
 //------------------------------------------------------------------------------------//
 
 void ReliableRDMA::createQP(struct ib_qp_t *qp) {
+  createQP(qp, m_buffer->ib_pd());
+}
+
+void ReliableRDMA::createQP(struct ib_qp_t *qp, struct ibv_pd *pd) {
   // initialize QP attributes
   struct ibv_device_attr device_attr;
   struct ibv_qp_init_attr qp_init_attr;
@@ -500,7 +645,7 @@ void ReliableRDMA::createQP(struct ib_qp_t *qp) {
   // m_res.device_attr.comp_mask |= IBV_EXP_DEVICE_ATTR_EXT_ATOMIC_ARGS
   //         | IBV_EXP_DEVICE_ATTR_EXP_CAP_FLAGS;
 
-  if (ibv_query_device(m_buffer->ib_context(), &(device_attr))) {
+  if (ibv_query_device(pd->context, &(device_attr))) {
     throw runtime_error("Error, ibv_query_device() failed");
   }
 
@@ -526,7 +671,7 @@ void ReliableRDMA::createQP(struct ib_qp_t *qp) {
   qp_init_attr.cap.max_recv_sge = Config::RDMA_MAX_SGE;
 
   // create queue pair
-  if (!(qp->qp = ibv_create_qp(m_buffer->ib_pd(), &qp_init_attr))) {
+  if (!(qp->qp = ibv_create_qp(pd, &qp_init_attr))) {
     throw runtime_error("Cannot create queue pair!");
   }
 }
@@ -534,13 +679,17 @@ void ReliableRDMA::createQP(struct ib_qp_t *qp) {
 //------------------------------------------------------------------------------------//
 
 void ReliableRDMA::modifyQPToInit(struct ibv_qp *qp) {
+  modifyQPToInit(qp, m_buffer->getIBPort());
+}
+
+void ReliableRDMA::modifyQPToInit(struct ibv_qp *qp, int ibPort) {
   int flags =
       IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT | IBV_QP_ACCESS_FLAGS;
   struct ibv_qp_attr attr;
 
   memset(&attr, 0, sizeof(attr));
   attr.qp_state = IBV_QPS_INIT;
-  attr.port_num = m_buffer->getIBPort();
+  attr.port_num = ibPort;
   attr.pkey_index = 0;
   attr.qp_access_flags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ |
                          IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_REMOTE_ATOMIC;
@@ -554,12 +703,18 @@ void ReliableRDMA::modifyQPToInit(struct ibv_qp *qp) {
 
 void ReliableRDMA::modifyQPToRTR(struct ibv_qp *qp, uint32_t remote_qpn,
                                  uint16_t dlid, uint8_t *dgid) {
+  modifyQPToRTR(qp, remote_qpn, dlid, dgid, m_buffer->getIBPort(), m_gidIdx, getPathMTU());
+}
+
+void ReliableRDMA::modifyQPToRTR(struct ibv_qp *qp, uint32_t remote_qpn,
+                                 uint16_t dlid, uint8_t *dgid, int ibPort,
+                                 int gidIdx, ibv_mtu mtu) {
   struct ibv_qp_attr attr;
   int flags = IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU | IBV_QP_DEST_QPN |
               IBV_QP_RQ_PSN | IBV_QP_MAX_DEST_RD_ATOMIC | IBV_QP_MIN_RNR_TIMER;
   memset(&attr, 0, sizeof(attr));
   attr.qp_state = IBV_QPS_RTR;
-  attr.path_mtu = IBV_MTU_4096;
+  attr.path_mtu = mtu;
   attr.dest_qp_num = remote_qpn;
   attr.rq_psn = 0;
   attr.max_dest_rd_atomic = 16;
@@ -568,14 +723,13 @@ void ReliableRDMA::modifyQPToRTR(struct ibv_qp *qp, uint32_t remote_qpn,
   attr.ah_attr.dlid = dlid;
   attr.ah_attr.sl = 0;
   attr.ah_attr.src_path_bits = 0;
-  attr.ah_attr.port_num = m_buffer->getIBPort();
-  if (-1 != m_gidIdx) {
+  attr.ah_attr.port_num = ibPort;
+  if (-1 != gidIdx) {
     attr.ah_attr.is_global = 1;
-    attr.ah_attr.port_num = 1;
     memcpy(&attr.ah_attr.grh.dgid, dgid, 16);
     attr.ah_attr.grh.flow_label = 0;
-    attr.ah_attr.grh.hop_limit = 1;
-    attr.ah_attr.grh.sgid_index = m_gidIdx;
+    attr.ah_attr.grh.hop_limit = 64; // RoCEv2 is routable
+    attr.ah_attr.grh.sgid_index = gidIdx;
     attr.ah_attr.grh.traffic_class = 0;
   }
 
@@ -596,7 +750,7 @@ void ReliableRDMA::modifyQPToRTS(struct ibv_qp *qp) {
   attr.qp_state = IBV_QPS_RTS;
   attr.timeout = 0x12;
   attr.retry_cnt = 6;
-  attr.rnr_retry = 0;
+  attr.rnr_retry = Config::RDMA_RNR_RETRY;
   attr.sq_psn = 0;
   attr.max_rd_atomic = 16;
 
@@ -653,7 +807,7 @@ void rdma::ReliableRDMA::fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
                             to_string(wc.status) +
                             " errno: " + std::string(std::strerror(errno)));
       }
-    } while (ne == 0);
+    } while (ne == 0 || (ne > 0 && creditBulkCompletion(wc)));
 
     if (ne < 0) {
       throw runtime_error("RDMA polling from CQ failed!");
@@ -920,14 +1074,11 @@ void ReliableRDMA::initQPForSRQWithSuppliedID(size_t srq_id,
 
   // create local connection data
   struct ib_conn_t localConn;
-  union ibv_gid my_gid;
-  memset(&my_gid, 0, sizeof my_gid);
-
   localConn.buffer = (uint64_t)m_buffer->pointer();
   localConn.rc.rkey = m_buffer->ib_mr()->rkey;
   localConn.qp_num = qp.qp->qp_num;
   localConn.lid = m_buffer->ib_port_attributes().lid;
-  memcpy(localConn.gid, &my_gid, sizeof my_gid);
+  getLocalGid(localConn.gid);
 
   // init queue pair
   modifyQPToInit(qp.qp);
@@ -9,6 +9,7 @@
 
 #include "../utils/Config.h"
 #include <atomic>
+#include <deque>
 #include "BaseRDMA.h"
 
 namespace rdma {
@@ -18,6 +19,36 @@ struct sharedrq_t {
   ibv_cq* recv_cq;
 };
 
+/* Struct: bulk_transfer_t
+ * ----------------
+ * State of a chunked write/read, see ReliableRDMA::startBulkWrite().
+ * Must not be destroyed before the transfer is complete, as its
+ * tagged address is the wr_id of the posted chunks.
+ */
+struct bulk_transfer_t {
+  size_t connID = 0;
+  uint64_t remoteAddr = 0;
+  uint64_t localAddr = 0;
+  size_t size = 0;
+  ibv_wr_opcode verb = IBV_WR_RDMA_WRITE;
+
+  size_t chunkSize = 0;
+  size_t chunks = 0;
+  size_t postedChunks = 0;
+  size_t completedChunks = 0;
+  size_t retiredChunks = 0;  // completed chunks no longer counted as WRs of the connection
+  std::deque<size_t> signaledChunks;  // posted signaled chunks in posting order
+
+  bool isComplete() const { return completedChunks == chunks; }
+
+  void creditCompletion() {
+    // completions of a QP arrive in order, i.e. all chunks
+    // up to the signaled one are complete
+    completedChunks = signaledChunks.front() + 1;
+    signaledChunks.pop_front();
+  }
+};
+
 class ReliableRDMA : public BaseRDMA {
  public:
   ReliableRDMA(size_t mem_size=Config::RDMA_MEMSIZE);
@@ -51,7 +82,8 @@ class ReliableRDMA : public BaseRDMA {
    * rdmaConnID:  id of the remote
    * offset:      offset on the remote side where to start writing
    * memAddr:     address of the local array that should be transfered
-   * size:        how many bytes should be transfered
+   * size:        how many bytes should be transfered, at most the max
+   *              message size of the port (see writeBulk())
    * signaled:    if true the function blocks until the write request was
    *              processed by the NIC. Multiple writes can be called and 
    *              the last one should always be signaled=true.
@@ -90,7 +122,8 @@ class ReliableRDMA : public BaseRDMA {
    * rdmaConnID:  id of the remote
    * offset:      offset on the remote side where to start reading
    * memAddr:     address of local array where the data should be stored
-   * size:        how many bytes should be transfered
+   * size:        how many bytes should be transfered, at most the max
+   *              message size of the port (see readBulk())
    * signaled:    if true the function blocks until the read has fully been 
    *              completed. Multiple reads can be called and 
    *              the last one should always be signaled=true. 
@@ -103,6 +136,67 @@ class ReliableRDMA : public BaseRDMA {
 
   void requestRead(const rdmaConnID rdmaConnID, size_t offset,
                    const void* memAddr, size_t size);
+
+  /* Function: writeBulk
+   * ----------------
+   * Writes data of any size in chunks of Config::RDMA_BULK_CHUNK_SIZE
+   * (at most the max message size of the port) with a window of
+   * Config::RDMA_BULK_WINDOW outstanding chunks. Blocks until
+   * the whole transfer completed.
+   *
+   * rdmaConnID:  id of the remote
+   * offset:      offset on the remote side where to start writing
+   * memAddr:     address of the local array that should be transfered
+   * size:        how many bytes should be transfered
+   */
+  void writeBulk(const rdmaConnID rdmaConnID, size_t offset, const void* memAddr,
+                 size_t size);
+
+  /* Function: readBulk
+   * ----------------
+   * Reads data of any size in chunks, see writeBulk()
+   */
+  void readBulk(const rdmaConnID rdmaConnID, size_t offset, const void* memAddr,
+                size_t size);
+
+  /* Function: startBulkWrite
+   * ----------------
+   * Starts a chunked write without blocking. The transfer is
+   * driven by progressBulk(), other operations can be posted on the
+   * same connection between the calls, so they only wait for at most
+   * Config::RDMA_BULK_WINDOW chunks instead of the whole transfer.
+   * Operations which are polled later (e.g. requestRead()) must not
+   * be outstanding while a bulk transfer progresses.
+   *
+   * transfer:    state of the transfer, must be kept until complete
+   * rdmaConnID:  id of the remote
+   * offset:      offset on the remote side where to start writing
+   * memAddr:     address of the local array that should be transfered
+   * size:        how many bytes should be transfered
+   */
+  void startBulkWrite(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                      size_t offset, const void* memAddr, size_t size);
+
+  /* Function: startBulkRead
+   * ----------------
+   * Starts a chunked read without blocking, see startBulkWrite()
+   */
+  void startBulkRead(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                     size_t offset, const void* memAddr, size_t size);
+
+  /* Function: progressBulk
+   * ----------------
+   * Posts chunks of a bulk transfer until the window is full and
+   * polls for completions. Only every Config::RDMA_BULK_WINDOW / 2
+   * chunk and the last chunk are signaled. Chunks in flight count as
+   * outstanding WRs of the connection like unsignaled operations,
+   * so the window shrinks if the send queue has less room.
+   *
+   * transfer:  started transfer
+   * doPoll:    if true the function blocks until the transfer completed
+   * return:    true if the transfer completed
+   */
+  bool progressBulk(bulk_transfer_t &transfer, bool doPoll = false);
  
   /* Function: fetchAndAdd
    * ----------------
@@ -275,6 +369,31 @@ class ReliableRDMA : public BaseRDMA {
   void createSharedReceiveQueue(size_t& ret_srq_id);
 
  protected:
+  // low bit of the wr_id of bulk chunks, other wr_ids (0 or
+  // aligned pointers of subclasses) never have it set
+  static const uint64_t BULK_WR_ID_TAG = 1;
+
+  /* Function: creditBulkCompletion
+   * ----------------
+   * Send completions of bulk transfers carry the transfer tagged
+   * with BULK_WR_ID_TAG as wr_id. Polling loops pass completions
+   * of bulk transfers on to them.
+   *
+   * return:  true if the completion belongs to a bulk transfer
+   */
+  static inline bool __attribute__((always_inline))
+  creditBulkCompletion(const struct ibv_wc &wc) {
+    if ((wc.wr_id & BULK_WR_ID_TAG) == 0) {
+      return false;
+    }
+    ((bulk_transfer_t *)(wc.wr_id & ~BULK_WR_ID_TAG))->creditCompletion();
+    return true;
+  }
+
+  void startBulk(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID, size_t offset,
+                 const void* memAddr, size_t size, enum ibv_wr_opcode verb);
+  void postBulkChunks(bulk_transfer_t &transfer);
+
   // RDMA operations
   inline void __attribute__((always_inline))
   remoteAccess(const rdmaConnID rdmaConnID, size_t offset, const void* memAddr,
@@ -333,7 +452,7 @@ class ReliableRDMA : public BaseRDMA {
           __asm__("pause");
         }
 #endif
-      } while (ne == 0);
+      } while (ne == 0 || (ne > 0 && creditBulkCompletion(wc)));
 
       if (ne < 0) {
         throw runtime_error("RDMA polling from CQ failed!");
@@ -346,10 +465,14 @@ class ReliableRDMA : public BaseRDMA {
 
   virtual void destroyQPs() override;
   void createQP(struct ib_qp_t* qp) override;
+  void createQP(struct ib_qp_t* qp, struct ibv_pd* pd);
   void createQP(size_t srq_id, struct ib_qp_t& qp);
   void modifyQPToInit(struct ibv_qp* qp);
+  void modifyQPToInit(struct ibv_qp* qp, int ibPort);
   void modifyQPToRTR(struct ibv_qp* qp, uint32_t remote_qpn, uint16_t dlid,
                      uint8_t* dgid);
+  void modifyQPToRTR(struct ibv_qp* qp, uint32_t remote_qpn, uint16_t dlid,
+                     uint8_t* dgid, int ibPort, int gidIdx, ibv_mtu mtu);
   void modifyQPToRTS(struct ibv_qp* qp);
 
   // shared receive queues
@@ -359,6 +482,8 @@ class ReliableRDMA : public BaseRDMA {
 
   std::mutex m_qpLock;
 
+  size_t m_maxMsgSize = SIZE_MAX;  // of the port, larger writes/reads need writeBulk()/readBulk()
+
 };
 
 }  // namespace rdma
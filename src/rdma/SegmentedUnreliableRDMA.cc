@@ -0,0 +1,292 @@
+#include "SegmentedUnreliableRDMA.h"
+#include "../utils/Logging.h"
+
+#ifndef HUGEPAGE
+#define HUGEPAGE false
+#endif
+
+using namespace rdma;
+
+// segments posted with one doorbell, the last one is signaled
+static const size_t UD_SEGMENT_BATCH = 32;
+// completions processed per call of ibv_poll_cq
+static const int UD_POLL_BATCH = 16;
+
+//------------------------------------------------------------------------------------//
+
+SegmentedUnreliableRDMA::SegmentedUnreliableRDMA(size_t mem_size) : SegmentedUnreliableRDMA(mem_size, (int)MEMORY_TYPE::MAIN, HUGEPAGE, (int)Config::RDMA_NUMAREGION) {}
+SegmentedUnreliableRDMA::SegmentedUnreliableRDMA(size_t mem_size, int mem_type, bool huge, int numaNode) : UnreliableRDMA(mem_size, mem_type, huge, numaNode) {
+  initSegments();
+}
+SegmentedUnreliableRDMA::SegmentedUnreliableRDMA(BaseMemory *buffer) : UnreliableRDMA(buffer) {
+  initSegments();
+}
+
+//------------------------------------------------------------------------------------//
+
+SegmentedUnreliableRDMA::~SegmentedUnreliableRDMA() {
+  // receives stay posted until the QP is destroyed, the memory stays registered
+  if (!m_recvSegments.isnull) {
+    m_buffer->free(m_recvSegments.offset);
+  }
+  // send buffers of the threads are released with their QPs
+}
+
+//------------------------------------------------------------------------------------//
+
+void SegmentedUnreliableRDMA::initSegments() {
+  size_t pathMTU = 128 << getPathMTU();
+  m_segmentSize = std::min<size_t>(Config::RDMA_UD_MTU, pathMTU);
+  if (m_segmentSize <= sizeof(ud_segment_hdr_t)) {
+    throw runtime_error("SegmentedUnreliableRDMA: UD MTU too small! MTU: " + to_string(m_segmentSize));
+  }
+  m_segmentPayload = m_segmentSize - sizeof(ud_segment_hdr_t);
+
+  // FNV-1a of LID and GID
+  m_sender = 2166136261u;
+  for (size_t i = 0; i < sizeof(m_udqpConn.gid); ++i) {
+    m_sender = (m_sender ^ m_udqpConn.gid[i]) * 16777619u;
+  }
+  m_sender = (m_sender ^ m_udqpConn.lid) * 16777619u;
+
+  m_recvSegmentCount = std::min<size_t>(Config::RDMA_UD_RECV_SEGMENTS, Config::RDMA_MAX_WR);
+  m_recvSegments = m_buffer->internalAlloc(m_recvSegmentCount * (Config::RDMA_UD_OFFSET + m_segmentSize));
+  if (m_recvSegments.isnull) {
+    throw runtime_error("SegmentedUnreliableRDMA allocating segment buffers failed! Receives: " +
+                        to_string(m_recvSegmentCount));
+  }
+
+  for (size_t i = 0; i < m_recvSegmentCount; ++i) {
+    postSegmentReceive(i);
+  }
+  Logging::debug(__FILE__, __LINE__, "SegmentedUnreliableRDMA: segment payload " + to_string(m_segmentPayload) +
+                                         ", posted " + to_string(m_recvSegmentCount) + " receives");
+}
+
+//------------------------------------------------------------------------------------//
+
+void SegmentedUnreliableRDMA::postSegmentReceive(size_t segment) {
+  struct ibv_sge sge;
+  struct ibv_recv_wr wr;
+  struct ibv_recv_wr *bad_wr;
+
+  memset(&sge, 0, sizeof(sge));
+  sge.addr = (uintptr_t)m_buffer->pointer() + m_recvSegments.offset + segment * (Config::RDMA_UD_OFFSET + m_segmentSize);
+  sge.length = Config::RDMA_UD_OFFSET + m_segmentSize;
+  sge.lkey = m_buffer->ib_mr()->lkey;
+
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = segment;
+  wr.sg_list = &sge;
+  wr.num_sge = 1;
+
+  if ((errno = ibv_post_recv(m_udqp.qp, &wr, &bad_wr)) != 0) {
+    throw runtime_error("RECV has not been posted successfully in postSegmentReceive()! errno: " +
+                        std::string(std::strerror(errno)));
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void SegmentedUnreliableRDMA::sendMessage(const rdmaConnID rdmaConnID, const void *memAddr, size_t size) {
+  size_t segments = (size + m_segmentPayload - 1) / m_segmentPayload;
+  segments = segments == 0 ? 1 : segments;
+  if (segments > UINT16_MAX || size > UINT32_MAX) {
+    throw runtime_error("SegmentedUnreliableRDMA: message too large! Size: " + to_string(size));
+  }
+
+  // headers are in the send buffer of the thread, so threads send without locking
+  ud_thread_qp_t &localQP = getThreadQP();
+  if (localQP.sendBuffer.isnull) {
+    localQP.sendBuffer = m_buffer->internalAlloc(UD_SEGMENT_BATCH * sizeof(ud_segment_hdr_t));
+    if (localQP.sendBuffer.isnull) {
+      throw runtime_error("SegmentedUnreliableRDMA allocating segment headers failed!");
+    }
+  }
+  struct ib_conn_t &remoteConn = m_rconns[rdmaConnID];
+  uint32_t msgID = m_nextMsgID++;
+  auto headers = (ud_segment_hdr_t *)((char *)m_buffer->pointer() + localQP.sendBuffer.offset);
+  uint32_t lkey = m_buffer->ib_mr()->lkey;
+
+  struct ibv_send_wr sr[UD_SEGMENT_BATCH];
+  struct ibv_sge sge[UD_SEGMENT_BATCH][2];
+
+  for (size_t first = 0; first < segments; first += UD_SEGMENT_BATCH) {
+    size_t count = std::min(UD_SEGMENT_BATCH, segments - first);
+    memset(sr, 0, sizeof(sr[0]) * count);
+    for (size_t i = 0; i < count; ++i) {
+      size_t segment = first + i;
+      size_t offset = segment * m_segmentPayload;
+      ud_segment_hdr_t &hdr = headers[i];
+      hdr.sender = m_sender;
+      hdr.msgID = msgID;
+      hdr.size = size;
+      hdr.offset = offset;
+      hdr.segment = segment;
+      hdr.segments = segments;
+
+      sge[i][0].addr = (uintptr_t)&hdr;
+      sge[i][0].length = sizeof(ud_segment_hdr_t);
+      sge[i][0].lkey = lkey;
+      sge[i][1].addr = (uintptr_t)memAddr + offset;
+      sge[i][1].length = std::min(m_segmentPayload, size - offset);
+      sge[i][1].lkey = lkey;
+
+      sr[i].sg_list = sge[i];
+      sr[i].num_sge = sge[i][1].length > 0 ? 2 : 1;
+      sr[i].opcode = IBV_WR_SEND;
+      sr[i].wr.ud.ah = remoteConn.ud.ah;
+      sr[i].wr.ud.remote_qpn = remoteConn.qp_num;
+      sr[i].wr.ud.remote_qkey = 0x11111111;
+    }
+    // signaled and waited for, the headers are reused by the next batch
+    postThreadSend(localQP, sr, count, true);
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void SegmentedUnreliableRDMA::receiveMessage(const void *memAddr, size_t size) {
+  std::unique_lock<std::mutex> lck(m_recvMsgLock);
+  m_msgBuffers.push_back(msg_buffer_t{(char *)memAddr, size});
+}
+
+//------------------------------------------------------------------------------------//
+
+bool SegmentedUnreliableRDMA::cancelReceiveMessage(const void *memAddr) {
+  std::unique_lock<std::mutex> lck(m_recvMsgLock);
+  for (auto it = m_msgBuffers.begin(); it != m_msgBuffers.end(); ++it) {
+    if (it->memAddr == memAddr) {
+      m_msgBuffers.erase(it);
+      return true;
+    }
+  }
+  for (auto it = m_reassembly.begin(); it != m_reassembly.end(); ++it) {
+    if (it->second.buffer.memAddr == memAddr) {
+      m_reassembly.erase(it);
+      return true;
+    }
+  }
+  for (auto it = m_receivedMsgs.begin(); it != m_receivedMsgs.end(); ++it) {
+    if (it->memAddr == memAddr) {
+      m_receivedMsgs.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------------//
+
+bool SegmentedUnreliableRDMA::pollReceiveMessage(ud_message_t &message, bool doPoll) {
+  std::unique_lock<std::mutex> lck(m_recvMsgLock);
+  struct ibv_wc wc[UD_POLL_BATCH];
+  while (m_receivedMsgs.empty()) {
+    int ne = ibv_poll_cq(m_udqp.recv_cq, UD_POLL_BATCH, wc);
+    if (ne < 0) {
+      throw runtime_error("RDMA polling from CQ failed!");
+    }
+    for (int i = 0; i < ne; ++i) {
+      if (wc[i].status != IBV_WC_SUCCESS) {
+        throw runtime_error("RDMA completion event in CQ with error in pollReceiveMessage()! " +
+                            to_string(wc[i].status));
+      }
+      handleSegment(wc[i]);
+      postSegmentReceive(wc[i].wr_id);
+    }
+    expireMessages();
+
+    if (!doPoll) {
+      break;
+    }
+  }
+
+  if (m_receivedMsgs.empty()) {
+    return false;
+  }
+  message = m_receivedMsgs.front();
+  m_receivedMsgs.pop_front();
+  return true;
+}
+
+//------------------------------------------------------------------------------------//
+
+void SegmentedUnreliableRDMA::handleSegment(const struct ibv_wc &wc) {
+  if (wc.byte_len < Config::RDMA_UD_OFFSET + sizeof(ud_segment_hdr_t)) {
+    Logging::debug(__FILE__, __LINE__, "SegmentedUnreliableRDMA: dropped segment without header");
+    return;
+  }
+  const char *segment = (char *)m_buffer->pointer() + m_recvSegments.offset +
+                        wc.wr_id * (Config::RDMA_UD_OFFSET + m_segmentSize) + Config::RDMA_UD_OFFSET;
+  ud_segment_hdr_t hdr;
+  memcpy(&hdr, segment, sizeof(hdr));
+  size_t payload = wc.byte_len - Config::RDMA_UD_OFFSET - sizeof(ud_segment_hdr_t);
+  // a segment sits at its fixed position in the message, so segments
+  // with the same index can't overlap or leave gaps
+  if (hdr.segment >= hdr.segments || (size_t)hdr.offset != hdr.segment * m_segmentPayload ||
+      (size_t)hdr.offset + payload > hdr.size) {
+    Logging::debug(__FILE__, __LINE__, "SegmentedUnreliableRDMA: dropped invalid segment");
+    return;
+  }
+
+  msg_key_t key(((uint64_t)wc.src_qp << 32) | hdr.sender, hdr.msgID);
+  auto it = m_reassembly.find(key);
+  if (it == m_reassembly.end()) {
+    if (m_msgBuffers.empty()) {
+      Logging::debug(__FILE__, __LINE__, "SegmentedUnreliableRDMA: dropped segment, no message buffer");
+      return;
+    }
+    if (m_msgBuffers.front().size < hdr.size) {
+      Logging::debug(__FILE__, __LINE__, "SegmentedUnreliableRDMA: dropped segment, message of " +
+                                             to_string(hdr.size) + " bytes exceeds buffer");
+      return;
+    }
+    reassembly_t reassembly;
+    reassembly.buffer = m_msgBuffers.front();
+    reassembly.size = hdr.size;
+    reassembly.srcQPN = wc.src_qp;
+    reassembly.segments.resize(hdr.segments, false);
+    m_msgBuffers.pop_front();
+    it = m_reassembly.emplace(key, std::move(reassembly)).first;
+  }
+
+  // later segments must describe the message of the first one, otherwise they don't fit into its buffer
+  reassembly_t &reassembly = it->second;
+  if (hdr.size != reassembly.size || (size_t)hdr.offset + payload > reassembly.size ||
+      hdr.segments != reassembly.segments.size()) {
+    Logging::debug(__FILE__, __LINE__, "SegmentedUnreliableRDMA: dropped segment not matching its message");
+    return;
+  }
+  if (reassembly.segments[hdr.segment]) {
+    return;
+  }
+  memcpy(reassembly.buffer.memAddr + hdr.offset, segment + sizeof(ud_segment_hdr_t), payload);
+  reassembly.segments[hdr.segment] = true;
+  reassembly.lastSegment = std::chrono::steady_clock::now();
+
+  if (++reassembly.received == reassembly.segments.size()) {
+    m_receivedMsgs.push_back(ud_message_t{reassembly.buffer.memAddr, reassembly.size, reassembly.srcQPN});
+    m_reassembly.erase(it);
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+void SegmentedUnreliableRDMA::expireMessages() {
+  if (m_reassembly.empty()) {
+    return;
+  }
+  auto deadline = std::chrono::steady_clock::now() - std::chrono::microseconds(Config::RDMA_UD_REASSEMBLY_TIMEOUT);
+  for (auto it = m_reassembly.begin(); it != m_reassembly.end();) {
+    if (it->second.lastSegment < deadline) {
+      Logging::debug(__FILE__, __LINE__, "SegmentedUnreliableRDMA: dropped message after " +
+                                             to_string(it->second.received) + " of " +
+                                             to_string(it->second.segments.size()) + " segments");
+      // buffer is used for the next message
+      m_msgBuffers.push_front(it->second.buffer);
+      it = m_reassembly.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
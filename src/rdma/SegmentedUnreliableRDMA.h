@@ -0,0 +1,156 @@
+/**
+ * @file SegmentedUnreliableRDMA.h
+ */
+
+#ifndef SegmentedUnreliableRDMA_H_
+#define SegmentedUnreliableRDMA_H_
+
+#include "../utils/Config.h"
+#include "UnreliableRDMA.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace rdma {
+
+/* Class: SegmentedUnreliableRDMA
+ * ----------------
+ * Unreliable RDMA for messages larger than one UD MTU. A message is
+ * sent as segments of at most Config::RDMA_UD_MTU bytes (limited by
+ * the MTU of the port), each carrying the message ID of the sender,
+ * its offset and the size of the message. The payload is not copied
+ * on the sender.
+ *
+ * The receiver keeps Config::RDMA_UD_RECV_SEGMENTS receives posted
+ * for segments and reassembles the messages into the buffers given to
+ * receiveMessage. A message takes the next free buffer when its first
+ * segment arrives, messages of different senders can be reassembled
+ * concurrently and complete in the order their last segment arrives.
+ * Messages whose segments stop arriving for more than
+ * Config::RDMA_UD_REASSEMBLY_TIMEOUT microseconds are dropped and
+ * their buffer is reused. Segments arriving while no buffer is free
+ * are dropped, i.e. a message is delivered completely or not at all.
+ *
+ * The raw receive of UnreliableRDMA must not be used together with
+ * messages, since both use the receive queue of the same QP.
+ */
+class SegmentedUnreliableRDMA : public UnreliableRDMA {
+ public:
+  // message returned by pollReceiveMessage
+  struct ud_message_t {
+    void *memAddr;    // buffer given to receiveMessage
+    size_t size;      // size of the message
+    uint32_t srcQPN;  // UD QP of the sender
+  };
+
+  SegmentedUnreliableRDMA(size_t mem_size = Config::RDMA_MEMSIZE);
+  SegmentedUnreliableRDMA(size_t mem_size, int mem_type, bool huge, int numaNode);
+  SegmentedUnreliableRDMA(BaseMemory *buffer);
+  ~SegmentedUnreliableRDMA();
+
+  /* Function: sendMessage
+   * ----------------
+   * Sends a message of any size (up to 65535 segments) as UD
+   * segments on the UD QP of the calling thread. Returns when
+   * all segments are sent. Thread safe.
+   *
+   * rdmaConnID:  id of the remote
+   * memAddr:     message, must be in the RDMA buffer (e.g. localAlloc)
+   * size:        size of the message
+   */
+  void sendMessage(const rdmaConnID rdmaConnID, const void *memAddr, size_t size);
+
+  /* Function: receiveMessage
+   * ----------------
+   * Provides a buffer for the next incoming message.
+   * The buffer does not need to be in the RDMA buffer.
+   *
+   * memAddr:  buffer for the message
+   * size:     size of the buffer, larger messages are dropped
+   */
+  void receiveMessage(const void *memAddr, size_t size);
+
+  /* Function: cancelReceiveMessage
+   * ----------------
+   * Withdraws a buffer given to receiveMessage, e.g. before it
+   * is freed. A message which is reassembled into the buffer
+   * or was received but not polled yet is dropped.
+   *
+   * memAddr:  buffer given to receiveMessage
+   * return:   true if the buffer was withdrawn
+   */
+  bool cancelReceiveMessage(const void *memAddr);
+
+  /* Function: pollReceiveMessage
+   * ----------------
+   * Processes incoming segments and returns the next completely
+   * received message. Thread safe.
+   *
+   * message:  received message
+   * doPoll:   if true then function blocks until
+   *           a message has arrived
+   * return:   true if a message was received
+   */
+  bool pollReceiveMessage(ud_message_t &message, bool doPoll = true);
+
+  /* Function: getSegmentPayload
+   * ----------------
+   * Returns the payload of one segment, messages up to this
+   * size are sent with a single UD send
+   */
+  size_t getSegmentPayload() { return m_segmentPayload; }
+
+ protected:
+  // header in front of the payload of every segment
+  struct ud_segment_hdr_t {
+    uint32_t sender;  // hash of LID and GID of the sender
+    uint32_t msgID;
+    uint32_t size;    // size of the message
+    uint32_t offset;  // offset of the payload in the message
+    uint16_t segment;
+    uint16_t segments;
+  };
+
+  struct msg_buffer_t {
+    char *memAddr;
+    size_t size;
+  };
+
+  struct reassembly_t {
+    msg_buffer_t buffer;
+    uint32_t size;
+    uint32_t srcQPN;
+    size_t received = 0;
+    std::vector<bool> segments;  // segments already copied
+    std::chrono::steady_clock::time_point lastSegment;
+  };
+
+  // messages are identified by QP number and hash of the sender and the message ID
+  typedef std::pair<uint64_t, uint32_t> msg_key_t;
+
+  void initSegments();
+  void postSegmentReceive(size_t segment);
+  void handleSegment(const struct ibv_wc &wc);
+  void expireMessages();
+
+  size_t m_segmentSize = 0;     // header and payload
+  size_t m_segmentPayload = 0;  // payload of a segment
+
+  uint32_t m_sender = 0;
+  std::atomic<uint32_t> m_nextMsgID{0};
+
+  std::mutex m_recvMsgLock;
+  rdma_mem_t m_recvSegments;  // posted receives, each with GRH and segment
+  size_t m_recvSegmentCount = 0;
+  std::deque<msg_buffer_t> m_msgBuffers;  // buffers for the next messages
+  std::map<msg_key_t, reassembly_t> m_reassembly;
+  std::deque<ud_message_t> m_receivedMsgs;
+};
+
+}  // namespace rdma
+
+#endif /* SegmentedUnreliableRDMA_H_ */
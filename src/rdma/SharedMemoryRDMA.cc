@@ -0,0 +1,436 @@
+#include "SharedMemoryRDMA.h"
+#include "../utils/Logging.h"
+
+#include <fstream>
+#include <unistd.h>
+
+#ifndef HUGEPAGE
+#define HUGEPAGE false
+#endif
+
+using namespace rdma;
+
+//------------------------------------------------------------------------------------//
+
+SharedMemoryRDMA::SharedMemoryRDMA(size_t mem_size) : SharedMemoryRDMA(mem_size, HUGEPAGE){}
+SharedMemoryRDMA::SharedMemoryRDMA(size_t mem_size, int numaNode) : SharedMemoryRDMA(mem_size, HUGEPAGE, numaNode){}
+SharedMemoryRDMA::SharedMemoryRDMA(size_t mem_size, bool huge) : SharedMemoryRDMA(mem_size, huge, (int)Config::RDMA_NUMAREGION){}
+SharedMemoryRDMA::SharedMemoryRDMA(size_t mem_size, bool huge, int numaNode) : SharedMemoryRDMA(mem_size, MEMORY_TYPE::MAIN, huge, numaNode){}
+SharedMemoryRDMA::SharedMemoryRDMA(size_t mem_size, MEMORY_TYPE mem_type) : SharedMemoryRDMA(mem_size, (int)mem_type, HUGEPAGE, (int)Config::RDMA_NUMAREGION){}
+SharedMemoryRDMA::SharedMemoryRDMA(size_t mem_size, MEMORY_TYPE mem_type, bool huge, int numaNode) : SharedMemoryRDMA(mem_size, (int)mem_type, huge, numaNode){}
+SharedMemoryRDMA::SharedMemoryRDMA(size_t mem_size, int mem_type, bool huge, int numaNode) : ReliableRDMA(createBuffer(mem_size, mem_type, huge, numaNode)){
+  m_buffer_owner = true;
+  m_sharedBuffer = dynamic_cast<SharedMemory *>(m_buffer);
+  m_hostID = getHostID();
+}
+SharedMemoryRDMA::SharedMemoryRDMA(BaseMemory *buffer) : ReliableRDMA(buffer) {
+  m_sharedBuffer = dynamic_cast<SharedMemory *>(buffer);
+  m_hostID = getHostID();
+}
+
+//------------------------------------------------------------------------------------//
+
+SharedMemoryRDMA::~SharedMemoryRDMA() {
+  std::unique_lock<std::mutex> lck(m_shmLock);
+  for (auto &conn : m_shmConns) {
+    disconnectLocal(conn);
+  }
+  m_shmConns.clear();
+  for (auto &pending : m_pendingQueues) {
+    SharedMemory::closeSegment(getQueueName(getpid(), m_sharedBuffer->getSegmentID(), pending.first),
+                               pending.second.queue, pending.second.size, true);
+  }
+  m_pendingQueues.clear();
+}
+
+//------------------------------------------------------------------------------------//
+
+SharedMemory *SharedMemoryRDMA::createBuffer(size_t mem_size, int mem_type, bool huge, int numaNode) {
+  if (mem_type > (int)MEMORY_TYPE::MAIN) {
+    throw runtime_error("SharedMemoryRDMA only supports main memory");
+  }
+  // without device the buffer is only shared, not registered
+  return new SharedMemory(isDeviceAvailable(), mem_size, huge, numaNode);
+}
+
+//------------------------------------------------------------------------------------//
+
+bool SharedMemoryRDMA::isDeviceAvailable() {
+  int num_devices = 0;
+  struct ibv_device **dev_list = ibv_get_device_list(&num_devices);
+  if (dev_list == nullptr) {
+    return false;
+  }
+  ibv_free_device_list(dev_list);
+  return num_devices > 0;
+}
+
+//------------------------------------------------------------------------------------//
+
+uint64_t SharedMemoryRDMA::getHostID() {
+  static const uint64_t hostID = [] {
+    std::string bootID;
+    std::ifstream bootIDFile("/proc/sys/kernel/random/boot_id");
+    bootIDFile >> bootID;
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+
+    // FNV-1a, has to be the same in every process
+    std::string host = bootID + "/" + hostname;
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : host) {
+      hash ^= (uint8_t)c;
+      hash *= 1099511628211ULL;
+    }
+    return hash == 0 ? 1 : hash;  // zero marks a buffer which is not shared
+  }();
+  return hostID;
+}
+
+//------------------------------------------------------------------------------------//
+
+std::string SharedMemoryRDMA::getQueueName(uint32_t pid, uint32_t segmentID, uint32_t queueID) {
+  return SharedMemory::getSegmentName(pid, segmentID) + ".q" + to_string(queueID);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::initLocalConnData(struct ib_conn_t &localConn) {
+  if (m_sharedBuffer == nullptr) {
+    return;  // connections always use QPs
+  }
+
+  // receive queue of this side, the peer maps it on connect
+  uint64_t capacity = Config::RDMA_MAX_WR;
+  size_t size = sizeof(shm_queue_t) + capacity * (sizeof(shm_recv_t) + sizeof(shm_cqe_t));
+  std::unique_lock<std::mutex> lck(m_shmLock);
+  uint32_t queueID = m_nextQueueID++;
+  auto queue = (shm_queue_t *)SharedMemory::createSegment(getQueueName(getpid(), m_sharedBuffer->getSegmentID(), queueID), size);
+  queue->capacity = capacity;
+  m_pendingQueues[queueID] = shm_segment_t{queue, size};
+
+  localConn.shm.host = m_hostID;
+  localConn.shm.pid = getpid();
+  localConn.shm.segment = m_sharedBuffer->getSegmentID();
+  localConn.shm.queue = queueID;
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::initQPWithSuppliedID(const rdmaConnID rdmaConnID) {
+  if (m_buffer->isIBV()) {
+    ReliableRDMA::initQPWithSuppliedID(rdmaConnID);
+  } else {
+    // no device: connection data without QP
+    struct ib_qp_t qp;
+    struct ib_conn_t localConn = ib_conn_t();
+    localConn.buffer = (uint64_t)m_buffer->pointer();
+    setQP(rdmaConnID, qp);
+    setLocalConnData(rdmaConnID, localConn);
+  }
+  initLocalConnData(m_lconns[rdmaConnID]);
+}
+
+void SharedMemoryRDMA::initQPWithSuppliedID(struct ib_qp_t **qp, struct ib_conn_t **localConn) {
+  if (m_buffer->isIBV()) {
+    ReliableRDMA::initQPWithSuppliedID(qp, localConn);
+  } else {
+    **localConn = ib_conn_t();
+    (*localConn)->buffer = (uint64_t)m_buffer->pointer();
+  }
+  initLocalConnData(**localConn);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::connectQP(const rdmaConnID rdmaConnID) {
+  if (m_connected.find(rdmaConnID) != m_connected.end()) {
+    return;
+  }
+
+  // both sides decide on the exchanged data only
+  uint64_t localHost = m_lconns[rdmaConnID].shm.host;
+  if (localHost != 0 && localHost == m_rconns[rdmaConnID].shm.host) {
+    connectLocal(rdmaConnID);
+    m_connected[rdmaConnID] = true;
+    Logging::debug(__FILE__, __LINE__, "Connected shared memory queues!");
+    return;
+  }
+
+  if (!m_buffer->isIBV()) {
+    throw runtime_error("SharedMemoryRDMA: peer is not on the same host and no RDMA device is available");
+  }
+  ReliableRDMA::connectQP(rdmaConnID);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::connectLocal(const rdmaConnID rdmaConnID) {
+  ib_conn_t &localConn = m_lconns[rdmaConnID];
+  ib_conn_t &remoteConn = m_rconns[rdmaConnID];
+
+  std::unique_lock<std::mutex> lck(m_shmLock);
+  auto pending = m_pendingQueues.find(localConn.shm.queue);
+  if (pending == m_pendingQueues.end()) {
+    throw runtime_error("SharedMemoryRDMA: no receive queue for connection " + to_string(rdmaConnID));
+  }
+
+  shm_conn_t conn;
+  conn.inQueue = pending->second.queue;
+  conn.inQueueSize = pending->second.size;
+  conn.inQueueID = pending->first;
+  m_pendingQueues.erase(pending);
+  try {
+    conn.peerBuffer = (char *)SharedMemory::openSegment(
+        SharedMemory::getSegmentName(remoteConn.shm.pid, remoteConn.shm.segment), conn.peerSize);
+    conn.outQueue = (shm_queue_t *)SharedMemory::openSegment(
+        getQueueName(remoteConn.shm.pid, remoteConn.shm.segment, remoteConn.shm.queue), conn.outQueueSize);
+  } catch (runtime_error &e) {
+    disconnectLocal(conn);
+    throw;
+  }
+
+  if (m_shmConns.size() < rdmaConnID + 1) {
+    m_shmConns.resize(rdmaConnID + 1);
+  }
+  m_shmConns[rdmaConnID] = conn;
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::disconnectLocal(shm_conn_t &conn) {
+  // expects m_shmLock to be held, the own queue is removed, segments of the peer only unmapped
+  if (conn.inQueue != nullptr) {
+    SharedMemory::closeSegment(getQueueName(getpid(), m_sharedBuffer->getSegmentID(), conn.inQueueID),
+                               conn.inQueue, conn.inQueueSize, true);
+  }
+  SharedMemory::closeSegment("", conn.outQueue, conn.outQueueSize, false);
+  SharedMemory::closeSegment("", conn.peerBuffer, conn.peerSize, false);
+  conn = shm_conn_t();
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::disconnectQP(const rdmaConnID rdmaConnID) {
+  if (isLocal(rdmaConnID)) {
+    std::unique_lock<std::mutex> lck(m_shmLock);
+    disconnectLocal(m_shmConns[rdmaConnID]);
+  }
+  // destroys the QP (if any) and marks the connection as disconnected
+  ReliableRDMA::disconnectQP(rdmaConnID);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::write(const rdmaConnID rdmaConnID, size_t offset,
+                             const void *memAddr, size_t size, bool signaled) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::write(rdmaConnID, offset, memAddr, size, signaled);
+    return;
+  }
+  memcpy(localRemoteAccess(m_shmConns[rdmaConnID], offset, size), memAddr, size);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::writeImm(const rdmaConnID rdmaConnID, size_t offset,
+                                const void *memAddr, size_t size, uint32_t imm, bool signaled) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::writeImm(rdmaConnID, offset, memAddr, size, imm, signaled);
+    return;
+  }
+  localSend(m_shmConns[rdmaConnID], memAddr, size, offset, true, &imm);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::read(const rdmaConnID rdmaConnID, size_t offset,
+                            const void *memAddr, size_t size, bool signaled) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::read(rdmaConnID, offset, memAddr, size, signaled);
+    return;
+  }
+  memcpy((void *)memAddr, localRemoteAccess(m_shmConns[rdmaConnID], offset, size), size);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::writeBulk(const rdmaConnID rdmaConnID, size_t offset,
+                                 const void *memAddr, size_t size) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::writeBulk(rdmaConnID, offset, memAddr, size);
+    return;
+  }
+  write(rdmaConnID, offset, memAddr, size, true);
+}
+
+void SharedMemoryRDMA::readBulk(const rdmaConnID rdmaConnID, size_t offset,
+                                const void *memAddr, size_t size) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::readBulk(rdmaConnID, offset, memAddr, size);
+    return;
+  }
+  read(rdmaConnID, offset, memAddr, size, true);
+}
+
+void SharedMemoryRDMA::startBulkWrite(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                                      size_t offset, const void *memAddr, size_t size) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::startBulkWrite(transfer, rdmaConnID, offset, memAddr, size);
+    return;
+  }
+  write(rdmaConnID, offset, memAddr, size, true);
+  transfer = bulk_transfer_t();  // no chunks, i.e. complete
+  transfer.connID = rdmaConnID;
+}
+
+void SharedMemoryRDMA::startBulkRead(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                                     size_t offset, const void *memAddr, size_t size) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::startBulkRead(transfer, rdmaConnID, offset, memAddr, size);
+    return;
+  }
+  read(rdmaConnID, offset, memAddr, size, true);
+  transfer = bulk_transfer_t();
+  transfer.connID = rdmaConnID;
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
+                                   const void *memAddr, size_t value_to_add, size_t size,
+                                   bool signaled) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::fetchAndAdd(rdmaConnID, offset, memAddr, value_to_add, size, signaled);
+    return;
+  }
+  if (offset % sizeof(uint64_t) != 0) {
+    throw runtime_error("Shared memory atomics must be 8 byte aligned! offset: " + to_string(offset));
+  }
+  auto remote = (uint64_t *)localRemoteAccess(m_shmConns[rdmaConnID], offset, sizeof(uint64_t));
+  *(uint64_t *)memAddr = __atomic_fetch_add(remote, (uint64_t)value_to_add, __ATOMIC_SEQ_CST);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::compareAndSwap(const rdmaConnID rdmaConnID, size_t offset,
+                                      const void *memAddr, int toCompare, int toSwap,
+                                      size_t size, bool signaled) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::compareAndSwap(rdmaConnID, offset, memAddr, toCompare, toSwap, size, signaled);
+    return;
+  }
+  if (offset % sizeof(uint64_t) != 0) {
+    throw runtime_error("Shared memory atomics must be 8 byte aligned! offset: " + to_string(offset));
+  }
+  auto remote = (uint64_t *)localRemoteAccess(m_shmConns[rdmaConnID], offset, sizeof(uint64_t));
+  // same conversion as the NIC gets (sign extended)
+  uint64_t original = (uint64_t)toCompare;
+  __atomic_compare_exchange_n(remote, &original, (uint64_t)toSwap, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  *(uint64_t *)memAddr = original;
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::send(const rdmaConnID rdmaConnID, const void *memAddr, size_t size, bool signaled) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::send(rdmaConnID, memAddr, size, signaled);
+    return;
+  }
+  localSend(m_shmConns[rdmaConnID], memAddr, size, 0, false, nullptr);
+}
+
+void SharedMemoryRDMA::sendImm(const rdmaConnID rdmaConnID, const void *memAddr, size_t size, uint32_t imm, bool signaled) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::sendImm(rdmaConnID, memAddr, size, imm, signaled);
+    return;
+  }
+  localSend(m_shmConns[rdmaConnID], memAddr, size, 0, false, &imm);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::localSend(shm_conn_t &conn, const void *memAddr, size_t size,
+                                 size_t offset, bool isWrite, uint32_t *imm) {
+  shm_queue_t *queue = conn.outQueue;
+  shm_recv_t recv;
+  if (!ringPeek(queue->recvs, queue->recvEntries(), queue->capacity, recv)) {
+    // same as a QP without RNR retries
+    throw runtime_error("Shared memory send failed, no receive posted by the peer (RNR)!");
+  }
+
+  // the receive is only consumed if the send is valid
+  char *dest;
+  if (isWrite) {
+    dest = localRemoteAccess(conn, offset, size);
+  } else {
+    if (size > recv.size) {
+      throw runtime_error("Shared memory send of " + to_string(size) +
+                          " bytes does not fit into posted receive of " + to_string(recv.size) + " bytes!");
+    }
+    dest = conn.peerBuffer + recv.offset;
+  }
+  memcpy(dest, memAddr, size);
+  ringConsume(queue->recvs);
+
+  // receives are never posted beyond capacity, so there is always room for the completion
+  shm_cqe_t cqe;
+  cqe.size = size;
+  cqe.imm = imm != nullptr ? *imm : 0;
+  ringPush(queue->completions, queue->cqEntries(), queue->capacity, cqe);
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::receive(const rdmaConnID rdmaConnID, const void *memAddr, size_t size) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::receive(rdmaConnID, memAddr, size);
+    return;
+  }
+
+  shm_recv_t recv{0, 0};
+  if (memAddr != nullptr) {
+    recv.offset = convertPointerToOffset((void *)memAddr);
+    recv.size = size;
+    if (memAddr < m_buffer->pointer() || recv.offset + size > m_buffer->getSize()) {
+      throw runtime_error("Passed memAddr falls out of buffer addr space");
+    }
+  }
+
+  shm_queue_t *queue = m_shmConns[rdmaConnID].inQueue;
+  if (!ringPush(queue->recvs, queue->recvEntries(), queue->capacity, recv)) {
+    throw runtime_error("RECV has not been posted successfully in receive()! More than Config::RDMA_MAX_WR receives posted");
+  }
+}
+
+//------------------------------------------------------------------------------------//
+
+int SharedMemoryRDMA::pollReceive(const rdmaConnID rdmaConnID, bool doPoll, uint32_t *imm) {
+  if (!isLocal(rdmaConnID)) {
+    return ReliableRDMA::pollReceive(rdmaConnID, doPoll, imm);
+  }
+
+  shm_queue_t *queue = m_shmConns[rdmaConnID].inQueue;
+  shm_cqe_t cqe;
+  while (!ringPop(queue->completions, queue->cqEntries(), queue->capacity, cqe)) {
+    if (!doPoll) {
+      return 0;
+    }
+#ifdef BACKOFF
+    __asm__("pause");
+#endif
+  }
+  if (imm != nullptr) {
+    *imm = cqe.imm;
+  }
+  return 1;
+}
+
+//------------------------------------------------------------------------------------//
+
+void SharedMemoryRDMA::pollSend(const rdmaConnID rdmaConnID, bool doPoll, uint32_t *imm) {
+  if (!isLocal(rdmaConnID)) {
+    ReliableRDMA::pollSend(rdmaConnID, doPoll, imm);
+  }
+  // local operations complete synchronously
+}
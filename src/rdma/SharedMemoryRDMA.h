@@ -0,0 +1,267 @@
+/**
+ * @file SharedMemoryRDMA.h
+ */
+
+#ifndef SharedMemoryRDMA_H_
+#define SharedMemoryRDMA_H_
+
+#include "../memory/SharedMemory.h"
+#include "../utils/Config.h"
+#include "ReliableRDMA.h"
+
+#include <atomic>
+#include <map>
+
+namespace rdma {
+
+/* Class: SharedMemoryRDMA
+ * ----------------
+ * Reliable RDMA which bypasses the NIC for peers on the same host.
+ * The buffer is a shared memory segment and every connection gets
+ * a segment with lock-free queues for posted receives and
+ * completions. On connect the peers exchange host ID and segment
+ * names: if both are on the same host, the peer maps the buffer and
+ * queues and write/read/atomics/send/receive become memory operations.
+ * Connections to other hosts use the QP of ReliableRDMA as usual.
+ *
+ * The operations are resolved statically, i.e. it must be used
+ * as RDMAClient<SharedMemoryRDMA> / RDMAServer<SharedMemoryRDMA>
+ * and not through a pointer to ReliableRDMA.
+ *
+ * Without an RDMA device the buffer is not registered and no QPs
+ * are created, so e.g. RDMAServer<SharedMemoryRDMA> and
+ * RDMAClient<SharedMemoryRDMA> also work on machines without NIC
+ * (same host only).
+ *
+ * Like a QP, a local connection must only be used by one thread per
+ * side at a time (single producer / single consumer queues).
+ * Operations on local connections complete synchronously, i.e.
+ * signaled has no effect and pollSend() returns immediately.
+ *
+ * As with RDMA, write() and read() give no ordering guarantees to a
+ * peer which polls the buffer. Data written before a writeImm(),
+ * send() or atomic is visible to the peer once it received the
+ * message or observed the atomic, as those publish through atomics.
+ */
+class SharedMemoryRDMA : public ReliableRDMA {
+ public:
+  SharedMemoryRDMA(size_t mem_size = Config::RDMA_MEMSIZE);
+  SharedMemoryRDMA(size_t mem_size, bool huge);
+  SharedMemoryRDMA(size_t mem_size, int numaNode);
+  SharedMemoryRDMA(size_t mem_size, bool huge, int numaNode);
+  SharedMemoryRDMA(size_t mem_size, MEMORY_TYPE mem_type);
+  SharedMemoryRDMA(size_t mem_size, MEMORY_TYPE mem_type, bool huge, int numaNode);
+  /**
+   * Only main memory can be shared (mem_type must be MAIN)
+   */
+  SharedMemoryRDMA(size_t mem_size, int mem_type, bool huge, int numaNode);
+  /**
+   * Buffers which are not SharedMemory are never
+   * shared, i.e. all connections use QPs
+   */
+  SharedMemoryRDMA(BaseMemory *buffer);
+  ~SharedMemoryRDMA();
+
+  void initQPWithSuppliedID(const rdmaConnID suppliedID) override;
+  void initQPWithSuppliedID(struct ib_qp_t **qp, struct ib_conn_t **localConn) override;
+
+  void connectQP(const rdmaConnID rdmaConnID) override;
+  void disconnectQP(const rdmaConnID rdmaConnID) override;
+
+  /* Function: isLocal
+   * ----------------
+   * True if the connection bypasses the NIC
+   */
+  bool isLocal(const rdmaConnID rdmaConnID) {
+    return rdmaConnID < m_shmConns.size() && m_shmConns[rdmaConnID].peerBuffer != nullptr;
+  }
+
+  // see ReliableRDMA, the operations hide (do not override) those of
+  // ReliableRDMA to keep virtual calls off its RC path
+  void write(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+             size_t size, bool signaled);
+  void writeImm(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+                size_t size, uint32_t imm, bool signaled);
+  void read(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+            size_t size, bool signaled);
+
+  // local bulk transfers are copied at once and are complete after start
+  void writeBulk(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+                 size_t size);
+  void readBulk(const rdmaConnID rdmaConnID, size_t offset, const void *memAddr,
+                size_t size);
+  void startBulkWrite(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                      size_t offset, const void *memAddr, size_t size);
+  void startBulkRead(bulk_transfer_t &transfer, const rdmaConnID rdmaConnID,
+                     size_t offset, const void *memAddr, size_t size);
+
+  void fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
+                   const void *memAddr, size_t size, bool signaled) {
+    fetchAndAdd(rdmaConnID, offset, memAddr, 1, size, signaled);
+  }
+  void fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
+                   const void *memAddr, bool signaled) {
+    fetchAndAdd(rdmaConnID, offset, memAddr, sizeof(uint64_t), signaled);
+  }
+  void fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
+                   const void *memAddr, size_t value_to_add, size_t size,
+                   bool signaled);
+  void fetchAndAdd(const rdmaConnID rdmaConnID, size_t offset,
+                   const void *memAddr, int64_t value_to_add, bool signaled) {
+    fetchAndAdd(rdmaConnID, offset, memAddr, value_to_add, sizeof(uint64_t), signaled);
+  }
+  void compareAndSwap(const rdmaConnID rdmaConnID, size_t offset,
+                      const void *memAddr, int toCompare, int toSwap,
+                      size_t size, bool signaled);
+  void compareAndSwap(const rdmaConnID rdmaConnID, size_t offset,
+                      const void *memAddr, int toCompare, int toSwap, bool signaled) {
+    compareAndSwap(rdmaConnID, offset, memAddr, toCompare, toSwap, sizeof(int64_t), signaled);
+  }
+
+  void sendImm(const rdmaConnID rdmaConnID, const void *memAddr,
+               size_t size, uint32_t imm, bool signaled) override;
+  void send(const rdmaConnID rdmaConnID, const void *memAddr, size_t size,
+            bool signaled) override;
+  void receive(const rdmaConnID rdmaConnID, const void *memAddr,
+               size_t size) override;
+  int pollReceive(const rdmaConnID rdmaConnID, bool doPoll = true, uint32_t *imm = nullptr) override;
+  void pollSend(const rdmaConnID rdmaConnID, bool doPoll, uint32_t *imm = nullptr) override;
+
+  /* Function: getHostID
+   * ----------------
+   * Identifies the host (boot ID and host name), so that
+   * processes in different containers are not mistaken
+   * as local
+   */
+  static uint64_t getHostID();
+
+  /* Function: isDeviceAvailable
+   * ----------------
+   * True if there is at least one RDMA device
+   */
+  static bool isDeviceAvailable();
+
+ protected:
+  // receive posted by the owner of the queue
+  struct shm_recv_t {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  // completion of a send or writeImm of the peer
+  struct shm_cqe_t {
+    uint64_t size;
+    uint32_t imm;
+  };
+
+  // single producer / single consumer ring, entries are stored after the header
+  struct shm_ring_t {
+    alignas(64) std::atomic<uint64_t> head;  // next entry to consume
+    alignas(64) std::atomic<uint64_t> tail;  // next entry to produce
+  };
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory queues need lock-free atomics");
+
+  // receive queue of one side of a connection, followed by capacity
+  // shm_recv_t and capacity shm_cqe_t entries
+  struct shm_queue_t {
+    uint64_t capacity;
+    shm_ring_t recvs;        // posted by the owner, consumed by sends of the peer
+    shm_ring_t completions;  // produced by the peer, polled by the owner
+
+    shm_recv_t *recvEntries() { return (shm_recv_t *)(this + 1); }
+    shm_cqe_t *cqEntries() { return (shm_cqe_t *)(recvEntries() + capacity); }
+  };
+
+  struct shm_conn_t {
+    char *peerBuffer = nullptr;
+    size_t peerSize = 0;
+    shm_queue_t *inQueue = nullptr;   // own queue
+    size_t inQueueSize = 0;
+    uint32_t inQueueID = 0;
+    shm_queue_t *outQueue = nullptr;  // queue of the peer
+    size_t outQueueSize = 0;
+  };
+
+  struct shm_segment_t {
+    shm_queue_t *queue;
+    size_t size;
+  };
+
+  template <typename T>
+  static inline bool __attribute__((always_inline))
+  ringPush(shm_ring_t &ring, T *entries, uint64_t capacity, const T &entry) {
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail - ring.head.load(std::memory_order_acquire) == capacity) {
+      return false;
+    }
+    entries[tail % capacity] = entry;
+    ring.tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // reads the next entry without consuming it
+  template <typename T>
+  static inline bool __attribute__((always_inline))
+  ringPeek(shm_ring_t &ring, T *entries, uint64_t capacity, T &entry) {
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head == ring.tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    entry = entries[head % capacity];
+    return true;
+  }
+
+  // consumes the entry returned by ringPeek()
+  static inline void __attribute__((always_inline))
+  ringConsume(shm_ring_t &ring) {
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  template <typename T>
+  static inline bool __attribute__((always_inline))
+  ringPop(shm_ring_t &ring, T *entries, uint64_t capacity, T &entry) {
+    if (!ringPeek(ring, entries, capacity, entry)) {
+      return false;
+    }
+    ringConsume(ring);
+    return true;
+  }
+
+  /* Function: localRemoteAccess
+   * ----------------
+   * Checks the bounds of a remote access on a local connection
+   *
+   * return:  address in the mapped buffer of the peer
+   */
+  inline char *__attribute__((always_inline))
+  localRemoteAccess(shm_conn_t &conn, size_t offset, size_t size) {
+    if (offset + size > conn.peerSize) {
+      throw runtime_error("Shared memory access out of remote buffer bounds! offset: " + to_string(offset));
+    }
+    return conn.peerBuffer + offset;
+  }
+
+  void localSend(shm_conn_t &conn, const void *memAddr, size_t size,
+                 size_t offset, bool isWrite, uint32_t *imm);
+
+  void initLocalConnData(struct ib_conn_t &localConn);
+  void connectLocal(const rdmaConnID rdmaConnID);
+  void disconnectLocal(shm_conn_t &conn);
+
+  static std::string getQueueName(uint32_t pid, uint32_t segmentID, uint32_t queueID);
+  static SharedMemory *createBuffer(size_t mem_size, int mem_type, bool huge, int numaNode);
+
+  SharedMemory *m_sharedBuffer = nullptr;  // nullptr if the buffer is not shared
+  uint64_t m_hostID = 0;
+
+  std::vector<shm_conn_t> m_shmConns;  // rdmaConnID is the index of the vector
+
+  // queues created in initQP which are not connected yet
+  std::mutex m_shmLock;
+  uint32_t m_nextQueueID = 0;
+  std::map<uint32_t, shm_segment_t> m_pendingQueues;
+};
+
+}  // namespace rdma
+
+#endif /* SharedMemoryRDMA_H_ */
@@ -1,11 +1,45 @@
 #include "UnreliableRDMA.h"
 
+#include <atomic>
+
 #ifndef HUGEPAGE
 #define HUGEPAGE false
 #endif
 
 using namespace rdma;
 
+static std::atomic<uint64_t> s_nextInstanceID {0};
+
+// live instances by ID, so that exiting threads only release QPs of instances
+// which were not destroyed yet (never destroyed: threads may exit after main)
+static std::mutex &instancesLock() {
+  static std::mutex *lock = new std::mutex();
+  return *lock;
+}
+static std::unordered_map<uint64_t, UnreliableRDMA *> &instances() {
+  static auto *instances = new std::unordered_map<uint64_t, UnreliableRDMA *>();
+  return *instances;
+}
+
+namespace rdma {
+// QPs of the calling thread, keyed by the instance ID (IDs are never reused)
+struct ud_thread_qps_t {
+  std::unordered_map<uint64_t, UnreliableRDMA::ud_thread_qp_t *> qps;
+
+  ~ud_thread_qps_t() {
+    std::unique_lock<std::mutex> lck(instancesLock());
+    for (auto &threadQP : qps) {
+      auto instance = instances().find(threadQP.first);
+      if (instance != instances().end()) {
+        instance->second->releaseThreadQP(threadQP.second);
+      }
+    }
+  }
+};
+}  // namespace rdma
+
+static thread_local ud_thread_qps_t t_threadQPs;
+
 UnreliableRDMA::UnreliableRDMA(size_t mem_size) : UnreliableRDMA(mem_size, HUGEPAGE){}
 UnreliableRDMA::UnreliableRDMA(size_t mem_size, bool huge) : UnreliableRDMA(mem_size, huge, (int)Config::RDMA_NUMAREGION){}
 UnreliableRDMA::UnreliableRDMA(size_t mem_size, int numaNode) : UnreliableRDMA(mem_size, HUGEPAGE, numaNode){}
@@ -15,18 +49,31 @@ UnreliableRDMA::UnreliableRDMA(size_t mem_size, MEMORY_TYPE mem_type, bool huge,
 UnreliableRDMA::UnreliableRDMA(size_t mem_size, int mem_type, bool huge, int numaNode) : BaseRDMA(mem_size, mem_type, huge, numaNode) {
   m_qpType = IBV_QPT_UD;
   m_lastMCastConnKey = 0;
+  m_instanceID = s_nextInstanceID++;
 
   initQPWithSuppliedID(0);
+
+  std::unique_lock<std::mutex> lck(instancesLock());
+  instances()[m_instanceID] = this;
 }
 UnreliableRDMA::UnreliableRDMA(BaseMemory *buffer) : BaseRDMA(buffer) {
   m_qpType = IBV_QPT_UD;
   m_lastMCastConnKey = 0;
+  m_instanceID = s_nextInstanceID++;
 
   initQPWithSuppliedID(0);
+
+  std::unique_lock<std::mutex> lck(instancesLock());
+  instances()[m_instanceID] = this;
 }
 
 
 UnreliableRDMA::~UnreliableRDMA() {
+  {
+    // exiting threads must not release QPs from now on
+    std::unique_lock<std::mutex> lck(instancesLock());
+    instances().erase(m_instanceID);
+  }
   rdmaConnID mcastID = 0;
   for(auto& mcastConn : m_udpMcastConns){
     (void)mcastConn;
@@ -76,12 +123,10 @@ void UnreliableRDMA::initQPWithSuppliedID(const rdmaConnID rdmaConnID) {
   createQP(qp);
 
   // create local connection data
-  union ibv_gid my_gid;
-  memset(&my_gid, 0, sizeof my_gid);
   qpConn->buffer = (uintptr_t)m_buffer->pointer();
   qpConn->qp_num = m_udqp.qp->qp_num;
   qpConn->lid = m_buffer->ib_port_attributes().lid;
-  memcpy(qpConn->gid, &my_gid, sizeof my_gid);
+  getLocalGid(qpConn->gid);
   qpConn->ud.psn = lrand48() & 0xffffff;
   qpConn->ud.ah = nullptr;
 
@@ -123,12 +168,10 @@ void UnreliableRDMA::initQPWithSuppliedID(ib_qp_t** qpp, ib_conn_t** localcon) {
 
 
     // create local connection data
-    union ibv_gid my_gid;
-    memset(&my_gid, 0, sizeof my_gid);
     qpConn->buffer = (uintptr_t)m_buffer->pointer();
     qpConn->qp_num = m_udqp.qp->qp_num;
     qpConn->lid = m_buffer->ib_port_attributes().lid;
-    memcpy(qpConn->gid, &my_gid, sizeof my_gid);
+    getLocalGid(qpConn->gid);
     qpConn->ud.psn = lrand48() & 0xffffff;
     qpConn->ud.ah = nullptr;
 
@@ -169,6 +212,13 @@ void UnreliableRDMA::connectQP(const rdmaConnID rdmaConnID) {
   ah_attr.sl = 0;
   ah_attr.src_path_bits = 0;
   ah_attr.port_num = m_buffer->getIBPort();
+  if (-1 != m_gidIdx) {
+    // RoCE needs a GRH to route to the remote GID
+    ah_attr.is_global = 1;
+    memcpy(&ah_attr.grh.dgid, m_rconns[rdmaConnID].gid, 16);
+    ah_attr.grh.hop_limit = 64;
+    ah_attr.grh.sgid_index = m_gidIdx;
+  }
   struct ibv_ah* ah = ibv_create_ah(m_buffer->ib_pd(), &ah_attr);
   m_rconns[rdmaConnID].ud.ah = ah;
 
@@ -198,6 +248,18 @@ void UnreliableRDMA::destroyQPs() {
     m_udqp.qp = nullptr;
   }
 
+  std::unique_lock<std::mutex> threadLck(m_threadQPLock);
+  for (auto& threadQP : m_threadQPs) {
+    if (ibv_destroy_qp(threadQP->qp.qp) != 0) {
+      throw runtime_error("Error, ibv_destroy_qp() failed while destroying QPs");
+    }
+    ibv_destroy_cq(threadQP->qp.send_cq);
+    if (!threadQP->sendBuffer.isnull) {
+      m_buffer->free(threadQP->sendBuffer.offset);
+    }
+  }
+  m_threadQPs.clear();
+
   if (m_udqpMgmt.qp != nullptr) {
     if (ibv_destroy_qp(m_udqpMgmt.qp) != 0) {
       throw runtime_error("Error, ibv_destroy_qp() failed while destroying QPs");
@@ -208,12 +270,8 @@ void UnreliableRDMA::destroyQPs() {
 
 void UnreliableRDMA::send(const rdmaConnID rdmaConnID, const void* memAddr,
                           size_t size, bool signaled) {
-
-  //todo check signaled 
-  checkSignaled(signaled, 0);
-
-  struct ib_qp_t localQP = m_udqp; //m_qps[rdmaConnID]; 
-  struct ib_conn_t remoteConn = m_rconns[rdmaConnID];
+  ud_thread_qp_t& localQP = getThreadQP();
+  struct ib_conn_t& remoteConn = m_rconns[rdmaConnID];
 
   struct ibv_send_wr sr;
   struct ibv_sge sge;
@@ -225,37 +283,142 @@ void UnreliableRDMA::send(const rdmaConnID rdmaConnID, const void* memAddr,
   sr.sg_list = &sge;
   sr.num_sge = 1;
   sr.opcode = IBV_WR_SEND;
-  sr.next = NULL;
 
   sr.wr.ud.ah = remoteConn.ud.ah;
   sr.wr.ud.remote_qpn = remoteConn.qp_num;
   sr.wr.ud.remote_qkey = 0x11111111;  // remoteConn.ud.qkey;
-  sr.send_flags = (signaled) ? IBV_SEND_SIGNALED : 0;
 
-  struct ibv_send_wr* bad_wr = NULL;
-  if ((errno = ibv_post_send(localQP.qp, &sr, &bad_wr)) != 0) {
+  postThreadSend(localQP, &sr, 1, signaled);
+}
+
+void UnreliableRDMA::sendBatch(const ud_send_t* sends, size_t count, bool signaled) {
+  ud_thread_qp_t& localQP = getThreadQP();
+  uint32_t lkey = m_buffer->ib_mr()->lkey;
+
+  size_t maxBatch = std::max<size_t>(Config::RDMA_MAX_WR / 2, 1);
+  std::vector<struct ibv_send_wr> sr(std::min(count, maxBatch));
+  std::vector<struct ibv_sge> sge(sr.size());
+
+  for (size_t first = 0; first < count; first += maxBatch) {
+    size_t batch = std::min(maxBatch, count - first);
+    memset(sr.data(), 0, sizeof(struct ibv_send_wr) * batch);
+    memset(sge.data(), 0, sizeof(struct ibv_sge) * batch);
+    for (size_t i = 0; i < batch; ++i) {
+      const ud_send_t& udSend = sends[first + i];
+      struct ib_conn_t& remoteConn = m_rconns[udSend.connID];
+
+      sge[i].addr = (uintptr_t)udSend.memAddr;
+      sge[i].lkey = lkey;
+      sge[i].length = udSend.size;
+
+      sr[i].sg_list = &sge[i];
+      sr[i].num_sge = 1;
+      sr[i].opcode = IBV_WR_SEND;
+      sr[i].wr.ud.ah = remoteConn.ud.ah;
+      sr[i].wr.ud.remote_qpn = remoteConn.qp_num;
+      sr[i].wr.ud.remote_qkey = 0x11111111;  // remoteConn.ud.qkey;
+    }
+    postThreadSend(localQP, sr.data(), batch, signaled && first + batch == count);
+  }
+}
+
+void UnreliableRDMA::postThreadSend(ud_thread_qp_t& qp, struct ibv_send_wr* wrs, size_t count, bool signaled) {
+  size_t maxUnsignaled = std::max<size_t>(Config::RDMA_MAX_WR / 2, 1);
+  size_t signaledWRs = 0;
+  for (size_t i = 0; i < count; ++i) {
+    wrs[i].next = i + 1 < count ? &wrs[i + 1] : nullptr;
+    if ((signaled && i + 1 == count) || ++qp.unsignaled >= maxUnsignaled) {
+      wrs[i].send_flags |= IBV_SEND_SIGNALED;
+      qp.unsignaled = 0;
+      ++signaledWRs;
+    }
+  }
+
+  struct ibv_send_wr* bad_wr = nullptr;
+  if ((errno = ibv_post_send(qp.qp.qp, wrs, &bad_wr)) != 0) {
     throw runtime_error("SEND not successful! errno: " + std::string(std::strerror(errno)));
   }
 
-  int ne = 0;
-  if (signaled) {
-    struct ibv_wc wc;
-    do {
-      wc.status = IBV_WC_SUCCESS;
-      ne = ibv_poll_cq(localQP.send_cq, 1, &wc);
+  for (size_t i = 0; i < signaledWRs; ++i) {
+    pollThreadSend(qp);
+  }
+}
 
-      if (wc.status != IBV_WC_SUCCESS) {
-        throw runtime_error("RDMA completion event in CQ with error! " + to_string(wc.status) + " errno: " + std::string(std::strerror(errno)));
-      }
+void UnreliableRDMA::pollThreadSend(ud_thread_qp_t& qp) {
+  int ne;
+  struct ibv_wc wc;
+  do {
+    wc.status = IBV_WC_SUCCESS;
+    ne = ibv_poll_cq(qp.qp.send_cq, 1, &wc);
 
-    } while (ne == 0);
+    if (wc.status != IBV_WC_SUCCESS) {
+      throw runtime_error("RDMA completion event in CQ with error! " + to_string(wc.status) + " errno: " + std::string(std::strerror(errno)));
+    }
+  } while (ne == 0);
 
-    if (ne < 0) {
-      throw runtime_error("RDMA polling from CQ failed!");
+  if (ne < 0) {
+    throw runtime_error("RDMA polling from CQ failed!");
+  }
+}
+
+UnreliableRDMA::ud_thread_qp_t* UnreliableRDMA::findThreadQP() {
+  auto it = t_threadQPs.qps.find(m_instanceID);
+  return it == t_threadQPs.qps.end() ? nullptr : it->second;
+}
+
+UnreliableRDMA::ud_thread_qp_t& UnreliableRDMA::getThreadQP() {
+  ud_thread_qp_t* existing = findThreadQP();
+  if (existing != nullptr) {
+    return *existing;
+  }
+
+  std::unique_ptr<ud_thread_qp_t> threadQP(new ud_thread_qp_t());
+  ib_qp_t* qp = &threadQP->qp;
+  // receives are only posted on m_udqp
+  qp->recv_cq = m_udqp.recv_cq;
+  if (!(qp->send_cq = ibv_create_cq(m_buffer->ib_context(), Config::RDMA_MAX_WR + 1, nullptr, nullptr, 0))) {
+    throw runtime_error("Cannot create send CQ of thread QP!");
+  }
+  createQP(qp);
+  modifyQPToInit(qp->qp);
+  modifyQPToRTR(qp->qp);
+  modifyQPToRTS(qp->qp, lrand48() & 0xffffff);
+
+  ud_thread_qp_t* ret = threadQP.get();
+  {
+    std::unique_lock<std::mutex> lck(m_threadQPLock);
+    m_threadQPs.push_back(std::move(threadQP));
+  }
+  t_threadQPs.qps[m_instanceID] = ret;
+  Logging::debug(__FILE__, __LINE__, "Created UD queue pair of thread");
+  return *ret;
+}
+
+void UnreliableRDMA::releaseThreadQP(ud_thread_qp_t* threadQP) {
+  std::unique_lock<std::mutex> lck(m_threadQPLock);
+  for (auto it = m_threadQPs.begin(); it != m_threadQPs.end(); ++it) {
+    if (it->get() != threadQP) {
+      continue;
+    }
+    // pending sends are dropped like lost datagrams
+    if (ibv_destroy_qp(threadQP->qp.qp) != 0) {
+      Logging::error(__FILE__, __LINE__, "Error, ibv_destroy_qp() failed while releasing UD queue pair of thread");
     }
+    ibv_destroy_cq(threadQP->qp.send_cq);
+    if (!threadQP->sendBuffer.isnull) {
+      m_buffer->free(threadQP->sendBuffer.offset);
+    }
+    m_threadQPs.erase(it);
+    Logging::debug(__FILE__, __LINE__, "Released UD queue pair of exited thread");
+    return;
   }
 }
 
+size_t UnreliableRDMA::getThreadQPCount() {
+  std::unique_lock<std::mutex> lck(m_threadQPLock);
+  return m_threadQPs.size();
+}
+
 void UnreliableRDMA::receive(const rdmaConnID, const void* memAddr,
                              size_t size) {
   // struct ib_qp_t localQP = m_qps[rdmaConnID]; //m_udqp
@@ -311,8 +474,12 @@ void UnreliableRDMA::pollSend(const rdmaConnID, bool doPoll, uint32_t *imm) {
   int ne;
   struct ibv_wc wc;
 
-  // struct ib_qp_t localQP = m_qps[rdmaConnID]; //m_udqp.qp
-  struct ib_qp_t localQP = m_udqp;
+  // sends are posted on the QP of the thread, polling before its first send is an error
+  ud_thread_qp_t* threadQP = findThreadQP();
+  if (threadQP == nullptr) {
+    throw runtime_error("pollSend() called by a thread without UD QP, nothing was sent by this thread!");
+  }
+  struct ib_qp_t localQP = threadQP->qp;
 
   do {
     wc.status = IBV_WC_SUCCESS;
@@ -562,7 +729,8 @@ void UnreliableRDMA::createQP(struct ib_qp_t* qp) {
 
   qp_init_attr.cap.max_send_wr = Config::RDMA_MAX_WR;
   qp_init_attr.cap.max_recv_wr = Config::RDMA_MAX_WR;
-  qp_init_attr.cap.max_send_sge = Config::RDMA_MAX_SGE;
+  // segments of SegmentedUnreliableRDMA are sent as header and payload
+  qp_init_attr.cap.max_send_sge = Config::RDMA_MAX_SGE < 2 ? 2 : Config::RDMA_MAX_SGE;
   qp_init_attr.cap.max_recv_sge = Config::RDMA_MAX_SGE;
 
   // create queue pair
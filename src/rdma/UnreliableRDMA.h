@@ -57,8 +57,33 @@ class UnreliableRDMA : public BaseRDMA {
   void connectQP(const rdmaConnID rdmaConnID) override;
   void disconnectQP(const rdmaConnID rdmaConnID) override;
 
+  // UD send to one remote, used by sendBatch
+  struct ud_send_t {
+    rdmaConnID connID;
+    const void *memAddr;
+    size_t size;
+  };
+
+  /* Function: send
+   * ----------------
+   * Sends on the UD QP of the calling thread (see getThreadQP),
+   * threads can send concurrently without synchronization
+   */
   void send(const rdmaConnID rdmaConnID, const void *memAddr, size_t size,
             bool signaled) override;
+
+  /* Function: sendBatch
+   * ----------------
+   * Sends to many remotes with one doorbell (per
+   * Config::RDMA_MAX_WR / 2 sends) on the UD QP of the
+   * calling thread
+   *
+   * sends:     remotes and messages
+   * count:     number of sends
+   * signaled:  if true then function blocks until
+   *            all sends completed
+   */
+  void sendBatch(const ud_send_t *sends, size_t count, bool signaled);
   void receive(const rdmaConnID rdmaConnID, const void *memAddr,
                size_t size) override;
   int pollReceive(const rdmaConnID rdmaConnID,  bool doPoll = true,uint32_t* = nullptr) override;
@@ -76,13 +101,53 @@ class UnreliableRDMA : public BaseRDMA {
                     size_t size);
   int pollReceiveMCast(const rdmaConnID rdmaConnID, bool doPoll);
 
- private:
+  /* Function: getThreadQPCount
+   * ----------------
+   * Number of UD QPs of threads which sent and did not exit yet
+   */
+  size_t getThreadQPCount();
+
+ protected:
   void createQP(struct ib_qp_t *qp) override;
   void destroyQPs() override;
   void modifyQPToInit(struct ibv_qp *qp);
   void modifyQPToRTR(struct ibv_qp *qp);
   void modifyQPToRTS(struct ibv_qp *qp, const uint32_t psn);
 
+  // send-only UD QP of a thread, receives arrive at m_udqp
+  struct ud_thread_qp_t {
+    ib_qp_t qp;
+    size_t unsignaled = 0;  // WRs since the last signaled WR
+    rdma_mem_t sendBuffer;  // scratch memory of the thread, used by subclasses
+  };
+
+  /* Function: getThreadQP
+   * ----------------
+   * Returns the UD QP of the calling thread, created with its
+   * own send CQ on the first send of the thread. Only the
+   * creation is synchronized. The QP (and its send buffer) is
+   * released when the thread exits.
+   */
+  ud_thread_qp_t &getThreadQP();
+
+  // UD QP of the calling thread or nullptr if it did not send yet
+  ud_thread_qp_t *findThreadQP();
+
+  // destroys the QP of an exiting thread
+  void releaseThreadQP(ud_thread_qp_t *threadQP);
+  friend struct ud_thread_qps_t;
+
+  /* Function: postThreadSend
+   * ----------------
+   * Posts a chain of at most Config::RDMA_MAX_WR / 2 WRs on the QP
+   * of the thread. Every Config::RDMA_MAX_WR / 2 WRs one is signaled
+   * and waited for, so the send queue never overflows.
+   *
+   * signaled:  if true the last WR is signaled and waited for
+   */
+  void postThreadSend(ud_thread_qp_t &qp, struct ibv_send_wr *wrs, size_t count, bool signaled);
+  void pollThreadSend(ud_thread_qp_t &qp);
+
   inline uint64_t nextMCastConnKey() { return m_lastMCastConnKey++; }
 
   void setMCastConn(const rdmaConnID rdmaConnID, rdma_mcast_conn_t &conn);
@@ -105,6 +170,11 @@ class UnreliableRDMA : public BaseRDMA {
   std::mutex m_cqCreateLock;
   std::mutex m_qpLock;
 
+  // identifies the instance in the thread local QP lookup
+  uint64_t m_instanceID;
+  std::mutex m_threadQPLock;
+  std::vector<std::unique_ptr<ud_thread_qp_t>> m_threadQPs;
+
 };
 
 }  // namespace rdma
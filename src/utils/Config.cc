@@ -32,14 +32,28 @@ size_t Config::RDMA_MEMSIZE = 1024ul * 1024 * 1024 * 8;  //1GB
 uint32_t Config::RDMA_NUMAREGION = 1;
 std::string Config::RDMA_DEVICE_FILE_PATH;
 uint32_t Config::RDMA_IBPORT = 1;
+int Config::RDMA_GID_INDEX = -1;
+std::string Config::RDMA_RAILS = "";
+size_t Config::RDMA_STRIPE_THRESHOLD = 64 * 1024;
 std::string Config::RDMA_SERVER_ADDRESSES = "172.18.94.20"; // ip node02 RDMA_INTERFACEs
 uint16_t Config::RDMA_PORT = 5200;
 uint32_t Config::RDMA_MAX_WR = 4096;
+size_t Config::RDMA_BULK_CHUNK_SIZE = 1024 * 1024;
+uint32_t Config::RDMA_BULK_WINDOW = 8;
+uint32_t Config::RDMA_MUX_QPS = 4;
 
 uint32_t Config::RDMA_UD_MTU = 4096;
+uint32_t Config::RDMA_UD_RECV_SEGMENTS = 256;
+uint32_t Config::RDMA_UD_REASSEMBLY_TIMEOUT = 10000;
+uint32_t Config::RDMA_UD_RPC_TIMEOUT = 1000;
+uint32_t Config::RDMA_UD_RPC_RETRIES = 5;
+uint32_t Config::RDMA_MCAST_WINDOW = 256;
+uint32_t Config::RDMA_MCAST_RETRANSMIT_TIMEOUT = 1000;
 
 std::string Config::SEQUENCER_IP = "192.168.94.21"; //node02
 uint16_t Config::SEQUENCER_PORT = 5600;
+uint32_t Config::SEQUENCER_LOOKUP_TIMEOUT = 5000;
+uint32_t Config::SEQUENCER_RESYNC_INTERVAL = 500;
 uint32_t Config::RDMA_GET_NODE_ID_RETRIES = 5; // 50
 
 std::string Config::RDMA_INTERFACE = "ib1";
@@ -157,6 +171,32 @@ void Config::set(string key, string value) {
     Config::RDMA_NUMAREGION = stoi(value);
   } else if (key.compare("RDMA_IBPORT") == 0) {
     Config::RDMA_IBPORT = stoi(value);
+  } else if (key.compare("RDMA_GID_INDEX") == 0) {
+    Config::RDMA_GID_INDEX = stoi(value);
+  } else if (key.compare("RDMA_BULK_CHUNK_SIZE") == 0) {
+    Config::RDMA_BULK_CHUNK_SIZE = strtoul(value.c_str(), nullptr, 0);
+  } else if (key.compare("RDMA_BULK_WINDOW") == 0) {
+    Config::RDMA_BULK_WINDOW = stoi(value);
+  } else if (key.compare("RDMA_MUX_QPS") == 0) {
+    Config::RDMA_MUX_QPS = stoi(value);
+  } else if (key.compare("RDMA_UD_MTU") == 0) {
+    Config::RDMA_UD_MTU = stoi(value);
+  } else if (key.compare("RDMA_UD_RECV_SEGMENTS") == 0) {
+    Config::RDMA_UD_RECV_SEGMENTS = stoi(value);
+  } else if (key.compare("RDMA_UD_REASSEMBLY_TIMEOUT") == 0) {
+    Config::RDMA_UD_REASSEMBLY_TIMEOUT = stoi(value);
+  } else if (key.compare("RDMA_UD_RPC_TIMEOUT") == 0) {
+    Config::RDMA_UD_RPC_TIMEOUT = stoi(value);
+  } else if (key.compare("RDMA_UD_RPC_RETRIES") == 0) {
+    Config::RDMA_UD_RPC_RETRIES = stoi(value);
+  } else if (key.compare("RDMA_MCAST_WINDOW") == 0) {
+    Config::RDMA_MCAST_WINDOW = stoi(value);
+  } else if (key.compare("RDMA_MCAST_RETRANSMIT_TIMEOUT") == 0) {
+    Config::RDMA_MCAST_RETRANSMIT_TIMEOUT = stoi(value);
+  } else if (key.compare("RDMA_RAILS") == 0) {
+    Config::RDMA_RAILS = value;
+  } else if (key.compare("RDMA_STRIPE_THRESHOLD") == 0) {
+    Config::RDMA_STRIPE_THRESHOLD = strtoul(value.c_str(), nullptr, 0);
   } else if (key.compare("LOGGING_LEVEL") == 0) {
     Config::LOGGING_LEVEL = stoi(value);
   } else if (key.compare("MLX5_SINGLE_THREADED") == 0) {
@@ -167,6 +207,10 @@ void Config::set(string key, string value) {
     Config::SEQUENCER_IP = value;
   } else if (key.compare("NODE_SEQUENCER_PORT") == 0) {
     Config::SEQUENCER_PORT = stoi(value);
+  } else if (key.compare("NODE_SEQUENCER_LOOKUP_TIMEOUT") == 0) {
+    Config::SEQUENCER_LOOKUP_TIMEOUT = stoi(value);
+  } else if (key.compare("NODE_SEQUENCER_RESYNC_INTERVAL") == 0) {
+    Config::SEQUENCER_RESYNC_INTERVAL = stoi(value);
   } else if (key.compare("RDMA_GET_NODE_ID_RETRIES") == 0) {
     Config::RDMA_GET_NODE_ID_RETRIES = stoi(value);
   } else {
@@ -73,23 +73,43 @@ class Config
     static uint32_t RDMA_NUMAREGION;
     static std::string RDMA_DEVICE_FILE_PATH;
     static uint32_t RDMA_IBPORT;
+    static int RDMA_GID_INDEX; // -1 = LID routing on InfiniBand, auto-selected GID on RoCE
+    static std::string RDMA_RAILS; // rails of MultiRailRDMA as "device:port,...", empty = all active ports at RDMA_NUMAREGION
+    const static uint32_t RDMA_MAX_RAILS = 4;
+    static size_t RDMA_STRIPE_THRESHOLD; // MultiRailRDMA stripes writes/reads of at least this size
+    const static int RDMA_CM_TIMEOUT = 2000; // milliseconds for rdma_cm address and route resolution
+    const static int RDMA_CM_POLL_INTERVAL = 100; // milliseconds a rdma_cm listener waits before checking for shutdown
     static uint32_t RDMA_MAX_WR;
+    const static uint32_t RDMA_RNR_RETRY = 7; // RNR retries of RC QPs, 7 = retry until the peer posted a receive
+    static size_t RDMA_BULK_CHUNK_SIZE; // chunk size of bulk transfers (ReliableRDMA::writeBulk)
+    static uint32_t RDMA_BULK_WINDOW; // outstanding chunks of a bulk transfer
+    static uint32_t RDMA_MUX_QPS; // QPs per peer that MultiplexedRDMA spreads logical connections over
     const static uint32_t RDMA_MAX_SGE = 1;
     const static size_t RDMA_UD_OFFSET = 40;
     const static int RDMA_SLEEP_INTERVAL = 100 * 1000;
-    static uint32_t RDMA_GET_NODE_ID_RETRIES;
+    static uint32_t RDMA_GET_NODE_ID_RETRIES; // deprecated, lookups wait for membership updates
     
     static uint32_t RDMA_UD_MTU;
+    static uint32_t RDMA_UD_RECV_SEGMENTS; // receives posted for segments of SegmentedUnreliableRDMA
+    static uint32_t RDMA_UD_REASSEMBLY_TIMEOUT; // microseconds until a partially received UD message is dropped
+    static uint32_t RDMA_UD_RPC_TIMEOUT; // microseconds until a UD RPC is retransmitted (doubled per retry)
+    static uint32_t RDMA_UD_RPC_RETRIES; // retransmissions of a UD RPC before it fails
+    static uint32_t RDMA_MCAST_WINDOW; // messages of a reliable multicast sender not yet acknowledged by all receivers
+    static uint32_t RDMA_MCAST_RETRANSMIT_TIMEOUT; // microseconds until reliable multicast NACKs and heartbeats are repeated
 
     const static uint32_t RDMA_MINIMUM_MSG_SIZE = 1;
     const static uint32_t GPUDIRECT_MINIMUM_MSG_SIZE = 256;
 
-    const static int PROTO_MAX_SOCKETS = 1024;
+    const static int PROTO_MAX_SOCKETS = 16384; // shared by all sockets of the process
+    const static int PROTO_IO_THREADS = 1; // I/O threads of the process-wide ZMQ context
+    const static int PROTO_POLL_INTERVAL = 100; // milliseconds a server waits before checking for shutdown
     const static int PROTO_SEND_TIMEOUT = 50; // milliseconds
     const static int PROTO_RECV_TIMEOUT = 50; // milliseconds
 
     static std::string SEQUENCER_IP;
     static uint16_t SEQUENCER_PORT;
+    static uint32_t SEQUENCER_LOOKUP_TIMEOUT; // milliseconds to wait for a server to join
+    static uint32_t SEQUENCER_RESYNC_INTERVAL; // milliseconds without membership update before a lookup asks the sequencer
 
     static std::string RDMA_INTERFACE;
 